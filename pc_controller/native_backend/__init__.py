@@ -1,15 +1,29 @@
 """Python package wrapper for the native backend extension.
 
 This package expects a compiled extension named `native_backend` (.pyd/.so)
-located in the same directory. It exposes NativeShimmer and NativeWebcam
-classes. If the extension is missing, importing from this package will raise
-ImportError; the GUI uses Python fallbacks in that case.
+located in the same directory. It exposes the NativeShimmer, NativeShimmerHub,
+NativeWebcam and NativeSynchronizer classes. If the extension is missing, importing from this
+package will raise ImportError; the GUI uses Python fallbacks in that case.
 """
 from __future__ import annotations
 
 try:
-    from .native_backend import NativeShimmer, NativeWebcam, __version__, shimmer_capi_enabled  # type: ignore[attr-defined]
-    __all__ = ["NativeShimmer", "NativeWebcam", "__version__", "shimmer_capi_enabled"]
+    from .native_backend import (  # type: ignore[attr-defined]
+        NativeShimmer,
+        NativeShimmerHub,
+        NativeSynchronizer,
+        NativeWebcam,
+        __version__,
+        shimmer_capi_enabled,
+    )
+    __all__ = [
+        "NativeShimmer",
+        "NativeShimmerHub",
+        "NativeSynchronizer",
+        "NativeWebcam",
+        "__version__",
+        "shimmer_capi_enabled",
+    ]
 except Exception as exc:  # pragma: no cover - optional
     raise ImportError(
         "native_backend extension not found. Build it with CMake and place the compiled "
@@ -0,0 +1,96 @@
+// Cost of draining Shimmer samples into Python: list of tuples versus NumPy
+// arrays versus a caller-preallocated buffer, called through the real
+// bindings in an embedded interpreter.
+//
+// The module is compiled into this executable and registered as a built-in
+// before the interpreter starts, so the numbers include argument parsing,
+// GIL release and result conversion exactly as Python code sees them.
+
+#include <benchmark/benchmark.h>
+#include <pybind11/embed.h>
+
+#include "../native_backend.cpp"
+
+namespace {
+
+// Connected simulator whose ring is refilled outside the timed region
+class DrainFixture {
+public:
+    explicit DrainFixture(size_t rows) : _rows(rows), _dev(rows) {
+        SimulatorConfig cfg;
+        cfg.unpaced = true;
+        _dev.configure_simulation(cfg);
+        _dev.connect("SIM");
+        _dev.begin_external_streaming();
+    }
+
+    ~DrainFixture() { _dev.stop_streaming(); }
+
+    void refill() {
+        while (_dev.ring().size() < _rows) _dev.poll(0);
+    }
+
+    // Python view of the C++ object; the fixture keeps ownership
+    py::object handle() { return py::cast(&_dev, py::return_value_policy::reference); }
+
+private:
+    size_t _rows;
+    NativeShimmer _dev;
+};
+
+bool numpy_available() {
+    try {
+        py::module_::import("numpy");
+        return true;
+    } catch (const py::error_already_set&) {
+        return false;
+    }
+}
+
+void run_drain(benchmark::State& state, const char* method, bool preallocated) {
+    if (std::string(method) != "get_latest_samples" && !numpy_available()) {
+        state.SkipWithError("numpy is not importable");
+        return;
+    }
+    const auto rows = static_cast<size_t>(state.range(0));
+    DrainFixture fx(rows);
+    py::object dev = fx.handle();
+    py::object fn = dev.attr(method);
+    py::object ts, vals;
+    if (preallocated) {
+        auto np = py::module_::import("numpy");
+        ts = np.attr("empty")(rows);
+        vals = np.attr("empty")(rows);
+    }
+    for (auto _ : state) {
+        state.PauseTiming();
+        fx.refill();
+        state.ResumeTiming();
+        py::object out = preallocated ? fn(ts, vals) : fn();
+        benchmark::DoNotOptimize(out.ptr());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+}
+
+void BM_DrainListOfTuples(benchmark::State& state) { run_drain(state, "get_latest_samples", false); }
+void BM_DrainArray(benchmark::State& state) { run_drain(state, "get_latest_samples_array", false); }
+void BM_DrainInto(benchmark::State& state) { run_drain(state, "drain_into", true); }
+
+BENCHMARK(BM_DrainListOfTuples)->Arg(128)->Arg(4096)->Arg(65536);
+BENCHMARK(BM_DrainArray)->Arg(128)->Arg(4096)->Arg(65536);
+BENCHMARK(BM_DrainInto)->Arg(128)->Arg(4096)->Arg(65536);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    // Must precede interpreter start-up
+    PyImport_AppendInittab("native_backend", &PyInit_native_backend);
+    py::scoped_interpreter interpreter;
+    py::module_::import("native_backend");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
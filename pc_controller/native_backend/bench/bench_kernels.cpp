@@ -0,0 +1,280 @@
+// Benchmarks of the pybind-free hot paths: ring buffers, GSR conversion and
+// webcam frame handoff/conversion.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_analysis.h"
+#include "frame_pool.h"
+#include "gsr_conversion.h"
+#include "pixel_format.h"
+#include "soa_ring.h"
+#include "stream_sync.h"
+
+namespace {
+
+double steady_ns() {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+// Push a batch of `capacity` rows, then drain it: uncontended throughput
+void BM_SpscRingPushPop(benchmark::State& state) {
+    const auto cap = static_cast<size_t>(state.range(0));
+    SpscRing ring(cap);
+    std::vector<double> ts(cap), vals(cap);
+    for (auto _ : state) {
+        for (size_t i = 0; i < cap; ++i) ring.push(static_cast<double>(i), 1.0);
+        benchmark::DoNotOptimize(ring.pop_into(cap, ts.data(), vals.data()));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * cap));
+}
+BENCHMARK(BM_SpscRingPushPop)->RangeMultiplier(16)->Range(256, 65536);
+
+// Shimmer-shaped rows pushed one call per row vs one push_n per hardware read
+void BM_ShimmerRingPush(benchmark::State& state) {
+    const auto batch = static_cast<size_t>(state.range(0));
+    SoaRing<double, double, double, double, uint16_t, uint16_t, uint32_t> ring(1 << 14);
+    std::vector<double> ts(batch, 1.0);
+    std::vector<uint16_t> raw(batch, 1);
+    std::vector<uint32_t> flags(batch, 3);
+    const bool bulk = state.range(1) != 0;
+    for (auto _ : state) {
+        if (bulk) {
+            ring.push_n(batch, ts.data(), ts.data(), ts.data(), ts.data(), raw.data(), raw.data(), flags.data());
+        } else {
+            for (size_t i = 0; i < batch; ++i) ring.push(ts[i], ts[i], ts[i], ts[i], raw[i], raw[i], flags[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_ShimmerRingPush)->ArgsProduct({{8, 64, 256}, {0, 1}});
+
+// Producer pushes while a consumer thread drains in 256-row batches
+void BM_SpscRingContended(benchmark::State& state) {
+    const auto cap = static_cast<size_t>(state.range(0));
+    SpscRing ring(cap);
+    std::atomic<bool> stop{false};
+    std::thread consumer([&] {
+        std::vector<double> ts(256), vals(256);
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (ring.pop_into(ts.size(), ts.data(), vals.data()) == 0) std::this_thread::yield();
+        }
+    });
+    for (auto _ : state) {
+        for (int i = 0; i < 1024; ++i) ring.push(static_cast<double>(i), 1.0);
+    }
+    stop.store(true);
+    consumer.join();
+    state.SetItemsProcessed(state.iterations() * 1024);
+    // Rows the consumer lost because it fell a full ring behind
+    state.counters["dropped_ratio"] =
+        static_cast<double>(ring.dropped()) / static_cast<double>(std::max<uint64_t>(1, ring.total_pushed()));
+}
+BENCHMARK(BM_SpscRingContended)->RangeMultiplier(16)->Range(256, 65536)->UseRealTime();
+
+// One row handed to a spinning consumer thread and acknowledged: the time
+// per iteration is the producer -> consumer -> producer round trip
+void BM_SpscRingLatency(benchmark::State& state) {
+    SpscRing ring(static_cast<size_t>(state.range(0)));
+    std::atomic<uint64_t> acked{0};
+    std::atomic<bool> stop{false};
+    std::atomic<double> one_way_sum{0.0};
+    std::thread consumer([&] {
+        double ts = 0.0, val = 0.0;
+        double sum = 0.0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (ring.pop_into(1, &ts, &val) == 1) {
+                sum += steady_ns() - ts;
+                acked.fetch_add(1, std::memory_order_release);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        one_way_sum.store(sum);
+    });
+    uint64_t sent = 0;
+    for (auto _ : state) {
+        ring.push(steady_ns(), 0.0);
+        ++sent;
+        // Yield rather than spin so the round trip stays meaningful on few cores
+        while (acked.load(std::memory_order_acquire) < sent) std::this_thread::yield();
+    }
+    stop.store(true);
+    consumer.join();
+    state.counters["one_way_ns"] = one_way_sum.load() / static_cast<double>(std::max<uint64_t>(1, sent));
+}
+BENCHMARK(BM_SpscRingLatency)->Arg(4096)->UseRealTime();
+
+std::vector<uint16_t> gsr_words(size_t n) {
+    std::vector<uint16_t> raw(n);
+    uint32_t x = 1;
+    for (auto& w : raw) {
+        x = 1664525u * x + 1013904223u;
+        w = static_cast<uint16_t>(((x >> 8) & 0xFFF) | ((x >> 30) << 14));
+    }
+    return raw;
+}
+
+void BM_GsrConvert(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const std::vector<uint16_t> raw = gsr_words(n);
+    std::vector<double> out(n);
+    const GsrCalibration cal;
+    for (auto _ : state) {
+        gsr_raw_to_microsiemens(raw.data(), out.data(), n, cal);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+    state.SetLabel(gsr_kernel_name());
+}
+BENCHMARK(BM_GsrConvert)->Arg(32)->Arg(4096)->Arg(1 << 20);
+
+void BM_GsrConvertScalar(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const std::vector<uint16_t> raw = gsr_words(n);
+    std::vector<double> out(n);
+    const gsr_detail::Coefficients c{GsrCalibration{}};
+    for (auto _ : state) {
+        gsr_detail::convert_scalar(raw.data(), out.data(), n, c);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK(BM_GsrConvertScalar)->Arg(32)->Arg(4096)->Arg(1 << 20);
+
+// Capture-side cost of one frame: acquire a free buffer, publish it, and a
+// consumer taking the latest reference (no pixel copy)
+void BM_FrameHandoff(benchmark::State& state) {
+    const int w = static_cast<int>(state.range(0)), h = static_cast<int>(state.range(1));
+    const size_t bytes = pixel_format_frame_bytes(PixelFormat::BGR, w, h);
+    FramePool pool(bytes);
+    for (auto _ : state) {
+        auto buf = pool.acquire();
+        buf->prepare(PixelFormat::BGR, w, h, bytes);
+        pool.publish(std::move(buf));
+        benchmark::DoNotOptimize(pool.latest());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameHandoff)->Args({640, 480})->Args({1920, 1080});
+
+// Same handoff to a consumer thread blocked in wait_newer()
+void BM_FrameHandoffToWaiter(benchmark::State& state) {
+    const size_t bytes = pixel_format_frame_bytes(PixelFormat::BGR, 640, 480);
+    FramePool pool(bytes);
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> seen{0};
+    std::thread consumer([&] {
+        uint64_t last = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (auto f = pool.wait_newer(last, std::chrono::milliseconds(10))) {
+                last = f->seq;
+                seen.store(last, std::memory_order_release);
+            }
+        }
+    });
+    uint64_t published = 0;
+    for (auto _ : state) {
+        auto buf = pool.acquire();
+        if (!buf) continue;
+        buf->prepare(PixelFormat::BGR, 640, 480, bytes);
+        pool.publish(std::move(buf));
+        ++published;
+        while (seen.load(std::memory_order_acquire) < published) std::this_thread::yield();
+    }
+    stop.store(true);
+    pool.wake_all();
+    consumer.join();
+    state.SetItemsProcessed(static_cast<int64_t>(published));
+}
+BENCHMARK(BM_FrameHandoffToWaiter)->UseRealTime();
+
+// Native pixel layout -> packed BGR, as done for get_latest_frame()
+void BM_FrameToBgr(benchmark::State& state) {
+    const auto fmt = static_cast<PixelFormat>(state.range(0));
+    const int w = static_cast<int>(state.range(1)), h = static_cast<int>(state.range(2));
+    std::vector<uint8_t> src(pixel_format_frame_bytes(fmt, w, h), 128);
+    std::vector<uint8_t> dst(static_cast<size_t>(w) * static_cast<size_t>(h) * 3);
+    for (auto _ : state) {
+        convert_to_bgr(fmt, src.data(), src.size(), w, h, dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * dst.size()));
+    state.SetLabel(std::string(pixel_format_name(fmt)) + "/" + pixel_kernel_name());
+}
+BENCHMARK(BM_FrameToBgr)
+    ->Args({static_cast<int>(PixelFormat::YUYV), 640, 480})
+    ->Args({static_cast<int>(PixelFormat::YUYV), 1920, 1080})
+    ->Args({static_cast<int>(PixelFormat::NV12), 1920, 1080})
+    ->Args({static_cast<int>(PixelFormat::GRAY), 1920, 1080});
+
+
+// Mean and variance over one full-frame ROI, as done by the webcam analysis stage
+void BM_FrameRoiStats(benchmark::State& state) {
+    const auto fmt = static_cast<PixelFormat>(state.range(0));
+    const int w = static_cast<int>(state.range(1)), h = static_cast<int>(state.range(2));
+    std::vector<uint8_t> src(pixel_format_frame_bytes(fmt, w, h));
+    for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<uint8_t>(i * 7);
+    const std::vector<FrameRoi> rois{{0, 0, w, h}};
+    std::vector<uint8_t> row;
+    RoiStats out;
+    for (auto _ : state) {
+        frame_roi_stats(fmt, src.data(), w, h, rois, row, &out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * w * h);
+    state.SetLabel(std::string(pixel_format_name(fmt)) + "/" + analysis_kernel_name());
+}
+BENCHMARK(BM_FrameRoiStats)
+    ->Args({static_cast<int>(PixelFormat::BGR), 640, 480})
+    ->Args({static_cast<int>(PixelFormat::BGR), 1920, 1080})
+    ->Args({static_cast<int>(PixelFormat::YUYV), 640, 480});
+
+void BM_FrameRoiStatsScalar(benchmark::State& state) {
+    const int w = static_cast<int>(state.range(0)), h = static_cast<int>(state.range(1));
+    std::vector<uint8_t> src(static_cast<size_t>(w) * static_cast<size_t>(h) * 3);
+    for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<uint8_t>(i * 7);
+    for (auto _ : state) {
+        ChannelSums s;
+        analysis_detail::accumulate_scalar(src.data(), static_cast<size_t>(w) * static_cast<size_t>(h), s);
+        benchmark::DoNotOptimize(s);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * w * h);
+}
+BENCHMARK(BM_FrameRoiStatsScalar)->Args({640, 480})->Args({1920, 1080});
+
+// One second of 128 Hz GSR per device and 30 fps video per camera, joined in 10 ms polls
+void BM_StreamJoin(benchmark::State& state) {
+    const auto devices = static_cast<size_t>(state.range(0)), cameras = static_cast<size_t>(state.range(1));
+    StreamJoiner joiner(devices, cameras, SyncConfig{}, 0);
+    double t = 0.0;
+    uint64_t seq = 0;
+    for (auto _ : state) {
+        for (int poll = 0; poll < 100; ++poll, t += 0.01) {
+            double ts[2] = {t, t + 1.0 / 128}, gsr[2] = {5.0, 5.1};
+            uint32_t flags[2] = {0, 0};
+            for (size_t d = 0; d < devices; ++d) joiner.add_samples(d, ts, gsr, flags, poll % 3 == 0 ? 2 : 1);
+            if (poll % 3 == 0) {
+                ++seq;
+                for (size_t c = 0; c < cameras; ++c) joiner.add_frame(c, seq, t);
+            }
+            joiner.join(false);
+        }
+        for (size_t c = 0; c < cameras; ++c) benchmark::DoNotOptimize(joiner.pop(c));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 34 * static_cast<int64_t>(cameras));
+}
+BENCHMARK(BM_StreamJoin)->Args({1, 1})->Args({4, 4});
+
+}  // namespace
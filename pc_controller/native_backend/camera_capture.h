@@ -0,0 +1,650 @@
+#pragma once
+
+// Native camera capture without OpenCV.
+//
+// open_native_camera() returns the backend for this platform:
+//
+//   Linux    V4L2 streaming I/O (USE_V4L2). Driver buffers are mmap'd once
+//            and published as FrameBuffers that point straight at them; a
+//            buffer is handed back to the driver (VIDIOC_QBUF) only once no
+//            consumer references it any more. Frames carry the driver's
+//            CLOCK_MONOTONIC capture time.
+//   Windows  Media Foundation source reader (USE_MEDIA_FOUNDATION). Each
+//            sample's buffer stays locked and is wrapped in place until its
+//            last reference is dropped; frames carry the sample's QPC device
+//            reference time.
+//
+// Timestamps are converted to steady_clock seconds, the clock of every other
+// native stream. Layouts the pixel kernels cannot use in place (padded rows,
+// bottom-up RGB, GRAY taken from a YUYV stream) are copied into pooled
+// buffers instead.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "frame_pool.h"
+
+#if defined(USE_V4L2) && defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#define CAMERA_HAVE_V4L2 1
+#endif
+
+#if defined(USE_MEDIA_FOUNDATION) && defined(_WIN32)
+#include <windows.h>
+#include <mfapi.h>
+#include <mferror.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#define CAMERA_HAVE_MEDIA_FOUNDATION 1
+#endif
+
+class CameraCapture {
+public:
+    virtual ~CameraCapture() = default;
+
+    // Next frame, prepared and timestamped, or nullptr if none arrived within
+    // timeout. Throws std::runtime_error when the device fails (e.g. unplugged).
+    virtual std::shared_ptr<FrameBuffer> read(std::chrono::milliseconds timeout) = 0;
+
+    virtual const char* name() const = 0;
+
+    // Negotiated mode; may differ from the request
+    int width() const { return _width; }
+    int height() const { return _height; }
+    PixelFormat format() const { return _delivered; }
+
+protected:
+    // Bytes per row of a tightly packed plane (the first plane for NV12)
+    static size_t packed_row_bytes(PixelFormat f, int width) {
+        switch (f) {
+            case PixelFormat::BGR: return static_cast<size_t>(width) * 3;
+            case PixelFormat::YUYV: return static_cast<size_t>(width) * 2;
+            default: return static_cast<size_t>(width);
+        }
+    }
+
+    // Bytes copy_frame() reads from a source with row stride src_stride
+    size_t source_frame_bytes(ptrdiff_t src_stride) const {
+        int rows = _height;
+        if (_negotiated == PixelFormat::NV12) rows += _height / 2;
+        const auto step = static_cast<size_t>(src_stride < 0 ? -src_stride : src_stride);
+        return step * static_cast<size_t>(rows - 1) + packed_row_bytes(_negotiated, _width);
+    }
+
+    // Copy a frame with source row stride src_stride (negative for bottom-up
+    // rows, src then points at the first row in memory) into a tight buffer,
+    // taking only the luma bytes when a YUYV frame is delivered as GRAY
+    void copy_frame(const uint8_t* src, ptrdiff_t src_stride, uint8_t* dst) const {
+        const size_t row = packed_row_bytes(_delivered, _width);
+        int rows = _height;
+        if (_negotiated == PixelFormat::NV12) rows += _height / 2;
+        const ptrdiff_t step = src_stride < 0 ? -src_stride : src_stride;
+        const uint8_t* first = src_stride < 0 ? src + step * (rows - 1) : src;
+        for (int y = 0; y < rows; ++y) {
+            const uint8_t* s = first + src_stride * y;
+            uint8_t* d = dst + row * static_cast<size_t>(y);
+            if (_negotiated == PixelFormat::YUYV && _delivered == PixelFormat::GRAY) {
+                for (size_t x = 0; x < row; ++x) d[x] = s[x * 2];
+            } else {
+                std::memcpy(d, s, row);
+            }
+        }
+    }
+
+    static double steady_seconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int _width{0};
+    int _height{0};
+    PixelFormat _negotiated{PixelFormat::BGR};  // layout the device fills
+    PixelFormat _delivered{PixelFormat::BGR};   // layout handed to consumers
+};
+
+#if defined(CAMERA_HAVE_V4L2)
+class V4L2Capture : public CameraCapture {
+public:
+    // Throws std::runtime_error if the device cannot stream in a supported format
+    V4L2Capture(const std::string& path, int width, int height, double fps, PixelFormat format) {
+        _fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (_fd < 0) {
+            throw std::runtime_error(errno_text("Cannot open " + path));
+        }
+        try {
+            setup(width, height, fps, format);
+        } catch (...) {
+            teardown();
+            throw;
+        }
+    }
+
+    ~V4L2Capture() override { teardown(); }
+
+    V4L2Capture(const V4L2Capture&) = delete;
+    V4L2Capture& operator=(const V4L2Capture&) = delete;
+
+    const char* name() const override { return "v4l2"; }
+
+    std::shared_ptr<FrameBuffer> read(std::chrono::milliseconds timeout) override {
+        requeue_released();
+        if (_queued == 0) {
+            // Consumers hold every driver buffer; wait for one to come back
+            std::this_thread::sleep_for(std::min(timeout, std::chrono::milliseconds(2)));
+            return nullptr;
+        }
+        pollfd pfd{_fd, POLLIN, 0};
+        int rc = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+        if (rc < 0) {
+            if (errno == EINTR) return nullptr;
+            throw std::runtime_error(errno_text("V4L2 poll failed"));
+        }
+        if (rc == 0) return nullptr;
+
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(_fd, VIDIOC_DQBUF, &buf) < 0) {
+            if (errno == EAGAIN) return nullptr;
+            throw std::runtime_error(errno_text("VIDIOC_DQBUF failed"));
+        }
+        --_queued;
+        Slot& slot = _slots[buf.index];
+        if ((buf.flags & V4L2_BUF_FLAG_ERROR) || buf.bytesused == 0) {
+            queue(buf.index);
+            return nullptr;
+        }
+        const double ts = timestamp_of(buf);
+        const size_t frame_bytes =
+            _delivered == PixelFormat::MJPG ? buf.bytesused : pixel_format_frame_bytes(_delivered, _width, _height);
+
+        // With the driver queue empty, capture would stall until a consumer
+        // lets go of a frame; copy this one out and hand the buffer straight back
+        if (_copy || _queued == 0) {
+            auto out = _copies.acquire();
+            if (out) {
+                out->prepare(_delivered, _width, _height, frame_bytes);
+                if (_delivered == PixelFormat::MJPG) {
+                    std::memcpy(out->pixels(), slot.addr, frame_bytes);
+                } else {
+                    copy_frame(static_cast<const uint8_t*>(slot.addr), static_cast<ptrdiff_t>(_bytesperline),
+                               out->pixels());
+                }
+                out->timestamp = ts;
+            }
+            queue(buf.index);
+            return out;
+        }
+        slot.frame->prepare(_delivered, _width, _height, std::min(frame_bytes, slot.frame->capacity()));
+        slot.frame->timestamp = ts;
+        slot.out = true;
+        return slot.frame;
+    }
+
+private:
+    // Driver buffers; 4 keeps capture running while the latest frame and a
+    // recorder or encoder each hold one
+    static constexpr unsigned kBuffers = 4;
+
+    struct Mapping {
+        Mapping(void* a, size_t n) : addr(a), length(n) {}
+        ~Mapping() { ::munmap(addr, length); }
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+        void* addr;
+        size_t length;
+    };
+
+    struct Slot {
+        void* addr;
+        std::shared_ptr<FrameBuffer> frame;  // wraps the mapping
+        bool out;                            // dequeued and not yet handed back
+    };
+
+    static int xioctl(int fd, unsigned long request, void* arg) {
+        int rc;
+        do {
+            rc = ::ioctl(fd, request, arg);
+        } while (rc == -1 && errno == EINTR);
+        return rc;
+    }
+
+    static std::string errno_text(const std::string& what) { return what + ": " + std::strerror(errno); }
+
+    static uint32_t fourcc_of(PixelFormat f) {
+        switch (f) {
+            case PixelFormat::BGR: return V4L2_PIX_FMT_BGR24;
+            case PixelFormat::GRAY: return V4L2_PIX_FMT_GREY;
+            case PixelFormat::YUYV: return V4L2_PIX_FMT_YUYV;
+            case PixelFormat::NV12: return V4L2_PIX_FMT_NV12;
+            case PixelFormat::MJPG: return V4L2_PIX_FMT_MJPEG;
+        }
+        return V4L2_PIX_FMT_YUYV;
+    }
+
+    static bool pixel_format_of(uint32_t fourcc, PixelFormat& out) {
+        switch (fourcc) {
+            case V4L2_PIX_FMT_BGR24: out = PixelFormat::BGR; return true;
+            case V4L2_PIX_FMT_GREY: out = PixelFormat::GRAY; return true;
+            case V4L2_PIX_FMT_YUYV: out = PixelFormat::YUYV; return true;
+            case V4L2_PIX_FMT_NV12: out = PixelFormat::NV12; return true;
+#ifdef USE_LIBJPEG
+            case V4L2_PIX_FMT_MJPEG:
+            case V4L2_PIX_FMT_JPEG: out = PixelFormat::MJPG; return true;
+#endif
+            default: return false;
+        }
+    }
+
+    // S_FMT with the requested fourcc; true if the driver settled on a format we handle
+    bool try_format(int width, int height, uint32_t fourcc, v4l2_format& fmt) {
+        fmt = v4l2_format{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = static_cast<uint32_t>(width);
+        fmt.fmt.pix.height = static_cast<uint32_t>(height);
+        fmt.fmt.pix.pixelformat = fourcc;
+        fmt.fmt.pix.field = V4L2_FIELD_ANY;
+        if (xioctl(_fd, VIDIOC_S_FMT, &fmt) < 0) return false;
+        return pixel_format_of(fmt.fmt.pix.pixelformat, _negotiated);
+    }
+
+    void setup(int width, int height, double fps, PixelFormat format) {
+        v4l2_capability cap{};
+        if (xioctl(_fd, VIDIOC_QUERYCAP, &cap) < 0) {
+            throw std::runtime_error(errno_text("VIDIOC_QUERYCAP failed"));
+        }
+        const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+        if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+            throw std::runtime_error("V4L2 device does not support streaming capture");
+        }
+
+        // The requested format, else YUYV (every UVC camera has it), else MJPG
+        v4l2_format fmt{};
+        if (!try_format(width, height, fourcc_of(format), fmt) &&
+            !try_format(width, height, V4L2_PIX_FMT_YUYV, fmt) &&
+            !try_format(width, height, V4L2_PIX_FMT_MJPEG, fmt)) {
+            throw std::runtime_error("V4L2 device offers no supported pixel format");
+        }
+        _width = static_cast<int>(fmt.fmt.pix.width);
+        _height = static_cast<int>(fmt.fmt.pix.height);
+        _bytesperline = fmt.fmt.pix.bytesperline;
+        _delivered = (format == PixelFormat::GRAY && _negotiated == PixelFormat::YUYV) ? PixelFormat::GRAY : _negotiated;
+        _copy = _delivered != _negotiated ||
+                (_negotiated != PixelFormat::MJPG && _bytesperline != packed_row_bytes(_negotiated, _width));
+        _copies.set_frame_bytes(pixel_format_frame_bytes(_delivered, _width, _height));
+
+        v4l2_streamparm parm{};
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(_fd, VIDIOC_G_PARM, &parm) == 0 && (parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME)) {
+            parm.parm.capture.timeperframe.numerator = 1000;
+            parm.parm.capture.timeperframe.denominator = static_cast<uint32_t>(std::lround(fps * 1000.0));
+            xioctl(_fd, VIDIOC_S_PARM, &parm);  // best effort; the driver rounds to a supported rate
+        }
+
+        v4l2_requestbuffers req{};
+        req.count = kBuffers;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(_fd, VIDIOC_REQBUFS, &req) < 0) {
+            throw std::runtime_error(errno_text("VIDIOC_REQBUFS failed"));
+        }
+        if (req.count < 2) {
+            throw std::runtime_error("V4L2 driver granted fewer than two buffers");
+        }
+        for (uint32_t i = 0; i < req.count; ++i) {
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (xioctl(_fd, VIDIOC_QUERYBUF, &buf) < 0) {
+                throw std::runtime_error(errno_text("VIDIOC_QUERYBUF failed"));
+            }
+            void* addr = ::mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, buf.m.offset);
+            if (addr == MAP_FAILED) {
+                throw std::runtime_error(errno_text("Mapping a V4L2 buffer failed"));
+            }
+            // Consumers may outlive the capture; the last reference unmaps
+            auto mapping = std::make_shared<Mapping>(addr, buf.length);
+            auto frame = std::make_shared<FrameBuffer>(static_cast<uint8_t*>(addr), buf.length, std::move(mapping));
+            _slots.push_back(Slot{addr, std::move(frame), false});
+        }
+        for (uint32_t i = 0; i < _slots.size(); ++i) {
+            queue(i);
+        }
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(_fd, VIDIOC_STREAMON, &type) < 0) {
+            throw std::runtime_error(errno_text("VIDIOC_STREAMON failed"));
+        }
+        timespec mono{};
+        ::clock_gettime(CLOCK_MONOTONIC, &mono);
+        _mono_offset = steady_seconds() - (static_cast<double>(mono.tv_sec) + mono.tv_nsec * 1e-9);
+    }
+
+    void teardown() {
+        if (_fd < 0) return;
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(_fd, VIDIOC_STREAMOFF, &type);
+        _slots.clear();  // mappings still referenced by consumers stay valid
+        ::close(_fd);
+        _fd = -1;
+    }
+
+    void queue(uint32_t index) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        if (xioctl(_fd, VIDIOC_QBUF, &buf) < 0) {
+            throw std::runtime_error(errno_text("VIDIOC_QBUF failed"));
+        }
+        ++_queued;
+    }
+
+    // Hand back every dequeued buffer that only this capture still references
+    void requeue_released() {
+        for (uint32_t i = 0; i < _slots.size(); ++i) {
+            Slot& slot = _slots[i];
+            if (slot.out && slot.frame.use_count() == 1) {
+                // Pair with the consumers' release of their last reference
+                std::atomic_thread_fence(std::memory_order_acquire);
+                slot.out = false;
+                queue(i);
+            }
+        }
+    }
+
+    double timestamp_of(const v4l2_buffer& buf) const {
+        if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+            return static_cast<double>(buf.timestamp.tv_sec) + buf.timestamp.tv_usec * 1e-6 + _mono_offset;
+        }
+        return steady_seconds();
+    }
+
+    int _fd{-1};
+    uint32_t _bytesperline{0};
+    bool _copy{false};
+    unsigned _queued{0};
+    double _mono_offset{0.0};  // steady_clock - CLOCK_MONOTONIC, seconds
+    std::vector<Slot> _slots;
+    FramePool _copies{0};
+};
+#endif
+
+#if defined(CAMERA_HAVE_MEDIA_FOUNDATION)
+class MediaFoundationCapture : public CameraCapture {
+public:
+    // nullptr if there is no video capture device with this index
+    static std::unique_ptr<MediaFoundationCapture> open(int device_id, int width, int height, double fps,
+                                                        PixelFormat format) {
+        std::unique_ptr<MediaFoundationCapture> cam(new MediaFoundationCapture());
+        if (!cam->open_device(device_id)) return nullptr;
+        cam->select_type(width, height, fps, format);
+        return cam;
+    }
+
+    ~MediaFoundationCapture() override { release(); }
+
+    MediaFoundationCapture(const MediaFoundationCapture&) = delete;
+    MediaFoundationCapture& operator=(const MediaFoundationCapture&) = delete;
+
+    const char* name() const override { return "mediafoundation"; }
+
+    // ReadSample is synchronous: the timeout is bounded by one frame interval
+    std::shared_ptr<FrameBuffer> read(std::chrono::milliseconds) override {
+        DWORD stream = 0, flags = 0;
+        LONGLONG sample_time = 0;
+        IMFSample* sample = nullptr;
+        check(_reader->ReadSample(MF_SOURCE_READER_FIRST_VIDEO_STREAM, 0, &stream, &flags, &sample_time, &sample),
+              "ReadSample failed");
+        if (flags & (MF_SOURCE_READERF_ERROR | MF_SOURCE_READERF_ENDOFSTREAM)) {
+            if (sample) sample->Release();
+            throw std::runtime_error("Media Foundation capture stopped");
+        }
+        if (!sample) return nullptr;  // stream tick
+        const double ts = timestamp_of(sample);
+        IMFMediaBuffer* buffer = nullptr;
+        HRESULT hr = sample->ConvertToContiguousBuffer(&buffer);
+        sample->Release();
+        check(hr, "ConvertToContiguousBuffer failed");
+        BYTE* data = nullptr;
+        DWORD max_length = 0, length = 0;
+        hr = buffer->Lock(&data, &max_length, &length);
+        if (FAILED(hr)) {
+            buffer->Release();
+            check(hr, "Locking a Media Foundation buffer failed");
+        }
+        auto locked = std::make_shared<LockedBuffer>(buffer);
+        const size_t frame_bytes =
+            _delivered == PixelFormat::MJPG ? length : pixel_format_frame_bytes(_delivered, _width, _height);
+
+        if (length < frame_bytes) return nullptr;  // truncated sample
+        if (_copy) {
+            if (length < source_frame_bytes(_stride)) return nullptr;  // truncated padded or bottom-up rows
+            auto out = _copies.acquire();
+            if (out) {
+                // copy_frame() writes exactly the tight frame_bytes
+                out->prepare(_delivered, _width, _height, frame_bytes);
+                copy_frame(data, _stride, out->pixels());
+                out->timestamp = ts;
+            }
+            return out;  // locked goes out of scope and unlocks the sample
+        }
+        auto frame = std::make_shared<FrameBuffer>(data, length, std::move(locked));
+        frame->prepare(_delivered, _width, _height, frame_bytes);
+        frame->timestamp = ts;
+        return frame;
+    }
+
+private:
+    struct LockedBuffer {
+        explicit LockedBuffer(IMFMediaBuffer* b) : buffer(b) {}
+        ~LockedBuffer() {
+            buffer->Unlock();
+            buffer->Release();
+        }
+        LockedBuffer(const LockedBuffer&) = delete;
+        LockedBuffer& operator=(const LockedBuffer&) = delete;
+        IMFMediaBuffer* buffer;
+    };
+
+    MediaFoundationCapture() {
+        HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+        _com = SUCCEEDED(hr);  // RPC_E_CHANGED_MODE: COM already set up on this thread
+        hr = MFStartup(MF_VERSION, MFSTARTUP_LITE);
+        if (FAILED(hr)) {
+            if (_com) CoUninitialize();
+            check(hr, "MFStartup failed");
+        }
+        _mf = true;
+    }
+
+    static void check(HRESULT hr, const char* what) {
+        if (FAILED(hr)) {
+            char code[16];
+            std::snprintf(code, sizeof(code), "0x%08lx", static_cast<unsigned long>(hr));
+            throw std::runtime_error(std::string(what) + " (" + code + ")");
+        }
+    }
+
+    bool open_device(int device_id) {
+        IMFAttributes* attrs = nullptr;
+        check(MFCreateAttributes(&attrs, 1), "MFCreateAttributes failed");
+        attrs->SetGUID(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE, MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_GUID);
+        IMFActivate** devices = nullptr;
+        UINT32 count = 0;
+        HRESULT hr = MFEnumDeviceSources(attrs, &devices, &count);
+        attrs->Release();
+        check(hr, "MFEnumDeviceSources failed");
+        const bool found = device_id >= 0 && static_cast<UINT32>(device_id) < count;
+        if (found) {
+            hr = devices[device_id]->ActivateObject(IID_PPV_ARGS(&_source));
+        }
+        for (UINT32 i = 0; i < count; ++i) devices[i]->Release();
+        CoTaskMemFree(devices);
+        if (!found) return false;
+        check(hr, "Activating the capture device failed");
+        check(MFCreateSourceReaderFromMediaSource(_source, nullptr, &_reader), "Creating the source reader failed");
+        return true;
+    }
+
+    static bool pixel_format_of(const GUID& subtype, PixelFormat& out) {
+        if (subtype == MFVideoFormat_RGB24) { out = PixelFormat::BGR; return true; }
+        if (subtype == MFVideoFormat_L8) { out = PixelFormat::GRAY; return true; }
+        if (subtype == MFVideoFormat_YUY2) { out = PixelFormat::YUYV; return true; }
+        if (subtype == MFVideoFormat_NV12) { out = PixelFormat::NV12; return true; }
+#ifdef USE_LIBJPEG
+        if (subtype == MFVideoFormat_MJPG) { out = PixelFormat::MJPG; return true; }
+#endif
+        return false;
+    }
+
+    // Lower is better: an exact format first, then GRAY from a NV12 or YUYV stream, then YUYV
+    static int format_rank(PixelFormat want, PixelFormat got) {
+        if (got == want) return 0;
+        if (want == PixelFormat::GRAY && got == PixelFormat::NV12) return 1;
+        if (got == PixelFormat::YUYV) return 2;
+        return 3;
+    }
+
+    // Pick the native media type closest to the request and make it current
+    void select_type(int width, int height, double fps, PixelFormat format) {
+        IMFMediaType* best = nullptr;
+        double best_score = 0.0;
+        for (DWORD i = 0;; ++i) {
+            IMFMediaType* type = nullptr;
+            if (FAILED(_reader->GetNativeMediaType(MF_SOURCE_READER_FIRST_VIDEO_STREAM, i, &type))) break;
+            GUID subtype{};
+            UINT32 w = 0, h = 0, num = 0, den = 1;
+            PixelFormat pf;
+            if (SUCCEEDED(type->GetGUID(MF_MT_SUBTYPE, &subtype)) && pixel_format_of(subtype, pf) &&
+                SUCCEEDED(MFGetAttributeSize(type, MF_MT_FRAME_SIZE, &w, &h))) {
+                MFGetAttributeRatio(type, MF_MT_FRAME_RATE, &num, &den);
+                const double rate = den ? static_cast<double>(num) / den : 0.0;
+                const double score = format_rank(format, pf) * 1e12 +
+                                     std::fabs(static_cast<double>(w) * h - static_cast<double>(width) * height) * 1e3 +
+                                     std::fabs(rate - fps);
+                if (!best || score < best_score) {
+                    if (best) best->Release();
+                    best = type;
+                    best_score = score;
+                    _negotiated = pf;
+                    _width = static_cast<int>(w);
+                    _height = static_cast<int>(h);
+                    continue;
+                }
+            }
+            type->Release();
+        }
+        if (!best) {
+            throw std::runtime_error("Capture device offers no supported pixel format");
+        }
+        HRESULT hr = _reader->SetCurrentMediaType(MF_SOURCE_READER_FIRST_VIDEO_STREAM, nullptr, best);
+        GUID subtype{};
+        best->GetGUID(MF_MT_SUBTYPE, &subtype);
+        UINT32 stride = 0;
+        if (FAILED(best->GetUINT32(MF_MT_DEFAULT_STRIDE, &stride))) {
+            LONG computed = 0;
+            if (SUCCEEDED(MFGetStrideForBitmapInfoHeader(subtype.Data1, static_cast<DWORD>(_width), &computed))) {
+                stride = static_cast<UINT32>(computed);
+            }
+        }
+        best->Release();
+        check(hr, "SetCurrentMediaType failed");
+
+        _delivered = format == PixelFormat::GRAY &&
+                             (_negotiated == PixelFormat::NV12 || _negotiated == PixelFormat::YUYV)
+                         ? PixelFormat::GRAY
+                         : _negotiated;
+        const auto tight = static_cast<ptrdiff_t>(packed_row_bytes(_negotiated, _width));
+        _stride = stride ? static_cast<ptrdiff_t>(static_cast<INT32>(stride)) : tight;
+        // GRAY from NV12 is the Y plane in place; everything else must match its packed layout
+        const bool gray_from_nv12 = _delivered == PixelFormat::GRAY && _negotiated == PixelFormat::NV12;
+        _copy = _negotiated != PixelFormat::MJPG && (_stride != tight || (_delivered != _negotiated && !gray_from_nv12));
+        if (_copy) {
+            if (gray_from_nv12) _negotiated = PixelFormat::GRAY;  // copy the Y plane only
+            _copies.set_frame_bytes(pixel_format_frame_bytes(_delivered, _width, _height));
+        }
+    }
+
+    double timestamp_of(IMFSample* sample) const {
+        // QPC time of capture in 100 ns units (Windows 8+ capture pipelines)
+        UINT64 device_time = 0;
+        if (SUCCEEDED(sample->GetUINT64(MFSampleExtension_DeviceReferenceSystemTime, &device_time))) {
+            LARGE_INTEGER now{}, freq{};
+            QueryPerformanceCounter(&now);
+            QueryPerformanceFrequency(&freq);
+            const double now_s = static_cast<double>(now.QuadPart) / static_cast<double>(freq.QuadPart);
+            const double age = std::max(0.0, now_s - static_cast<double>(device_time) * 1e-7);
+            return steady_seconds() - age;
+        }
+        return steady_seconds();
+    }
+
+    void release() {
+        if (_reader) _reader->Release();
+        _reader = nullptr;
+        if (_source) {
+            _source->Shutdown();
+            _source->Release();
+        }
+        _source = nullptr;
+        if (_mf) MFShutdown();
+        _mf = false;
+        if (_com) CoUninitialize();
+        _com = false;
+    }
+
+    bool _com{false};
+    bool _mf{false};
+    IMFMediaSource* _source{nullptr};
+    IMFSourceReader* _reader{nullptr};
+    ptrdiff_t _stride{0};
+    bool _copy{false};
+    FramePool _copies{0};
+};
+#endif
+
+// Native capture for device_id, or nullptr when this build has no native
+// backend or the device does not exist. Throws std::runtime_error when the
+// device exists but cannot stream.
+inline std::unique_ptr<CameraCapture> open_native_camera(int device_id, int width, int height, double fps,
+                                                         PixelFormat format) {
+#if defined(CAMERA_HAVE_V4L2)
+    const std::string path = "/dev/video" + std::to_string(device_id);
+    if (::access(path.c_str(), F_OK) != 0) return nullptr;
+    return std::make_unique<V4L2Capture>(path, width, height, fps, format);
+#elif defined(CAMERA_HAVE_MEDIA_FOUNDATION)
+    return MediaFoundationCapture::open(device_id, width, height, fps, format);
+#else
+    (void)device_id; (void)width; (void)height; (void)fps; (void)format;
+    return nullptr;
+#endif
+}
+
+// Name of the native backend compiled in ("v4l2", "mediafoundation" or "")
+inline const char* native_camera_backend() {
+#if defined(CAMERA_HAVE_V4L2)
+    return "v4l2";
+#elif defined(CAMERA_HAVE_MEDIA_FOUNDATION)
+    return "mediafoundation";
+#else
+    return "";
+#endif
+}
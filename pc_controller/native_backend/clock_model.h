@@ -0,0 +1,179 @@
+#pragma once
+
+// Online model of a device clock against the host steady clock.
+//
+// Every sample pairs the device timestamp d with the host receive time h.
+// The observed offset h - d is the true clock offset plus a transport delay
+// that is always positive and varies with Bluetooth/USB scheduling, so the
+// model tracks the lower envelope of the offsets rather than their mean: the
+// minimum offset is kept per bin of bin_seconds of device time, and a line
+// is fitted through the last window_bins minima by least squares. The slope
+// is the device crystal's drift, the intercept the offset at the newest bin.
+//
+//     aligned = d + offset + drift * (d - d_ref)
+//
+// The fit is refreshed once per bin, so observe() is O(1) per sample. A
+// device clock that runs backwards (the device restarted its counter) or
+// jumps ahead of host time resets the model.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+
+struct ClockModelState {
+    double offset{0.0};     // host - device at the newest observed device time (s)
+    double drift_ppm{0.0};  // growth of host - device; positive when the device clock runs slow
+    double jitter{0.0};     // RMS distance of the window minima from the fit (s)
+    uint64_t samples{0};    // samples observed since the last reset
+    uint64_t resets{0};
+    size_t bins{0};         // closed bins in the fit window
+};
+
+class ClockModel {
+public:
+    explicit ClockModel(double bin_seconds = 0.5, size_t window_bins = 64, double reset_threshold = 1.0)
+        : _bin_seconds(bin_seconds), _window_bins(std::max<size_t>(2, window_bins)),
+          _reset_threshold(reset_threshold) {}
+
+    // Feed one (device, host receive) pair; returns the host-aligned device time
+    double observe(double device_ts, double host_ts) {
+        const double d = host_ts - device_ts;
+        if (_samples > 0 &&
+            (device_ts < _last_device - kBackwardsTolerance || d < predict(device_ts) - _reset_threshold)) {
+            restart();
+            ++_resets;
+        }
+        if (_samples == 0) {
+            _bin_start = device_ts;
+            _bin_min = d;
+            _bin_min_x = device_ts;
+        } else if (device_ts - _bin_start >= _bin_seconds) {
+            close_bin();
+            _bin_start = device_ts;
+            _bin_min = d;
+            _bin_min_x = device_ts;
+        } else if (d < _bin_min) {
+            _bin_min = d;
+            _bin_min_x = device_ts;
+        }
+        ++_samples;
+
+        double aligned = device_ts + predict(device_ts);
+        // Refits must not move time backwards for samples that moved forwards
+        if (device_ts >= _last_device && aligned < _last_aligned) aligned = _last_aligned;
+        _last_device = device_ts;
+        _last_aligned = aligned;
+        return aligned;
+    }
+
+    // Host-aligned time of a device timestamp under the current fit; the
+    // identity before the first observation
+    double align(double device_ts) const {
+        return device_ts + predict(device_ts);
+    }
+
+    ClockModelState state() const {
+        ClockModelState s;
+        s.offset = _samples ? predict(_last_device) : 0.0;
+        s.drift_ppm = _slope * 1e6;
+        s.jitter = _jitter;
+        s.samples = _samples;
+        s.resets = _resets;
+        s.bins = _points.size();
+        return s;
+    }
+
+    void reset() {
+        restart();
+        _resets = 0;
+    }
+
+private:
+    // A real crystal stays within +-100 ppm; the clamp keeps short windows sane
+    static constexpr double kMaxDrift = 500e-6;
+    // Device timestamps with 1 ms resolution may repeat but never step back
+    static constexpr double kBackwardsTolerance = 1e-3;
+
+    struct Point {
+        double x;  // device time of the bin minimum
+        double y;  // minimum host - device offset in the bin
+    };
+
+    double predict(double device_ts) const {
+        if (_samples == 0) return 0.0;  // nothing observed: leave timestamps as they are
+        if (_points.size() < 2) {
+            // Not enough history for a slope: best offset seen so far
+            double best = _bin_min;
+            for (const Point& p : _points) best = std::min(best, p.y);
+            return best;
+        }
+        // The open bin's minimum can only improve on the line, never worsen it
+        double offset = _intercept + _slope * (device_ts - _ref);
+        return std::min(offset, _bin_min + _slope * (device_ts - _bin_min_x));
+    }
+
+    void close_bin() {
+        _points.push_back({_bin_min_x, _bin_min});
+        if (_points.size() > _window_bins) _points.pop_front();
+        refit();
+    }
+
+    void refit() {
+        const size_t n = _points.size();
+        if (n < 2) return;
+        // Centre on the newest point so the intercept is the current offset
+        _ref = _points.back().x;
+        double sx = 0.0, sy = 0.0;
+        for (const Point& p : _points) {
+            sx += p.x - _ref;
+            sy += p.y;
+        }
+        const double mx = sx / static_cast<double>(n);
+        const double my = sy / static_cast<double>(n);
+        double sxx = 0.0, sxy = 0.0;
+        for (const Point& p : _points) {
+            const double dx = p.x - _ref - mx;
+            sxx += dx * dx;
+            sxy += dx * (p.y - my);
+        }
+        _slope = sxx > 0.0 ? std::clamp(sxy / sxx, -kMaxDrift, kMaxDrift) : 0.0;
+        _intercept = my - _slope * mx;
+        double ss = 0.0;
+        for (const Point& p : _points) {
+            const double r = p.y - (_intercept + _slope * (p.x - _ref));
+            ss += r * r;
+        }
+        _jitter = std::sqrt(ss / static_cast<double>(n));
+    }
+
+    void restart() {
+        _points.clear();
+        _samples = 0;
+        _slope = 0.0;
+        _intercept = 0.0;
+        _ref = 0.0;
+        _jitter = 0.0;
+        _bin_min = std::numeric_limits<double>::infinity();
+        _last_device = -std::numeric_limits<double>::infinity();
+        _last_aligned = -std::numeric_limits<double>::infinity();
+    }
+
+    const double _bin_seconds;
+    const size_t _window_bins;
+    const double _reset_threshold;
+    std::deque<Point> _points;
+    uint64_t _samples{0};
+    uint64_t _resets{0};
+    double _bin_start{0.0};
+    double _bin_min{std::numeric_limits<double>::infinity()};
+    double _bin_min_x{0.0};
+    double _slope{0.0};
+    double _intercept{0.0};
+    double _ref{0.0};
+    double _jitter{0.0};
+    double _last_device{-std::numeric_limits<double>::infinity()};
+    double _last_aligned{-std::numeric_limits<double>::infinity()};
+};
@@ -0,0 +1,217 @@
+#pragma once
+
+// Multi-resolution min/max pyramid over an append-only (timestamp, value)
+// series, so a plot of any time range costs O(log n + max_points) however
+// long the session has run.
+//
+// Level 0 is the raw series. Bucket i of level L >= 1 covers raw samples
+// [i * fanout^L, (i + 1) * fanout^L) and keeps the minimum and maximum
+// sample with their timestamps. Appending updates the open bucket of every
+// level (O(log n)); a level is added whenever the series outgrows the top.
+//
+// query(t0, t1, max_points) binary-searches the raw range, returns it as is
+// if it fits, and otherwise takes the finest level with at most
+// fanout * max_points / 2 buckets in range, merges groups of them down to
+// max_points / 2 and emits each group's min and max in time order, which
+// keeps every peak visible. LTTB (largest triangle three buckets) instead
+// picks max_points of those min/max candidates by visual area. Buckets are
+// aligned to the pyramid, not to t0/t1, so the first and last point may lie
+// up to one bucket outside the range.
+//
+// Timestamps must not decrease; out-of-order and NaN samples are skipped.
+// Storage is std::deque so growth never relocates what is already stored.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class DecimationMethod { MinMax, Lttb };
+
+inline DecimationMethod parse_decimation_method(const std::string& name) {
+    if (name == "minmax") return DecimationMethod::MinMax;
+    if (name == "lttb") return DecimationMethod::Lttb;
+    throw std::invalid_argument("method must be 'minmax' or 'lttb'");
+}
+
+class DecimationPyramid {
+public:
+    explicit DecimationPyramid(size_t fanout = 8) : _fanout(fanout) {
+        if (fanout < 2 || fanout > 1024) {
+            throw std::invalid_argument("pyramid fanout must be in [2, 1024]");
+        }
+    }
+
+    size_t fanout() const { return _fanout; }
+    size_t size() const { return _ts.size(); }
+    size_t levels() const { return _levels.size() + 1; }
+    uint64_t skipped() const { return _skipped; }
+    double first_ts() const { return _ts.empty() ? 0.0 : _ts.front(); }
+    double last_ts() const { return _ts.empty() ? 0.0 : _ts.back(); }
+
+    size_t memory_bytes() const {
+        size_t buckets = 0;
+        for (const Level& l : _levels) buckets += l.buckets.size();
+        return _ts.size() * 2 * sizeof(double) + buckets * sizeof(Bucket);
+    }
+
+    void clear() {
+        _ts.clear();
+        _vals.clear();
+        _levels.clear();
+        _skipped = 0;
+    }
+
+    void append(double ts, double v) {
+        if (!std::isfinite(v) || !std::isfinite(ts) || (!_ts.empty() && ts < _ts.back())) {
+            ++_skipped;
+            return;
+        }
+        const size_t index = _ts.size();
+        _ts.push_back(ts);
+        _vals.push_back(v);
+        for (Level& l : _levels) {
+            if (index / l.stride == l.buckets.size()) {
+                l.buckets.push_back({ts, v, ts, v});
+            } else {
+                l.buckets.back().merge({ts, v, ts, v});
+            }
+        }
+        if (_ts.size() > top_stride() * _fanout) add_level();
+    }
+
+    // Points of [t0, t1] for plotting, appended to ts_out/vals_out in time order
+    void query(double t0, double t1, size_t max_points, DecimationMethod method, std::vector<double>& ts_out,
+               std::vector<double>& vals_out) const {
+        ts_out.clear();
+        vals_out.clear();
+        if (_ts.empty() || !(t1 >= t0) || max_points == 0) return;
+        const size_t a = static_cast<size_t>(std::lower_bound(_ts.begin(), _ts.end(), t0) - _ts.begin());
+        const size_t b = static_cast<size_t>(std::upper_bound(_ts.begin(), _ts.end(), t1) - _ts.begin());
+        if (a >= b) return;
+        if (b - a <= max_points || _levels.empty()) {
+            ts_out.assign(_ts.begin() + static_cast<std::ptrdiff_t>(a), _ts.begin() + static_cast<std::ptrdiff_t>(b));
+            vals_out.assign(_vals.begin() + static_cast<std::ptrdiff_t>(a),
+                            _vals.begin() + static_cast<std::ptrdiff_t>(b));
+            if (method == DecimationMethod::Lttb) lttb(ts_out, vals_out, max_points);
+            return;
+        }
+        const size_t pairs = std::max<size_t>(1, max_points / 2);
+        const Level* level = &_levels.back();
+        for (const Level& l : _levels) {
+            if ((b - 1) / l.stride - a / l.stride + 1 <= _fanout * pairs) {
+                level = &l;
+                break;
+            }
+        }
+        const size_t first = a / level->stride;
+        const size_t last = (b - 1) / level->stride;
+        // LTTB chooses among every bucket's extremes; min/max merges buckets down to `pairs`
+        const size_t group = method == DecimationMethod::Lttb ? 1 : (last - first + pairs) / pairs;
+        for (size_t i = first; i <= last; i += group) {
+            Bucket g = level->buckets[i];
+            for (size_t j = i + 1; j < std::min(i + group, last + 1); ++j) g.merge(level->buckets[j]);
+            g.emit(ts_out, vals_out);
+        }
+        if (method == DecimationMethod::Lttb) lttb(ts_out, vals_out, max_points);
+    }
+
+private:
+    struct Bucket {
+        double t_min, v_min, t_max, v_max;
+
+        void merge(const Bucket& o) {
+            if (o.v_min < v_min) { v_min = o.v_min; t_min = o.t_min; }
+            if (o.v_max > v_max) { v_max = o.v_max; t_max = o.t_max; }
+        }
+
+        void emit(std::vector<double>& ts, std::vector<double>& vals) const {
+            if (t_min == t_max && v_min == v_max) {
+                ts.push_back(t_min); vals.push_back(v_min);
+            } else if (t_min <= t_max) {
+                ts.push_back(t_min); vals.push_back(v_min);
+                ts.push_back(t_max); vals.push_back(v_max);
+            } else {
+                ts.push_back(t_max); vals.push_back(v_max);
+                ts.push_back(t_min); vals.push_back(v_min);
+            }
+        }
+    };
+
+    struct Level {
+        size_t stride;  // raw samples per bucket
+        std::deque<Bucket> buckets;
+    };
+
+    size_t top_stride() const { return _levels.empty() ? 1 : _levels.back().stride; }
+
+    void add_level() {
+        Level l{top_stride() * _fanout, {}};
+        if (_levels.empty()) {
+            for (size_t i = 0; i < _ts.size(); ++i) {
+                if (i % l.stride == 0) l.buckets.push_back({_ts[i], _vals[i], _ts[i], _vals[i]});
+                else l.buckets.back().merge({_ts[i], _vals[i], _ts[i], _vals[i]});
+            }
+        } else {
+            const std::deque<Bucket>& below = _levels.back().buckets;
+            for (size_t i = 0; i < below.size(); ++i) {
+                if (i % _fanout == 0) l.buckets.push_back(below[i]);
+                else l.buckets.back().merge(below[i]);
+            }
+        }
+        _levels.push_back(std::move(l));
+    }
+
+    // Reduce to n points in place, keeping the first and last
+    static void lttb(std::vector<double>& ts, std::vector<double>& vals, size_t n) {
+        const size_t count = ts.size();
+        if (n >= count) return;
+        if (n < 3) {  // no room for triangles: keep the ends
+            ts[1] = ts[count - 1];
+            vals[1] = vals[count - 1];
+            ts.resize(n);
+            vals.resize(n);
+            return;
+        }
+        const double every = static_cast<double>(count - 2) / static_cast<double>(n - 2);
+        size_t selected = 0;
+        size_t out = 1;
+        for (size_t k = 0; k < n - 2; ++k) {
+            // Average of the next bucket is the third triangle vertex
+            const size_t next_begin = static_cast<size_t>(static_cast<double>(k + 1) * every) + 1;
+            const size_t next_end = std::min(count, static_cast<size_t>(static_cast<double>(k + 2) * every) + 1);
+            double avg_t = 0.0, avg_v = 0.0;
+            for (size_t j = next_begin; j < next_end; ++j) { avg_t += ts[j]; avg_v += vals[j]; }
+            const double m = static_cast<double>(std::max<size_t>(1, next_end - next_begin));
+            avg_t /= m;
+            avg_v /= m;
+            const size_t begin = static_cast<size_t>(static_cast<double>(k) * every) + 1;
+            const size_t end = next_begin;
+            double best_area = -1.0;
+            size_t best = begin;
+            for (size_t j = begin; j < end; ++j) {
+                const double area = std::abs((ts[selected] - avg_t) * (vals[j] - vals[selected]) -
+                                             (ts[selected] - ts[j]) * (avg_v - vals[selected]));
+                if (area > best_area) { best_area = area; best = j; }
+            }
+            // Compacting in place is safe: out <= k + 1 <= best
+            ts[out] = ts[best];
+            vals[out] = vals[best];
+            selected = out++;
+        }
+        ts[out] = ts[count - 1];
+        vals[out] = vals[count - 1];
+        ts.resize(n);
+        vals.resize(n);
+    }
+
+    size_t _fanout;
+    std::deque<double> _ts;
+    std::deque<double> _vals;
+    std::vector<Level> _levels;
+    uint64_t _skipped{0};
+};
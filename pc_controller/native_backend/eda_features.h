@@ -0,0 +1,186 @@
+#pragma once
+
+// Online electrodermal activity (EDA) features with O(1) work per sample.
+//
+//   cleaned = lowpass(gsr, lowpass_hz)        noise and motion spikes
+//   tonic   = lowpass(cleaned, tonic_hz)      skin conductance level (SCL)
+//   phasic  = cleaned - tonic                 skin conductance responses
+//
+// Both low-passes are 2nd-order Butterworth biquads (direct form II
+// transposed), started at steady state on the first sample so there is no
+// start-up transient.
+//
+// SCRs are detected on the phasic signal with a trough/peak state machine:
+// the running minimum is the candidate onset; once the signal has risen
+// onset_threshold_us above it, the rise is tracked until the signal falls
+// onset_threshold_us below its maximum. That maximum is the peak, and the
+// response is reported if peak - onset >= min_amplitude_us. A rise longer
+// than max_rise_s is abandoned (slow drift, not a response). An event is
+// therefore emitted shortly after its peak, not at completion of recovery.
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+struct Biquad {
+    double b0{1.0}, b1{0.0}, b2{0.0}, a1{0.0}, a2{0.0};
+    double s1{0.0}, s2{0.0};
+
+    // RBJ cookbook low-pass; q = 1/sqrt(2) is Butterworth
+    static Biquad lowpass(double cutoff_hz, double sample_rate, double q = 0.7071067811865476) {
+        const double w = 2.0 * 3.141592653589793 * cutoff_hz / sample_rate;
+        const double alpha = std::sin(w) / (2.0 * q);
+        const double cw = std::cos(w);
+        const double a0 = 1.0 + alpha;
+        Biquad f;
+        f.b0 = (1.0 - cw) / 2.0 / a0;
+        f.b1 = (1.0 - cw) / a0;
+        f.b2 = f.b0;
+        f.a1 = -2.0 * cw / a0;
+        f.a2 = (1.0 - alpha) / a0;
+        return f;
+    }
+
+    double process(double x) {
+        const double y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        return y;
+    }
+
+    // State of a filter that has seen x forever
+    void settle(double x) {
+        const double gain = (b0 + b1 + b2) / (1.0 + a1 + a2);
+        const double y = gain * x;
+        s2 = b2 * x - a2 * y;
+        s1 = y - b0 * x;
+    }
+};
+
+struct EdaConfig {
+    double sample_rate{128.0};
+    double lowpass_hz{1.0};
+    double tonic_hz{0.05};
+    double onset_threshold_us{0.01};
+    double min_amplitude_us{0.05};
+    double max_rise_s{5.0};
+};
+
+// Throws std::invalid_argument for settings the filters cannot realise
+inline void validate_eda_config(const EdaConfig& cfg) {
+    if (!(cfg.sample_rate > 0.0)) {
+        throw std::invalid_argument("EDA sample_rate must be positive");
+    }
+    if (!(cfg.tonic_hz > 0.0 && cfg.tonic_hz < cfg.lowpass_hz && cfg.lowpass_hz < cfg.sample_rate / 2.0)) {
+        throw std::invalid_argument("EDA cut-offs must satisfy 0 < tonic_hz < lowpass_hz < sample_rate / 2");
+    }
+    if (!(cfg.onset_threshold_us > 0.0 && cfg.min_amplitude_us >= 0.0 && cfg.max_rise_s > 0.0)) {
+        throw std::invalid_argument("SCR thresholds must be positive");
+    }
+}
+
+struct EdaSample {
+    double cleaned;
+    double tonic;
+    double phasic;
+};
+
+struct ScrEvent {
+    double onset_ts;
+    double peak_ts;
+    double amplitude;  // peak - onset of the phasic signal (uS)
+    double rise_time;  // peak_ts - onset_ts (s)
+    double tonic;      // SCL at the peak (uS)
+};
+
+class EdaProcessor {
+public:
+    explicit EdaProcessor(const EdaConfig& cfg = {}) { configure(cfg); }
+
+    void configure(const EdaConfig& cfg) {
+        validate_eda_config(cfg);
+        _cfg = cfg;
+        _clean = Biquad::lowpass(cfg.lowpass_hz, cfg.sample_rate);
+        _tonic = Biquad::lowpass(cfg.tonic_hz, cfg.sample_rate);
+        restart();
+    }
+
+    const EdaConfig& config() const { return _cfg; }
+
+    // Forget the signal history, e.g. after a gap; counters are kept
+    void restart() {
+        _started = false;
+        _rising = false;
+    }
+
+    uint64_t samples() const { return _samples; }
+    uint64_t responses() const { return _responses; }
+
+    // One sample; returns true and fills `event` when an SCR peak is confirmed
+    bool process(double ts, double gsr_us, EdaSample& out, ScrEvent& event) {
+        ++_samples;
+        if (!_started) {
+            _clean.settle(gsr_us);
+            _tonic.settle(gsr_us);
+            _started = true;
+            _trough = 0.0;
+            _trough_ts = ts;
+        }
+        out.cleaned = _clean.process(gsr_us);
+        out.tonic = _tonic.process(out.cleaned);
+        out.phasic = out.cleaned - out.tonic;
+        return detect(ts, out, event);
+    }
+
+private:
+    bool detect(double ts, const EdaSample& s, ScrEvent& event) {
+        const double x = s.phasic;
+        if (!_rising) {
+            if (x < _trough || ts - _trough_ts > _cfg.max_rise_s) {
+                _trough = x;
+                _trough_ts = ts;
+            } else if (x - _trough >= _cfg.onset_threshold_us) {
+                _rising = true;
+                _peak = x;
+                _peak_ts = ts;
+                _peak_tonic = s.tonic;
+            }
+            return false;
+        }
+        if (x > _peak) {
+            _peak = x;
+            _peak_ts = ts;
+            _peak_tonic = s.tonic;
+            if (_peak_ts - _trough_ts > _cfg.max_rise_s) {
+                _rising = false;  // drift rather than a response
+                _trough = x;
+                _trough_ts = ts;
+            }
+            return false;
+        }
+        if (_peak - x < _cfg.onset_threshold_us) return false;
+        _rising = false;
+        const double amplitude = _peak - _trough;
+        const bool accepted = amplitude >= _cfg.min_amplitude_us;
+        if (accepted) {
+            event = {_trough_ts, _peak_ts, amplitude, _peak_ts - _trough_ts, _peak_tonic};
+            ++_responses;
+        }
+        _trough = x;
+        _trough_ts = ts;
+        return accepted;
+    }
+
+    EdaConfig _cfg;
+    Biquad _clean;
+    Biquad _tonic;
+    bool _started{false};
+    bool _rising{false};
+    double _trough{0.0};
+    double _trough_ts{0.0};
+    double _peak{0.0};
+    double _peak_ts{0.0};
+    double _peak_tonic{0.0};
+    uint64_t _samples{0};
+    uint64_t _responses{0};
+};
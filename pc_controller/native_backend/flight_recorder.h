@@ -0,0 +1,397 @@
+#pragma once
+
+// Crash-safe flight recorder: the acquisition threads append the last
+// minutes of samples, or the last frames, to a circular journal in a
+// memory-mapped file. Appending is a memcpy into the file's own page cache
+// and never enters the kernel, so a crash of the process loses nothing that
+// was appended; the OS writes the pages back on its own schedule and msync
+// only runs on close. A power loss can tear a page, which the per-record
+// checksum detects.
+//
+// File layout (little-endian, offsets in bytes):
+//
+//   page 0      header
+//     0    u64  magic "NBFLT01\0"
+//     8    u32  version (1)
+//     12   u32  kind: 1 = sample rows, 2 = frames
+//     16   u32  page_bytes (4096)
+//     20   u32  record_pages: pages per record
+//     24   u64  records: record slots after the header page
+//     32   u32  row_bytes: size of one packed row (rows only)
+//     36   u32  column_count
+//     40   u32  writer_pid
+//     44   u32  clean: 1 once the writer has closed the journal
+//     64   16 x {char name[24], char dtype[8]} row columns, packed in this order
+//   record s    at (1 + s * record_pages) * page_bytes: a 64-byte header, then the payload
+//     0    u32  magic "FREC"
+//     8    u64  seq: 1-based record number; 0 while the slot is being reused
+//     16   u64  first: index of the first row, or the frame seq
+//     24   f64  timestamp (frames)
+//     32   u32  width, 36 u32 height, 40 u32 format: PixelFormat code (frames)
+//     48   u64  commit: count << 32 | CRC-32 of the first count rows or bytes
+//
+// Rows fill one-page records in turn; a frame takes one record. Record seq
+// lives in slot (seq - 1) % records. Reusing a slot clears seq and commit
+// before anything else, and every append writes the payload first and then
+// the commit word in one 8-byte store, so a record is self-consistent at any
+// instant: a reader trusts only `count` rows or bytes, checks them against
+// the CRC (zlib's CRC-32) and orders records by seq.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "shm_transport.h"  // shm_current_pid, RecorderTypeStr
+
+constexpr uint64_t kFlightMagic = 0x003130544C46424Eull;  // the bytes "NBFLT01\0"
+constexpr uint32_t kFlightVersion = 1;
+constexpr uint32_t kFlightKindRows = 1;
+constexpr uint32_t kFlightKindFrames = 2;
+constexpr uint32_t kFlightRecordMagic = 0x43455246u;  // "FREC"
+constexpr size_t kFlightPageBytes = 4096;
+constexpr size_t kFlightMaxColumns = 16;
+
+// zlib-compatible CRC-32, continued from crc (0 to start)
+inline uint32_t flight_crc32(uint32_t crc, const void* data, size_t n) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    const auto* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFFu] ^ (crc >> 8);
+    return ~crc;
+}
+
+struct FlightColumn {
+    char name[24];
+    char dtype[8];  // NumPy array-protocol type string, e.g. "<f8"
+};
+
+struct FlightHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t page_bytes;
+    uint32_t record_pages;
+    uint64_t records;
+    uint32_t row_bytes;
+    uint32_t column_count;
+    uint32_t writer_pid;
+    std::atomic<uint32_t> clean;
+    uint8_t reserved[16];
+    FlightColumn columns[kFlightMaxColumns];
+};
+
+struct FlightRecord {
+    uint32_t magic;
+    uint32_t reserved;
+    std::atomic<uint64_t> seq;
+    uint64_t first;
+    double timestamp;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t reserved2;
+    std::atomic<uint64_t> commit;
+    uint8_t pad[8];
+};
+
+static_assert(offsetof(FlightHeader, clean) == 44 && offsetof(FlightHeader, columns) == 64 &&
+                  sizeof(FlightHeader) <= kFlightPageBytes,
+              "flight recorder header layout is part of the file format");
+static_assert(offsetof(FlightRecord, seq) == 8 && offsetof(FlightRecord, commit) == 48 && sizeof(FlightRecord) == 64,
+              "flight recorder record layout is part of the file format");
+
+// A file mapped read/write; unmapping flushes it to disk
+class MappedFile {
+public:
+    // Create (or replace) path with `bytes` zeroed bytes. A journal that was
+    // never closed is kept as path + ".crash" rather than overwritten.
+    MappedFile(const std::string& path, size_t bytes) : _path(path), _size(bytes) {
+        preserve_crashed(path);
+#ifdef _WIN32
+        _file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE) throw std::runtime_error("Failed to create flight recorder " + path);
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                      static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr);
+        _data = _mapping ? static_cast<uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes)) : nullptr;
+        if (!_data) {
+            if (_mapping) CloseHandle(_mapping);
+            CloseHandle(_file);
+            throw std::runtime_error("Failed to map flight recorder " + path);
+        }
+#else
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("Failed to create flight recorder " + path + ": " + std::strerror(errno));
+        // Reserve the blocks now: a full disk must fail here, not as SIGBUS on the hot path
+#ifdef __linux__
+        const int rc = posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+#else
+        const int rc = ftruncate(fd, static_cast<off_t>(bytes)) == 0 ? 0 : errno;
+#endif
+        void* p = rc == 0 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            ::unlink(path.c_str());
+            throw std::runtime_error("Failed to allocate " + std::to_string(bytes) + " bytes for flight recorder " + path);
+        }
+        _data = static_cast<uint8_t*>(p);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        flush();
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+#else
+        munmap(_data, _size);
+#endif
+    }
+
+    uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+    const std::string& path() const { return _path; }
+
+    // Write dirty pages back and wait for the device
+    void flush() {
+#ifdef _WIN32
+        FlushViewOfFile(_data, 0);
+        FlushFileBuffers(_file);
+#else
+        msync(_data, _size, MS_SYNC);
+#endif
+    }
+
+private:
+    static void preserve_crashed(const std::string& path) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return;
+        uint8_t head[48] = {};
+        const bool full = std::fread(head, 1, sizeof(head), f) == sizeof(head);
+        std::fclose(f);
+        uint64_t magic;
+        uint32_t clean;
+        std::memcpy(&magic, head, sizeof(magic));
+        std::memcpy(&clean, head + offsetof(FlightHeader, clean), sizeof(clean));
+        if (full && magic == kFlightMagic && clean == 0) {
+            const std::string kept = path + ".crash";
+            std::remove(kept.c_str());
+            std::rename(path.c_str(), kept.c_str());
+        }
+    }
+
+    std::string _path;
+    size_t _size;
+    uint8_t* _data{nullptr};
+#ifdef _WIN32
+    HANDLE _file{INVALID_HANDLE_VALUE};
+    HANDLE _mapping{nullptr};
+#endif
+};
+
+// Header, record slots and counters shared by the row and frame journals
+class FlightJournal {
+public:
+    FlightJournal(const FlightJournal&) = delete;
+    FlightJournal& operator=(const FlightJournal&) = delete;
+
+    virtual ~FlightJournal() { header()->clean.store(1, std::memory_order_release); }
+
+    const std::string& path() const { return _file.path(); }
+    uint32_t kind() const { return header()->kind; }
+    uint64_t records() const { return _records; }
+    size_t file_bytes() const { return _file.size(); }
+    uint64_t written() const { return _written.load(std::memory_order_relaxed); }
+
+protected:
+    FlightJournal(const std::string& path, uint32_t kind, size_t record_pages, uint64_t records, uint32_t row_bytes,
+                  const std::vector<FlightColumn>& columns)
+        : _file(path, (1 + record_pages * records) * kFlightPageBytes),
+          _record_bytes(record_pages * kFlightPageBytes),
+          _records(records) {
+        FlightHeader* h = header();
+        h->version = kFlightVersion;
+        h->kind = kind;
+        h->page_bytes = static_cast<uint32_t>(kFlightPageBytes);
+        h->record_pages = static_cast<uint32_t>(record_pages);
+        h->records = records;
+        h->row_bytes = row_bytes;
+        h->column_count = static_cast<uint32_t>(columns.size());
+        std::copy(columns.begin(), columns.end(), h->columns);
+        h->writer_pid = shm_current_pid();
+        h->clean.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        h->magic = kFlightMagic;  // last, so a half-initialised file is not a journal
+    }
+
+    static void check_records(uint64_t records, size_t record_pages) {
+        if (records < 2 || records > (uint64_t{1} << 32) / record_pages) {
+            throw std::invalid_argument("flight recorder size out of range");
+        }
+    }
+
+    FlightHeader* header() const { return reinterpret_cast<FlightHeader*>(_file.data()); }
+
+    // Claim the slot of record seq, invalidating whatever it held
+    FlightRecord* open_record(uint64_t seq, uint64_t first) {
+        FlightRecord* r = slot((seq - 1) % _records);
+        r->seq.store(0, std::memory_order_release);
+        r->commit.store(0, std::memory_order_release);
+        r->magic = kFlightRecordMagic;
+        r->first = first;
+        r->seq.store(seq, std::memory_order_release);
+        return r;
+    }
+
+    FlightRecord* slot(uint64_t s) const {
+        return reinterpret_cast<FlightRecord*>(_file.data() + kFlightPageBytes + static_cast<size_t>(s) * _record_bytes);
+    }
+
+    static uint8_t* payload(FlightRecord* r) { return reinterpret_cast<uint8_t*>(r) + sizeof(FlightRecord); }
+    size_t payload_capacity() const { return _record_bytes - sizeof(FlightRecord); }
+
+    MappedFile _file;
+    size_t _record_bytes;
+    uint64_t _records;
+    std::atomic<uint64_t> _written{0};
+};
+
+inline FlightColumn flight_column(const std::string& name, const char* dtype) {
+    if (name.empty() || name.size() >= sizeof(FlightColumn::name)) {
+        throw std::invalid_argument("flight recorder column names must be 1-23 characters");
+    }
+    FlightColumn c{};
+    std::memcpy(c.name, name.data(), name.size());
+    std::strncpy(c.dtype, dtype, sizeof(c.dtype) - 1);
+    return c;
+}
+
+// Last `rows` rows of a fixed set of columns; one writer thread
+template <typename... Columns>
+class FlightRowRecorder : public FlightJournal {
+public:
+    static constexpr size_t kRowBytes = (sizeof(Columns) + ... + 0);
+    static constexpr size_t kRowsPerRecord = (kFlightPageBytes - sizeof(FlightRecord)) / kRowBytes;
+
+    // One spare record, so the oldest is only reused once `rows` newer ones are committed
+    FlightRowRecorder(const std::string& path, uint64_t rows, const std::vector<std::string>& names)
+        : FlightJournal(path, kFlightKindRows, 1, records_for(rows), static_cast<uint32_t>(kRowBytes),
+                        columns_of(names)) {}
+
+    // Rows the journal always holds once that many have been pushed
+    uint64_t capacity() const { return (_records - 1) * kRowsPerRecord; }
+
+    void push(Columns... values) {
+        if (!_record || _count == kRowsPerRecord) {
+            _record = open_record(++_seq, _written.load(std::memory_order_relaxed));
+            _count = 0;
+            _crc = 0;
+        }
+        uint8_t* dst = payload(_record) + _count * kRowBytes;
+        size_t offset = 0;
+        ((std::memcpy(dst + offset, &values, sizeof(values)), offset += sizeof(values)), ...);
+        _crc = flight_crc32(_crc, dst, kRowBytes);
+        ++_count;
+        _record->commit.store((static_cast<uint64_t>(_count) << 32) | _crc, std::memory_order_release);
+        _written.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    static uint64_t records_for(uint64_t rows) {
+        const uint64_t records = (std::max<uint64_t>(rows, 1) + kRowsPerRecord - 1) / kRowsPerRecord + 1;
+        check_records(records, 1);
+        return records;
+    }
+
+    static std::vector<FlightColumn> columns_of(const std::vector<std::string>& names) {
+        static_assert(sizeof...(Columns) <= kFlightMaxColumns, "too many flight recorder columns");
+        if (names.size() != sizeof...(Columns)) {
+            throw std::invalid_argument("one column name is required per flight recorder column");
+        }
+        const char* dtypes[] = {RecorderTypeStr<Columns>::value...};
+        std::vector<FlightColumn> cols;
+        for (size_t i = 0; i < names.size(); ++i) cols.push_back(flight_column(names[i], dtypes[i]));
+        return cols;
+    }
+
+    FlightRecord* _record{nullptr};
+    uint64_t _seq{0};
+    size_t _count{0};
+    uint32_t _crc{0};
+};
+
+// Last `frames` encoded frames of at most max_frame_bytes each
+class FlightFrameRecorder : public FlightJournal {
+public:
+    FlightFrameRecorder(const std::string& path, uint64_t frames, size_t max_frame_bytes)
+        : FlightJournal(path, kFlightKindFrames, pages_for(frames, max_frame_bytes), frames, 0, {}) {}
+
+    uint64_t capacity() const { return _records; }
+    size_t max_frame_bytes() const { return payload_capacity(); }
+    uint64_t oversized() const { return _oversized.load(std::memory_order_relaxed); }
+
+    // Any thread; returns false (and counts it) when the frame does not fit a record
+    bool push(const uint8_t* data, size_t bytes, uint32_t format, int width, int height, double timestamp,
+              uint64_t frame_seq) {
+        if (bytes > payload_capacity()) {
+            _oversized.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::lock_guard<std::mutex> g(_mtx);
+        FlightRecord* r = open_record(++_seq, frame_seq);
+        std::memcpy(payload(r), data, bytes);
+        r->timestamp = timestamp;
+        r->width = static_cast<uint32_t>(width);
+        r->height = static_cast<uint32_t>(height);
+        r->format = format;
+        r->commit.store((static_cast<uint64_t>(bytes) << 32) | flight_crc32(0, data, bytes), std::memory_order_release);
+        _written.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    static size_t pages_for(uint64_t frames, size_t max_frame_bytes) {
+        if (max_frame_bytes == 0 || max_frame_bytes > (size_t{1} << 28)) {
+            throw std::invalid_argument("flight recorder max_frame_bytes must be in [1, 256 MiB]");
+        }
+        const size_t pages = (max_frame_bytes + sizeof(FlightRecord) + kFlightPageBytes - 1) / kFlightPageBytes;
+        check_records(frames, pages);
+        return pages;
+    }
+
+    std::mutex _mtx;  // serialises writers: capture thread (MJPG) and encoder thread
+    uint64_t _seq{0};
+    std::atomic<uint64_t> _oversized{0};
+};
@@ -0,0 +1,509 @@
+#pragma once
+
+// Optional per-frame analysis stage for NativeWebcam, running on its own thread.
+//
+// For every published frame the analyzer takes the mean and variance of B, G
+// and R over each configured region of interest and appends them to a ring
+// stamped with the frame's capture time. That time is steady_clock seconds,
+// the time base of the Shimmer host_ts and aligned_ts columns. It can also
+// keep a pyramid of 2x box-filtered BGR thumbnails of the latest frame.
+// Camera-derived signals (remote PPG, motion) then leave the native side as
+// a few doubles per frame instead of whole frames.
+//
+// Non-BGR frames are converted to BGR only along the ROI rows (MJPG through
+// the frame's cached BGR view). The accumulation kernel sums pixels and
+// squared pixels in integer lanes: SSE2 on x86-64, NEON on AArch64, and a
+// scalar fallback with identical sums.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANALYSIS_HAVE_SSE2_KERNEL 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ANALYSIS_HAVE_NEON_KERNEL 1
+#endif
+
+#include "frame_pool.h"
+#include "pixel_format.h"
+#include "thread_registry.h"
+
+// Region of interest in frame pixels; clipped to each frame
+struct FrameRoi {
+    int x{0};
+    int y{0};
+    int width{0};
+    int height{0};
+};
+
+constexpr int kMaxThumbnailLevels = 6;
+
+struct FrameAnalysisConfig {
+    std::vector<FrameRoi> rois;
+    int thumbnail_levels{0};  // thumbnails of the latest frame at 1/2, 1/4, ... size
+    size_t capacity{1024};    // frames of statistics kept until drained
+    size_t max_queue{2};      // frames waiting for the analyzer before drops
+};
+
+inline void validate_frame_analysis_config(const FrameAnalysisConfig& cfg) {
+    for (const auto& r : cfg.rois) {
+        if (r.x < 0 || r.y < 0 || r.width <= 0 || r.height <= 0) {
+            throw std::invalid_argument("ROIs need x, y >= 0 and a positive width and height");
+        }
+    }
+    if (cfg.thumbnail_levels < 0 || cfg.thumbnail_levels > kMaxThumbnailLevels) {
+        throw std::invalid_argument("thumbnail_levels must be in [0, " + std::to_string(kMaxThumbnailLevels) + "]");
+    }
+    if (cfg.rois.empty() && cfg.thumbnail_levels == 0) {
+        throw std::invalid_argument("frame analysis needs at least one ROI or thumbnail level");
+    }
+    if (cfg.capacity == 0) {
+        throw std::invalid_argument("capacity must be positive");
+    }
+}
+
+// Per-channel totals of one ROI, in B, G, R order
+struct ChannelSums {
+    uint64_t n{0};
+    uint64_t sum[3]{0, 0, 0};
+    uint64_t sq[3]{0, 0, 0};
+};
+
+// Population mean and variance per channel; NaN for an ROI outside the frame
+struct RoiStats {
+    double mean[3];
+    double var[3];
+
+    static RoiStats from(const ChannelSums& s) {
+        RoiStats out;
+        for (int c = 0; c < 3; ++c) {
+            if (s.n == 0) {
+                out.mean[c] = out.var[c] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            const double n = static_cast<double>(s.n);
+            out.mean[c] = static_cast<double>(s.sum[c]) / n;
+            out.var[c] = std::max(0.0, static_cast<double>(s.sq[c]) / n - out.mean[c] * out.mean[c]);
+        }
+        return out;
+    }
+};
+
+namespace analysis_detail {
+
+inline void accumulate_scalar(const uint8_t* bgr, size_t n, ChannelSums& s) {
+    for (size_t i = 0; i < n; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t v = bgr[i * 3 + c];
+            s.sum[c] += v;
+            s.sq[c] += v * v;
+        }
+    }
+}
+
+#if defined(ANALYSIS_HAVE_SSE2_KERNEL)
+// 16 pixels (three registers) per step. Byte k of the 48-byte step always
+// holds channel k % 3, so the lanes are folded into channels once per block
+// of at most 256 steps, before a 16-bit sum can overflow. Returns the pixels done.
+inline size_t accumulate_sse2(const uint8_t* bgr, size_t n, ChannelSums& s) {
+    const __m128i zero = _mm_setzero_si128();
+    alignas(16) uint16_t sums[48];
+    alignas(16) uint32_t squares[48];
+    size_t i = 0;
+    while (i + 16 <= n) {
+        __m128i sum16[6], sq32[12];
+        for (auto& v : sum16) v = zero;
+        for (auto& v : sq32) v = zero;
+        const size_t steps = std::min<size_t>((n - i) / 16, 256);
+        for (size_t k = 0; k < steps; ++k, i += 16) {
+            for (int r = 0; r < 3; ++r) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + i * 3 + r * 16));
+                const __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+                sum16[r * 2] = _mm_add_epi16(sum16[r * 2], lo);
+                sum16[r * 2 + 1] = _mm_add_epi16(sum16[r * 2 + 1], hi);
+                // 255^2 fits in 16 bits, so the low half of the product is exact
+                const __m128i qlo = _mm_mullo_epi16(lo, lo), qhi = _mm_mullo_epi16(hi, hi);
+                sq32[r * 4] = _mm_add_epi32(sq32[r * 4], _mm_unpacklo_epi16(qlo, zero));
+                sq32[r * 4 + 1] = _mm_add_epi32(sq32[r * 4 + 1], _mm_unpackhi_epi16(qlo, zero));
+                sq32[r * 4 + 2] = _mm_add_epi32(sq32[r * 4 + 2], _mm_unpacklo_epi16(qhi, zero));
+                sq32[r * 4 + 3] = _mm_add_epi32(sq32[r * 4 + 3], _mm_unpackhi_epi16(qhi, zero));
+            }
+        }
+        for (int j = 0; j < 6; ++j) _mm_store_si128(reinterpret_cast<__m128i*>(sums + j * 8), sum16[j]);
+        for (int j = 0; j < 12; ++j) _mm_store_si128(reinterpret_cast<__m128i*>(squares + j * 4), sq32[j]);
+        for (int k = 0; k < 48; ++k) {
+            s.sum[k % 3] += sums[k];
+            s.sq[k % 3] += squares[k];
+        }
+    }
+    return i;
+}
+#endif
+
+#if defined(ANALYSIS_HAVE_NEON_KERNEL)
+// 16 pixels per step, de-interleaved by vld3; pairwise 16-bit sums are
+// folded every 128 steps, before they can overflow. Returns the pixels done.
+inline size_t accumulate_neon(const uint8_t* bgr, size_t n, ChannelSums& s) {
+    size_t i = 0;
+    while (i + 16 <= n) {
+        uint16x8_t sum16[3] = {vdupq_n_u16(0), vdupq_n_u16(0), vdupq_n_u16(0)};
+        uint32x4_t sq32[3] = {vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0)};
+        const size_t steps = std::min<size_t>((n - i) / 16, 128);
+        for (size_t k = 0; k < steps; ++k, i += 16) {
+            const uint8x16x3_t px = vld3q_u8(bgr + i * 3);
+            for (int c = 0; c < 3; ++c) {
+                sum16[c] = vpadalq_u8(sum16[c], px.val[c]);
+                sq32[c] = vpadalq_u16(sq32[c], vmull_u8(vget_low_u8(px.val[c]), vget_low_u8(px.val[c])));
+                sq32[c] = vpadalq_u16(sq32[c], vmull_u8(vget_high_u8(px.val[c]), vget_high_u8(px.val[c])));
+            }
+        }
+        for (int c = 0; c < 3; ++c) {
+            s.sum[c] += vaddlvq_u16(sum16[c]);
+            s.sq[c] += vaddlvq_u32(sq32[c]);
+        }
+    }
+    return i;
+}
+#endif
+
+}  // namespace analysis_detail
+
+// Add n packed BGR pixels to s using the fastest available kernel
+inline void accumulate_bgr(const uint8_t* bgr, size_t n, ChannelSums& s) {
+    size_t i = 0;
+#if defined(ANALYSIS_HAVE_SSE2_KERNEL)
+    i = analysis_detail::accumulate_sse2(bgr, n, s);
+#elif defined(ANALYSIS_HAVE_NEON_KERNEL)
+    i = analysis_detail::accumulate_neon(bgr, n, s);
+#endif
+    analysis_detail::accumulate_scalar(bgr + i * 3, n - i, s);
+    s.n += n;
+}
+
+// Name of the kernel accumulate_bgr() uses on this machine
+inline const char* analysis_kernel_name() {
+#if defined(ANALYSIS_HAVE_SSE2_KERNEL)
+    return "sse2";
+#elif defined(ANALYSIS_HAVE_NEON_KERNEL)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+// BGR pixels [x0, x1) of row y: in place for BGR frames, otherwise converted
+// into `row` (one whole BGR row). MJPG frames are passed as their BGR view.
+inline const uint8_t* bgr_span(PixelFormat f, const uint8_t* px, int width, int height, int y, int x0, int x1,
+                               uint8_t* row) {
+    if (f == PixelFormat::BGR) {
+        return px + (static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x0)) * 3;
+    }
+    convert_row_to_bgr(f, px, width, height, y, x0, x1, row);
+    return row + static_cast<size_t>(x0) * 3;
+}
+
+// Statistics of each ROI of one frame; `row` is scratch space of width * 3 bytes
+inline void frame_roi_stats(PixelFormat f, const uint8_t* px, int width, int height, const std::vector<FrameRoi>& rois,
+                            std::vector<uint8_t>& row, RoiStats* out) {
+    row.resize(static_cast<size_t>(width) * 3);
+    for (size_t i = 0; i < rois.size(); ++i) {
+        const FrameRoi& r = rois[i];
+        // 64-bit ends: x + width may not fit an int
+        const int x0 = std::min(r.x, width), y0 = std::min(r.y, height);
+        const int x1 = static_cast<int>(std::min<int64_t>(int64_t{r.x} + r.width, width));
+        const int y1 = static_cast<int>(std::min<int64_t>(int64_t{r.y} + r.height, height));
+        ChannelSums s;
+        for (int y = y0; x1 > x0 && y < y1; ++y) {
+            accumulate_bgr(bgr_span(f, px, width, height, y, x0, x1, row.data()), static_cast<size_t>(x1 - x0), s);
+        }
+        out[i] = RoiStats::from(s);
+    }
+}
+
+struct Thumbnail {
+    int width{0};
+    int height{0};
+    std::vector<uint8_t> bgr;  // packed, width * height * 3
+};
+
+// Thumbnails of one frame; levels[0] is half size, each further level halves again
+struct ThumbnailPyramid {
+    uint64_t seq{0};
+    double timestamp{0.0};
+    std::vector<Thumbnail> levels;
+};
+
+// dst = src shrunk by two, each pixel the rounded mean of a 2x2 block (an odd
+// last row or column is dropped). Returns false if src is too small.
+inline bool downscale_half(PixelFormat f, const uint8_t* px, int width, int height, std::vector<uint8_t>& rows,
+                           Thumbnail& dst) {
+    dst.width = width / 2;
+    dst.height = height / 2;
+    if (dst.width == 0 || dst.height == 0) return false;
+    const size_t stride = static_cast<size_t>(width) * 3;
+    const size_t w = static_cast<size_t>(dst.width);
+    rows.resize(stride * 2);
+    dst.bgr.resize(w * static_cast<size_t>(dst.height) * 3);
+    const int even = dst.width * 2;
+    for (int y = 0; y < dst.height; ++y) {
+        const uint8_t* a = bgr_span(f, px, width, height, y * 2, 0, even, rows.data());
+        const uint8_t* b = bgr_span(f, px, width, height, y * 2 + 1, 0, even, rows.data() + stride);
+        uint8_t* d = dst.bgr.data() + static_cast<size_t>(y) * w * 3;
+        for (size_t x = 0; x < w; ++x) {
+            for (size_t c = 0; c < 3; ++c) {
+                const size_t k = x * 6 + c;
+                d[x * 3 + c] = static_cast<uint8_t>((a[k] + a[k + 3] + b[k] + b[k + 3] + 2) >> 2);
+            }
+        }
+    }
+    return true;
+}
+
+// Fixed-capacity ring of per-frame ROI statistics; when full, the oldest
+// entry is overwritten and counted
+class RoiStatsRing {
+public:
+    RoiStatsRing(size_t capacity, size_t rois)
+        : _capacity(capacity), _rois(rois), _seq(capacity), _timestamp(capacity), _mean(capacity * rois * 3),
+          _var(capacity * rois * 3) {}
+
+    void push(uint64_t seq, double timestamp, const RoiStats* stats) {
+        std::lock_guard<std::mutex> g(_mtx);
+        if (_size == _capacity) {
+            _head = (_head + 1) % _capacity;
+            --_size;
+            ++_dropped;
+        }
+        const size_t slot = (_head + _size) % _capacity;
+        _seq[slot] = seq;
+        _timestamp[slot] = timestamp;
+        for (size_t r = 0; r < _rois; ++r) {
+            for (size_t c = 0; c < 3; ++c) {
+                _mean[(slot * _rois + r) * 3 + c] = stats[r].mean[c];
+                _var[(slot * _rois + r) * 3 + c] = stats[r].var[c];
+            }
+        }
+        ++_size;
+    }
+
+    // Pop up to max entries, oldest first; mean and var take max * rois() * 3 values
+    size_t pop_into(size_t max, uint64_t* seq, double* timestamp, double* mean, double* var) {
+        std::lock_guard<std::mutex> g(_mtx);
+        const size_t n = std::min(max, _size);
+        const size_t per = _rois * 3;
+        for (size_t i = 0; i < n; ++i) {
+            const size_t slot = (_head + i) % _capacity;
+            seq[i] = _seq[slot];
+            timestamp[i] = _timestamp[slot];
+            std::copy_n(_mean.begin() + static_cast<std::ptrdiff_t>(slot * per), per, mean + i * per);
+            std::copy_n(_var.begin() + static_cast<std::ptrdiff_t>(slot * per), per, var + i * per);
+        }
+        _head = (_head + n) % _capacity;
+        _size -= n;
+        return n;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _size;
+    }
+
+    uint64_t dropped() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _dropped;
+    }
+
+    size_t rois() const { return _rois; }
+
+private:
+    const size_t _capacity;
+    const size_t _rois;
+    mutable std::mutex _mtx;  // guards everything below
+    std::vector<uint64_t> _seq;
+    std::vector<double> _timestamp;
+    std::vector<double> _mean;  // [slot][roi][channel]
+    std::vector<double> _var;
+    size_t _head{0};
+    size_t _size{0};
+    uint64_t _dropped{0};
+};
+
+struct FrameAnalysisStats {
+    uint64_t frames{0};           // frames analyzed
+    uint64_t dropped{0};          // frames skipped because the analyzer was behind
+    uint64_t overwritten{0};      // ring entries replaced before they were drained
+    uint64_t errors{0};           // frames that could not be decoded
+    double analysis_seconds{0};   // total time spent on statistics and thumbnails
+};
+
+class FrameAnalyzer {
+public:
+    explicit FrameAnalyzer(FrameAnalysisConfig cfg)
+        : _cfg(std::move(cfg)), _ring(std::max<size_t>(1, _cfg.capacity), _cfg.rois.size()), _stats(_cfg.rois.size()) {
+        validate_frame_analysis_config(_cfg);
+        _cfg.max_queue = std::max<size_t>(1, _cfg.max_queue);
+        _thread = spawn_thread("analysis", "analysis", [this] { run(); });
+    }
+
+    ~FrameAnalyzer() { stop(); }
+
+    FrameAnalyzer(const FrameAnalyzer&) = delete;
+    FrameAnalyzer& operator=(const FrameAnalyzer&) = delete;
+
+    // Capture thread: queue a published frame; dropped if the analyzer is behind
+    void push(std::shared_ptr<FrameBuffer> frame) {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            if (_queue.size() >= _cfg.max_queue) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            _queue.push_back(std::move(frame));
+        }
+        _cv.notify_one();
+    }
+
+    // Frames queued but not yet taken by the analyzer thread
+    size_t backlog() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _queue.size();
+    }
+
+    size_t max_queue() const { return _cfg.max_queue; }
+
+    // Notified after every frame analyzed (nullptr stops)
+    void set_release_signal(std::shared_ptr<FrameReleaseSignal> signal) {
+        std::lock_guard<std::mutex> g(_mtx);
+        _released = std::move(signal);
+    }
+
+    // Analyze what is queued and join the thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            _stop = true;
+        }
+        _cv.notify_all();
+        if (_thread.joinable()) _thread.join();
+    }
+
+    const FrameAnalysisConfig& config() const { return _cfg; }
+    RoiStatsRing& ring() { return _ring; }
+
+    // Thumbnails of the most recently analyzed frame, or nullptr
+    std::shared_ptr<const ThumbnailPyramid> thumbnails() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _thumbnails;
+    }
+
+    FrameAnalysisStats stats() const {
+        FrameAnalysisStats s;
+        s.frames = _frames.load(std::memory_order_relaxed);
+        s.dropped = _dropped.load(std::memory_order_relaxed);
+        s.overwritten = _ring.dropped();
+        s.errors = _errors.load(std::memory_order_relaxed);
+        s.analysis_seconds = _analysis_ns.load(std::memory_order_relaxed) * 1e-9;
+        return s;
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::shared_ptr<FrameBuffer> frame;
+            std::shared_ptr<FrameReleaseSignal> released;
+            {
+                std::unique_lock<std::mutex> lk(_mtx);
+                _cv.wait(lk, [&] { return _stop || !_queue.empty(); });
+                if (_queue.empty()) break;
+                frame = std::move(_queue.front());
+                _queue.pop_front();
+                released = _released;
+            }
+            try {
+                analyze(*frame);
+            } catch (const std::exception&) {
+                _errors.fetch_add(1, std::memory_order_relaxed);  // corrupt or undecodable MJPG frame
+            }
+            frame.reset();
+            if (released) released->notify();
+        }
+    }
+
+    void analyze(FrameBuffer& frame) {
+        auto t0 = std::chrono::steady_clock::now();
+        PixelFormat f = frame.format;
+        const uint8_t* px = frame.pixels();
+        if (f == PixelFormat::MJPG) {
+            px = frame.bgr();  // decoded once and shared with other BGR consumers
+            f = PixelFormat::BGR;
+        }
+        if (!_cfg.rois.empty()) {
+            frame_roi_stats(f, px, frame.width, frame.height, _cfg.rois, _row, _stats.data());
+            _ring.push(frame.seq, frame.timestamp, _stats.data());
+        }
+        if (_cfg.thumbnail_levels > 0) build_thumbnails(frame, f, px);
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0);
+        _analysis_ns.fetch_add(static_cast<uint64_t>(ns.count()), std::memory_order_relaxed);
+        _frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Reuses the previous pyramid unless a consumer still holds it
+    void build_thumbnails(const FrameBuffer& frame, PixelFormat f, const uint8_t* px) {
+        if (_spare && _spare.use_count() == 1) {
+            // Pair with the consumers' release of their last reference
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } else {
+            _spare = std::make_shared<ThumbnailPyramid>();
+        }
+        ThumbnailPyramid& p = *_spare;
+        p.seq = frame.seq;
+        p.timestamp = frame.timestamp;
+        p.levels.resize(static_cast<size_t>(_cfg.thumbnail_levels));
+        size_t built = 0;
+        for (; built < p.levels.size(); ++built) {
+            const bool first = built == 0;
+            const Thumbnail* prev = first ? nullptr : &p.levels[built - 1];
+            if (!downscale_half(first ? f : PixelFormat::BGR, first ? px : prev->bgr.data(),
+                                first ? frame.width : prev->width, first ? frame.height : prev->height, _rows,
+                                p.levels[built])) {
+                break;
+            }
+        }
+        p.levels.resize(built);
+        std::lock_guard<std::mutex> g(_mtx);
+        std::swap(_thumbnails, _spare);
+    }
+
+    FrameAnalysisConfig _cfg;
+    RoiStatsRing _ring;
+    std::vector<RoiStats> _stats;   // analyzer thread only, like the scratch rows below
+    std::vector<uint8_t> _row;
+    std::vector<uint8_t> _rows;
+    std::shared_ptr<ThumbnailPyramid> _spare;
+    mutable std::mutex _mtx;  // guards _queue, _released, _stop and _thumbnails
+    std::condition_variable _cv;
+    std::deque<std::shared_ptr<FrameBuffer>> _queue;
+    std::shared_ptr<FrameReleaseSignal> _released;
+    bool _stop{false};
+    std::shared_ptr<ThumbnailPyramid> _thumbnails;  // handed out as const
+    std::thread _thread;
+    std::atomic<uint64_t> _frames{0};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint64_t> _errors{0};
+    std::atomic<uint64_t> _analysis_ns{0};
+};
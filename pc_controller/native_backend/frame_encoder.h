@@ -0,0 +1,671 @@
+#pragma once
+
+// Optional encode stage for NativeWebcam, running on its own thread.
+//
+// The capture thread hands published frames to FrameEncoder::push(); the
+// encoder thread compresses them and writes them to a container file:
+//
+//   mjpeg  libjpeg(-turbo), stored in the chunked columnar format of
+//          stream_recorder.h with seq, timestamp, width, height and jpeg
+//          columns, one frame per chunk (built with USE_LIBJPEG); frames
+//          the camera already delivers as MJPG are stored as captured
+//   h264   FFmpeg (NVENC if present, else libx264 or the default H.264
+//          encoder) muxed into whatever container the path's extension
+//          names, e.g. .mp4 or .mkv (built with USE_FFMPEG)
+//
+// Every preview_interval-th frame is also published as a JPEG to an
+// EncodedPreview, which network transports poll or wait on.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef USE_LIBJPEG
+#include <csetjmp>
+#include <jpeglib.h>
+#endif
+
+#ifdef USE_FFMPEG
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+#include "flight_recorder.h"
+#include "frame_pool.h"
+#include "stream_recorder.h"
+#include "thread_registry.h"
+
+struct EncodedFrame {
+    std::vector<uint8_t> data;
+    uint64_t seq{0};         // seq of the source frame
+    double timestamp{0.0};   // capture time of the source frame
+    int width{0};
+    int height{0};
+};
+
+// Latest encoded preview frame, shared between the encoder and consumers
+class EncodedPreview {
+public:
+    void publish(std::shared_ptr<const EncodedFrame> frame) {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            _latest = std::move(frame);
+            ++_count;
+        }
+        _cv.notify_all();
+    }
+
+    std::shared_ptr<const EncodedFrame> latest() {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _latest;
+    }
+
+    // Block until a preview newer than last_seq, the timeout or wake_all()
+    std::shared_ptr<const EncodedFrame> wait_newer(uint64_t last_seq, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        const uint64_t generation = _generation;
+        _cv.wait_for(lk, timeout, [&] {
+            return (_latest && _latest->seq > last_seq) || generation != _generation;
+        });
+        return _latest && _latest->seq > last_seq ? _latest : nullptr;
+    }
+
+    void wake_all() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            ++_generation;
+        }
+        _cv.notify_all();
+    }
+
+    uint64_t published() {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _count;
+    }
+
+private:
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::shared_ptr<const EncodedFrame> _latest;
+    uint64_t _count{0};
+    uint64_t _generation{0};
+};
+
+inline bool jpeg_encoder_available() {
+#ifdef USE_LIBJPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline bool h264_encoder_available() {
+#ifdef USE_FFMPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef USE_LIBJPEG
+// Reusable libjpeg compressor for BGR (3-channel) and grayscale frames
+class JpegEncoder {
+public:
+    JpegEncoder() {
+        _cinfo.err = jpeg_std_error(&_err.pub);
+        _err.pub.error_exit = &JpegEncoder::on_error;
+        jpeg_create_compress(&_cinfo);
+    }
+    ~JpegEncoder() {
+        jpeg_destroy_compress(&_cinfo);
+        std::free(_mem);
+    }
+    JpegEncoder(const JpegEncoder&) = delete;
+    JpegEncoder& operator=(const JpegEncoder&) = delete;
+
+    // Compress packed BGR (channels 3) or grayscale (channels 1) pixels into
+    // out; throws std::runtime_error on a libjpeg error
+    void encode(const uint8_t* pixels, int width, int height, int channels, int quality,
+                std::vector<uint8_t>& out) {
+        if (channels != 1 && channels != 3) {
+            throw std::runtime_error("JPEG encoding needs a BGR or grayscale frame");
+        }
+        const size_t stride = static_cast<size_t>(width) * static_cast<size_t>(channels);
+        _rows.resize(static_cast<size_t>(height));
+#ifndef JCS_EXTENSIONS
+        _rgb_row.resize(static_cast<size_t>(width) * 3);
+#endif
+        for (int y = 0; y < height; ++y) {
+            _rows[static_cast<size_t>(y)] = const_cast<JSAMPLE*>(pixels + stride * static_cast<size_t>(y));
+        }
+        if (!compress(width, height, channels, quality)) {
+            throw std::runtime_error(std::string("JPEG encoding failed: ") + _err.msg);
+        }
+        out.assign(_mem, _mem + _mem_size);
+    }
+
+private:
+    struct ErrorMgr {
+        jpeg_error_mgr pub;
+        jmp_buf jump;
+        char msg[JMSG_LENGTH_MAX];
+    };
+
+    static void on_error(j_common_ptr cinfo) {
+        auto* err = reinterpret_cast<ErrorMgr*>(cinfo->err);
+        (*cinfo->err->format_message)(cinfo, err->msg);
+        longjmp(err->jump, 1);
+    }
+
+    // Kept free of objects with destructors: libjpeg errors longjmp out of here
+    bool compress(int width, int height, int channels, int quality) {
+        std::free(_mem);
+        _mem = nullptr;
+        _mem_size = 0;
+        if (setjmp(_err.jump)) {
+            jpeg_abort_compress(&_cinfo);
+            return false;
+        }
+        jpeg_mem_dest(&_cinfo, &_mem, &_mem_size);
+        _cinfo.image_width = static_cast<JDIMENSION>(width);
+        _cinfo.image_height = static_cast<JDIMENSION>(height);
+        _cinfo.input_components = channels;
+#ifdef JCS_EXTENSIONS
+        _cinfo.in_color_space = channels == 3 ? JCS_EXT_BGR : JCS_GRAYSCALE;
+#else
+        // Plain libjpeg has no BGR input; each row is swapped to RGB below
+        _cinfo.in_color_space = channels == 3 ? JCS_RGB : JCS_GRAYSCALE;
+#endif
+        jpeg_set_defaults(&_cinfo);
+        jpeg_set_quality(&_cinfo, std::clamp(quality, 1, 100), TRUE);
+        _cinfo.dct_method = JDCT_IFAST;
+        jpeg_start_compress(&_cinfo, TRUE);
+#ifndef JCS_EXTENSIONS
+        if (channels == 3) {
+            while (_cinfo.next_scanline < _cinfo.image_height) {
+                const JSAMPLE* src = _rows[_cinfo.next_scanline];
+                for (size_t x = 0; x < _rgb_row.size(); x += 3) {
+                    _rgb_row[x] = src[x + 2];
+                    _rgb_row[x + 1] = src[x + 1];
+                    _rgb_row[x + 2] = src[x];
+                }
+                JSAMPROW row = _rgb_row.data();
+                jpeg_write_scanlines(&_cinfo, &row, 1);
+            }
+        }
+#endif
+        while (_cinfo.next_scanline < _cinfo.image_height) {
+            jpeg_write_scanlines(&_cinfo, _rows.data() + _cinfo.next_scanline,
+                                 _cinfo.image_height - _cinfo.next_scanline);
+        }
+        jpeg_finish_compress(&_cinfo);
+        return true;
+    }
+
+    jpeg_compress_struct _cinfo{};
+    ErrorMgr _err{};
+    unsigned char* _mem{nullptr};  // malloc'd by jpeg_mem_dest
+    unsigned long _mem_size{0};
+    std::vector<JSAMPROW> _rows;
+#ifndef JCS_EXTENSIONS
+    std::vector<JSAMPLE> _rgb_row;  // staging row for the BGR -> RGB swap
+#endif
+};
+#endif
+
+#ifdef USE_FFMPEG
+// H.264 encoder + muxer for one recording; frame size is fixed by the first frame
+class H264Writer {
+public:
+    H264Writer(const std::string& path, const FrameBuffer& first, double fps, int bitrate_kbps)
+        : _width(first.width), _height(first.height), _format(first.format), _t0(first.timestamp) {
+        if (avformat_alloc_output_context2(&_fmt, nullptr, nullptr, path.c_str()) < 0 || !_fmt) {
+            throw std::runtime_error("Unsupported container for " + path);
+        }
+        try {
+            open_codec(fps, bitrate_kbps);
+            _stream = avformat_new_stream(_fmt, nullptr);
+            if (!_stream || avcodec_parameters_from_context(_stream->codecpar, _ctx) < 0) {
+                throw std::runtime_error("Cannot create H.264 stream");
+            }
+            _stream->time_base = _ctx->time_base;
+            if (!(_fmt->oformat->flags & AVFMT_NOFILE) && avio_open(&_fmt->pb, path.c_str(), AVIO_FLAG_WRITE) < 0) {
+                throw std::runtime_error("Cannot open " + path);
+            }
+            if (avformat_write_header(_fmt, nullptr) < 0) {
+                throw std::runtime_error("Cannot write container header for " + path);
+            }
+            _sws = sws_getContext(_width, _height, source_format(_format), _width, _height, AV_PIX_FMT_YUV420P, SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+            _frame = av_frame_alloc();
+            _pkt = av_packet_alloc();
+            if (!_sws || !_frame || !_pkt) {
+                throw std::runtime_error("Out of memory setting up H.264 encoding");
+            }
+            _frame->format = AV_PIX_FMT_YUV420P;
+            _frame->width = _width;
+            _frame->height = _height;
+            if (av_frame_get_buffer(_frame, 0) < 0) {
+                throw std::runtime_error("Out of memory setting up H.264 encoding");
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~H264Writer() {
+        try {
+            close();
+        } catch (...) {
+        }
+        release();
+    }
+
+    H264Writer(const H264Writer&) = delete;
+    H264Writer& operator=(const H264Writer&) = delete;
+
+    const char* encoder_name() const { return _ctx && _ctx->codec ? _ctx->codec->name : ""; }
+
+    // Encode one frame; returns false if its size or format differs from the stream's
+    bool write(FrameBuffer& frame) {
+        if (frame.width != _width || frame.height != _height || frame.format != _format) {
+            return false;
+        }
+        if (av_frame_make_writable(_frame) < 0) {
+            throw std::runtime_error("H.264 frame buffer unavailable");
+        }
+        // Raw formats go straight into swscale; MJPG is decoded through the BGR view
+        const uint8_t* src[2] = {frame.pixels(), nullptr};
+        int src_stride[2] = {_width * frame.channels, 0};
+        if (_format == PixelFormat::NV12) {
+            src[1] = frame.pixels() + static_cast<size_t>(_width) * static_cast<size_t>(_height);
+            src_stride[1] = _width;
+        } else if (_format == PixelFormat::MJPG) {
+            src[0] = frame.bgr();
+            src_stride[0] = _width * 3;
+        }
+        sws_scale(_sws, src, src_stride, 0, _height, _frame->data, _frame->linesize);
+        // Capture timestamps in ms keep the file in sync with the other streams
+        int64_t pts = std::llround((frame.timestamp - _t0) * 1000.0);
+        _frame->pts = std::max(pts, _last_pts + 1);
+        _last_pts = _frame->pts;
+        send(_frame);
+        return true;
+    }
+
+    // Flush the encoder and write the trailer; safe to call more than once
+    void close() {
+        if (!_fmt || _closed) return;
+        _closed = true;
+        send(nullptr);
+        av_write_trailer(_fmt);
+    }
+
+private:
+    static AVPixelFormat source_format(PixelFormat f) {
+        switch (f) {
+            case PixelFormat::GRAY: return AV_PIX_FMT_GRAY8;
+            case PixelFormat::YUYV: return AV_PIX_FMT_YUYV422;
+            case PixelFormat::NV12: return AV_PIX_FMT_NV12;
+            default: return AV_PIX_FMT_BGR24;
+        }
+    }
+
+    void open_codec(double fps, int bitrate_kbps) {
+        // Hardware encoder first; opening fails cleanly when no GPU is present
+        for (const char* name : {"h264_nvenc", "libx264", ""}) {
+            const AVCodec* codec = *name ? avcodec_find_encoder_by_name(name) : avcodec_find_encoder(AV_CODEC_ID_H264);
+            if (!codec) continue;
+            AVCodecContext* ctx = avcodec_alloc_context3(codec);
+            if (!ctx) continue;
+            ctx->width = _width;
+            ctx->height = _height;
+            ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+            ctx->time_base = AVRational{1, 1000};
+            ctx->framerate = av_d2q(fps, 1000);
+            ctx->gop_size = std::max(1, static_cast<int>(fps));
+            ctx->max_b_frames = 0;
+            ctx->bit_rate = static_cast<int64_t>(bitrate_kbps) * 1000;
+            if (_fmt->oformat->flags & AVFMT_GLOBALHEADER) {
+                ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+            av_opt_set(ctx->priv_data, "preset", std::string(codec->name) == "libx264" ? "veryfast" : "p3", 0);
+            av_opt_set(ctx->priv_data, "tune", std::string(codec->name) == "libx264" ? "zerolatency" : "ll", 0);
+            if (avcodec_open2(ctx, codec, nullptr) == 0) {
+                _ctx = ctx;
+                return;
+            }
+            avcodec_free_context(&ctx);
+        }
+        throw std::runtime_error("No usable H.264 encoder in this FFmpeg build");
+    }
+
+    void send(AVFrame* frame) {
+        if (avcodec_send_frame(_ctx, frame) < 0) {
+            throw std::runtime_error("H.264 encoding failed");
+        }
+        while (avcodec_receive_packet(_ctx, _pkt) == 0) {
+            av_packet_rescale_ts(_pkt, _ctx->time_base, _stream->time_base);
+            _pkt->stream_index = _stream->index;
+            int rc = av_interleaved_write_frame(_fmt, _pkt);
+            av_packet_unref(_pkt);
+            if (rc < 0) {
+                throw std::runtime_error("Writing H.264 packet failed");
+            }
+        }
+    }
+
+    void release() {
+        if (_sws) sws_freeContext(_sws);
+        _sws = nullptr;
+        av_frame_free(&_frame);
+        av_packet_free(&_pkt);
+        avcodec_free_context(&_ctx);
+        if (_fmt) {
+            if (_fmt->pb && !(_fmt->oformat->flags & AVFMT_NOFILE)) avio_closep(&_fmt->pb);
+            avformat_free_context(_fmt);
+            _fmt = nullptr;
+        }
+    }
+
+    const int _width;
+    const int _height;
+    const PixelFormat _format;
+    const double _t0;
+    int64_t _last_pts{-1};
+    bool _closed{false};
+    AVFormatContext* _fmt{nullptr};
+    AVCodecContext* _ctx{nullptr};
+    AVStream* _stream{nullptr};
+    SwsContext* _sws{nullptr};
+    AVFrame* _frame{nullptr};
+    AVPacket* _pkt{nullptr};
+};
+#endif
+
+struct EncoderOptions {
+    std::string path;              // container file; empty = preview only
+    std::string codec{"mjpeg"};    // "mjpeg" or "h264"
+    int quality{85};               // JPEG quality (file and preview)
+    int bitrate_kbps{4000};        // H.264 target bitrate
+    double fps{30.0};              // nominal rate for the H.264 stream
+    int preview_interval{1};       // publish every Nth frame as preview; 0 disables
+    size_t max_queue{2};           // frames waiting for the encoder before drops
+};
+
+struct EncoderStats {
+    uint64_t frames{0};        // frames encoded
+    uint64_t bytes{0};         // encoded bytes produced for the file
+    uint64_t dropped{0};       // frames skipped because the encoder was behind
+    uint64_t errors{0};        // frames that could not be decoded
+    double encode_seconds{0};  // total time spent compressing
+};
+
+class FrameEncoder {
+public:
+    FrameEncoder(EncoderOptions opts, EncodedPreview& preview) : _opts(std::move(opts)), _preview(preview) {
+        if (_opts.codec == "mjpeg") {
+            if (!jpeg_encoder_available()) {
+                throw std::runtime_error("MJPEG encoding needs a build with USE_LIBJPEG");
+            }
+            if (!_opts.path.empty()) {
+                _file = std::make_unique<ColumnarFileWriter>(
+                    _opts.path,
+                    std::vector<RecorderColumn>{{"seq", "<u8"}, {"timestamp", "<f8"}, {"width", "<u4"},
+                                                {"height", "<u4"}, {"jpeg", "|u1"}},
+                    RecorderSync::OnClose);
+            }
+        } else if (_opts.codec == "h264") {
+            if (!h264_encoder_available()) {
+                throw std::runtime_error("H.264 encoding needs a build with USE_FFMPEG");
+            }
+            if (_opts.path.empty()) {
+                throw std::invalid_argument("H.264 encoding needs an output path");
+            }
+        } else {
+            throw std::invalid_argument("codec must be 'mjpeg' or 'h264'");
+        }
+        _opts.max_queue = std::max<size_t>(1, _opts.max_queue);
+        _thread = spawn_thread("encoder", "encoder:" + _opts.codec, [this] { run(); });
+    }
+
+    ~FrameEncoder() {
+        try {
+            stop();
+        } catch (...) {
+        }
+    }
+
+    // Capture thread: queue a published frame; dropped if the encoder is behind
+    void push(std::shared_ptr<FrameBuffer> frame) {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            if (_queue.size() >= _opts.max_queue || !_error.empty()) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            _queue.push_back(std::move(frame));
+        }
+        _cv.notify_one();
+    }
+
+    // Frames queued but not yet taken by the encoder thread
+    size_t backlog() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _queue.size();
+    }
+
+    size_t max_queue() const { return _opts.max_queue; }
+
+    // Encode what is queued, close the file and rethrow the first error
+    void stop() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            _stop = true;
+        }
+        _cv.notify_all();
+        if (_thread.joinable()) _thread.join();
+        std::lock_guard<std::mutex> g(_mtx);
+        if (!_error.empty()) {
+            std::string err;
+            err.swap(_error);
+            throw std::runtime_error("Encoding failed: " + err);
+        }
+    }
+
+    // Also keep the JPEG of every frame in a flight recorder (nullptr stops);
+    // MJPG camera frames are journaled by the capture thread instead
+    void set_journal(std::shared_ptr<FlightFrameRecorder> journal) {
+        std::lock_guard<std::mutex> g(_mtx);
+        _journal = std::move(journal);
+    }
+
+    // Notified after every frame encoded (nullptr stops)
+    void set_release_signal(std::shared_ptr<FrameReleaseSignal> signal) {
+        std::lock_guard<std::mutex> g(_mtx);
+        _released = std::move(signal);
+    }
+
+    EncoderStats stats() const {
+        EncoderStats s;
+        s.frames = _frames.load(std::memory_order_relaxed);
+        s.bytes = _bytes.load(std::memory_order_relaxed);
+        s.dropped = _dropped.load(std::memory_order_relaxed);
+        s.errors = _errors.load(std::memory_order_relaxed);
+        s.encode_seconds = _encode_ns.load(std::memory_order_relaxed) * 1e-9;
+        return s;
+    }
+
+private:
+    void run() {
+        try {
+            while (true) {
+                std::shared_ptr<FrameBuffer> frame;
+                std::shared_ptr<FlightFrameRecorder> journal;
+                std::shared_ptr<FrameReleaseSignal> released;
+                {
+                    std::unique_lock<std::mutex> lk(_mtx);
+                    _cv.wait(lk, [&] { return _stop || !_queue.empty(); });
+                    if (_queue.empty()) break;
+                    frame = std::move(_queue.front());
+                    _queue.pop_front();
+                    journal = _journal;
+                    released = _released;
+                }
+                encode(*frame, journal.get());
+                frame.reset();
+                if (released) released->notify();
+            }
+            finish();
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> g(_mtx);
+            _error = e.what();
+            _queue.clear();
+        }
+    }
+
+    void encode(FrameBuffer& frame, FlightFrameRecorder* journal) {
+        auto t0 = std::chrono::steady_clock::now();
+        const bool preview = _opts.preview_interval > 0 && (_index++ % _opts.preview_interval) == 0;
+        const bool mjpeg_file = _opts.codec == "mjpeg" && _file;
+        const bool journaled = journal && frame.format != PixelFormat::MJPG;
+        if (!mjpeg_file && !preview && !journaled && _opts.codec == "mjpeg") {
+            return;  // preview-only encoder between preview frames
+        }
+        std::shared_ptr<EncodedFrame> jpeg;
+        uint64_t file_bytes = 0;
+
+        if (mjpeg_file || preview || journaled) {
+            jpeg = encode_jpeg(frame);
+        }
+        if (journaled && jpeg) {
+            journal->push(jpeg->data.data(), jpeg->data.size(), static_cast<uint32_t>(PixelFormat::MJPG),
+                          frame.width, frame.height, frame.timestamp, frame.seq);
+        }
+        if (mjpeg_file && jpeg) {
+            uint32_t dims[2] = {static_cast<uint32_t>(frame.width), static_cast<uint32_t>(frame.height)};
+            _file->write_chunk(1, {{&frame.seq, sizeof(uint64_t)},
+                                   {&frame.timestamp, sizeof(double)},
+                                   {&dims[0], sizeof(uint32_t)},
+                                   {&dims[1], sizeof(uint32_t)},
+                                   {jpeg->data.data(), jpeg->data.size()}});
+            file_bytes = jpeg->data.size();
+        }
+#ifdef USE_FFMPEG
+        if (_opts.codec == "h264") {
+            // A corrupt MJPG frame is skipped; only FFmpeg and I/O errors end the stream
+            if (frame.format == PixelFormat::MJPG) {
+                try {
+                    frame.bgr();
+                } catch (const std::exception&) {
+                    _errors.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            if (!_h264) {
+                _h264 = std::make_unique<H264Writer>(_opts.path, frame, _opts.fps, _opts.bitrate_kbps);
+            }
+            if (!_h264->write(frame)) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);  // size changed mid-stream
+                return;
+            }
+        }
+#endif
+        if (preview && jpeg) {
+            _preview.publish(std::move(jpeg));
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0);
+        _encode_ns.fetch_add(static_cast<uint64_t>(ns.count()), std::memory_order_relaxed);
+        _frames.fetch_add(1, std::memory_order_relaxed);
+        if (_file) {
+            _bytes.fetch_add(file_bytes, std::memory_order_relaxed);
+        }
+    }
+
+    // JPEG for the file and preview: MJPG camera frames pass through untouched,
+    // BGR and GRAY are compressed directly and YUV goes through the BGR view
+    std::shared_ptr<EncodedFrame> encode_jpeg(FrameBuffer& frame) {
+        auto jpeg = std::make_shared<EncodedFrame>();
+        if (frame.format == PixelFormat::MJPG) {
+            jpeg->data.assign(frame.pixels(), frame.pixels() + std::min(frame.bytes, frame.capacity()));
+        } else {
+#ifdef USE_LIBJPEG
+            const bool direct = frame.format == PixelFormat::BGR || frame.format == PixelFormat::GRAY;
+            _jpeg.encode(direct ? frame.pixels() : frame.bgr(), frame.width, frame.height,
+                         direct ? frame.channels : 3, _opts.quality, jpeg->data);
+#else
+            return nullptr;
+#endif
+        }
+        jpeg->seq = frame.seq;
+        jpeg->timestamp = frame.timestamp;
+        jpeg->width = frame.width;
+        jpeg->height = frame.height;
+        return jpeg;
+    }
+
+    void finish() {
+        if (_file) {
+            _file->close();
+        }
+#ifdef USE_FFMPEG
+        if (_h264) {
+            _h264->close();
+        }
+        if (!_opts.path.empty() && _opts.codec == "h264") {
+            _bytes.store(file_size(_opts.path), std::memory_order_relaxed);
+        }
+#endif
+    }
+
+#ifdef USE_FFMPEG
+    static uint64_t file_size(const std::string& path) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return 0;
+        std::fseek(f, 0, SEEK_END);
+        long n = std::ftell(f);
+        std::fclose(f);
+        return n > 0 ? static_cast<uint64_t>(n) : 0;
+    }
+#endif
+
+    EncoderOptions _opts;
+    EncodedPreview& _preview;
+    std::unique_ptr<ColumnarFileWriter> _file;
+#ifdef USE_LIBJPEG
+    JpegEncoder _jpeg;
+#endif
+#ifdef USE_FFMPEG
+    std::unique_ptr<H264Writer> _h264;
+#endif
+    uint64_t _index{0};  // encoder thread only
+    mutable std::mutex _mtx;  // guards _queue, _journal, _released, _stop and _error
+    std::condition_variable _cv;
+    std::deque<std::shared_ptr<FrameBuffer>> _queue;
+    std::shared_ptr<FrameReleaseSignal> _released;
+    std::shared_ptr<FlightFrameRecorder> _journal;
+    bool _stop{false};
+    std::string _error;
+    std::thread _thread;
+    std::atomic<uint64_t> _frames{0};
+    std::atomic<uint64_t> _bytes{0};
+    std::atomic<uint64_t> _dropped{0};
+    std::atomic<uint64_t> _errors{0};
+    std::atomic<uint64_t> _encode_ns{0};
+};
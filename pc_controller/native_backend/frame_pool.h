@@ -0,0 +1,220 @@
+#pragma once
+
+// Pool of refcounted frame buffers for tear-free zero-copy frame handoff.
+//
+// The capture thread fills a buffer nobody else references and publishes it
+// as the latest frame. Consumers take a shared reference to the latest frame,
+// so a buffer is never rewritten while any consumer (e.g. a NumPy array that
+// wraps it) still holds it. When every buffer is in use the pool grows up to
+// max_buffers; past that the new frame is dropped instead of waiting.
+//
+// Buffers hold frames in the camera's native pixel format. The BGR view is
+// converted on first request and cached with the buffer until it is reused.
+// A buffer can also wrap external storage, such as a driver buffer mapped by
+// a native capture backend, so frames reach consumers without a copy.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pixel_format.h"
+
+struct FrameBuffer {
+    explicit FrameBuffer(size_t bytes) : data(bytes, 0) {}
+
+    // Wrap capacity bytes at ptr; owner keeps the storage alive for as long
+    // as any reference to this buffer exists
+    FrameBuffer(uint8_t* ptr, size_t capacity, std::shared_ptr<void> owner)
+        : _external(ptr), _external_capacity(capacity), _external_owner(std::move(owner)) {}
+
+    std::vector<uint8_t> data;  // owned storage; empty for external buffers
+    size_t bytes{0};         // valid bytes at pixels() (varies per frame for MJPG)
+    PixelFormat format{PixelFormat::BGR};
+    int width{0};
+    int height{0};
+    int channels{3};         // interleaved channels of the native layout
+    uint64_t seq{0};         // monotonically increasing frame index, starts at 1
+    double timestamp{0.0};   // capture time, steady_clock seconds
+    bool delivered{false};   // guarded by FramePool::_mtx once published
+
+    uint8_t* pixels() { return _external ? _external : data.data(); }
+    const uint8_t* pixels() const { return _external ? _external : data.data(); }
+    size_t capacity() const { return _external ? _external_capacity : data.size(); }
+
+    // Packed BGR pixels: the data itself for BGR frames, otherwise converted
+    // on the first call and shared by later callers. Throws on a corrupt MJPG frame.
+    const uint8_t* bgr() {
+        if (format == PixelFormat::BGR) return pixels();
+        std::lock_guard<std::mutex> g(_bgr_mtx);
+        if (!_bgr_valid) {
+            _bgr.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
+            convert_to_bgr(format, pixels(), bytes, width, height, _bgr.data());
+            _bgr_valid = true;
+        }
+        return _bgr.data();
+    }
+
+    // Producer: set the layout of the frame about to be written and drop the old BGR view
+    void prepare(PixelFormat fmt, int w, int h, size_t frame_bytes) {
+        format = fmt;
+        width = w;
+        height = h;
+        channels = pixel_format_channels(fmt);
+        bytes = frame_bytes;
+        if (!_external && data.size() < frame_bytes) data.resize(frame_bytes);
+        _bgr_valid = false;
+    }
+
+private:
+    uint8_t* _external{nullptr};
+    size_t _external_capacity{0};
+    std::shared_ptr<void> _external_owner;
+    std::mutex _bgr_mtx;
+    std::vector<uint8_t> _bgr;
+    bool _bgr_valid{false};
+};
+
+// Raised by frame consumers each time they let go of a frame, so a producer
+// that must not drop frames (an unthrottled replay) can sleep until a queue
+// slot or a pool buffer may have come free instead of polling
+class FrameReleaseSignal {
+public:
+    uint64_t count() {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _count;
+    }
+
+    void notify() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            ++_count;
+        }
+        _cv.notify_all();
+    }
+
+    // Until notify() is called after count() returned `seen`, or timeout
+    void wait(uint64_t seen, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        _cv.wait_for(lk, timeout, [&] { return _count != seen; });
+    }
+
+private:
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    uint64_t _count{0};
+};
+
+class FramePool {
+public:
+    // Three buffers cover capture + latest + one consumer without allocation
+    explicit FramePool(size_t frame_bytes, size_t initial_buffers = 3, size_t max_buffers = 8)
+        : _frame_bytes(frame_bytes), _max_buffers(max_buffers) {
+        for (size_t i = 0; i < initial_buffers; ++i) {
+            _buffers.push_back(std::make_shared<FrameBuffer>(frame_bytes));
+        }
+    }
+
+    // Size of newly allocated buffers; only call while no producer is running.
+    // Buffers still referenced by consumers keep their old contents.
+    void set_frame_bytes(size_t frame_bytes) { _frame_bytes = frame_bytes; }
+
+    // Producer: get a buffer no consumer references, or nullptr if the pool is exhausted
+    std::shared_ptr<FrameBuffer> acquire() {
+        for (auto& buf : _buffers) {
+            if (buf.use_count() == 1) {
+                // Pair with the consumers' release of their last reference
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return buf;
+            }
+        }
+        if (_buffers.size() < _max_buffers) {
+            _buffers.push_back(std::make_shared<FrameBuffer>(_frame_bytes));
+            return _buffers.back();
+        }
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // Producer: make a filled buffer the latest frame and assign its sequence number
+    void publish(std::shared_ptr<FrameBuffer> frame) {
+        frame->delivered = false;
+        std::shared_ptr<FrameBuffer> previous;
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            frame->seq = ++_seq;
+            previous = std::move(_latest);
+            _latest = std::move(frame);
+            if (previous && !previous->delivered) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            wake = _waiters > 0;
+        }
+        _captured.fetch_add(1, std::memory_order_relaxed);
+        if (wake) _cv.notify_all();
+    }
+
+    // Consumer: shared reference to the latest frame (nullptr before the first one)
+    std::shared_ptr<FrameBuffer> latest() {
+        std::lock_guard<std::mutex> g(_mtx);
+        return take_latest();
+    }
+
+    // Consumer: block until a frame newer than last_seq is published, the
+    // timeout expires or wake_all() is called. Returns nullptr on timeout.
+    std::shared_ptr<FrameBuffer> wait_newer(uint64_t last_seq, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        const uint64_t generation = _generation;
+        ++_waiters;
+        _cv.wait_for(lk, timeout, [&] { return _seq > last_seq || generation != _generation; });
+        --_waiters;
+        return _seq > last_seq ? take_latest() : nullptr;
+    }
+
+    // Release every waiter (used on shutdown)
+    void wake_all() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            ++_generation;
+        }
+        _cv.notify_all();
+    }
+
+    uint64_t latest_seq() {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _seq;
+    }
+
+    uint64_t frames_captured() const { return _captured.load(std::memory_order_relaxed); }
+    uint64_t frames_delivered() const { return _delivered.load(std::memory_order_relaxed); }
+    // Frames replaced before any consumer saw them, or skipped for lack of a free buffer
+    uint64_t frames_dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Requires _mtx
+    std::shared_ptr<FrameBuffer> take_latest() {
+        if (_latest && !_latest->delivered) {
+            _latest->delivered = true;
+            _delivered.fetch_add(1, std::memory_order_relaxed);
+        }
+        return _latest;
+    }
+
+    size_t _frame_bytes;
+    const size_t _max_buffers;
+    std::vector<std::shared_ptr<FrameBuffer>> _buffers;  // producer-owned list
+    std::mutex _mtx;                                     // guards the fields below
+    std::condition_variable _cv;
+    std::shared_ptr<FrameBuffer> _latest;
+    uint64_t _seq{0};
+    uint64_t _generation{0};
+    int _waiters{0};
+    std::atomic<uint64_t> _captured{0};
+    std::atomic<uint64_t> _delivered{0};
+    std::atomic<uint64_t> _dropped{0};
+};
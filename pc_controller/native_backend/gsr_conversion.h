@@ -0,0 +1,139 @@
+#pragma once
+
+// Batch conversion of Shimmer3 GSR+ raw words to skin conductance (uS).
+//
+// A raw GSR word carries the 12-bit ADC value in bits 0-11 and the active
+// feedback-resistor range in bits 14-15 (set by the device in auto range).
+// For range r with feedback resistor Rf[r] (kOhm):
+//
+//     V   = adc * vref / 4095
+//     uS  = (V / v_bias - 1) * 1000 / Rf[r]
+//
+// which folds into one multiply-add per sample: uS = adc * a[r] - b[r].
+// On x86-64 an AVX2 kernel is selected at runtime; it looks the coefficients
+// up with one permute per vector and rounds like the scalar loop, so results
+// are identical. Elsewhere the scalar loop is left to the compiler's
+// auto-vectorizer.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define GSR_HAVE_X86 1
+#endif
+
+struct GsrCalibration {
+    // Shimmer3 GSR+ feedback resistors for ranges 0-3 (kOhm)
+    double rf_kohm[4] = {40.2, 287.0, 1000.0, 3300.0};
+    double vref = 3.0;      // ADC reference voltage
+    double v_bias = 0.5;    // amplifier input voltage
+    double floor_us = 0.1;  // lower clamp; open electrodes give non-physical values
+};
+
+constexpr uint16_t kGsrAdcMask = 0x0FFF;
+constexpr int kGsrRangeShift = 14;
+
+inline int gsr_range_of(uint16_t raw) { return (raw >> kGsrRangeShift) & 0x3; }
+
+namespace gsr_detail {
+
+// Per-range coefficients of uS = adc * a[r] - b[r]
+struct Coefficients {
+    double a[4];
+    double b[4];
+    double floor_us;
+
+    explicit Coefficients(const GsrCalibration& cal) : floor_us(cal.floor_us) {
+        for (int r = 0; r < 4; ++r) {
+            b[r] = 1000.0 / cal.rf_kohm[r];
+            a[r] = b[r] * cal.vref / (4095.0 * cal.v_bias);
+        }
+    }
+};
+
+inline void convert_scalar(const uint16_t* raw, double* out, size_t n, const Coefficients& c) {
+    for (size_t i = 0; i < n; ++i) {
+        int r = gsr_range_of(raw[i]);
+        double adc = static_cast<double>(raw[i] & kGsrAdcMask);
+        out[i] = std::max(c.floor_us, adc * c.a[r] - c.b[r]);
+    }
+}
+
+#if defined(GSR_HAVE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GSR_HAVE_AVX2_KERNEL 1
+__attribute__((target("avx2")))
+inline void convert_avx2(const uint16_t* raw, double* out, size_t n, const Coefficients& c) {
+    // The 4-entry double tables viewed as 8 floats: range r lives in float
+    // lanes 2r and 2r+1, so a per-lane permute selects the coefficient.
+    const __m256 a_tab = _mm256_castpd_ps(_mm256_loadu_pd(c.a));
+    const __m256 b_tab = _mm256_castpd_ps(_mm256_loadu_pd(c.b));
+    const __m256d floor_v = _mm256_set1_pd(c.floor_us);
+    const __m256i adc_mask = _mm256_set1_epi32(kGsrAdcMask);
+    const __m256i even = _mm256_set1_epi32(~1);
+    const __m256i high_one = _mm256_set1_epi64x(int64_t{1} << 32);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // 8 x uint16 -> 8 x int32: ADC value and 2 * range
+        __m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i)));
+        __m256i adc = _mm256_and_si256(w, adc_mask);
+        __m256i range2 = _mm256_and_si256(_mm256_srli_epi32(w, kGsrRangeShift - 1), even);
+        for (int half = 0; half < 2; ++half) {
+            __m128i adc4 = half ? _mm256_extracti128_si256(adc, 1) : _mm256_castsi256_si128(adc);
+            __m128i r4 = half ? _mm256_extracti128_si256(range2, 1) : _mm256_castsi256_si128(range2);
+            // Float lane indices {2r, 2r + 1} for each 64-bit lane
+            __m256i idx = _mm256_cvtepu32_epi64(r4);
+            idx = _mm256_or_si256(_mm256_or_si256(idx, _mm256_slli_epi64(idx, 32)), high_one);
+            __m256d a = _mm256_castps_pd(_mm256_permutevar8x32_ps(a_tab, idx));
+            __m256d b = _mm256_castps_pd(_mm256_permutevar8x32_ps(b_tab, idx));
+            __m256d us = _mm256_sub_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(adc4), a), b);
+            _mm256_storeu_pd(out + i + 4 * half, _mm256_max_pd(us, floor_v));
+        }
+    }
+    convert_scalar(raw + i, out + i, n - i, c);
+}
+
+inline bool cpu_has_avx2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#endif
+
+}  // namespace gsr_detail
+
+// Convert n raw GSR words to microsiemens using the fastest available kernel
+inline void gsr_raw_to_microsiemens(const uint16_t* raw, double* out, size_t n, const GsrCalibration& cal) {
+    const gsr_detail::Coefficients c(cal);
+#if defined(GSR_HAVE_AVX2_KERNEL)
+    if (gsr_detail::cpu_has_avx2()) {
+        gsr_detail::convert_avx2(raw, out, n, c);
+        return;
+    }
+#endif
+    gsr_detail::convert_scalar(raw, out, n, c);
+}
+
+// Name of the kernel gsr_raw_to_microsiemens() dispatches to on this machine
+inline const char* gsr_kernel_name() {
+#if defined(GSR_HAVE_AVX2_KERNEL)
+    return gsr_detail::cpu_has_avx2() ? "avx2" : "scalar";
+#else
+    return "scalar";
+#endif
+}
+
+// Inverse of the conversion, used by the simulators: picks the most
+// sensitive range whose ADC value fits and returns the encoded raw word.
+inline uint16_t gsr_microsiemens_to_raw(double us, const GsrCalibration& cal) {
+    for (int r = 3; r >= 0; --r) {
+        double adc = (us * cal.rf_kohm[r] / 1000.0 + 1.0) * cal.v_bias * 4095.0 / cal.vref;
+        if (adc <= 4095.0 || r == 0) {
+            auto code = static_cast<uint16_t>(std::lround(std::clamp(adc, 0.0, 4095.0)));
+            return static_cast<uint16_t>(code | (r << kGsrRangeShift));
+        }
+    }
+    return 0;
+}
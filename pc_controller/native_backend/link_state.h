@@ -0,0 +1,138 @@
+#pragma once
+
+// Connection state of a streaming device and the reconnect state machine.
+//
+// A device that loses its link goes from "streaming" to "reconnecting" and
+// is re-opened with capped exponential backoff, so the thread, the ring and
+// any recorder survive the outage. Its acquisition thread (or hub worker)
+// drives the attempts; a hardware device is opened on a PendingReopen helper
+// thread that the poller only checks on, so a slow pairing does not block
+// it. After max_attempts failed attempts, or at once if reconnecting is
+// disabled, it goes to "failed" and stays there until streaming is restarted.
+//
+// Every transition is appended to a LinkEventLog. Consumers block in
+// wait_newer() (without the GIL) instead of polling the state.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class LinkState { Idle, Streaming, Reconnecting, Failed };
+
+inline const char* link_state_name(LinkState s) {
+    switch (s) {
+        case LinkState::Idle: return "idle";
+        case LinkState::Streaming: return "streaming";
+        case LinkState::Reconnecting: return "reconnecting";
+        case LinkState::Failed: return "failed";
+    }
+    return "unknown";
+}
+
+struct ReconnectPolicy {
+    bool enabled{true};
+    double initial_backoff_ms{100.0};
+    double max_backoff_ms{5000.0};
+    uint32_t max_attempts{0};  // 0 = keep trying
+};
+
+inline void validate_reconnect_policy(const ReconnectPolicy& p) {
+    if (!(p.initial_backoff_ms >= 0.0 && p.max_backoff_ms >= p.initial_backoff_ms)) {
+        throw std::invalid_argument("backoff must satisfy 0 <= initial_backoff_ms <= max_backoff_ms");
+    }
+}
+
+struct LinkEvent {
+    uint64_t seq{0};
+    LinkState state{LinkState::Idle};
+    double timestamp{0.0};  // host steady clock seconds
+    uint32_t attempt{0};    // reconnect attempts so far in this outage
+    std::string message;
+};
+
+// Bounded history of state transitions with blocking waits for new ones
+class LinkEventLog {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    void push(LinkState state, double timestamp, uint32_t attempt, std::string message) {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            _events.push_back({++_seq, state, timestamp, attempt, std::move(message)});
+            if (_events.size() > kCapacity) _events.pop_front();
+        }
+        _cv.notify_all();
+    }
+
+    // Events with seq > last_seq, waiting up to timeout for the first one;
+    // empty on timeout or wake_all(). Events older than the history are lost.
+    std::vector<LinkEvent> wait_newer(uint64_t last_seq, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        const uint64_t generation = _generation;
+        _cv.wait_for(lk, timeout, [&] { return _seq > last_seq || generation != _generation; });
+        std::vector<LinkEvent> out;
+        for (const LinkEvent& e : _events) {
+            if (e.seq > last_seq) out.push_back(e);
+        }
+        return out;
+    }
+
+    uint64_t latest_seq() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _seq;
+    }
+
+    // Release every waiter, e.g. on shutdown
+    void wake_all() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            ++_generation;
+        }
+        _cv.notify_all();
+    }
+
+private:
+    mutable std::mutex _mtx;
+    std::condition_variable _cv;
+    std::deque<LinkEvent> _events;
+    uint64_t _seq{0};
+    uint64_t _generation{0};
+};
+
+// Attempt schedule of one outage; owned by the thread that polls the device
+class ReconnectBackoff {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void begin(Clock::time_point now) {
+        _attempts = 0;
+        _next = now;
+    }
+
+    bool due(Clock::time_point now) const { return now >= _next; }
+    Clock::time_point next_attempt() const { return _next; }
+    uint32_t attempts() const { return _attempts; }
+
+    // An attempt failed at `now`; false once the policy gives up
+    bool failed(const ReconnectPolicy& policy, Clock::time_point now) {
+        ++_attempts;
+        if (policy.max_attempts && _attempts >= policy.max_attempts) return false;
+        const double backoff = std::min(policy.max_backoff_ms,
+                                        policy.initial_backoff_ms * static_cast<double>(1ull << std::min(_attempts - 1, 20u)));
+        _next = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(backoff));
+        return true;
+    }
+
+    // The link is back; counts the successful attempt
+    void succeeded() { ++_attempts; }
+
+private:
+    uint32_t _attempts{0};
+    Clock::time_point _next{};
+};
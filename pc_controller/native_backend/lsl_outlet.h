@@ -0,0 +1,195 @@
+#pragma once
+
+// Lab Streaming Layer outlet fed straight from a Shimmer ring.
+//
+// The outlet follows the ring with its own Reader on a native thread, so
+// samples reach LSL consumers without a Python hop and without taking them
+// from any other consumer. The thread sleeps on the ring's RingSignal until
+// chunk_size rows are pending or the oldest pending row has waited
+// max_latency_ms, then pushes the chunk with pushthrough set. Each sample
+// is stamped with its aligned_ts (device clock mapped onto the host steady
+// clock by the ClockModel), converted to lsl::local_clock().
+//
+// Channels are GSR (microsiemens) and PPG (raw ADC), float32, with the
+// labels, units and desc entries of the Python outlets in
+// network/lsl_integration.py; only the PPG channel's type is "PPG" rather
+// than "GSR". Built with USE_LSL (liblsl); without it constructing an
+// outlet throws.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef USE_LSL
+#include <lsl_cpp.h>
+#endif
+
+#include "soa_ring.h"
+#include "stream_stats.h"
+#include "thread_registry.h"
+
+inline bool lsl_outlet_available() {
+#ifdef USE_LSL
+    return true;
+#else
+    return false;
+#endif
+}
+
+struct LslOutletOptions {
+    std::string name;
+    std::string source_id;     // lets consumers re-resolve the stream after a restart; may be empty
+    double nominal_rate{128.0};
+    size_t chunk_size{1};      // rows per push
+    double max_latency_ms{10.0};  // push a partial chunk once its oldest row is this old
+    std::string device_id;     // desc "device_id" entry; omitted if empty
+};
+
+struct LslOutletStats {
+    uint64_t samples{0};
+    uint64_t chunks{0};
+    uint64_t dropped{0};  // rows overwritten in the ring before the outlet read them
+    bool has_consumers{false};
+    HistogramSnapshot latency;  // host receive to push, per sample
+};
+
+// Ring must have the ShimmerRing layout: (device_ts, host_ts, aligned_ts,
+// gsr_us, gsr_raw, ppg_raw, flags)
+template <typename Ring>
+class RingLslOutlet {
+public:
+    RingLslOutlet(LslOutletOptions opts, Ring& ring, RingSignal& signal)
+        : _opts(std::move(opts)), _ring(ring), _signal(signal), _reader(ring.make_reader()) {
+        if (!lsl_outlet_available()) {
+            throw std::runtime_error("LSL output needs a build with USE_LSL");
+        }
+        if (_opts.name.empty()) {
+            throw std::invalid_argument("LSL stream name must not be empty");
+        }
+        if (_opts.chunk_size == 0 || !(_opts.max_latency_ms >= 0.0)) {
+            throw std::invalid_argument("chunk_size must be at least 1 and max_latency_ms not negative");
+        }
+        _opts.chunk_size = std::min(_opts.chunk_size, ring.capacity());
+        _host_ts.resize(_opts.chunk_size);
+        _aligned_ts.resize(_opts.chunk_size);
+        _gsr.resize(_opts.chunk_size);
+        _ppg.resize(_opts.chunk_size);
+        _samples.resize(_opts.chunk_size * 2);
+        _stamps.resize(_opts.chunk_size);
+#ifdef USE_LSL
+        lsl::stream_info info(_opts.name, "GSR", 2, _opts.nominal_rate, lsl::cf_float32, _opts.source_id);
+        lsl::xml_element channels = info.desc().append_child("channels");
+        channels.append_child("channel")
+            .append_child_value("label", "GSR")
+            .append_child_value("unit", "microsiemens")
+            .append_child_value("type", "GSR");
+        channels.append_child("channel")
+            .append_child_value("label", "PPG")
+            .append_child_value("unit", "raw")
+            .append_child_value("type", "PPG");
+        info.desc().append_child_value("manufacturer", "Shimmer");
+        if (!_opts.device_id.empty()) info.desc().append_child_value("device_id", _opts.device_id);
+        // No outlet-side chunking: it would override pushthrough for latency-triggered partial chunks
+        _outlet = std::make_unique<lsl::stream_outlet>(info);
+        // liblsl normally uses the same steady clock; measure the offset rather than assume it
+        _clock_offset = lsl::local_clock() - steady_seconds();
+#endif
+        _thread = spawn_thread("lsl", "lsl:" + _opts.name, [this] { run(); });
+    }
+
+    RingLslOutlet(const RingLslOutlet&) = delete;
+    RingLslOutlet& operator=(const RingLslOutlet&) = delete;
+
+    ~RingLslOutlet() { stop(); }
+
+    // Push what is pending and end the thread; the LSL stream stays open until destruction
+    void stop() {
+        _stop.store(true);
+        _signal.wake_all();
+        if (_thread.joinable()) _thread.join();
+    }
+
+    const LslOutletOptions& options() const { return _opts; }
+
+    LslOutletStats stats() const {
+        LslOutletStats s;
+        s.samples = _pushed.value();
+        s.chunks = _chunks.value();
+        s.dropped = _reader->dropped();
+#ifdef USE_LSL
+        s.has_consumers = _outlet->have_consumers();
+#endif
+        s.latency = _latency.snapshot();
+        return s;
+    }
+
+private:
+    static double steady_seconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void run() {
+        const double max_latency_s = _opts.max_latency_ms / 1000.0;
+        size_t pending = 0;
+        while (!_stop.load()) {
+            pending += _ring.read(*_reader, _opts.chunk_size - pending, nullptr, _host_ts.data() + pending,
+                                  _aligned_ts.data() + pending, _gsr.data() + pending, nullptr,
+                                  _ppg.data() + pending, nullptr);
+            const double now = steady_seconds();
+            if (pending == _opts.chunk_size || (pending > 0 && now >= _host_ts[0] + max_latency_s)) {
+                push(pending);
+                pending = 0;
+                continue;  // more rows may already be waiting
+            }
+            // Wait for the rest of the chunk, or the first row, or the latency deadline
+            const uint64_t target = _reader->cursor() + (pending ? _opts.chunk_size - pending : 1);
+            const double wait_s = pending ? _host_ts[0] + max_latency_s - now : 0.1;
+            _signal.wait(target, [this] {
+                return _stop.load() ? std::numeric_limits<uint64_t>::max() : _ring.total_pushed();
+            }, std::chrono::milliseconds(static_cast<int64_t>(std::ceil(std::max(0.0, wait_s) * 1000.0))));
+        }
+        if (pending) push(pending);
+    }
+
+    void push(size_t rows) {
+        for (size_t i = 0; i < rows; ++i) {
+            _samples[2 * i] = static_cast<float>(_gsr[i]);
+            _samples[2 * i + 1] = static_cast<float>(_ppg[i]);
+            _stamps[i] = _aligned_ts[i] + _clock_offset;
+        }
+#ifdef USE_LSL
+        _outlet->push_chunk_multiplexed(_samples.data(), _stamps.data(), rows * 2, true);
+#endif
+        const double now = steady_seconds();
+        for (size_t i = 0; i < rows; ++i) _latency.record(now - _host_ts[i]);
+        _pushed.add(rows);
+        _chunks.add();
+    }
+
+    LslOutletOptions _opts;
+    Ring& _ring;
+    RingSignal& _signal;
+    std::unique_ptr<typename Ring::Reader> _reader;  // outlet thread only, except dropped()
+    // Staging for one chunk, outlet thread only
+    std::vector<double> _host_ts, _aligned_ts, _gsr;
+    std::vector<uint16_t> _ppg;
+    std::vector<float> _samples;  // multiplexed GSR, PPG
+    std::vector<double> _stamps;
+    double _clock_offset{0.0};    // lsl::local_clock() - steady clock
+#ifdef USE_LSL
+    std::unique_ptr<lsl::stream_outlet> _outlet;
+#endif
+    StatCounter _pushed;
+    StatCounter _chunks;
+    LatencyHistogram _latency;
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+};
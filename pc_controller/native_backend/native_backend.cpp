@@ -2,17 +2,52 @@
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "camera_capture.h"
+#include "clock_model.h"
+#include "decimation_pyramid.h"
+#include "eda_features.h"
+#include "flight_recorder.h"
+#include "frame_analysis.h"
+#include "frame_encoder.h"
+#include "frame_pool.h"
+#include "gsr_conversion.h"
+#include "link_state.h"
+#include "lsl_outlet.h"
+#include "pacer.h"
+#include "pixel_format.h"
+#include "replay_source.h"
+#include "shimmer_simulator.h"
+#include "shm_transport.h"
+#include "soa_ring.h"
+#include "stream_recorder.h"
+#include "stream_stats.h"
+#include "stream_sync.h"
+#include "thread_registry.h"
+
+#ifdef USE_OPENCV
+#include <opencv2/opencv.hpp>
+#endif
+
 // Shimmer C-API integration
 #ifdef USE_SHIMMER_CAPI
 #include "Shimmer.h"
@@ -23,58 +58,553 @@
 namespace py = pybind11;
 using Clock = std::chrono::steady_clock;
 
-// Simple single-producer single-consumer ring buffer for (t,value)
-class SpscRing {
-public:
-    explicit SpscRing(size_t capacity)
-        : _cap(next_pow2(capacity)), _mask(_cap - 1), _buf(_cap * 2), _head(0), _tail(0) {}
-
-    // Producer push
-    void push(double t, double v) {
-        auto h = _head.load(std::memory_order_relaxed);
-        auto n = h + 1;
-        // overwrite when full to keep latest samples (lock-free drop-oldest)
-        _buf[(h & _mask) * 2 + 0] = t;
-        _buf[(h & _mask) * 2 + 1] = v;
-        _head.store(n, std::memory_order_release);
-        // if producer runs too far ahead, advance tail (drop)
-        auto tcur = _tail.load(std::memory_order_acquire);
-        if (n - tcur > _cap) {
-            _tail.store(n - _cap, std::memory_order_release);
-        }
-    }
-
-    // Consumer pop all into vector of pairs
-    std::vector<std::pair<double,double>> pop_all() {
-        std::vector<std::pair<double,double>> out;
-        auto tcur = _tail.load(std::memory_order_relaxed);
-        auto h = _head.load(std::memory_order_acquire);
-        size_t count = static_cast<size_t>(h - tcur);
-        out.reserve(count);
-        for (size_t i = 0; i < count; ++i) {
-            size_t idx = ((tcur + i) & _mask) * 2;
-            out.emplace_back(_buf[idx + 0], _buf[idx + 1]);
+// Host time in seconds on the steady clock shared by every native stream
+inline double now_seconds() {
+    return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+// Per-sample flags stored in the ShimmerRing flags column
+enum ShimmerSampleFlags : uint32_t {
+    SAMPLE_HAS_GSR = 1u << 0,
+    SAMPLE_HAS_PPG = 1u << 1,
+    SAMPLE_SIMULATED = 1u << 2,
+    SAMPLE_AFTER_GAP = 1u << 3,  // first sample after a reconnect; samples before it were lost
+    SAMPLE_REPLAYED = 1u << 4,   // read back from a recording by a replay
+};
+
+// Columns: device timestamp (s), host receive timestamp (s), device timestamp
+// mapped onto the host clock by the ClockModel (s), GSR (uS), raw GSR ADC,
+// raw PPG ADC, flags
+using ShimmerRing = SoaRing<double, double, double, double, uint16_t, uint16_t, uint32_t>;
+using ShimmerRecorder = RingRecorder<double, double, double, double, uint16_t, uint16_t, uint32_t>;
+using ShimmerLslOutlet = RingLslOutlet<ShimmerRing>;
+using ShimmerShmWriter = ShmRingWriter<double, double, double, double, uint16_t, uint16_t, uint32_t>;
+using ShimmerFlightRecorder = FlightRowRecorder<double, double, double, double, uint16_t, uint16_t, uint32_t>;
+
+// ShimmerRing columns of one hardware read, published together
+struct ShimmerSampleBatch {
+    static constexpr size_t kMax = 256;
+    double device_ts[kMax];
+    double host_ts[kMax];
+    double aligned_ts[kMax];
+    double gsr_us[kMax];
+    uint16_t gsr_raw[kMax];
+    uint16_t ppg_raw[kMax];
+    uint32_t flags[kMax];
+    size_t size{0};
+};
+
+inline py::dict encoder_stats_dict(const EncoderStats& s) {
+    py::dict out;
+    out["frames"] = s.frames;
+    out["bytes"] = s.bytes;
+    out["dropped"] = s.dropped;
+    out["errors"] = s.errors;
+    out["encode_seconds"] = s.encode_seconds;
+    return out;
+}
+
+inline py::dict recorder_stats_dict(const RecorderStats& s) {
+    py::dict out;
+    out["rows"] = s.rows;
+    out["chunks"] = s.chunks;
+    out["bytes"] = s.bytes;
+    out["dropped"] = s.dropped;
+    return out;
+}
+
+inline py::dict clock_model_dict(const ClockModelState& s) {
+    py::dict out;
+    out["offset"] = s.offset;
+    out["drift_ppm"] = s.drift_ppm;
+    out["jitter"] = s.jitter;
+    out["samples"] = s.samples;
+    out["resets"] = s.resets;
+    out["bins"] = s.bins;
+    return out;
+}
+
+inline py::dict thread_policy_dict(const ThreadPolicy& p) {
+    py::dict out;
+    out["priority"] = p.priority;
+    out["cpus"] = p.cpus;
+    return out;
+}
+
+inline py::dict thread_info_dict(const ThreadInfo& t) {
+    py::dict out;
+    out["name"] = t.name;
+    out["role"] = t.role;
+    out["tid"] = t.tid;
+    out["priority"] = t.priority;
+    out["cpus"] = t.cpus;
+    out["error"] = t.error;
+    return out;
+}
+
+inline py::dict histogram_dict(const HistogramSnapshot& h) {
+    py::dict out;
+    out["count"] = h.count;
+    out["min"] = h.min;
+    out["mean"] = h.mean;
+    out["p50"] = h.p50;
+    out["p90"] = h.p90;
+    out["p99"] = h.p99;
+    out["p999"] = h.p999;
+    out["max"] = h.max;
+    return out;
+}
+
+// Instrumentation of one Shimmer stream; see stream_stats.h
+struct ShimmerStreamStats {
+    StatCounter packets;             // samples published to the ring
+    StatCounter timeouts;            // reads that timed out (simulated: injected link stalls)
+    StatCounter errors;              // device read errors
+    StatCounter reconnects;          // link losses recovered by the reconnect state machine
+    IntervalHistogram interarrival;  // between deliveries from the device; a batch read counts once
+    LatencyHistogram drain_latency;  // host receive -> taken by a consumer, per sample
+
+    void reset() {
+        packets.reset();
+        timeouts.reset();
+        errors.reset();
+        reconnects.reset();
+        interarrival.reset();
+        drain_latency.reset();
+    }
+};
+
+struct ShimmerStatsSnapshot {
+    uint64_t packets{0};
+    uint64_t timeouts{0};
+    uint64_t errors{0};
+    uint64_t reconnects{0};
+    uint64_t ring_dropped{0};
+    HistogramSnapshot interarrival;
+    HistogramSnapshot drain_latency;
+};
+
+inline py::dict shimmer_stats_dict(const ShimmerStatsSnapshot& s) {
+    py::dict out;
+    out["packets"] = s.packets;
+    out["timeouts"] = s.timeouts;
+    out["errors"] = s.errors;
+    out["reconnects"] = s.reconnects;
+    out["ring_dropped"] = s.ring_dropped;
+    out["interarrival"] = histogram_dict(s.interarrival);
+    out["drain_latency"] = histogram_dict(s.drain_latency);
+    return out;
+}
+
+// Instrumentation of one webcam stream
+struct WebcamStreamStats {
+    StatCounter timeouts;               // reads that returned no frame in time
+    StatCounter errors;                 // capture errors
+    IntervalHistogram interarrival;     // between published frames
+    LatencyHistogram delivery_latency;  // capture timestamp -> handed to Python
+
+    void reset() {
+        timeouts.reset();
+        errors.reset();
+        interarrival.reset();
+        delivery_latency.reset();
+    }
+};
+
+struct WebcamStatsSnapshot {
+    uint64_t frames_captured{0};
+    uint64_t frames_delivered{0};
+    uint64_t frames_dropped{0};
+    uint64_t timeouts{0};
+    uint64_t errors{0};
+    HistogramSnapshot interarrival;
+    HistogramSnapshot delivery_latency;
+};
+
+inline py::dict webcam_stats_dict(const WebcamStatsSnapshot& s) {
+    py::dict out;
+    out["frames_captured"] = s.frames_captured;
+    out["frames_delivered"] = s.frames_delivered;
+    out["frames_dropped"] = s.frames_dropped;
+    out["timeouts"] = s.timeouts;
+    out["errors"] = s.errors;
+    out["interarrival"] = histogram_dict(s.interarrival);
+    out["delivery_latency"] = histogram_dict(s.delivery_latency);
+    return out;
+}
+
+inline py::dict lsl_outlet_stats_dict(const LslOutletStats& s) {
+    py::dict out;
+    out["samples"] = s.samples;
+    out["chunks"] = s.chunks;
+    out["dropped"] = s.dropped;
+    out["has_consumers"] = s.has_consumers;
+    out["latency"] = histogram_dict(s.latency);
+    return out;
+}
+
+struct FlightRecorderStats {
+    std::string path;
+    size_t file_bytes{0};
+    uint64_t capacity{0};  // rows (Shimmer) or frames (webcam) kept
+    uint64_t written{0};
+    uint64_t oversized{0};
+};
+
+template <typename Journal>
+inline FlightRecorderStats flight_stats(const Journal& j) {
+    return {j.path(), j.file_bytes(), j.capacity(), j.written(), 0};
+}
+
+inline FlightRecorderStats flight_stats(const FlightFrameRecorder& j) {
+    return {j.path(), j.file_bytes(), j.capacity(), j.written(), j.oversized()};
+}
+
+inline py::dict flight_stats_dict(const FlightRecorderStats& s) {
+    py::dict out;
+    out["path"] = s.path;
+    out["file_bytes"] = s.file_bytes;
+    out["capacity"] = s.capacity;
+    out["written"] = s.written;
+    out["oversized"] = s.oversized;
+    return out;
+}
+
+struct ShmWriterStats {
+    std::string name;
+    size_t capacity{0};
+    size_t segment_bytes{0};
+    uint64_t published{0};
+    uint64_t oversized{0};
+    std::vector<ShmReaderInfo> readers;
+};
+
+inline ShmWriterStats shm_writer_stats(const ShmWriterBase& w, uint64_t oversized = 0) {
+    return {w.name(), w.capacity(), w.segment_bytes(), w.published(), oversized, w.readers()};
+}
+
+inline py::dict shm_stats_dict(const ShmWriterStats& s) {
+    py::dict out;
+    out["name"] = s.name;
+    out["capacity"] = s.capacity;
+    out["segment_bytes"] = s.segment_bytes;
+    out["published"] = s.published;
+    out["oversized"] = s.oversized;
+    py::list readers;
+    for (const ShmReaderInfo& r : s.readers) {
+        py::dict d;
+        d["pid"] = r.pid;
+        d["cursor"] = r.cursor;
+        d["lag"] = r.lag;
+        readers.append(d);
+    }
+    out["readers"] = readers;
+    return out;
+}
+
+inline py::dict link_event_dict(const LinkEvent& e) {
+    py::dict out;
+    out["seq"] = e.seq;
+    out["state"] = link_state_name(e.state);
+    out["timestamp"] = e.timestamp;
+    out["attempt"] = e.attempt;
+    out["message"] = e.message;
+    return out;
+}
+
+inline py::dict reconnect_policy_dict(const ReconnectPolicy& p) {
+    py::dict out;
+    out["enabled"] = p.enabled;
+    out["initial_backoff_ms"] = p.initial_backoff_ms;
+    out["max_backoff_ms"] = p.max_backoff_ms;
+    out["max_attempts"] = p.max_attempts;
+    return out;
+}
+
+inline SimulatorConfig make_simulator_config(double rate_hz, uint64_t seed, double dropout_rate,
+                                             double timeout_rate, double timeout_ms, double drift_ppm,
+                                             bool unpaced, double disconnect_rate, double disconnect_ms) {
+    SimulatorConfig cfg{rate_hz,   seed,    dropout_rate,    timeout_rate, timeout_ms,
+                        drift_ppm, unpaced, disconnect_rate, disconnect_ms};
+    validate_simulator_config(cfg);
+    return cfg;
+}
+
+// Build a calibration from Python arguments; empty rf_kohm keeps the Shimmer3 defaults
+inline GsrCalibration make_gsr_calibration(const std::vector<double>& rf_kohm, double vref, double v_bias) {
+    GsrCalibration cal;
+    if (!rf_kohm.empty()) {
+        if (rf_kohm.size() != 4) {
+            throw std::invalid_argument("rf_kohm must list the feedback resistor of all 4 GSR ranges");
         }
-        _tail.store(h, std::memory_order_release);
+        std::copy(rf_kohm.begin(), rf_kohm.end(), cal.rf_kohm);
+    }
+    if (vref <= 0.0 || v_bias <= 0.0 || !std::all_of(cal.rf_kohm, cal.rf_kohm + 4, [](double r) { return r > 0.0; })) {
+        throw std::invalid_argument("GSR calibration values must be positive");
+    }
+    cal.vref = vref;
+    cal.v_bias = v_bias;
+    return cal;
+}
+
+// Growable host-side copy of the ShimmerRing columns
+struct ShimmerColumns {
+    std::vector<double> device_ts, host_ts, aligned_ts, gsr_us;
+    std::vector<uint16_t> gsr_raw, ppg_raw;
+    std::vector<uint32_t> flags;
+
+    size_t size() const { return device_ts.size(); }
+
+    void resize(size_t n) {
+        device_ts.resize(n); host_ts.resize(n); aligned_ts.resize(n); gsr_us.resize(n);
+        gsr_raw.resize(n); ppg_raw.resize(n); flags.resize(n);
+    }
+
+    // Append every row available to `reader`; returns rows appended
+    size_t read_from(ShimmerRing& ring, ShimmerRing::Reader& reader) {
+        size_t old = size();
+        resize(old + ring.available(reader));
+        size_t got = ring.read(reader, size() - old, device_ts.data() + old, host_ts.data() + old,
+                               aligned_ts.data() + old, gsr_us.data() + old, gsr_raw.data() + old,
+                               ppg_raw.data() + old, flags.data() + old);
+        resize(old + got);
+        return got;
+    }
+
+    void push_row(const ShimmerColumns& src, size_t i) {
+        device_ts.push_back(src.device_ts[i]); host_ts.push_back(src.host_ts[i]);
+        aligned_ts.push_back(src.aligned_ts[i]); gsr_us.push_back(src.gsr_us[i]); gsr_raw.push_back(src.gsr_raw[i]);
+        ppg_raw.push_back(src.ppg_raw[i]); flags.push_back(src.flags[i]);
+    }
+
+    void erase_front(size_t n) {
+        auto drop = [n](auto& v) { v.erase(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(n)); };
+        drop(device_ts); drop(host_ts); drop(aligned_ts); drop(gsr_us); drop(gsr_raw); drop(ppg_raw); drop(flags);
+    }
+
+    template <typename T>
+    static py::array_t<T> to_numpy(const std::vector<T>& v, size_t rows = std::numeric_limits<size_t>::max()) {
+        return py::array_t<T>(static_cast<py::ssize_t>(std::min(rows, v.size())), v.data());
+    }
+
+    // Same keys as NativeShimmer.get_latest_channels(), for the first `rows` rows
+    py::dict to_dict(size_t rows = std::numeric_limits<size_t>::max()) const {
+        py::dict out;
+        out["device_ts"] = to_numpy(device_ts, rows);
+        out["host_ts"] = to_numpy(host_ts, rows);
+        out["aligned_ts"] = to_numpy(aligned_ts, rows);
+        out["gsr_us"] = to_numpy(gsr_us, rows);
+        out["gsr_raw"] = to_numpy(gsr_raw, rows);
+        out["ppg_raw"] = to_numpy(ppg_raw, rows);
+        out["flags"] = to_numpy(flags, rows);
         return out;
     }
+};
 
-private:
-    static size_t next_pow2(size_t v) {
-        size_t p = 1;
-        while (p < v) p <<= 1;
-        return p;
-    }
-    const size_t _cap;
-    const size_t _mask;
-    std::vector<double> _buf; // interleaved t,v
-    std::atomic<size_t> _head;
-    std::atomic<size_t> _tail;
+// Columns: aligned_ts (s), cleaned GSR, tonic and phasic level (uS)
+using EdaFeatureRing = SoaRing<double, double, double, double>;
+// Columns: onset_ts, peak_ts (aligned, s), amplitude (uS), rise time (s), tonic level at the peak (uS)
+using ScrEventRing = SoaRing<double, double, double, double, double>;
+
+// Online EDA stage of one NativeShimmer, fed by publish_sample on the
+// acquisition thread. Its outputs are drained like the sample ring.
+struct EdaStage {
+    static constexpr size_t kEventCapacity = 1024;
+
+    EdaStage(const EdaConfig& cfg, size_t feature_capacity)
+        : processor(cfg), features(feature_capacity), events(kEventCapacity) {}
+
+    EdaProcessor processor;
+    EdaFeatureRing features;
+    ScrEventRing events;
+    EdaSample last{0.0, 0.0, 0.0};
+};
+
+struct EdaState {
+    bool enabled{false};
+    EdaConfig config;
+    uint64_t samples{0};
+    uint64_t responses{0};
+    uint64_t features_dropped{0};  // feature rows overwritten before they were drained
+    uint64_t events_dropped{0};
+    EdaSample last{0.0, 0.0, 0.0};
+};
+
+inline py::dict eda_state_dict(const EdaState& s) {
+    py::dict out;
+    out["enabled"] = s.enabled;
+    out["sample_rate"] = s.config.sample_rate;
+    out["lowpass_hz"] = s.config.lowpass_hz;
+    out["tonic_hz"] = s.config.tonic_hz;
+    out["onset_threshold_us"] = s.config.onset_threshold_us;
+    out["min_amplitude_us"] = s.config.min_amplitude_us;
+    out["max_rise_s"] = s.config.max_rise_s;
+    out["samples"] = s.samples;
+    out["responses"] = s.responses;
+    out["features_dropped"] = s.features_dropped;
+    out["events_dropped"] = s.events_dropped;
+    out["tonic"] = s.last.tonic;
+    out["phasic"] = s.last.phasic;
+    return out;
+}
+
+inline EdaConfig make_eda_config(double sample_rate, double lowpass_hz, double tonic_hz, double onset_threshold_us,
+                                 double min_amplitude_us, double max_rise_s) {
+    EdaConfig cfg{sample_rate, lowpass_hz, tonic_hz, onset_threshold_us, min_amplitude_us, max_rise_s};
+    validate_eda_config(cfg);
+    return cfg;
+}
+
+struct EdaFeatureColumns {
+    std::vector<double> aligned_ts, cleaned, tonic, phasic;
+
+    void resize(size_t n) {
+        aligned_ts.resize(n); cleaned.resize(n); tonic.resize(n); phasic.resize(n);
+    }
+
+    void push_row(double ts, const EdaSample& s) {
+        aligned_ts.push_back(ts); cleaned.push_back(s.cleaned); tonic.push_back(s.tonic); phasic.push_back(s.phasic);
+    }
+
+    py::dict to_dict() const {
+        py::dict out;
+        out["aligned_ts"] = ShimmerColumns::to_numpy(aligned_ts);
+        out["cleaned"] = ShimmerColumns::to_numpy(cleaned);
+        out["tonic"] = ShimmerColumns::to_numpy(tonic);
+        out["phasic"] = ShimmerColumns::to_numpy(phasic);
+        return out;
+    }
+};
+
+struct ScrEventColumns {
+    std::vector<double> onset_ts, peak_ts, amplitude, rise_time, tonic;
+
+    void resize(size_t n) {
+        onset_ts.resize(n); peak_ts.resize(n); amplitude.resize(n); rise_time.resize(n); tonic.resize(n);
+    }
+
+    void push_row(const ScrEvent& e) {
+        onset_ts.push_back(e.onset_ts); peak_ts.push_back(e.peak_ts); amplitude.push_back(e.amplitude);
+        rise_time.push_back(e.rise_time); tonic.push_back(e.tonic);
+    }
+
+    py::dict to_dict() const {
+        py::dict out;
+        out["onset_ts"] = ShimmerColumns::to_numpy(onset_ts);
+        out["peak_ts"] = ShimmerColumns::to_numpy(peak_ts);
+        out["amplitude"] = ShimmerColumns::to_numpy(amplitude);
+        out["rise_time"] = ShimmerColumns::to_numpy(rise_time);
+        out["tonic"] = ShimmerColumns::to_numpy(tonic);
+        return out;
+    }
+};
+
+struct PlotCacheState {
+    bool enabled{false};
+    size_t fanout{0};
+    size_t samples{0};
+    size_t levels{0};
+    uint64_t skipped{0};
+    size_t memory_bytes{0};
+    double first_ts{0.0};
+    double last_ts{0.0};
+};
+
+inline py::dict plot_cache_state_dict(const PlotCacheState& s) {
+    py::dict out;
+    out["enabled"] = s.enabled;
+    out["fanout"] = s.fanout;
+    out["samples"] = s.samples;
+    out["levels"] = s.levels;
+    out["skipped"] = s.skipped;
+    out["memory_bytes"] = s.memory_bytes;
+    out["first_ts"] = s.first_ts;
+    out["last_ts"] = s.last_ts;
+    return out;
+}
+
+inline PlotCacheState pyramid_state(const DecimationPyramid& p) {
+    return {true, p.fanout(), p.size(), p.levels(), p.skipped(), p.memory_bytes(), p.first_ts(), p.last_ts()};
+}
+
+// (ts, values) float64 arrays of a pyramid query
+inline py::tuple decimated_tuple(const std::vector<double>& ts, const std::vector<double>& vals) {
+    return py::make_tuple(ShimmerColumns::to_numpy(ts), ShimmerColumns::to_numpy(vals));
+}
+
+// One subscribe() consumer of a NativeShimmer. It follows the ring with its
+// own reader, so subscribers never take samples from each other or from the
+// drain calls. Only the dispatcher thread touches reader and pending.
+struct ShimmerSubscription {
+    ShimmerSubscription(py::function cb, size_t batch, double max_latency_ms)
+        : callback(std::move(cb)), batch_size(batch), max_latency_s(max_latency_ms / 1000.0) {}
+
+    // The last reference may be dropped on a thread without the GIL
+    ~ShimmerSubscription() {
+        py::gil_scoped_acquire gil;
+        callback = py::function();
+    }
+
+    // Oldest undelivered sample has waited max_latency, or a batch is full
+    bool due(double now) const {
+        return pending.size() >= batch_size || (pending.size() > 0 && now >= deadline());
+    }
+    double deadline() const { return pending.host_ts.front() + max_latency_s; }
+
+    uint64_t id{0};
+    py::function callback;
+    const size_t batch_size;
+    const double max_latency_s;
+    std::unique_ptr<ShimmerRing::Reader> reader;
+    ShimmerColumns pending;
+    std::atomic<bool> active{true};
+    StatCounter batches;
+    StatCounter samples;
+    StatCounter errors;           // callbacks that raised
+    LatencyHistogram latency;     // host receive to callback, per sample
+};
+
+struct SubscriptionSnapshot {
+    uint64_t id{0};
+    size_t batch_size{0};
+    double max_latency_ms{0.0};
+    uint64_t batches{0};
+    uint64_t samples{0};
+    uint64_t dropped{0};
+    uint64_t errors{0};
+    HistogramSnapshot latency;
 };
 
+// Validated subscription for subscribe(); batches are capped at the ring capacity
+inline std::shared_ptr<ShimmerSubscription> make_subscription(py::function callback, size_t batch_size,
+                                                              double max_latency_ms, size_t ring_capacity) {
+    if (batch_size == 0) {
+        throw std::invalid_argument("batch_size must be at least 1");
+    }
+    if (!(max_latency_ms >= 0.0)) {
+        throw std::invalid_argument("max_latency_ms must not be negative");
+    }
+    return std::make_shared<ShimmerSubscription>(std::move(callback), std::min(batch_size, ring_capacity),
+                                                 max_latency_ms);
+}
+
+inline py::dict subscription_dict(const SubscriptionSnapshot& s) {
+    py::dict out;
+    out["id"] = s.id;
+    out["batch_size"] = s.batch_size;
+    out["max_latency_ms"] = s.max_latency_ms;
+    out["batches"] = s.batches;
+    out["samples"] = s.samples;
+    out["dropped"] = s.dropped;
+    out["errors"] = s.errors;
+    out["latency"] = histogram_dict(s.latency);
+    return out;
+}
+
 class NativeShimmer {
 public:
-    NativeShimmer() : _running(false), _queue(4096), _connected(false) {
+    explicit NativeShimmer(size_t ring_capacity = 4096)
+        : _running(false), _connected(false), _ring(ring_capacity) {
 #ifdef USE_SHIMMER_CAPI
         _shimmer_handle = nullptr;
         _use_real_hardware = true;
@@ -83,49 +613,28 @@ public:
 #endif
     }
 
+    // Ports starting with "SIM" always use the native simulator, even in C-API
+    // builds; "REPLAY" ports open no device either and stream a configured replay
+    static bool is_simulated_port(const std::string& port) {
+        return port.compare(0, 3, "SIM") == 0 || port.compare(0, 6, "REPLAY") == 0;
+    }
+
     void connect(const std::string& port) {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
         _port = port;
         
 #ifdef USE_SHIMMER_CAPI
+        _use_real_hardware = !is_simulated_port(port);
+        if (!_use_real_hardware) {
+            _connected = true;
+            std::cout << "Shimmer connected to " << port << " (Simulated)" << std::endl;
+            return;
+        }
         // Real Shimmer C-API integration
         try {
-            // Initialize Shimmer connection
-            // Check if it's a serial port or Bluetooth
-            if (port.find("COM") != std::string::npos || port.find("/dev/tty") != std::string::npos) {
-                // Serial connection
-                _shimmer_handle = ShimmerSerial_connect(port.c_str());
-            } else {
-                // Bluetooth connection (assumes port is MAC address)
-                _shimmer_handle = ShimmerBluetooth_connect(port.c_str());
-            }
-            
-            if (_shimmer_handle == nullptr) {
-                throw std::runtime_error("Failed to connect to Shimmer device at port: " + port);
-            }
-            
-            // Configure sensors - Enable GSR and PPG
-            int result = Shimmer_enableSensor(_shimmer_handle, SHIMMER_SENSOR_GSR);
-            if (result != SHIMMER_OK) {
-                throw std::runtime_error("Failed to enable GSR sensor");
-            }
-            
-            result = Shimmer_enableSensor(_shimmer_handle, SHIMMER_SENSOR_PPG);
-            if (result != SHIMMER_OK) {
-                throw std::runtime_error("Failed to enable PPG sensor");
-            }
-            
-            // Set sampling rate to 128 Hz as per requirements
-            result = Shimmer_setSamplingRate(_shimmer_handle, 128.0);
-            if (result != SHIMMER_OK) {
-                throw std::runtime_error("Failed to set sampling rate to 128 Hz");
-            }
-            
-            // Configure GSR range and gain
-            result = Shimmer_setGSRRange(_shimmer_handle, SHIMMER_GSR_RANGE_AUTO);
-            if (result != SHIMMER_OK) {
-                throw std::runtime_error("Failed to set GSR range");
-            }
-            
+            void* handle = open_hardware(port);
+            std::lock_guard<std::mutex> g(_handle_mtx);
+            _shimmer_handle = handle;
             _connected = true;
             std::cout << "Shimmer connected to " << port << " (Hardware C-API)" << std::endl;
             
@@ -145,308 +654,4165 @@ public:
     }
 
     void start_streaming() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
         if (!_connected) {
             throw std::runtime_error("Shimmer not connected. Call connect() first.");
         }
         
         if (_running.load()) return;
-        
-#ifdef USE_SHIMMER_CAPI
-        if (_shimmer_handle) {
-            // Start data streaming using real hardware
-            int result = Shimmer_startStreaming(_shimmer_handle);
-            if (result != SHIMMER_OK) {
-                throw std::runtime_error("Failed to start Shimmer streaming");
-            }
+        if (_external_streaming) {
+            throw std::runtime_error("Shimmer is driven by a NativeShimmerHub");
+        }
+        if (_thread.joinable()) {
+            _thread.join();  // ended by a failed link
         }
-#endif
         
+        start_device();
         _running.store(true);
-        _thread = std::thread([this]() { this->run_loop(); });
+        _thread = spawn_thread("shimmer", "shimmer:" + _port, [this]() { this->run_loop(); });
         
         std::cout << "Shimmer streaming started" << std::endl;
     }
 
-    void stop_streaming() {
+    // Start device-side streaming without an acquisition thread; the caller
+    // (NativeShimmerHub) then drives poll() from its own worker threads.
+    void begin_external_streaming() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (!_connected) {
+            throw std::runtime_error("Shimmer not connected. Call connect() first.");
+        }
+        if (_running.load() || _external_streaming) return;
+        start_device();
+        _external_streaming = true;
+    }
+
+    // One acquisition step: publish whatever the device has ready, waiting at
+    // most timeout_ms for hardware data. Returns the number of samples
+    // published, or -1 once the link has failed for good. A lost link is
+    // re-opened with backoff (link_state() is then "reconnecting"); hardware
+    // is re-opened on a separate thread that poll() only checks on.
+    int poll(int timeout_ms) {
+        switch (_link.load()) {
+            case LinkState::Failed: return -1;
+            case LinkState::Reconnecting: return try_reconnect(Clock::now());
+            default: break;
+        }
+        if (_replay) return emit_replay(Clock::now());
 #ifdef USE_SHIMMER_CAPI
-        if (_shimmer_handle && _running.load()) {
-            // Stop streaming on real hardware
-            Shimmer_stopStreaming(_shimmer_handle);
+        if (_use_real_hardware) {
+            int r = _shimmer_handle ? poll_hardware(timeout_ms) : -1;
+            return r < 0 ? link_lost("device read error") : r;
         }
 #endif
-        
+        (void)timeout_ms;
+        return emit_due_samples(Clock::now());
+    }
+
+    // When poll() next has data: the next simulated or replayed sample's
+    // deadline, one hardware polling interval from now, or the next reconnect
+    // attempt.
+    // Call from the polling thread.
+    Clock::time_point next_sample_due() const {
+        switch (_link.load()) {
+            case LinkState::Reconnecting:
+#ifdef USE_SHIMMER_CAPI
+                // Check on a reopen in progress every 10 ms
+                if (_reopen) return Clock::now() + std::chrono::milliseconds(10);
+#endif
+                return _backoff.next_attempt();
+            case LinkState::Failed: return Clock::now() + std::chrono::milliseconds(100);
+            default: break;
+        }
+        if (_replay) {
+            // Held back while the recorder catches up, or idle at the end
+            if (_replay_held) return Clock::now() + std::chrono::milliseconds(1);
+            if (_replay->finished()) return Clock::now() + std::chrono::milliseconds(100);
+            return _replay->next_due();
+        }
+#ifdef USE_SHIMMER_CAPI
+        if (_use_real_hardware) {
+            return Clock::now() + std::chrono::milliseconds(1);
+        }
+#endif
+        if (_sim.config().unpaced) return Clock::now();
+        return std::max(_sim_next, _sim_stall_end);
+    }
+
+    ShimmerRing& ring() { return _ring; }
+
+    void stop_streaming() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+#ifdef USE_SHIMMER_CAPI
+        const bool was_streaming = _running.load() || _external_streaming;
+#endif
+        _external_streaming = false;
         _running.store(false);
+        _poll_timer.cancel();
         if (_thread.joinable()) {
             _thread.join();
         }
+#ifdef USE_SHIMMER_CAPI
+        // After the join: the polling thread may have replaced the handle, and
+        // a reopen still pairing is waited for so its handle is stopped too
+        if (_reopen) {
+            std::string error;
+            finish_reopen(error);
+        }
+        if (_shimmer_handle && was_streaming && !_replay) {
+            // Stop streaming on real hardware
+            Shimmer_stopStreaming(_shimmer_handle);
+        }
+#endif
+        // A failed link stays "failed" until the next start
+        const LinkState link = _link.load();
+        if (link != LinkState::Idle && link != LinkState::Failed) {
+            set_link(LinkState::Idle, 0, "stopped");
+        }
+        _signal.wake_all();
         std::cout << "Shimmer streaming stopped" << std::endl;
     }
 
     std::vector<std::pair<double,double>> get_latest_samples() {
-        return _queue.pop_all();
+        const size_t n = _ring.size();
+        std::vector<double> ts(n), vals(n);
+        size_t count = pop_gsr(ts.data(), vals.data(), ts.size());
+        std::vector<std::pair<double,double>> out;
+        out.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            out.emplace_back(ts[i], vals[i]);
+        }
+        return out;
+    }
+
+    // Pop latest samples into two freshly allocated contiguous float64 arrays
+    py::tuple get_latest_samples_array() {
+        auto n = static_cast<py::ssize_t>(_ring.size());
+        py::array_t<double> ts(n);
+        py::array_t<double> vals(n);
+        auto got = static_cast<py::ssize_t>(
+            pop_gsr(ts.mutable_data(), vals.mutable_data(), static_cast<size_t>(n)));
+        if (got < n) {
+            // Producer dropped oldest samples between size() and pop
+            ts.resize({got});
+            vals.resize({got});
+        }
+        return py::make_tuple(ts, vals);
+    }
+
+    // Pop latest samples into caller-preallocated float64 arrays; returns count written
+    size_t drain_into(py::array ts_out, py::array vals_out) {
+        auto ts = writable_f64_column(ts_out, "ts_out");
+        auto vals = writable_f64_column(vals_out, "vals_out");
+        return pop_gsr(ts.first, vals.first, std::min(ts.second, vals.second));
+    }
+
+    // Pop latest samples with every channel as a dict of NumPy column arrays
+    py::dict get_latest_channels() {
+        auto n = static_cast<py::ssize_t>(_ring.size());
+        py::array_t<double> device_ts(n), host_ts(n), aligned_ts(n), gsr_us(n);
+        py::array_t<uint16_t> gsr_raw(n), ppg_raw(n);
+        py::array_t<uint32_t> flags(n);
+        std::unique_lock<std::mutex> drain(_drain_mtx);
+        auto got = static_cast<py::ssize_t>(_ring.pop_into(
+            static_cast<size_t>(n), device_ts.mutable_data(), host_ts.mutable_data(), aligned_ts.mutable_data(),
+            gsr_us.mutable_data(), gsr_raw.mutable_data(), ppg_raw.mutable_data(), flags.mutable_data()));
+        drain.unlock();
+        record_drained(host_ts.data(), static_cast<size_t>(got));
+        if (got < n) {
+            // Producer dropped oldest samples between size() and pop
+            for (py::array* col : {static_cast<py::array*>(&device_ts), static_cast<py::array*>(&host_ts),
+                                   static_cast<py::array*>(&aligned_ts), static_cast<py::array*>(&gsr_us), static_cast<py::array*>(&gsr_raw),
+                                   static_cast<py::array*>(&ppg_raw), static_cast<py::array*>(&flags)}) {
+                col->resize({got});
+            }
+        }
+        py::dict out;
+        out["device_ts"] = device_ts;
+        out["host_ts"] = host_ts;
+        out["aligned_ts"] = aligned_ts;
+        out["gsr_us"] = gsr_us;
+        out["gsr_raw"] = gsr_raw;
+        out["ppg_raw"] = ppg_raw;
+        out["flags"] = flags;
+        return out;
     }
     
     bool is_connected() const {
         return _connected;
     }
     
-    std::string get_device_info() const {
-        if (!_connected) {
-            return "Not connected";
-        }
-        
-#ifdef USE_SHIMMER_CAPI
-        if (_shimmer_handle) {
-            // Get actual device information from C-API
-            char device_name[256] = {0};
-            char firmware_version[64] = {0};
-            
-            // These function names are placeholders - actual API may differ
-            // Will need to check Shimmer C-API documentation for exact function names
-            Shimmer_getDeviceName(_shimmer_handle, device_name, sizeof(device_name));
-            Shimmer_getFirmwareVersion(_shimmer_handle, firmware_version, sizeof(firmware_version));
-            
-            return std::string("Shimmer3 GSR+ (Hardware) - Port: ") + _port + 
-                   " - Device: " + device_name + 
-                   " - FW: " + firmware_version + 
-                   " - Sample Rate: 128 Hz";
+    // Block until at least min_count samples are buffered or timeout_ms expires.
+    // Returns the number of samples available (may be fewer on timeout/stop).
+    size_t wait_for_samples(size_t min_count, int timeout_ms) {
+        min_count = std::max<size_t>(1, std::min(min_count, _ring.capacity()));
+        uint64_t target = _ring.default_reader().cursor() + min_count;
+        _signal.wait(target, [this] { return _ring.total_pushed(); },
+                     std::chrono::milliseconds(std::max(0, timeout_ms)));
+        return _ring.size();
+    }
+    // Deliver every new sample to callback(dict of column arrays) from a native
+    // dispatcher thread, in batches of batch_size or after max_latency_ms,
+    // whichever comes first. Returns an id for unsubscribe().
+    uint64_t subscribe(std::shared_ptr<ShimmerSubscription> sub) {
+        {
+            std::lock_guard<std::mutex> g(_sub_mtx);
+            sub->id = ++_last_sub_id;
+            sub->reader = _ring.make_reader();
+            _subscriptions.push_back(sub);
+            if (!_dispatcher.joinable()) {
+                _dispatcher = spawn_thread("dispatch", "dispatch:" + _port, [this]() { this->dispatch_loop(); });
+            }
         }
-#endif
-        
-        // Fallback to simulation info
-        return "Shimmer3 GSR+ (Simulated) - Port: " + _port + " - Sample Rate: 128 Hz";
+        _sub_version.fetch_add(1);
+        _signal.wake_all();
+        return sub->id;
     }
 
-    ~NativeShimmer() {
-        stop_streaming();
-#ifdef USE_SHIMMER_CAPI
-        if (_shimmer_handle) {
-            Shimmer_disconnect(_shimmer_handle);
-            _shimmer_handle = nullptr;
+    // Stop deliveries to a subscription; safe to call from its own callback
+    bool unsubscribe(uint64_t id) {
+        std::shared_ptr<ShimmerSubscription> removed;
+        {
+            std::lock_guard<std::mutex> g(_sub_mtx);
+            auto it = std::find_if(_subscriptions.begin(), _subscriptions.end(),
+                                   [id](const auto& sub) { return sub->id == id; });
+            if (it == _subscriptions.end()) return false;
+            removed = std::move(*it);
+            _subscriptions.erase(it);
         }
-#endif
+        removed->active.store(false);
+        _sub_version.fetch_add(1);
+        return true;
     }
 
-private:
-    void run_loop() {
-#ifdef USE_SHIMMER_CAPI
-        if (_shimmer_handle && _use_real_hardware) {
-            // Real hardware data acquisition loop
-            while (_running.load()) {
-                ShimmerDataPacket packet;
-                int result = Shimmer_getNextDataPacket(_shimmer_handle, &packet, 100); // 100ms timeout
-                
-                if (result == SHIMMER_OK) {
-                    // Extract timestamp (convert to seconds)
-                    double timestamp_sec = static_cast<double>(packet.timestamp_ms) / 1000.0;
-                    
-                    // Extract GSR value and convert using 12-bit ADC
-                    if (packet.has_gsr) {
-                        uint16_t raw_gsr = packet.gsr_raw;
-                        
-                        // Convert 12-bit ADC value (0-4095) to microsiemens
-                        // GSR conversion formula from Shimmer documentation
-                        double voltage = (static_cast<double>(raw_gsr) / 4095.0) * 3.0; // 3V reference
-                        double conductance = 1000.0 / (voltage * 10000.0); // Convert to microsiemens
-                        double gsr_microsiemens = std::max(0.1, conductance);
-                        
-                        _queue.push(timestamp_sec, gsr_microsiemens);
-                    }
-                } else if (result == SHIMMER_TIMEOUT) {
-                    // Normal timeout, continue loop
+    std::vector<SubscriptionSnapshot> subscriptions() const {
+        std::lock_guard<std::mutex> g(_sub_mtx);
+        std::vector<SubscriptionSnapshot> out;
+        for (const auto& sub : _subscriptions) {
+            SubscriptionSnapshot s;
+            s.id = sub->id;
+            s.batch_size = sub->batch_size;
+            s.max_latency_ms = sub->max_latency_s * 1000.0;
+            s.batches = sub->batches.value();
+            s.samples = sub->samples.value();
+            s.dropped = sub->reader->dropped();
+            s.errors = sub->errors.value();
+            s.latency = sub->latency.snapshot();
+            out.push_back(s);
+        }
+        return out;
+    }
+    
+    // Calibration used to convert raw GSR words to uS for new samples
+    void set_gsr_calibration(const GsrCalibration& cal) {
+        std::lock_guard<std::mutex> g(_cal_mtx);
+        _gsr_cal = cal;
+    }
+
+    py::dict get_gsr_calibration() const {
+        GsrCalibration cal = gsr_calibration();
+        py::dict out;
+        out["rf_kohm"] = std::vector<double>(std::begin(cal.rf_kohm), std::end(cal.rf_kohm));
+        out["vref"] = cal.vref;
+        out["v_bias"] = cal.v_bias;
+        return out;
+    }
+
+    // Write every sample from now on to `path` on a native I/O thread
+    void start_recording(const std::string& path, const std::string& sync) {
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        if (_recorder) {
+            throw std::runtime_error("Shimmer recording already in progress");
+        }
+        _recorder = std::make_unique<ShimmerRecorder>(
+            path, _ring, std::vector<std::string>{"device_ts", "host_ts", "aligned_ts", "gsr_us", "gsr_raw", "ppg_raw",
+                                            "flags"},
+            parse_recorder_sync(sync));
+    }
+
+    // Flush and close the recording; returns its final statistics
+    RecorderStats stop_recording() {
+        std::unique_ptr<ShimmerRecorder> rec;
+        {
+            std::lock_guard<std::mutex> g(_recorder_mtx);
+            rec = std::move(_recorder);
+        }
+        if (!rec) return {};
+        rec->stop();
+        return rec->stats();
+    }
+
+    // Publish every sample from now on as an LSL stream, pushed from a native thread
+    void enable_lsl(LslOutletOptions opts) {
+        {
+            std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+            opts.nominal_rate = stream_rate();
+        }
+        std::lock_guard<std::mutex> g(_lsl_mtx);
+        if (_lsl) {
+            throw std::runtime_error("LSL output already enabled");
+        }
+        _lsl = std::make_unique<ShimmerLslOutlet>(std::move(opts), _ring, _signal);
+    }
+
+    // Flush and close the LSL stream; returns its final statistics
+    LslOutletStats disable_lsl() {
+        std::unique_ptr<ShimmerLslOutlet> outlet;
+        {
+            std::lock_guard<std::mutex> g(_lsl_mtx);
+            outlet = std::move(_lsl);
+        }
+        if (!outlet) return {};
+        outlet->stop();
+        return outlet->stats();
+    }
+
+    std::optional<LslOutletStats> lsl_stats() const {
+        std::lock_guard<std::mutex> g(_lsl_mtx);
+        if (!_lsl) return std::nullopt;
+        return _lsl->stats();
+    }
+
+    // Run the online EDA stage on every sample from now on, at the stream's sample rate
+    void enable_eda(EdaConfig cfg) {
+        {
+            std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+            cfg.sample_rate = stream_rate();
+        }
+        auto stage = std::make_unique<EdaStage>(cfg, _ring.capacity());
+        std::lock_guard<std::mutex> g(_eda_mtx);
+        if (_eda) {
+            throw std::runtime_error("EDA features already enabled");
+        }
+        _eda = std::move(stage);
+        _eda_on.store(true);
+    }
+
+    // Stop the EDA stage and discard undrained output; returns its final state
+    EdaState disable_eda() {
+        std::lock_guard<std::mutex> g(_eda_mtx);
+        EdaState s = eda_state_locked();
+        _eda_on.store(false);
+        _eda.reset();
+        return s;
+    }
+
+    EdaState eda_state() const {
+        std::lock_guard<std::mutex> g(_eda_mtx);
+        return eda_state_locked();
+    }
+
+    // Pop every buffered feature row; empty while the stage is disabled
+    EdaFeatureColumns pop_eda_features() {
+        EdaFeatureColumns out;
+        std::lock_guard<std::mutex> g(_eda_mtx);
+        if (!_eda) return out;
+        out.resize(_eda->features.size());
+        out.resize(_eda->features.pop_into(out.aligned_ts.size(), out.aligned_ts.data(), out.cleaned.data(),
+                                           out.tonic.data(), out.phasic.data()));
+        return out;
+    }
+
+    // Pop every SCR detected since the last call
+    ScrEventColumns pop_scr_events() {
+        ScrEventColumns out;
+        std::lock_guard<std::mutex> g(_eda_mtx);
+        if (!_eda) return out;
+        out.resize(_eda->events.size());
+        out.resize(_eda->events.pop_into(out.onset_ts.size(), out.onset_ts.data(), out.peak_ts.data(),
+                                         out.amplitude.data(), out.rise_time.data(), out.tonic.data()));
+        return out;
+    }
+
+    // Publish every sample from now on into the named shared segment; capacity 0 = ring capacity
+    void enable_shm(const std::string& name, size_t capacity) {
+        std::lock_guard<std::mutex> g(_shm_mtx);
+        if (_shm) {
+            throw std::runtime_error("shared-memory output already enabled");
+        }
+        _shm = std::make_unique<ShimmerShmWriter>(
+            name, capacity ? capacity : _ring.capacity(),
+            std::vector<std::string>{"device_ts", "host_ts", "aligned_ts", "gsr_us", "gsr_raw", "ppg_raw", "flags"});
+        _shm_on.store(true);
+    }
+
+    // Mark the segment closed and remove its name; attached readers keep their mapping
+    ShmWriterStats disable_shm() {
+        std::lock_guard<std::mutex> g(_shm_mtx);
+        _shm_on.store(false);
+        if (!_shm) return {};
+        ShmWriterStats s = shm_writer_stats(*_shm);
+        _shm.reset();
+        return s;
+    }
+
+    std::optional<ShmWriterStats> shm_stats() const {
+        std::lock_guard<std::mutex> g(_shm_mtx);
+        if (!_shm) return std::nullopt;
+        return shm_writer_stats(*_shm);
+    }
+
+    // Journal the last `minutes` of samples into a memory-mapped file that survives a crash
+    void enable_flight_recorder(const std::string& path, double minutes) {
+        if (!(minutes > 0.0)) {
+            throw std::invalid_argument("flight recorder minutes must be positive");
+        }
+        const auto rows = static_cast<uint64_t>(std::ceil(minutes * 60.0 * stream_rate()));
+        std::lock_guard<std::mutex> g(_flight_mtx);
+        if (_flight) {
+            throw std::runtime_error("flight recorder already enabled");
+        }
+        _flight = std::make_unique<ShimmerFlightRecorder>(
+            path, rows,
+            std::vector<std::string>{"device_ts", "host_ts", "aligned_ts", "gsr_us", "gsr_raw", "ppg_raw", "flags"});
+        _flight_on.store(true);
+    }
+
+    // Flush and close the journal, marking it clean; returns its final statistics
+    FlightRecorderStats disable_flight_recorder() {
+        std::lock_guard<std::mutex> g(_flight_mtx);
+        _flight_on.store(false);
+        if (!_flight) return {};
+        FlightRecorderStats s = flight_stats(*_flight);
+        _flight.reset();
+        return s;
+    }
+
+    std::optional<FlightRecorderStats> flight_recorder_stats() const {
+        std::lock_guard<std::mutex> g(_flight_mtx);
+        if (!_flight) return std::nullopt;
+        return flight_stats(*_flight);
+    }
+
+    // Keep every sample from now on in a min/max pyramid for plotting (aligned_ts, gsr_us)
+    void enable_plot_cache(size_t fanout) {
+        auto cache = std::make_unique<DecimationPyramid>(fanout);
+        std::lock_guard<std::mutex> g(_plot_mtx);
+        if (_plot) {
+            throw std::runtime_error("plot cache already enabled");
+        }
+        _plot = std::move(cache);
+        _plot_on.store(true);
+    }
+
+    // Free the cache; returns its final state
+    PlotCacheState disable_plot_cache() {
+        std::unique_ptr<DecimationPyramid> cache;
+        {
+            std::lock_guard<std::mutex> g(_plot_mtx);
+            _plot_on.store(false);
+            cache = std::move(_plot);
+        }
+        return cache ? pyramid_state(*cache) : PlotCacheState{};
+    }
+
+    PlotCacheState plot_cache_state() const {
+        std::lock_guard<std::mutex> g(_plot_mtx);
+        return _plot ? pyramid_state(*_plot) : PlotCacheState{};
+    }
+
+    // At most max_points points of [t0, t1] for plotting; empty while the cache is disabled
+    void query_plot_cache(double t0, double t1, size_t max_points, DecimationMethod method,
+                          std::vector<double>& ts_out, std::vector<double>& vals_out) const {
+        std::lock_guard<std::mutex> g(_plot_mtx);
+        if (_plot) {
+            _plot->query(t0, t1, max_points, method, ts_out, vals_out);
+        } else {
+            ts_out.clear();
+            vals_out.clear();
+        }
+    }
+
+    bool is_recording() const {
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        return _recorder != nullptr;
+    }
+
+    RecorderStats recording_stats() const {
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        return _recorder ? _recorder->stats() : RecorderStats{};
+    }
+
+    // Rate, seed and injected faults of the simulated device; takes effect
+    // on the next start and only while streaming is stopped
+    void configure_simulation(const SimulatorConfig& cfg) {
+        validate_simulator_config(cfg);
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load() || _external_streaming) {
+            throw std::runtime_error("Stop streaming before reconfiguring the simulator");
+        }
+        _sim_config = cfg;
+    }
+
+    SimulatorConfig simulation_config() const {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        return _sim_config;
+    }
+
+    // Simulator config plus what it generated, dropped and stalled this session
+    py::dict get_simulation() const {
+        SimulatorConfig cfg = simulation_config();
+        py::dict out;
+        out["rate_hz"] = cfg.rate_hz;
+        out["seed"] = cfg.seed;
+        out["dropout_rate"] = cfg.dropout_rate;
+        out["timeout_rate"] = cfg.timeout_rate;
+        out["timeout_ms"] = cfg.timeout_ms;
+        out["drift_ppm"] = cfg.drift_ppm;
+        out["unpaced"] = cfg.unpaced;
+        out["disconnect_rate"] = cfg.disconnect_rate;
+        out["disconnect_ms"] = cfg.disconnect_ms;
+        out["samples"] = _sim_generated.load(std::memory_order_relaxed);
+        out["dropouts"] = _sim_dropouts.load(std::memory_order_relaxed);
+        out["timeouts"] = _sim_timeouts.load(std::memory_order_relaxed);
+        out["disconnects"] = _sim_disconnects.load(std::memory_order_relaxed);
+        out["lost"] = _sim_lost.load(std::memory_order_relaxed);
+        return out;
+    }
+
+    // Replay a recording made with start_recording() instead of reading the
+    // device or the simulator, from the next start on; only while stopped.
+    // The file is opened here, so a bad path fails now rather than at start.
+    void configure_replay(const ReplayConfig& cfg) {
+        validate_replay_config(cfg);
+        const double rate = ShimmerReplaySource(cfg).sample_rate();
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load() || _external_streaming) {
+            throw std::runtime_error("Stop streaming before configuring a replay");
+        }
+        _replay_config = cfg;
+        _replay_rate = rate > 0.0 ? rate : 128.0;
+    }
+
+    // Return to the device or simulator from the next start on
+    void clear_replay() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load() || _external_streaming) {
+            throw std::runtime_error("Stop streaming before clearing the replay");
+        }
+        _replay_config.reset();
+    }
+
+    // Config and progress of the configured replay; nullopt without one
+    std::optional<ReplayStats> replay_stats() const {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (!_replay_config) return std::nullopt;
+        return _replay_counters.snapshot(*_replay_config);
+    }
+
+    // "idle", "streaming", "reconnecting" or "failed"
+    std::string link_state() const { return link_state_name(_link.load()); }
+
+    // Link state transitions newer than last_seq, waiting up to timeout_ms
+    // for the first; empty on timeout
+    std::vector<LinkEvent> wait_for_link_events(uint64_t last_seq, int timeout_ms) {
+        return _link_events.wait_newer(last_seq, std::chrono::milliseconds(std::max(0, timeout_ms)));
+    }
+
+    void set_reconnect_policy(const ReconnectPolicy& policy) {
+        validate_reconnect_policy(policy);
+        std::lock_guard<std::mutex> g(_reconnect_mtx);
+        _reconnect_policy = policy;
+    }
+
+    ReconnectPolicy reconnect_policy() const {
+        std::lock_guard<std::mutex> g(_reconnect_mtx);
+        return _reconnect_policy;
+    }
+
+    // Current fit of the device clock against the host clock
+    ClockModelState clock_model() const {
+        std::lock_guard<std::mutex> g(_clock_mtx);
+        return _clock.state();
+    }
+
+    // Samples lost because the ring overflowed before they were drained
+    uint64_t dropped_samples() const {
+        return _ring.dropped();
+    }
+
+    // Counters and latency histograms of the current streaming session
+    ShimmerStatsSnapshot stats() const {
+        ShimmerStatsSnapshot s;
+        s.packets = _stats.packets.value();
+        s.timeouts = _stats.timeouts.value();
+        s.errors = _stats.errors.value();
+        s.reconnects = _stats.reconnects.value();
+        s.ring_dropped = _ring.dropped();
+        s.interarrival = _stats.interarrival.snapshot();
+        s.drain_latency = _stats.drain_latency.snapshot();
+        return s;
+    }
+
+    // Restart the counters and histograms (ring_dropped is the ring's own count)
+    void reset_stats() { _stats.reset(); }
+
+    // Record the receive-to-drain latency of n rows taken from the ring
+    void record_drained(const double* host_ts, size_t n) {
+        const double now = now_seconds();
+        for (size_t i = 0; i < n; ++i) _stats.drain_latency.record(now - host_ts[i]);
+    }
+    
+    size_t ring_capacity() const {
+        return _ring.capacity();
+    }
+    
+    std::string get_device_info() const {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (!_connected) {
+            return "Not connected";
+        }
+        
+#ifdef USE_SHIMMER_CAPI
+        std::lock_guard<std::mutex> handle(_handle_mtx);
+        if (_shimmer_handle) {
+            // Get actual device information from C-API
+            char device_name[256] = {0};
+            char firmware_version[64] = {0};
+            
+            // These function names are placeholders - actual API may differ
+            // Will need to check Shimmer C-API documentation for exact function names
+            Shimmer_getDeviceName(_shimmer_handle, device_name, sizeof(device_name));
+            Shimmer_getFirmwareVersion(_shimmer_handle, firmware_version, sizeof(firmware_version));
+            
+            return std::string("Shimmer3 GSR+ (Hardware) - Port: ") + _port + 
+                   " - Device: " + device_name + 
+                   " - FW: " + firmware_version + 
+                   " - Sample Rate: 128 Hz";
+        }
+#endif
+        
+        // Fallback to simulation info
+        char rate[32];
+        std::snprintf(rate, sizeof(rate), "%g", _sim_config.rate_hz);
+        return "Shimmer3 GSR+ (Simulated) - Port: " + _port + " - Sample Rate: " + rate + " Hz";
+    }
+
+    ~NativeShimmer() {
+        stop_dispatcher();
+        stop_streaming();
+        {
+            std::lock_guard<std::mutex> g(_recorder_mtx);
+            _recorder.reset();  // flushes; must go before _ring
+        }
+        {
+            std::lock_guard<std::mutex> g(_lsl_mtx);
+            _lsl.reset();  // follows _ring and _signal
+        }
+#ifdef USE_SHIMMER_CAPI
+        if (_shimmer_handle) {
+            Shimmer_disconnect(_shimmer_handle);
+            _shimmer_handle = nullptr;
+        }
+#endif
+    }
+
+private:
+#ifdef USE_SHIMMER_CAPI
+    // Open and configure a device; the connect() sequence, also used to reconnect
+    static void* open_hardware(const std::string& port) {
+        // Check if it's a serial port or Bluetooth
+        void* handle;
+        if (port.find("COM") != std::string::npos || port.find("/dev/tty") != std::string::npos) {
+            // Serial connection
+            handle = ShimmerSerial_connect(port.c_str());
+        } else {
+            // Bluetooth connection (assumes port is MAC address)
+            handle = ShimmerBluetooth_connect(port.c_str());
+        }
+        if (handle == nullptr) {
+            throw std::runtime_error("Failed to connect to Shimmer device at port: " + port);
+        }
+        try {
+            // Configure sensors - Enable GSR and PPG
+            if (Shimmer_enableSensor(handle, SHIMMER_SENSOR_GSR) != SHIMMER_OK) {
+                throw std::runtime_error("Failed to enable GSR sensor");
+            }
+            if (Shimmer_enableSensor(handle, SHIMMER_SENSOR_PPG) != SHIMMER_OK) {
+                throw std::runtime_error("Failed to enable PPG sensor");
+            }
+            // Set sampling rate to 128 Hz as per requirements
+            if (Shimmer_setSamplingRate(handle, 128.0) != SHIMMER_OK) {
+                throw std::runtime_error("Failed to set sampling rate to 128 Hz");
+            }
+            // Configure GSR range and gain
+            if (Shimmer_setGSRRange(handle, SHIMMER_GSR_RANGE_AUTO) != SHIMMER_OK) {
+                throw std::runtime_error("Failed to set GSR range");
+            }
+        } catch (...) {
+            Shimmer_disconnect(handle);
+            throw;
+        }
+        return handle;
+    }
+#endif
+
+    void set_link(LinkState state, uint32_t attempt, std::string message) {
+        _link.store(state);
+        _link_events.push(state, now_seconds(), attempt, std::move(message));
+    }
+
+    // Polling thread: the device stopped delivering. Returns 0 while
+    // reconnecting, -1 if the policy does not reconnect.
+    int link_lost(const std::string& reason) {
+        _gap_pending = true;
+        if (!reconnect_policy().enabled) return link_failed(reason);
+        std::cerr << "Shimmer link lost (" << reason << "), reconnecting" << std::endl;
+        _backoff.begin(Clock::now());
+        set_link(LinkState::Reconnecting, 0, reason);
+        return 0;
+    }
+
+    int link_failed(const std::string& reason) {
+        std::cerr << "Shimmer link failed: " << reason << std::endl;
+        _connected.store(false);
+        _running.store(false);
+        set_link(LinkState::Failed, _backoff.attempts(), reason);
+        return -1;
+    }
+
+    enum class Reopen { Pending, Opened, Failed };
+
+    // Polling thread: one reconnect attempt if it is due
+    int try_reconnect(Clock::time_point now) {
+        std::string error;
+        const Reopen result = reopen_link(now, error);
+        if (result == Reopen::Pending) return 0;
+        if (result == Reopen::Opened) {
+            _backoff.succeeded();
+            _stats.reconnects.add();
+            // The outage is not a packet interval
+            _stats.interarrival.restart();
+            std::cerr << "Shimmer link restored after " << _backoff.attempts() << " attempt(s)" << std::endl;
+            set_link(LinkState::Streaming, _backoff.attempts(), "reconnected");
+            return 0;
+        }
+        if (!_backoff.failed(reconnect_policy(), now)) return link_failed(error);
+        set_link(LinkState::Reconnecting, _backoff.attempts(), error);
+        return 0;
+    }
+
+    // Pending while no attempt is due or a hardware reopen is still running
+    Reopen reopen_link(Clock::time_point now, std::string& error) {
+#ifdef USE_SHIMMER_CAPI
+        if (_use_real_hardware) {
+            if (_reopen) {
+                if (!_reopen->done.load(std::memory_order_acquire)) return Reopen::Pending;
+                return finish_reopen(error) ? Reopen::Opened : Reopen::Failed;
+            }
+            if (_backoff.due(now)) start_reopen();
+            return Reopen::Pending;
+        }
+#endif
+        if (!_backoff.due(now)) return Reopen::Pending;
+        // The simulated device is reachable again once its outage is over
+        if (now < _sim_outage_end) {
+            error = "simulated device unreachable";
+            return Reopen::Failed;
+        }
+        // Samples due during the outage were never received
+        while (_sim_next <= now) {
+            _sim.next();
+            _sim_generated.fetch_add(1, std::memory_order_relaxed);
+            _sim_lost.fetch_add(1, std::memory_order_relaxed);
+            _sim_next = sim_deadline(_sim.index());
+        }
+        return Reopen::Opened;
+    }
+
+#ifdef USE_SHIMMER_CAPI
+    // Polling thread: disconnect the lost handle and open the device again on
+    // a separate thread, so a slow serial or Bluetooth pairing never holds up
+    // the other devices of a hub worker
+    void start_reopen() {
+        void* old;
+        {
+            std::lock_guard<std::mutex> g(_handle_mtx);
+            old = _shimmer_handle;
+            _shimmer_handle = nullptr;
+        }
+        auto job = std::make_unique<PendingReopen>();
+        PendingReopen* p = job.get();
+        const std::string port = _stream_port;
+        job->thread = spawn_thread("shimmer", "shimmer-reopen:" + port, [p, old, port]() {
+            if (old) Shimmer_disconnect(old);
+            try {
+                void* handle = open_hardware(port);
+                if (Shimmer_startStreaming(handle) != SHIMMER_OK) {
+                    Shimmer_disconnect(handle);
+                    throw std::runtime_error("Failed to start Shimmer streaming");
+                }
+                p->handle = handle;
+            } catch (const std::exception& e) {
+                p->error = e.what();
+            }
+            p->done.store(true, std::memory_order_release);
+        });
+        _reopen = std::move(job);
+    }
+
+    // Polling thread, or stop_streaming() once it has stopped: join the
+    // reopen and install its handle. False, with the error, if it failed.
+    bool finish_reopen(std::string& error) {
+        std::unique_ptr<PendingReopen> job = std::move(_reopen);
+        job->thread.join();
+        if (!job->handle) {
+            error = job->error;
+            return false;
+        }
+        std::lock_guard<std::mutex> g(_handle_mtx);
+        _shimmer_handle = job->handle;
+        return true;
+    }
+#endif
+
+    // Wall-clock deadline of simulated sample `index`; from the index, so the rate never drifts
+    Clock::time_point sim_deadline(uint64_t index) const {
+        return _sim_origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(
+                                 static_cast<double>(index) / _sim.config().rate_hz));
+    }
+
+    // Nominal sample rate of the next or current session; requires _lifecycle_mtx
+    double stream_rate() const {
+        if (_replay_config) return _replay_rate;
+        return _use_real_hardware ? 128.0 : _sim_config.rate_hz;
+    }
+
+    // Requires _lifecycle_mtx
+    void start_device() {
+        restart_eda();
+        // A replay stands in for the device; the file is mapped per session
+        _replay.reset();
+        _replay_counters.reset();
+        if (_replay_config) {
+            _replay = std::make_unique<ShimmerReplaySource>(*_replay_config);
+            _replay->start(Clock::now());
+            _replay_counters.update(*_replay);
+            _replay_held = false;
+        }
+#ifdef USE_SHIMMER_CAPI
+        if (_shimmer_handle && !_replay) {
+            // Start data streaming using real hardware
+            int result = Shimmer_startStreaming(_shimmer_handle);
+            if (result != SHIMMER_OK) {
+                throw std::runtime_error("Failed to start Shimmer streaming");
+            }
+        }
+#endif
+        // Every session replays the configured simulated stream from sample 0
+        _sim.reset(_sim_config);
+        _sim_origin = _sim_next = Clock::now();
+        _sim_stall_end = {};
+        _sim_outage_end = {};
+        _sim_generated.store(0);
+        _sim_dropouts.store(0);
+        _sim_timeouts.store(0);
+        _sim_disconnects.store(0);
+        _sim_lost.store(0);
+        _poll_timer.rearm();
+        _stream_port = _port;
+        _gap_pending = false;
+        set_link(LinkState::Streaming, 0, "started");
+        _stats.reset();
+        _stats.interarrival.restart();
+        // A new session may restart the device's timestamp counter
+        std::lock_guard<std::mutex> g(_clock_mtx);
+        _clock.reset();
+    }
+
+    // A session starts the EDA filters afresh, at the rate it will stream; requires _lifecycle_mtx
+    void restart_eda() {
+        std::lock_guard<std::mutex> g(_eda_mtx);
+        if (!_eda) return;
+        EdaConfig cfg = _eda->processor.config();
+        if (cfg.sample_rate != stream_rate()) {
+            cfg.sample_rate = stream_rate();
+            _eda->processor.configure(cfg);  // throws if the cut-offs no longer fit the rate
+        }
+        _eda->processor.restart();
+    }
+
+    // Requires _eda_mtx
+    EdaState eda_state_locked() const {
+        EdaState s;
+        if (!_eda) return s;
+        s.enabled = true;
+        s.config = _eda->processor.config();
+        s.samples = _eda->processor.samples();
+        s.responses = _eda->processor.responses();
+        s.features_dropped = _eda->features.dropped();
+        s.events_dropped = _eda->events.dropped();
+        s.last = _eda->last;
+        return s;
+    }
+
+    void process_eda(const double* aligned_ts, const double* gsr_us, const uint32_t* flags, size_t n) {
+        std::lock_guard<std::mutex> g(_eda_mtx);
+        if (!_eda) return;
+        for (size_t i = 0; i < n; ++i) {
+            if (!std::isfinite(gsr_us[i])) continue;
+            // Filter state from before a gap would ring through the first samples after it
+            if (flags[i] & SAMPLE_AFTER_GAP) _eda->processor.restart();
+            ScrEvent e;
+            if (_eda->processor.process(aligned_ts[i], gsr_us[i], _eda->last, e)) {
+                _eda->events.push(e.onset_ts, e.peak_ts, e.amplitude, e.rise_time, e.tonic);
+            }
+            _eda->features.push(aligned_ts[i], _eda->last.cleaned, _eda->last.tonic, _eda->last.phasic);
+        }
+    }
+
+    GsrCalibration gsr_calibration() const {
+        std::lock_guard<std::mutex> g(_cal_mtx);
+        return _gsr_cal;
+    }
+
+    // align=false stores host_ts as aligned_ts without feeding the clock model
+    void publish_sample(double device_ts, double host_ts, double gsr_us,
+                        uint16_t gsr_raw, uint16_t ppg_raw, uint32_t flags, bool align = true) {
+        double aligned_ts = host_ts;
+        if (align) {
+            std::lock_guard<std::mutex> g(_clock_mtx);
+            aligned_ts = _clock.observe(device_ts, host_ts);
+        }
+        publish_rows(&device_ts, &host_ts, &aligned_ts, &gsr_us, &gsr_raw, &ppg_raw, &flags, 1);
+    }
+
+    // Align and publish a whole hardware read: each stage lock is taken once
+    // and the ring and its waiters see the batch in one update
+    void publish_batch(ShimmerSampleBatch& b) {
+        if (b.size == 0) return;
+        {
+            std::lock_guard<std::mutex> g(_clock_mtx);
+            for (size_t i = 0; i < b.size; ++i) b.aligned_ts[i] = _clock.observe(b.device_ts[i], b.host_ts[i]);
+        }
+        publish_rows(b.device_ts, b.host_ts, b.aligned_ts, b.gsr_us, b.gsr_raw, b.ppg_raw, b.flags, b.size);
+        b.size = 0;
+    }
+
+    // Run the inline stages over n aligned rows, then push them to the ring
+    void publish_rows(const double* device_ts, const double* host_ts, const double* aligned_ts,
+                      const double* gsr_us, const uint16_t* gsr_raw, const uint16_t* ppg_raw, uint32_t* flags,
+                      size_t n) {
+        if (_gap_pending) {
+            flags[0] |= SAMPLE_AFTER_GAP;
+            _gap_pending = false;
+        }
+        if (_eda_on.load(std::memory_order_relaxed)) process_eda(aligned_ts, gsr_us, flags, n);
+        if (_plot_on.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> g(_plot_mtx);
+            if (_plot) {
+                for (size_t i = 0; i < n; ++i) _plot->append(aligned_ts[i], gsr_us[i]);
+            }
+        }
+        if (_shm_on.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> g(_shm_mtx);
+            if (_shm) {
+                for (size_t i = 0; i < n; ++i) {
+                    _shm->push(device_ts[i], host_ts[i], aligned_ts[i], gsr_us[i], gsr_raw[i], ppg_raw[i], flags[i]);
+                }
+            }
+        }
+        if (_flight_on.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> g(_flight_mtx);
+            if (_flight) {
+                for (size_t i = 0; i < n; ++i) {
+                    _flight->push(device_ts[i], host_ts[i], aligned_ts[i], gsr_us[i], gsr_raw[i], ppg_raw[i],
+                                  flags[i]);
+                }
+            }
+        }
+        if (n == 1) {
+            _ring.push(*device_ts, *host_ts, *aligned_ts, *gsr_us, *gsr_raw, *ppg_raw, *flags);
+        } else {
+            _ring.push_n(n, device_ts, host_ts, aligned_ts, gsr_us, gsr_raw, ppg_raw, flags);
+        }
+        _stats.packets.add(n);
+        _signal.notify(_ring.total_pushed());
+    }
+
+    // Legacy two-column view of the ring: (host-aligned timestamp, GSR uS)
+    size_t pop_gsr(double* ts_out, double* vals_out, size_t max) {
+        std::lock_guard<std::mutex> drain(_drain_mtx);
+        // host_ts is only needed for the drain latency; one pop never exceeds the capacity
+        max = std::min(max, _ring.capacity());
+        if (_drain_host_ts.size() < max) _drain_host_ts.resize(max);
+        size_t n = _ring.pop_into(max, nullptr, _drain_host_ts.data(), ts_out, vals_out, nullptr, nullptr, nullptr);
+        record_drained(_drain_host_ts.data(), n);
+        return n;
+    }
+
+    // Validate that a numpy array can be written in place as a 1-D float64 column.
+    // No implicit conversion is done: a converted copy would silently drop the writes.
+    static std::pair<double*, size_t> writable_f64_column(py::array& arr, const char* name) {
+        if (!py::isinstance<py::array_t<double>>(arr)) {
+            throw std::invalid_argument(std::string(name) + " must have dtype float64");
+        }
+        if (arr.ndim() != 1 || !(arr.flags() & py::array::c_style)) {
+            throw std::invalid_argument(std::string(name) + " must be a contiguous 1-D array");
+        }
+        return {static_cast<double*>(arr.mutable_data()), static_cast<size_t>(arr.shape(0))};
+    }
+
+    void dispatch_loop() {
+        std::vector<std::shared_ptr<ShimmerSubscription>> subs;
+        while (!_dispatch_stop.load()) {
+            const uint64_t version = _sub_version.load();
+            {
+                std::lock_guard<std::mutex> g(_sub_mtx);
+                subs = _subscriptions;
+            }
+            // Sleep until the ring reaches the nearest batch (or the first new
+            // sample of an idle subscriber) or the nearest latency deadline
+            uint64_t target = std::numeric_limits<uint64_t>::max();
+            double wake = now_seconds() + 1.0;
+            for (auto& sub : subs) {
+                if (!sub->active.load()) continue;
+                sub->pending.read_from(_ring, *sub->reader);
+                while (sub->due(now_seconds())) deliver(*sub);
+                const size_t pending = sub->pending.size();
+                if (pending == 0) {
+                    target = std::min(target, sub->reader->cursor() + 1);
+                } else {
+                    target = std::min<uint64_t>(target, sub->reader->cursor() + (sub->batch_size - pending));
+                    wake = std::min(wake, sub->deadline());
+                }
+            }
+            subs.clear();
+            const auto timeout = std::chrono::milliseconds(
+                static_cast<int64_t>(std::ceil(std::max(0.0, wake - now_seconds()) * 1000.0)));
+            // A stop or a subscription change ends the wait like a reached target
+            _signal.wait(target, [this, version] {
+                return _dispatch_stop.load() || _sub_version.load() != version
+                           ? std::numeric_limits<uint64_t>::max()
+                           : _ring.total_pushed();
+            }, timeout);
+        }
+    }
+
+    // Hand the oldest batch_size pending rows to the callback; the GIL is taken once per batch
+    void deliver(ShimmerSubscription& sub) {
+        const size_t n = std::min(sub.pending.size(), sub.batch_size);
+        {
+            py::gil_scoped_acquire gil;
+            const double now = now_seconds();
+            for (size_t i = 0; i < n; ++i) sub.latency.record(now - sub.pending.host_ts[i]);
+            if (sub.active.load()) {
+                try {
+                    sub.callback(sub.pending.to_dict(n));
+                } catch (py::error_already_set& e) {
+                    sub.errors.add();
+                    e.discard_as_unraisable(sub.callback);
+                }
+            }
+        }
+        sub.batches.add();
+        sub.samples.add(n);
+        if (n == sub.pending.size()) {
+            sub.pending.resize(0);
+        } else {
+            sub.pending.erase_front(n);
+        }
+    }
+
+    void stop_dispatcher() {
+        std::thread dispatcher;
+        {
+            std::lock_guard<std::mutex> g(_sub_mtx);
+            dispatcher = std::move(_dispatcher);
+        }
+        if (!dispatcher.joinable()) return;
+        _dispatch_stop.store(true);
+        _signal.wake_all();
+        // The dispatcher may be waiting for the GIL to deliver a batch
+        if (PyGILState_Check()) {
+            py::gil_scoped_release nogil;
+            dispatcher.join();
+        } else {
+            dispatcher.join();
+        }
+    }
+
+    void run_loop() {
+        while (_running.load()) {
+            // poll() < 0: the link failed for good; link_state() says why
+            if (poll(100) < 0) break;
+#ifdef USE_SHIMMER_CAPI
+            // Hardware reads already waited up to 100 ms for data
+            if (_use_real_hardware && !_replay && _link.load() == LinkState::Streaming) continue;
+#endif
+            // One wakeup per simulated sample at its absolute deadline (none
+            // when unpaced), or at the next reconnect attempt
+            if (!_poll_timer.sleep_until(next_sample_due())) break;
+        }
+    }
+
+#ifdef USE_SHIMMER_CAPI
+    // Read everything the device has buffered in one call, waiting at most
+    // timeout_ms for the first packet, then convert the GSR words and publish
+    // the samples as one batch. Returns the number of samples published, 0 on
+    // timeout, -1 on error.
+    int poll_hardware(int timeout_ms) {
+        ShimmerDataPacket packets[ShimmerSampleBatch::kMax];
+        const int count = Shimmer_readPackets(_shimmer_handle, packets, static_cast<int>(ShimmerSampleBatch::kMax),
+                                              timeout_ms);
+        if (count == 0) {
+            // Normal timeout
+            _stats.timeouts.add();
+            return 0;
+        }
+        if (count < 0) {
+            _stats.errors.add();
+            std::cerr << "Error reading Shimmer data: " << count << std::endl;
+            return -1;
+        }
+
+        const double host_sec = now_seconds();
+        _stats.interarrival.mark(host_sec);
+        ShimmerSampleBatch& b = _batch;
+        for (int i = 0; i < count; ++i) {
+            const ShimmerDataPacket& packet = packets[i];
+            const uint32_t flags = (packet.has_gsr ? SAMPLE_HAS_GSR : 0u) | (packet.has_ppg ? SAMPLE_HAS_PPG : 0u);
+            if (flags == 0) {
+                continue;
+            }
+            const size_t k = b.size++;
+            b.device_ts[k] = static_cast<double>(packet.timestamp_ms) / 1000.0;
+            b.host_ts[k] = host_sec;
+            b.gsr_raw[k] = packet.has_gsr ? packet.gsr_raw : uint16_t{0};
+            b.ppg_raw[k] = packet.has_ppg ? packet.ppg_raw : uint16_t{0};
+            b.flags[k] = flags;
+        }
+        convert_gsr(b);
+        const int published = static_cast<int>(b.size);
+        publish_batch(b);
+        return published;
+    }
+#endif
+
+    // GSR in uS from the raw words of a batch; NaN for samples without GSR
+    void convert_gsr(ShimmerSampleBatch& b) const {
+        gsr_raw_to_microsiemens(b.gsr_raw, b.gsr_us, b.size, gsr_calibration());
+        for (size_t k = 0; k < b.size; ++k) {
+            if (!(b.flags[k] & SAMPLE_HAS_GSR)) b.gsr_us[k] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    // Publish the recorded samples due by `now` as one batch, converted and
+    // aligned again like a hardware read. An unthrottled replay waits for the
+    // recorder rather than outrunning its reader.
+    int emit_replay(Clock::time_point now) {
+        _replay_held = !_replay->finished() && _replay->unthrottled() && recorder_behind();
+        if (_replay_held) return 0;
+        // At most half a ring per batch, so a recorder within half a ring is never lapped
+        const size_t max = std::min(ShimmerSampleBatch::kMax, std::max<size_t>(1, _ring.capacity() / 2));
+        ShimmerSampleBatch& b = _batch;
+        b.size = _replay->read_due(now, max, b.device_ts, b.host_ts, b.gsr_raw, b.ppg_raw, b.flags);
+        const int published = static_cast<int>(b.size);
+        if (b.size > 0) {
+            _stats.interarrival.mark(now_seconds());
+            for (size_t k = 0; k < b.size; ++k) b.flags[k] |= SAMPLE_REPLAYED;
+            convert_gsr(b);
+            publish_batch(b);
+        }
+        _replay_counters.update(*_replay);
+        if (_replay->finished() && _link.load() == LinkState::Streaming) {
+            set_link(LinkState::Idle, 0, "replay finished");
+        }
+        return published;
+    }
+
+    // True (and the recorder woken) while it trails the ring by more than half its capacity
+    bool recorder_behind() {
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        if (!_recorder || _recorder->backlog() <= _ring.capacity() / 2) return false;
+        _recorder->kick();
+        return true;
+    }
+
+    // Publish every simulated sample scheduled at or before `now`; an
+    // unpaced simulator publishes the next batch regardless of the clock
+    int emit_due_samples(Clock::time_point now) {
+        constexpr int kUnpacedBatch = 256;
+        const SimulatorConfig& cfg = _sim.config();
+        const GsrCalibration cal = gsr_calibration();
+        if (cfg.unpaced) {
+            const double host_ts = now_seconds();
+            _stats.interarrival.mark(host_ts);
+            int emitted = 0;
+            for (int i = 0; i < kUnpacedBatch; ++i) {
+                // Host time is meaningless for virtual device time; stalls are not simulated
+                emitted += publish_simulated(_sim.next(), host_ts, cal, false);
+            }
+            return emitted;
+        }
+
+        // After a long suspension, resume from now instead of bursting the backlog
+        const auto max_backlog = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 + cfg.timeout_ms / 1000.0));
+        if (now - _sim_next > max_backlog) {
+            _sim_origin += now - _sim_next;
+            _sim_next = now;
+        }
+        if (_sim_next > now || now < _sim_stall_end) return 0;
+
+        const double host_ts = now_seconds();
+        _stats.interarrival.mark(host_ts);
+        int emitted = 0;
+        while (_sim_next <= now) {
+            SimulatedSample s = _sim.next();
+            emitted += publish_simulated(s, host_ts, cal, true);
+            _sim_next = sim_deadline(_sim.index());
+            if (s.outage_s > 0.0) {
+                _sim_disconnects.fetch_add(1, std::memory_order_relaxed);
+                _sim_outage_end = now + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double>(s.outage_s));
+                return link_lost("simulated link loss") < 0 ? -1 : emitted;
+            }
+            if (s.stall_s > 0.0) {
+                // The link goes quiet; samples due meanwhile arrive in a burst when it recovers
+                _sim_timeouts.fetch_add(1, std::memory_order_relaxed);
+                _stats.timeouts.add();
+                _sim_stall_end = now + std::chrono::duration_cast<Clock::duration>(
+                                           std::chrono::duration<double>(s.stall_s));
+                break;
+            }
+        }
+        return emitted;
+    }
+
+    // Returns 1 if the sample was published, 0 if it was dropped on the simulated link
+    int publish_simulated(const SimulatedSample& s, double host_ts, const GsrCalibration& cal, bool align) {
+        _sim_generated.fetch_add(1, std::memory_order_relaxed);
+        if (s.dropped) {
+            _sim_dropouts.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        publish_sample(s.device_ts, host_ts, s.gsr_us, gsr_microsiemens_to_raw(s.gsr_us, cal), s.ppg_raw,
+                       SAMPLE_HAS_GSR | SAMPLE_HAS_PPG | SAMPLE_SIMULATED, align);
+        return 1;
+    }
+
+    std::string _port;
+    std::atomic<bool> _running;
+    std::atomic<bool> _connected;
+    bool _use_real_hardware;
+    std::thread _thread;
+    ShimmerRing _ring;
+    RingSignal _signal;
+    // Bindings run without the GIL, so serialize what Python threads may race on
+    mutable std::mutex _lifecycle_mtx;  // connect/start/stop and _port
+    std::mutex _drain_mtx;              // the ring's default reader and _drain_host_ts
+    std::vector<double> _drain_host_ts;  // scratch host_ts column of pop_gsr
+    ShimmerStreamStats _stats;
+    SimulatorConfig _sim_config;     // guarded by _lifecycle_mtx; applied on start
+    ShimmerSimulator _sim;           // owned by the acquisition thread while streaming
+    Clock::time_point _sim_origin{};  // wall-clock time of simulated sample 0
+    Clock::time_point _sim_next{};    // next simulated sample time
+    Clock::time_point _sim_stall_end{};  // injected link stall in progress until then
+    Clock::time_point _sim_outage_end{};  // injected link loss in progress until then
+    DeadlineTimer _poll_timer;        // paces run_loop and reconnect backoff; cancelled by stop_streaming
+    std::atomic<uint64_t> _sim_generated{0};
+    std::atomic<uint64_t> _sim_dropouts{0};
+    std::atomic<uint64_t> _sim_timeouts{0};
+    std::atomic<uint64_t> _sim_disconnects{0};
+    std::atomic<uint64_t> _sim_lost{0};
+    std::optional<ReplayConfig> _replay_config;  // guarded by _lifecycle_mtx; applied on start
+    double _replay_rate{128.0};                  // recorded rate of _replay_config
+    std::unique_ptr<ShimmerReplaySource> _replay;  // owned by the polling thread while streaming
+    bool _replay_held{false};                    // waiting for the recorder (polling thread)
+    ReplayCounters _replay_counters;
+    ShimmerSampleBatch _batch;  // staging columns of hardware reads and replays (polling thread only)
+    // Reconnect state machine; _backoff, _gap_pending and _stream_port belong to the polling thread
+    std::atomic<LinkState> _link{LinkState::Idle};
+    LinkEventLog _link_events;
+    mutable std::mutex _reconnect_mtx;  // guards _reconnect_policy
+    ReconnectPolicy _reconnect_policy;
+    ReconnectBackoff _backoff;
+    bool _gap_pending{false};         // flag the next published sample SAMPLE_AFTER_GAP
+    std::string _stream_port;         // _port at start, for reconnecting
+    bool _external_streaming{false};  // polled by a hub instead of _thread
+    mutable std::mutex _cal_mtx;      // guards _gsr_cal
+    GsrCalibration _gsr_cal;
+    mutable std::mutex _recorder_mtx;  // guards _recorder
+    std::unique_ptr<ShimmerRecorder> _recorder;
+    mutable std::mutex _lsl_mtx;       // guards _lsl
+    std::unique_ptr<ShimmerLslOutlet> _lsl;
+    mutable std::mutex _clock_mtx;     // guards _clock
+    ClockModel _clock;                 // device -> host clock fit for aligned_ts
+    mutable std::mutex _eda_mtx;       // guards _eda
+    std::unique_ptr<EdaStage> _eda;
+    std::atomic<bool> _eda_on{false};  // lets publish_sample skip _eda_mtx while disabled
+    mutable std::mutex _plot_mtx;      // guards _plot
+    std::unique_ptr<DecimationPyramid> _plot;
+    std::atomic<bool> _plot_on{false};
+    mutable std::mutex _shm_mtx;       // guards _shm
+    std::unique_ptr<ShimmerShmWriter> _shm;
+    std::atomic<bool> _shm_on{false};
+    mutable std::mutex _flight_mtx;    // guards _flight
+    std::unique_ptr<ShimmerFlightRecorder> _flight;
+    std::atomic<bool> _flight_on{false};
+    mutable std::mutex _sub_mtx;       // guards _subscriptions, _last_sub_id and _dispatcher
+    std::vector<std::shared_ptr<ShimmerSubscription>> _subscriptions;
+    uint64_t _last_sub_id{0};
+    std::thread _dispatcher;            // started by the first subscribe(), runs until destruction
+    std::atomic<bool> _dispatch_stop{false};
+    std::atomic<uint64_t> _sub_version{0};  // bumped on (un)subscribe to re-plan the dispatcher's wait
+    
+#ifdef USE_SHIMMER_CAPI
+    void* _shimmer_handle; // Shimmer C-API handle
+    mutable std::mutex _handle_mtx;  // handle swaps by the polling thread vs get_device_info
+    // A hardware reopen in progress
+    struct PendingReopen {
+        std::thread thread;
+        std::atomic<bool> done{false};
+        void* handle{nullptr};  // written by the thread before done
+        std::string error;
+    };
+    std::unique_ptr<PendingReopen> _reopen;  // owned by the polling thread; joined by stop_streaming
+#endif
+};
+
+// Several Shimmer devices acquired by one small, fixed worker pool instead of
+// a thread per device. Devices are assigned round-robin to workers; each
+// worker cycles over its devices with non-blocking polls and only sleeps when
+// none of them had data. Output can be drained per device or merged into one
+// stream ordered by host receive time.
+class NativeShimmerHub {
+public:
+    explicit NativeShimmerHub(size_t workers = 2, size_t ring_capacity = 4096)
+        : _worker_count(std::max<size_t>(1, workers)), _ring_capacity(ring_capacity), _running(false) {}
+
+    ~NativeShimmerHub() {
+        stop();
+    }
+
+    // Connect a device and return its index; devices cannot be added while
+    // running
+    size_t add_device(const std::string& port) {
+        return connect_device(port, nullptr);
+    }
+
+    // Take over a device connected elsewhere (see ShimmerConnectJob); throws
+    // while running, like add_device()
+    size_t adopt_device(std::unique_ptr<NativeShimmer> shimmer) {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load()) {
+            throw std::runtime_error("Cannot add devices while the hub is running");
+        }
+        return push_device(std::move(shimmer));
+    }
+
+    size_t device_count() const {
+        std::lock_guard<std::mutex> drain(_drain_mtx);
+        return _devices.size();
+    }
+
+    // Ring capacity requested for every device
+    size_t ring_capacity() const { return _ring_capacity; }
+
+    // Add `count` simulated devices sharing cfg, each with its own seed
+    // (cfg.seed + i); returns their indices
+    std::vector<size_t> add_simulated_devices(size_t count, const SimulatorConfig& cfg) {
+        validate_simulator_config(cfg);
+        std::vector<size_t> out;
+        out.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            SimulatorConfig dev_cfg = cfg;
+            dev_cfg.seed = cfg.seed + i;
+            out.push_back(connect_device("SIM-" + std::to_string(device_count()), &dev_cfg));
+        }
+        return out;
+    }
+
+    // Add one device per recording, each replaying it (see
+    // NativeShimmer::configure_replay); returns their indices
+    std::vector<size_t> add_replay_devices(const std::vector<std::string>& paths, double speed, bool loop) {
+        std::vector<size_t> out;
+        out.reserve(paths.size());
+        for (const std::string& path : paths) {
+            auto shimmer = std::make_unique<NativeShimmer>(_ring_capacity);
+            shimmer->configure_replay({path, speed, loop});
+            shimmer->connect("REPLAY-" + std::to_string(device_count()));
+            out.push_back(adopt_device(std::move(shimmer)));
+        }
+        return out;
+    }
+
+    NativeShimmer& shimmer(size_t index) const {
+        return *device(index).shimmer;
+    }
+
+    void start() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load()) return;
+        for (auto& dev : _devices) {
+            try {
+                dev->shimmer->begin_external_streaming();
+                dev->failed.store(false);
+            } catch (const std::runtime_error& e) {
+                // A device whose link failed in an earlier run stays out until reconnected
+                std::cerr << "Shimmer hub: " << e.what() << std::endl;
+                dev->failed.store(true);
+            }
+        }
+        _idle_timer.rearm();
+        _running.store(true);
+        size_t n = std::min(_worker_count, std::max<size_t>(1, _devices.size()));
+        for (size_t w = 0; w < n; ++w) {
+            _workers.push_back(spawn_thread("shimmer", "shimmer-hub:" + std::to_string(w),
+                                            [this, w, n]() { this->worker_loop(w, n); }));
+        }
+        std::cout << "Shimmer hub started: " << _devices.size() << " devices on " << n << " workers" << std::endl;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        _running.store(false);
+        _idle_timer.cancel();
+        for (auto& t : _workers) {
+            if (t.joinable()) t.join();
+        }
+        _workers.clear();
+        for (auto& dev : _devices) {
+            dev->shimmer->stop_streaming();
+        }
+    }
+
+    // Drain every device: list of per-device column dicts, in device order
+    py::list drain() {
+        std::lock_guard<std::mutex> drain(_drain_mtx);
+        pull();
+        py::list out;
+        for (auto& dev : _devices) {
+            out.append(dev->pending.to_dict());
+            dev->pending.resize(0);
+        }
+        return out;
+    }
+
+    // Drain all devices as one stream ordered by host_ts, with a `device`
+    // column of device indices. A sample is only released once every device
+    // that delivered data within max_lag_ms has caught up to its timestamp,
+    // so successive calls stay globally ordered.
+    py::dict drain_merged(double max_lag_ms) {
+        std::lock_guard<std::mutex> drain(_drain_mtx);
+        pull();
+        double now = now_seconds();
+        double stale_before = now - max_lag_ms / 1000.0;
+        double watermark = now;
+        for (auto& dev : _devices) {
+            if (dev->last_host_ts >= stale_before) {
+                watermark = std::min(watermark, dev->last_host_ts);
+            }
+        }
+
+        ShimmerColumns merged;
+        std::vector<uint16_t> device_col;
+        std::vector<size_t> pos(_devices.size(), 0);
+        while (true) {
+            size_t best = _devices.size();
+            double best_ts = watermark;
+            for (size_t i = 0; i < _devices.size(); ++i) {
+                const auto& p = _devices[i]->pending;
+                if (pos[i] < p.size() && p.host_ts[pos[i]] <= best_ts) {
+                    best = i;
+                    best_ts = p.host_ts[pos[i]];
+                }
+            }
+            if (best == _devices.size()) break;
+            merged.push_row(_devices[best]->pending, pos[best]++);
+            device_col.push_back(static_cast<uint16_t>(best));
+        }
+        for (size_t i = 0; i < _devices.size(); ++i) {
+            _devices[i]->pending.erase_front(pos[i]);
+        }
+
+        py::dict out = merged.to_dict();
+        out["device"] = ShimmerColumns::to_numpy(device_col);
+        return out;
+    }
+
+    std::string get_device_info(size_t index) const {
+        return device(index).shimmer->get_device_info();
+    }
+
+    // Samples lost because the hub drained a device too late
+    uint64_t dropped_samples(size_t index) const {
+        return device(index).reader->dropped();
+    }
+
+    // True if the device's link failed for good and it is no longer polled
+    bool device_failed(size_t index) const {
+        return device(index).failed.load();
+    }
+
+    std::string link_state(size_t index) const {
+        return device(index).shimmer->link_state();
+    }
+
+    ClockModelState clock_model(size_t index) const {
+        return device(index).shimmer->clock_model();
+    }
+
+    // Subscriptions follow the device ring directly and do not consume hub drains
+    uint64_t subscribe(size_t index, std::shared_ptr<ShimmerSubscription> sub) {
+        return device(index).shimmer->subscribe(std::move(sub));
+    }
+
+    bool unsubscribe(size_t index, uint64_t id) {
+        return device(index).shimmer->unsubscribe(id);
+    }
+
+    void enable_lsl(size_t index, LslOutletOptions opts) {
+        device(index).shimmer->enable_lsl(std::move(opts));
+    }
+
+    LslOutletStats disable_lsl(size_t index) {
+        return device(index).shimmer->disable_lsl();
+    }
+
+    std::optional<LslOutletStats> lsl_stats(size_t index) const {
+        return device(index).shimmer->lsl_stats();
+    }
+
+    void enable_eda(size_t index, const EdaConfig& cfg) {
+        device(index).shimmer->enable_eda(cfg);
+    }
+
+    EdaState disable_eda(size_t index) {
+        return device(index).shimmer->disable_eda();
+    }
+
+    EdaState eda_state(size_t index) const {
+        return device(index).shimmer->eda_state();
+    }
+
+    EdaFeatureColumns pop_eda_features(size_t index) {
+        return device(index).shimmer->pop_eda_features();
+    }
+
+    ScrEventColumns pop_scr_events(size_t index) {
+        return device(index).shimmer->pop_scr_events();
+    }
+
+    void enable_shm(size_t index, const std::string& name, size_t capacity) {
+        device(index).shimmer->enable_shm(name, capacity);
+    }
+
+    ShmWriterStats disable_shm(size_t index) {
+        return device(index).shimmer->disable_shm();
+    }
+
+    std::optional<ShmWriterStats> shm_stats(size_t index) const {
+        return device(index).shimmer->shm_stats();
+    }
+
+    void enable_flight_recorder(size_t index, const std::string& path, double minutes) {
+        device(index).shimmer->enable_flight_recorder(path, minutes);
+    }
+
+    FlightRecorderStats disable_flight_recorder(size_t index) {
+        return device(index).shimmer->disable_flight_recorder();
+    }
+
+    std::optional<FlightRecorderStats> flight_recorder_stats(size_t index) const {
+        return device(index).shimmer->flight_recorder_stats();
+    }
+
+    void enable_plot_cache(size_t index, size_t fanout) {
+        device(index).shimmer->enable_plot_cache(fanout);
+    }
+
+    PlotCacheState disable_plot_cache(size_t index) {
+        return device(index).shimmer->disable_plot_cache();
+    }
+
+    PlotCacheState plot_cache_state(size_t index) const {
+        return device(index).shimmer->plot_cache_state();
+    }
+
+    void query_plot_cache(size_t index, double t0, double t1, size_t max_points, DecimationMethod method,
+                          std::vector<double>& ts_out, std::vector<double>& vals_out) const {
+        device(index).shimmer->query_plot_cache(t0, t1, max_points, method, ts_out, vals_out);
+    }
+
+    std::vector<SubscriptionSnapshot> subscriptions(size_t index) const {
+        return device(index).shimmer->subscriptions();
+    }
+
+    // Device stats, with ring_dropped counted against the hub's reader
+    ShimmerStatsSnapshot stats(size_t index) const {
+        const Device& dev = device(index);
+        ShimmerStatsSnapshot s = dev.shimmer->stats();
+        s.ring_dropped = dev.reader->dropped();
+        return s;
+    }
+
+private:
+    struct Device {
+        std::unique_ptr<NativeShimmer> shimmer;
+        std::unique_ptr<ShimmerRing::Reader> reader;  // hub's own cursor into the device ring
+        ShimmerColumns pending;                       // pulled but not yet drained, guarded by _drain_mtx
+        double last_host_ts{-std::numeric_limits<double>::infinity()};
+        std::atomic<bool> failed{false};
+    };
+
+    // add_device() with an optional simulator configuration for a simulated
+    // device
+    size_t connect_device(const std::string& port, const SimulatorConfig* sim) {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load()) {
+            throw std::runtime_error("Cannot add devices while the hub is running");
+        }
+        auto shimmer = std::make_unique<NativeShimmer>(_ring_capacity);
+        shimmer->connect(port);
+        if (sim) shimmer->configure_simulation(*sim);
+        return push_device(std::move(shimmer));
+    }
+
+    // Requires _lifecycle_mtx
+    size_t push_device(std::unique_ptr<NativeShimmer> shimmer) {
+        auto dev = std::make_unique<Device>();
+        dev->shimmer = std::move(shimmer);
+        dev->reader = dev->shimmer->ring().make_reader();
+        std::lock_guard<std::mutex> drain(_drain_mtx);
+        _devices.push_back(std::move(dev));
+        return _devices.size() - 1;
+    }
+
+    const Device& device(size_t index) const {
+        std::lock_guard<std::mutex> drain(_drain_mtx);
+        if (index >= _devices.size()) {
+            throw std::out_of_range("device index out of range");
+        }
+        return *_devices[index];
+    }
+
+    // Requires _drain_mtx
+    void pull() {
+        for (auto& dev : _devices) {
+            size_t old = dev->pending.size();
+            if (size_t got = dev->pending.read_from(dev->shimmer->ring(), *dev->reader)) {
+                dev->last_host_ts = dev->pending.host_ts.back();
+                dev->shimmer->record_drained(dev->pending.host_ts.data() + old, got);
+            }
+        }
+    }
+
+    void worker_loop(size_t worker, size_t stride) {
+        while (_running.load()) {
+            // Sleep until the earliest device has data: simulated devices
+            // report their next sample deadline, hardware is polled every ms
+            auto wake = Clock::now() + std::chrono::milliseconds(100);
+            for (size_t i = worker; i < _devices.size(); i += stride) {
+                Device& dev = *_devices[i];
+                if (dev.failed.load(std::memory_order_relaxed)) continue;
+                int r = dev.shimmer->poll(0);
+                if (r < 0) {
+                    dev.failed.store(true);
+                    std::cerr << "Shimmer hub: device " << i << " failed, no longer polled" << std::endl;
                     continue;
+                }
+                wake = std::min(wake, dev.shimmer->next_sample_due());
+            }
+            if (!_idle_timer.sleep_until(wake)) break;
+        }
+    }
+
+    const size_t _worker_count;
+    const size_t _ring_capacity;
+    std::atomic<bool> _running;
+    std::vector<std::unique_ptr<Device>> _devices;  // fixed while running
+    std::vector<std::thread> _workers;
+    DeadlineTimer _idle_timer;  // shared by the workers; cancelled by stop()
+    std::mutex _lifecycle_mtx;
+    mutable std::mutex _drain_mtx;
+};
+
+enum class ConnectState { Pending, Connecting, Connected, Failed, TimedOut, Cancelled };
+
+inline const char* connect_state_name(ConnectState s) {
+    switch (s) {
+        case ConnectState::Pending: return "pending";
+        case ConnectState::Connecting: return "connecting";
+        case ConnectState::Connected: return "connected";
+        case ConnectState::Failed: return "failed";
+        case ConnectState::TimedOut: return "timeout";
+        case ConnectState::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+// What discover_and_connect() connects: the given ports first, then whatever
+// the serial and Bluetooth scans find (scans need the Shimmer C-API)
+struct DiscoveryConfig {
+    std::vector<std::string> ports;
+    bool scan_serial{true};
+    bool scan_bluetooth{true};
+    double timeout_s{20.0};       // per device: link, sensor setup and sampling rate
+    double scan_timeout_s{15.0};  // ports a scan reports later are ignored
+    size_t max_parallel{8};       // connects in flight at once
+};
+
+inline void validate_discovery_config(const DiscoveryConfig& cfg) {
+    if (!(cfg.timeout_s > 0.0) || !(cfg.scan_timeout_s > 0.0)) {
+        throw std::invalid_argument("timeout_s and scan_timeout_s must be positive");
+    }
+    if (cfg.max_parallel == 0) {
+        throw std::invalid_argument("max_parallel must be at least 1");
+    }
+}
+
+struct ConnectProgress {
+    std::string port;
+    std::string source;  // "port", "serial" or "bluetooth"
+    ConnectState state{ConnectState::Pending};
+    std::string error;
+    double elapsed_s{0.0};  // connect time so far, or until the outcome
+    int64_t index{-1};      // hub index once added
+    uint64_t seq{0};        // update that last changed this entry
+};
+
+#ifdef USE_SHIMMER_CAPI
+// Run a C-API scan into our own address buffers
+inline std::vector<std::string> scan_ports(int (*scan)(char**, int)) {
+    constexpr int kMaxPorts = 32;
+    std::vector<char> storage(static_cast<size_t>(kMaxPorts) * SHIMMER_ADDRESS_MAX, '\0');
+    char* list[kMaxPorts];
+    for (int i = 0; i < kMaxPorts; ++i) list[i] = storage.data() + i * SHIMMER_ADDRESS_MAX;
+    const int n = scan(list, kMaxPorts);
+    if (n < 0) {
+        throw std::runtime_error("scan failed");
+    }
+    std::vector<std::string> out;
+    for (int i = 0; i < std::min(n, kMaxPorts); ++i) {
+        out.emplace_back(list[i], strnlen(list[i], SHIMMER_ADDRESS_MAX));
+    }
+    return out;
+}
+#endif
+
+// Startup of a whole hub at once: scans serial and Bluetooth in parallel and
+// connects every port found on its own thread, at most max_parallel at a
+// time, each with its own timeout. The C-API cannot abort a connect, so a
+// device that times out is disconnected when its connect finally returns.
+// Connected devices join the hub in port order once every device has an
+// outcome. The hub must outlive the job; destroying the job cancels it and
+// waits for connects still blocked in the C-API.
+class ShimmerConnectJob {
+public:
+    ShimmerConnectJob(NativeShimmerHub& hub, DiscoveryConfig cfg) : _hub(hub), _cfg(std::move(cfg)) {
+        validate_discovery_config(_cfg);
+        for (const std::string& port : _cfg.ports) add_port(port, "port");
+#ifdef USE_SHIMMER_CAPI
+        if (_cfg.scan_serial) start_scan("serial", &ShimmerSerial_scan);
+        if (_cfg.scan_bluetooth) start_scan("bluetooth", &ShimmerBluetooth_scan);
+#endif
+        _scan_deadline = Clock::now() + to_duration(_cfg.scan_timeout_s);
+        _manager = spawn_thread("shimmer", "shimmer-connect", [this]() { this->run(); });
+    }
+
+    ~ShimmerConnectJob() {
+        cancel();
+        if (_manager.joinable()) _manager.join();
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            threads.swap(_threads);
+        }
+        for (auto& t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    ShimmerConnectJob(const ShimmerConnectJob&) = delete;
+    ShimmerConnectJob& operator=(const ShimmerConnectJob&) = delete;
+
+    // Stop scanning and connecting; devices already connected are still added
+    void cancel() {
+        std::lock_guard<std::mutex> g(_mtx);
+        _cancelled = true;
+        _changed.notify_all();
+    }
+
+    // Block until the job is done or timeout_ms passes (forever if negative)
+    bool wait(int timeout_ms) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        auto done = [this]() { return _done; };
+        if (timeout_ms < 0) {
+            _changed.wait(lk, done);
+            return true;
+        }
+        return _changed.wait_for(lk, std::chrono::milliseconds(timeout_ms), done);
+    }
+
+    // Block until an update newer than last_seq, the end of the job or
+    // timeout_ms; returns the latest update number
+    uint64_t wait_for_update(uint64_t last_seq, int timeout_ms) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        _changed.wait_for(lk, std::chrono::milliseconds(std::max(0, timeout_ms)),
+                          [&]() { return _seq > last_seq || _done; });
+        return _seq;
+    }
+
+    std::vector<ConnectProgress> progress() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        const auto now = Clock::now();
+        std::vector<ConnectProgress> out;
+        out.reserve(_entries.size());
+        for (const Entry& e : _entries) {
+            out.push_back(e.progress);
+            if (e.progress.state == ConnectState::Connecting) {
+                out.back().elapsed_s = std::chrono::duration<double>(now - e.started).count();
+            }
+        }
+        return out;
+    }
+
+    // Hub indices of the devices added, in port order; only once done
+    std::vector<size_t> result() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        if (!_done) {
+            throw std::runtime_error("discovery is still running");
+        }
+        std::vector<size_t> out;
+        for (const Entry& e : _entries) {
+            if (e.progress.index >= 0) out.push_back(static_cast<size_t>(e.progress.index));
+        }
+        return out;
+    }
+
+    bool done() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _done;
+    }
+
+    bool scanning() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _scans_pending > 0 && !_scans_closed;
+    }
+
+private:
+    struct Entry {
+        ConnectProgress progress;
+        Clock::time_point started{};
+        std::unique_ptr<NativeShimmer> device;  // connected, not yet handed to the hub
+    };
+
+    static Clock::duration to_duration(double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    // Requires _mtx, or the constructor
+    void add_port(const std::string& port, const char* source) {
+        if (port.empty()) return;
+        for (const Entry& e : _entries) {
+            if (e.progress.port == port) return;  // listed and scanned, or seen by both scans
+        }
+        Entry e;
+        e.progress.port = port;
+        e.progress.source = source;
+        e.progress.seq = ++_seq;
+        _entries.push_back(std::move(e));
+    }
+
+    // Requires _mtx
+    void update(Entry& e, ConnectState state, std::string error = {}) {
+        e.progress.state = state;
+        e.progress.error = std::move(error);
+        if (e.started != Clock::time_point{}) {
+            e.progress.elapsed_s = std::chrono::duration<double>(Clock::now() - e.started).count();
+        }
+        e.progress.seq = ++_seq;
+        _changed.notify_all();
+    }
+
+#ifdef USE_SHIMMER_CAPI
+    void start_scan(const char* source, int (*scan)(char**, int)) {
+        std::lock_guard<std::mutex> g(_mtx);
+        ++_scans_pending;
+        _threads.push_back(spawn_thread("shimmer", std::string("shimmer-scan:") + source, [this, source, scan]() {
+            std::vector<std::string> found;
+            try {
+                found = scan_ports(scan);
+            } catch (const std::exception& e) {
+                std::cerr << "Shimmer " << source << " " << e.what() << std::endl;
+            }
+            std::lock_guard<std::mutex> g(_mtx);
+            --_scans_pending;
+            if (_scans_closed) return;  // too late: the job no longer takes ports
+            for (const std::string& port : found) add_port(port, source);
+            ++_seq;
+            _changed.notify_all();
+        }));
+    }
+#endif
+
+    // Connect thread; sensor setup is part of NativeShimmer::connect()
+    void connect_one(size_t i, std::string port) {
+        auto dev = std::make_unique<NativeShimmer>(_hub.ring_capacity());
+        std::string error;
+        try {
+            dev->connect(port);
+        } catch (const std::exception& e) {
+            error = e.what();
+            dev.reset();
+        }
+        std::lock_guard<std::mutex> g(_mtx);  // released before a late device is destroyed
+        Entry& e = _entries[i];
+        if (e.progress.state != ConnectState::Connecting) return;  // timed out or cancelled
+        if (dev) {
+            e.device = std::move(dev);
+            update(e, ConnectState::Connected);
+        } else {
+            update(e, ConnectState::Failed, std::move(error));
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lk(_mtx);
+        const auto timeout = to_duration(_cfg.timeout_s);
+        while (true) {
+            const auto now = Clock::now();
+            if (!_scans_closed && (_cancelled || _scans_pending == 0 || now >= _scan_deadline)) {
+                if (_scans_pending > 0 && !_cancelled) {
+                    std::cerr << "Shimmer discovery: scan did not finish in time" << std::endl;
+                }
+                _scans_closed = true;
+                ++_seq;
+                _changed.notify_all();
+            }
+            size_t active = 0;
+            auto wake = _scans_closed ? Clock::time_point::max() : _scan_deadline;
+            for (Entry& e : _entries) {
+                if (e.progress.state == ConnectState::Connecting) {
+                    if (_cancelled) {
+                        update(e, ConnectState::Cancelled);
+                    } else if (now - e.started >= timeout) {
+                        update(e, ConnectState::TimedOut, "no response within timeout");
+                    } else {
+                        ++active;
+                        wake = std::min(wake, e.started + timeout);
+                    }
+                } else if (e.progress.state == ConnectState::Pending && _cancelled) {
+                    update(e, ConnectState::Cancelled);
+                }
+            }
+            bool pending = false;
+            for (size_t i = 0; i < _entries.size(); ++i) {
+                Entry& e = _entries[i];
+                if (e.progress.state != ConnectState::Pending) continue;
+                if (active >= _cfg.max_parallel) {
+                    pending = true;
+                    break;
+                }
+                e.started = now;
+                update(e, ConnectState::Connecting);
+                ++active;
+                wake = std::min(wake, now + timeout);
+                _threads.push_back(spawn_thread("shimmer", "shimmer-connect:" + e.progress.port,
+                                                [this, i, port = e.progress.port]() { this->connect_one(i, port); }));
+            }
+            if (_scans_closed && active == 0 && !pending) break;
+            _changed.wait_until(lk, wake);
+        }
+        // Add in port order so indices do not depend on which device answered first
+        for (Entry& e : _entries) {
+            if (!e.device) continue;
+            std::unique_ptr<NativeShimmer> dev = std::move(e.device);
+            lk.unlock();
+            int64_t index = -1;
+            std::string error;
+            try {
+                index = static_cast<int64_t>(_hub.adopt_device(std::move(dev)));
+            } catch (const std::runtime_error& ex) {
+                error = ex.what();
+            }
+            lk.lock();
+            if (index >= 0) {
+                e.progress.index = index;
+                e.progress.seq = ++_seq;
+            } else {
+                update(e, ConnectState::Failed, std::move(error));
+            }
+        }
+        _done = true;
+        ++_seq;
+        _changed.notify_all();
+    }
+
+    NativeShimmerHub& _hub;
+    const DiscoveryConfig _cfg;
+    mutable std::mutex _mtx;
+    std::condition_variable _changed;
+    std::vector<Entry> _entries;        // guarded by _mtx
+    std::vector<std::thread> _threads;  // scans and connects, joined by the destructor
+    uint64_t _seq{0};
+    size_t _scans_pending{0};
+    bool _scans_closed{false};
+    bool _cancelled{false};
+    bool _done{false};
+    Clock::time_point _scan_deadline;
+    std::thread _manager;
+};
+
+inline py::dict connect_progress_dict(const ConnectProgress& p) {
+    py::dict out;
+    out["port"] = p.port;
+    out["source"] = p.source;
+    out["state"] = connect_state_name(p.state);
+    out["error"] = p.error;
+    out["elapsed"] = p.elapsed_s;
+    out["index"] = p.index >= 0 ? py::object(py::int_(p.index)) : py::object(py::none());
+    out["seq"] = p.seq;
+    return out;
+}
+
+struct FrameAnalysisState {
+    bool enabled{false};
+    FrameAnalysisConfig config;
+    FrameAnalysisStats stats;
+};
+
+inline FrameAnalysisState frame_analysis_state_of(const FrameAnalyzer& a) {
+    return {true, a.config(), a.stats()};
+}
+
+inline py::dict frame_analysis_state_dict(const FrameAnalysisState& s) {
+    py::list rois;
+    for (const auto& r : s.config.rois) rois.append(py::make_tuple(r.x, r.y, r.width, r.height));
+    py::dict out;
+    out["enabled"] = s.enabled;
+    out["rois"] = rois;
+    out["thumbnail_levels"] = s.config.thumbnail_levels;
+    out["capacity"] = s.config.capacity;
+    out["frames"] = s.stats.frames;
+    out["dropped"] = s.stats.dropped;
+    out["overwritten"] = s.stats.overwritten;
+    out["errors"] = s.stats.errors;
+    out["analysis_seconds"] = s.stats.analysis_seconds;
+    out["kernel"] = analysis_kernel_name();
+    return out;
+}
+
+inline FrameAnalysisConfig make_frame_analysis_config(const std::vector<std::tuple<int, int, int, int>>& rois,
+                                                      int thumbnail_levels, size_t capacity) {
+    FrameAnalysisConfig cfg;
+    for (const auto& [x, y, w, h] : rois) cfg.rois.push_back({x, y, w, h});
+    cfg.thumbnail_levels = thumbnail_levels;
+    cfg.capacity = capacity;
+    validate_frame_analysis_config(cfg);
+    return cfg;
+}
+
+// Popped RoiStatsRing entries; mean and var are [frame][roi][B, G, R]
+struct RoiStatsColumns {
+    size_t rois{0};
+    std::vector<uint64_t> seq;
+    std::vector<double> timestamp, mean, var;
+
+    void pop_from(RoiStatsRing& ring) {
+        rois = ring.rois();
+        const size_t n = ring.size();
+        seq.resize(n); timestamp.resize(n); mean.resize(n * rois * 3); var.resize(n * rois * 3);
+        const size_t got = ring.pop_into(n, seq.data(), timestamp.data(), mean.data(), var.data());
+        seq.resize(got); timestamp.resize(got); mean.resize(got * rois * 3); var.resize(got * rois * 3);
+    }
+
+    py::dict to_dict() const {
+        const std::vector<py::ssize_t> shape{static_cast<py::ssize_t>(seq.size()), static_cast<py::ssize_t>(rois), 3};
+        py::dict out;
+        out["seq"] = ShimmerColumns::to_numpy(seq);
+        out["timestamp"] = ShimmerColumns::to_numpy(timestamp);
+        out["mean"] = py::array_t<double>(shape, mean.data());
+        out["var"] = py::array_t<double>(shape, var.data());
+        return out;
+    }
+};
+
+// Requested capture mode; the camera may negotiate a different frame size
+struct WebcamConfig {
+    int width{640};
+    int height{480};
+    double fps{30.0};
+    PixelFormat format{PixelFormat::BGR};
+};
+
+inline WebcamConfig make_webcam_config(int width, int height, double fps, const std::string& pixel_format) {
+    WebcamConfig cfg;
+    cfg.width = width;
+    cfg.height = height;
+    cfg.fps = fps;
+    cfg.format = parse_pixel_format(pixel_format);
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("width and height must be positive");
+    }
+    if (!(fps > 0.0) || fps > 1000.0) {
+        throw std::invalid_argument("fps must be in (0, 1000]");
+    }
+    if ((cfg.format == PixelFormat::YUYV || cfg.format == PixelFormat::NV12) && (width % 2 || height % 2)) {
+        throw std::invalid_argument("YUYV and NV12 need an even width and height");
+    }
+    if (cfg.format == PixelFormat::MJPG && !jpeg_encoder_available()) {
+        throw std::invalid_argument("MJPG capture needs a build with USE_LIBJPEG");
+    }
+    return cfg;
+}
+
+// Columns: frame seq, frame timestamp (s, host clock)
+using FrameIndexRing = SoaRing<uint64_t, double>;
+
+class NativeWebcam {
+public:
+    explicit NativeWebcam(int device_id = 0, const WebcamConfig& config = WebcamConfig{})
+        : _device_id(device_id), _running(false), _config(config),
+          _pool(pixel_format_frame_bytes(config.format, config.width, config.height)) {}
+
+    ~NativeWebcam() {
+        stop_capture();
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        _recorder.reset();
+        _analyzer.reset();
+        _encoder.reset();  // joins the encoder thread before _preview goes away
+    }
+
+    void start_capture() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load()) return;
+        _pace.rearm();
+        _stats.reset();
+        _stats.interarrival.restart();
+        _running.store(true);
+        _thread = spawn_thread("webcam", "webcam:" + std::to_string(_device_id),
+                               [this, cfg = _config, replay = _replay_config]() { this->run_loop(cfg, replay); });
+    }
+
+    void stop_capture() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        _running.store(false);
+        _pace.cancel();
+        _released->notify();
+        if (_thread.joinable()) _thread.join();
+        _pool.wake_all();
+        _preview.wake_all();
+    }
+
+    // Change the capture mode; only allowed while capture is stopped
+    void configure(const WebcamConfig& config) {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load()) {
+            throw std::runtime_error("Stop capture before reconfiguring the webcam");
+        }
+        _config = config;
+        _pool.set_frame_bytes(pixel_format_frame_bytes(config.format, config.width, config.height));
+    }
+
+    WebcamConfig config() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        return _config;
+    }
+
+    // Replay a recording made with start_recording() instead of capturing,
+    // from the next start on; only while stopped. Frames keep their recorded
+    // format, size and timestamps.
+    void configure_replay(const ReplayConfig& cfg) {
+        validate_replay_config(cfg);
+        FrameReplaySource check(cfg);  // fail now on a bad path or a Shimmer recording
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load()) {
+            throw std::runtime_error("Stop capture before configuring a replay");
+        }
+        _replay_config = cfg;
+    }
+
+    void clear_replay() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (_running.load()) {
+            throw std::runtime_error("Stop capture before clearing the replay");
+        }
+        _replay_config.reset();
+    }
+
+    std::optional<ReplayStats> replay_stats() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (!_replay_config) return std::nullopt;
+        return _replay_counters.snapshot(*_replay_config);
+    }
+
+    // Format of the frames actually delivered (BGR when the camera cannot
+    // provide the requested format); None before the first frame
+    py::object delivered_pixel_format() {
+        auto frame = _pool.latest();
+        if (!frame) {
+            return py::none();
+        }
+        return py::str(pixel_format_name(frame->format));
+    }
+
+    // Latest frame as a read-only NumPy array (None before the first frame):
+    // BGR by default, or the capture format's own layout when native is true
+    py::object get_latest_frame(bool native) {
+        auto frame = _pool.latest();
+        if (!frame) {
+            return py::none();
+        }
+        record_delivery(*frame);
+        return wrap_frame(frame, native);
+    }
+
+    // Latest frame as (frame, seq, timestamp), or None before the first frame
+    py::object get_latest_frame_with_info(bool native) {
+        auto frame = _pool.latest();
+        if (!frame) {
+            return py::none();
+        }
+        record_delivery(*frame);
+        return py::make_tuple(wrap_frame(frame, native), frame->seq, frame->timestamp);
+    }
+
+    // Block (without the GIL) until a frame newer than last_seq arrives.
+    // Returns (frame, seq, timestamp), or None on timeout or stop_capture().
+    py::object wait_for_frame(uint64_t last_seq, int timeout_ms, bool native) {
+        std::shared_ptr<FrameBuffer> frame;
+        {
+            py::gil_scoped_release release;
+            frame = _pool.wait_newer(last_seq, std::chrono::milliseconds(std::max(0, timeout_ms)));
+        }
+        if (!frame) {
+            return py::none();
+        }
+        record_delivery(*frame);
+        return py::make_tuple(wrap_frame(frame, native), frame->seq, frame->timestamp);
+    }
+
+    uint64_t latest_frame_seq() { return _pool.latest_seq(); }
+
+    // (seq, timestamp) of every published frame, for consumers that follow
+    // frame times without holding frames (the synchronizer)
+    FrameIndexRing& frame_index() { return _frame_index; }
+
+    // Copy every published frame from now on into `slots` slots of the named
+    // shared segment, sized for the configured mode (or its BGR fallback)
+    void enable_shm(const std::string& name, size_t slots) {
+        WebcamConfig cfg = config();
+        const size_t bytes = std::max(pixel_format_frame_bytes(cfg.format, cfg.width, cfg.height),
+                                      pixel_format_frame_bytes(PixelFormat::BGR, cfg.width, cfg.height));
+        auto writer = std::make_unique<ShmFrameWriter>(name, slots, bytes);
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (_shm) {
+            throw std::runtime_error("shared-memory output already enabled");
+        }
+        _shm = std::move(writer);
+    }
+
+    // Mark the segment closed and remove its name; attached readers keep their mapping
+    ShmWriterStats disable_shm() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (!_shm) return {};
+        ShmWriterStats s = shm_writer_stats(*_shm, _shm->oversized());
+        _shm.reset();
+        return s;
+    }
+
+    std::optional<ShmWriterStats> shm_stats() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (!_shm) return std::nullopt;
+        return shm_writer_stats(*_shm, _shm->oversized());
+    }
+
+    // Journal the last `frames` encoded frames into a memory-mapped file that
+    // survives a crash. MJPG frames are kept as captured; other formats are
+    // compressed by the encode stage, so they are journaled while it runs.
+    void enable_flight_recorder(const std::string& path, uint64_t frames, size_t max_frame_bytes) {
+        if (max_frame_bytes == 0) {
+            const WebcamConfig cfg = config();
+            max_frame_bytes = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height) / 2;
+        }
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (_flight) {
+            throw std::runtime_error("flight recorder already enabled");
+        }
+        _flight = std::make_shared<FlightFrameRecorder>(path, frames, max_frame_bytes);
+        if (_encoder) _encoder->set_journal(_flight);
+    }
+
+    // Flush and close the journal, marking it clean; returns its final statistics
+    FlightRecorderStats disable_flight_recorder() {
+        std::shared_ptr<FlightFrameRecorder> flight;
+        {
+            std::lock_guard<std::mutex> g(_sink_mtx);
+            flight = std::move(_flight);
+            if (_encoder) _encoder->set_journal(nullptr);
+        }
+        if (!flight) return {};
+        return flight_stats(*flight);  // the encoder may hold the journal until its current frame is done
+    }
+
+    std::optional<FlightRecorderStats> flight_recorder_stats() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (!_flight) return std::nullopt;
+        return flight_stats(*_flight);
+    }
+
+    // Write every published frame from now on to `path` on a native I/O thread
+    void start_recording(const std::string& path, const std::string& sync) {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (_recorder) {
+            throw std::runtime_error("Webcam recording already in progress");
+        }
+        _recorder = std::make_shared<FrameRecorder>(path, parse_recorder_sync(sync));
+        _recorder->set_release_signal(_released);
+    }
+
+    RecorderStats stop_recording() {
+        std::shared_ptr<FrameRecorder> rec;
+        {
+            std::lock_guard<std::mutex> g(_sink_mtx);
+            rec = std::move(_recorder);
+        }
+        if (!rec) return {};
+        rec->stop();
+        return rec->stats();
+    }
+
+    bool is_recording() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        return _recorder != nullptr;
+    }
+
+    RecorderStats recording_stats() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        return _recorder ? _recorder->stats() : RecorderStats{};
+    }
+
+    // Compress every published frame from now on on a dedicated encoder thread
+    void start_encoding(const EncoderOptions& opts) {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (_encoder) {
+            throw std::runtime_error("Webcam encoding already in progress");
+        }
+        _encoder = std::make_shared<FrameEncoder>(opts, _preview);
+        _encoder->set_release_signal(_released);
+        if (_flight) _encoder->set_journal(_flight);
+    }
+
+    EncoderStats stop_encoding() {
+        std::shared_ptr<FrameEncoder> enc;
+        {
+            std::lock_guard<std::mutex> g(_sink_mtx);
+            enc = std::move(_encoder);
+        }
+        if (!enc) return {};
+        enc->stop();
+        _preview.wake_all();
+        return enc->stats();
+    }
+
+    bool is_encoding() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        return _encoder != nullptr;
+    }
+
+    EncoderStats encoding_stats() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        return _encoder ? _encoder->stats() : EncoderStats{};
+    }
+
+    // Per-channel mean and variance over the ROIs of every published frame,
+    // and thumbnails of the latest one, computed from now on on an analysis
+    // thread. Results are drained with pop_roi_stats().
+    void enable_frame_analysis(const FrameAnalysisConfig& cfg) {
+        auto analyzer = std::make_shared<FrameAnalyzer>(cfg);
+        analyzer->set_release_signal(_released);
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (_analyzer) {
+            throw std::runtime_error("frame analysis already enabled");
+        }
+        _analyzer = std::move(analyzer);
+    }
+
+    // Analyze what is queued and stop, discarding undrained statistics; returns the final state
+    FrameAnalysisState disable_frame_analysis() {
+        std::shared_ptr<FrameAnalyzer> analyzer;
+        {
+            std::lock_guard<std::mutex> g(_sink_mtx);
+            analyzer = std::move(_analyzer);
+        }
+        if (!analyzer) return {};
+        analyzer->stop();
+        return frame_analysis_state_of(*analyzer);
+    }
+
+    FrameAnalysisState frame_analysis_state() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        return _analyzer ? frame_analysis_state_of(*_analyzer) : FrameAnalysisState{};
+    }
+
+    RoiStatsColumns pop_roi_stats() {
+        RoiStatsColumns out;
+        std::shared_ptr<FrameAnalyzer> analyzer;
+        {
+            std::lock_guard<std::mutex> g(_sink_mtx);
+            analyzer = _analyzer;
+        }
+        if (analyzer) out.pop_from(analyzer->ring());
+        return out;
+    }
+
+    // Thumbnails of the latest analyzed frame, or nullptr
+    std::shared_ptr<const ThumbnailPyramid> thumbnails() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        return _analyzer ? _analyzer->thumbnails() : nullptr;
+    }
+
+    // Latest encoded preview as (jpeg bytes, seq, timestamp), or None
+    py::object get_encoded_preview() {
+        return wrap_preview(_preview.latest());
+    }
+
+    // Block (without the GIL) until a preview newer than last_seq is encoded
+    py::object wait_for_encoded_preview(uint64_t last_seq, int timeout_ms) {
+        std::shared_ptr<const EncodedFrame> frame;
+        {
+            py::gil_scoped_release release;
+            frame = _preview.wait_newer(last_seq, std::chrono::milliseconds(std::max(0, timeout_ms)));
+        }
+        return wrap_preview(frame);
+    }
+
+    // Capture path in use: "v4l2", "mediafoundation", "opencv", "synthetic" or "replay" ("" before start)
+    std::string capture_backend() const { return _backend.load(); }
+
+    uint64_t frames_captured() const { return _pool.frames_captured(); }
+    uint64_t frames_delivered() const { return _pool.frames_delivered(); }
+    uint64_t frames_dropped() const { return _pool.frames_dropped(); }
+
+    // Frame counters and latency histograms since start_capture()
+    WebcamStatsSnapshot stats() const {
+        WebcamStatsSnapshot s;
+        s.frames_captured = _pool.frames_captured();
+        s.frames_delivered = _pool.frames_delivered();
+        s.frames_dropped = _pool.frames_dropped();
+        s.timeouts = _stats.timeouts.value();
+        s.errors = _stats.errors.value();
+        s.interarrival = _stats.interarrival.snapshot();
+        s.delivery_latency = _stats.delivery_latency.snapshot();
+        return s;
+    }
+
+    // Restart the histograms and timeout/error counters (frame counts are the pool's)
+    void reset_stats() { _stats.reset(); }
+
+private:
+    // Age of a frame when it is handed to Python
+    void record_delivery(const FrameBuffer& frame) {
+        _stats.delivery_latency.record(now_seconds() - frame.timestamp);
+    }
+
+    void run_loop(const WebcamConfig& cfg, const std::optional<ReplayConfig>& replay) {
+        if (replay) {
+            _backend.store("replay");
+            run_replay(*replay);
+            return;
+        }
+        if (run_native(cfg)) return;
+#ifdef USE_OPENCV
+        if (run_opencv(cfg)) return;
+#endif
+        _backend.store("synthetic");
+        run_synthetic(cfg);
+    }
+
+    // V4L2 / Media Foundation capture; returns false if no such device exists
+    bool run_native(const WebcamConfig& cfg) {
+        std::unique_ptr<CameraCapture> cam;
+        try {
+            cam = open_native_camera(_device_id, cfg.width, cfg.height, cfg.fps, cfg.format);
+        } catch (const std::exception& e) {
+            std::cerr << "Native camera " << _device_id << " unavailable: " << e.what() << std::endl;
+            return false;
+        }
+        if (!cam) return false;
+        _backend.store(cam->name());
+        while (_running.load()) {
+            std::shared_ptr<FrameBuffer> frame;
+            try {
+                frame = cam->read(std::chrono::milliseconds(100));
+            } catch (const std::exception& e) {
+                _stats.errors.add();
+                std::cerr << "Native camera " << _device_id << " stopped: " << e.what() << std::endl;
+                break;
+            }
+            if (frame) {
+                publish(std::move(frame));
+            } else {
+                _stats.timeouts.add();
+            }
+        }
+        return true;
+    }
+
+#ifdef USE_OPENCV
+    // Returns false if the camera cannot be opened in the requested mode
+    bool run_opencv(const WebcamConfig& cfg) {
+        if (cfg.format == PixelFormat::NV12) {
+            std::cerr << "NV12 capture is not available through OpenCV; using synthetic frames" << std::endl;
+            return false;
+        }
+        cv::VideoCapture cap(_device_id);
+        if (!cap.isOpened()) return false;
+        _backend.store("opencv");
+        // GRAY is taken from the luma of a YUYV stream
+        const bool raw = cfg.format != PixelFormat::BGR;
+        if (cfg.format == PixelFormat::MJPG) {
+            cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+        } else if (raw) {
+            cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V'));
+        }
+        cap.set(cv::CAP_PROP_FRAME_WIDTH, cfg.width);
+        cap.set(cv::CAP_PROP_FRAME_HEIGHT, cfg.height);
+        cap.set(cv::CAP_PROP_FPS, cfg.fps);
+        if (raw) cap.set(cv::CAP_PROP_CONVERT_RGB, 0);
+        // Frames keep the size the driver negotiated; nothing is resized
+        const int width = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
+        const int height = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+        const size_t yuyv_bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * 2;
+        cv::Mat frame;
+        while (_running.load()) {
+            if (!cap.read(frame) || frame.empty()) {
+                _stats.timeouts.add();
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+            auto buf = _pool.acquire();
+            if (!buf) continue;  // every buffer is held by consumers; skip this frame
+            const size_t bytes = frame.total() * frame.elemSize();
+            if (frame.type() == CV_8UC3) {
+                // The backend decoded to BGR regardless of the requested format
+                if (cfg.format == PixelFormat::GRAY) {
+                    buf->prepare(PixelFormat::GRAY, frame.cols, frame.rows, frame.total());
+                    cv::Mat gray(frame.rows, frame.cols, CV_8UC1, buf->pixels());
+                    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
                 } else {
-                    // Error occurred
-                    std::cerr << "Error reading Shimmer data: " << result << std::endl;
-                    break;
+                    buf->prepare(PixelFormat::BGR, frame.cols, frame.rows, bytes);
+                    copy_rows(frame, buf->pixels());
+                }
+            } else if (cfg.format == PixelFormat::MJPG) {
+                buf->prepare(PixelFormat::MJPG, width, height, bytes);
+                std::memcpy(buf->pixels(), frame.data, bytes);
+            } else if (frame.type() == CV_8UC2 || (frame.type() == CV_8UC1 && bytes == yuyv_bytes)) {
+                const int w = frame.type() == CV_8UC2 ? frame.cols : width;
+                const int h = frame.type() == CV_8UC2 ? frame.rows : height;
+                const size_t px = static_cast<size_t>(w) * static_cast<size_t>(h);
+                if (cfg.format == PixelFormat::GRAY) {
+                    buf->prepare(PixelFormat::GRAY, w, h, px);
+                    const uint8_t* src = frame.ptr<uint8_t>();
+                    uint8_t* dst = buf->pixels();
+                    for (size_t i = 0; i < px; ++i) dst[i] = src[i * 2];
+                } else {
+                    buf->prepare(PixelFormat::YUYV, w, h, bytes);
+                    std::memcpy(buf->pixels(), frame.ptr<uint8_t>(), bytes);
                 }
+            } else {
+                continue;  // unexpected layout from the backend
             }
-            return;
+            buf->timestamp = now_seconds();
+            publish(std::move(buf));
         }
-#endif
+        cap.release();
+        return true;
+    }
 
-        // Fallback to simulation mode
-        simulation_loop();
+    static void copy_rows(const cv::Mat& frame, uint8_t* dst) {
+        const size_t row = static_cast<size_t>(frame.cols) * frame.elemSize();
+        for (int y = 0; y < frame.rows; ++y) {
+            std::memcpy(dst + row * static_cast<size_t>(y), frame.ptr(y), row);
+        }
     }
+#endif
 
-    void simulation_loop() {
-        // Production implementation should:
-        // 1. Use Shimmer C-API to read actual sensor data
-        // 2. Parse incoming data packets for GSR and PPG
-        // 3. Convert raw ADC values using proper 12-bit scaling (0-4095)
-        // 4. Apply calibration coefficients for microsiemens conversion
-        
-        // Current simulation: 128 Hz sine + noise centered around 10µS
-        constexpr double rate = 128.0;
-        constexpr double dt = 1.0 / rate;
-        double phase = 0.0;
-        const double two_pi = 6.283185307179586;
-        auto t_next = Clock::now();
-        
+    // Frames of a recording, copied from the mapped file into pool buffers at
+    // their recorded pace. Unthrottled, each frame waits for a free buffer and
+    // for room in the recorder, encoder and analyzer queues, so no stage drops one.
+    void run_replay(const ReplayConfig& replay) {
+        _replay_counters.reset();
+        std::unique_ptr<FrameReplaySource> src;
+        try {
+            src = std::make_unique<FrameReplaySource>(replay);
+        } catch (const std::exception& e) {
+            _stats.errors.add();
+            std::cerr << "Webcam replay " << replay.path << " unavailable: " << e.what() << std::endl;
+            return;
+        }
+        src->start(Clock::now());
+        const bool unthrottled = src->unthrottled();
         while (_running.load()) {
-            auto now = Clock::now();
-            if (now < t_next) {
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            ReplayFrame f;
+            if (!src->read_due(Clock::now(), f)) {
+                _replay_counters.update(*src);
+                if (src->finished()) break;
+                if (!_pace.sleep_until(src->next_due())) break;
                 continue;
             }
-            
-            double t = std::chrono::duration<double>(now.time_since_epoch()).count();
-            
-            // Simulate realistic GSR data (microsiemens)
-            double baseline_gsr = 8.0 + 2.0 * std::sin(phase * 0.1);  // Slow drift
-            double respiratory_component = 1.5 * std::sin(phase * 0.5);  // Breathing
-            double cardiac_component = 0.5 * std::sin(phase * 2.0);     // Heart rate
-            
-            // Add realistic noise
-            _rng = 1664525u * _rng + 1013904223u;
-            double noise = (static_cast<int>(_rng >> 16) / 32768.0 - 1.0) * 0.2;
-            
-            double gsr_value = baseline_gsr + respiratory_component + cardiac_component + noise;
-            gsr_value = std::max(0.1, gsr_value);  // Ensure positive values
-            
-            _queue.push(t, gsr_value);
-            
-            phase += two_pi * dt;
-            if (phase > two_pi) phase -= two_pi;
-            
-            t_next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+            auto buf = unthrottled ? acquire_when_sinks_ready() : _pool.acquire();
+            if (!buf) {
+                if (!unthrottled) _stats.timeouts.add();  // every buffer is held by consumers; skip this frame
+                continue;
+            }
+            buf->prepare(f.format, f.width, f.height, f.bytes);
+            std::memcpy(buf->pixels(), f.pixels, f.bytes);
+            buf->timestamp = f.timestamp;
+            publish(std::move(buf));
+            _replay_counters.update(*src);
         }
+        _replay_counters.update(*src);
     }
 
-    std::string _port;
+    // A free buffer once the recorder, encoder and analyzer can each queue one
+    // more frame; nullptr on stop. Sleeps on the sinks' release signal.
+    std::shared_ptr<FrameBuffer> acquire_when_sinks_ready() {
+        while (_running.load()) {
+            const uint64_t seen = _released->count();
+            if (sinks_have_room()) {
+                if (auto buf = _pool.acquire()) return buf;
+            }
+            // Buffers held by Python consumers come back without a notification
+            _released->wait(seen, std::chrono::milliseconds(10));
+        }
+        return nullptr;
+    }
+
+    bool sinks_have_room() {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        return (!_recorder || _recorder->backlog() < _recorder->max_queue()) &&
+               (!_encoder || _encoder->backlog() < _encoder->max_queue()) &&
+               (!_analyzer || _analyzer->backlog() < _analyzer->max_queue());
+    }
+
+    // Synthetic moving gradient, generated directly in the requested format
+    void run_synthetic(const WebcamConfig& cfg) {
+        const int w = cfg.width, h = cfg.height;
+        const size_t sw = static_cast<size_t>(w);
+        RateSchedule schedule(cfg.fps);
+        std::vector<uint8_t> row(sw);
+#ifdef USE_LIBJPEG
+        std::vector<uint8_t> bgr;
+        std::vector<uint8_t> jpeg;
+        JpegEncoder encoder;
+#endif
+        auto t0 = Clock::now();
+        while (_running.load()) {
+            auto dt = std::chrono::duration<double>(Clock::now() - t0).count();
+            int shift = static_cast<int>(std::fmod(dt * 60.0, static_cast<double>(w)));
+            for (int x = 0; x < w; ++x) {
+                row[static_cast<size_t>(x)] = static_cast<uint8_t>((((x + shift) % w) * 255) / w);
+            }
+            auto buf = _pool.acquire();
+            if (buf) {
+                buf->prepare(cfg.format, w, h, pixel_format_frame_bytes(cfg.format, w, h));
+                uint8_t* px = buf->pixels();
+                switch (cfg.format) {
+                    case PixelFormat::BGR:
+                        fill_bgr(row, h, px);
+                        break;
+                    case PixelFormat::GRAY:
+                        for (int y = 0; y < h; ++y) std::memcpy(px + static_cast<size_t>(y) * sw, row.data(), sw);
+                        break;
+                    case PixelFormat::YUYV:
+                        for (int y = 0; y < h; ++y) {
+                            uint8_t* d = px + static_cast<size_t>(y) * sw * 2;
+                            for (size_t x = 0; x < sw; x += 2) {
+                                d[x * 2 + 0] = studio_luma(row[x]);
+                                d[x * 2 + 1] = chroma_u(row[x]);
+                                d[x * 2 + 2] = studio_luma(row[x + 1]);
+                                d[x * 2 + 3] = chroma_v(row[x]);
+                            }
+                        }
+                        break;
+                    case PixelFormat::NV12: {
+                        for (int y = 0; y < h; ++y) {
+                            uint8_t* d = px + static_cast<size_t>(y) * sw;
+                            for (size_t x = 0; x < sw; ++x) d[x] = studio_luma(row[x]);
+                        }
+                        uint8_t* uv = px + sw * static_cast<size_t>(h);
+                        for (int y = 0; y < h / 2; ++y) {
+                            uint8_t* d = uv + static_cast<size_t>(y) * sw;
+                            for (size_t x = 0; x < sw; x += 2) {
+                                d[x] = chroma_u(row[x]);
+                                d[x + 1] = chroma_v(row[x]);
+                            }
+                        }
+                        break;
+                    }
+                    case PixelFormat::MJPG:
+#ifdef USE_LIBJPEG
+                        bgr.resize(sw * static_cast<size_t>(h) * 3);
+                        fill_bgr(row, h, bgr.data());
+                        encoder.encode(bgr.data(), w, h, 3, 85, jpeg);
+                        buf->prepare(PixelFormat::MJPG, w, h, jpeg.size());
+                        std::memcpy(buf->pixels(), jpeg.data(), jpeg.size());
+#endif
+                        break;
+                }
+                buf->timestamp = now_seconds();
+                publish(std::move(buf));
+            }
+            if (!_pace.sleep_until(schedule.next())) break;
+            schedule.advance(Clock::now());
+        }
+    }
+
+    static void fill_bgr(const std::vector<uint8_t>& row, int h, uint8_t* px) {
+        const size_t w = row.size();
+        for (int y = 0; y < h; ++y) {
+            uint8_t* d = px + static_cast<size_t>(y) * w * 3;
+            for (size_t x = 0; x < w; ++x) {
+                d[x * 3 + 0] = row[x];
+                d[x * 3 + 1] = static_cast<uint8_t>(255 - row[x]);
+                d[x * 3 + 2] = row[x];
+            }
+        }
+    }
+
+    // Synthetic YUV: luma follows the gradient, chroma swings around neutral
+    static uint8_t studio_luma(uint8_t v) { return static_cast<uint8_t>(16 + v * 219 / 255); }
+    static uint8_t chroma_u(uint8_t v) { return static_cast<uint8_t>(64 + v / 2); }
+    static uint8_t chroma_v(uint8_t v) { return static_cast<uint8_t>(191 - v / 2); }
+
+    // Read-only NumPy view of a pooled frame. A capsule holds a shared
+    // reference, keeping the buffer out of the capture thread's reach until
+    // the array is released. The BGR view of a non-BGR frame is converted
+    // once (without the GIL) and cached with the buffer.
+    static py::array wrap_frame(const std::shared_ptr<FrameBuffer>& frame, bool native) {
+        auto* holder = new std::shared_ptr<FrameBuffer>(frame);
+        py::capsule owner(holder, [](void* p) { delete static_cast<std::shared_ptr<FrameBuffer>*>(p); });
+        if (native && frame->format != PixelFormat::BGR) {
+            auto dims = pixel_format_shape(frame->format, frame->width, frame->height, frame->bytes);
+            std::vector<py::ssize_t> shape(dims.begin(), dims.end());
+            py::array arr(py::dtype::of<uint8_t>(), shape, frame->pixels(), owner);
+            arr.attr("flags").attr("writeable") = false;
+            return arr;
+        }
+        const uint8_t* px;
+        {
+            py::gil_scoped_release release;
+            px = frame->bgr();
+        }
+        auto shape = std::vector<py::ssize_t>{frame->height, frame->width, 3};
+        auto strides = std::vector<py::ssize_t>{static_cast<py::ssize_t>(frame->width * 3), 3, 1};
+        py::array arr(py::dtype::of<uint8_t>(), shape, strides, px, owner);
+        arr.attr("flags").attr("writeable") = false;
+        return arr;
+    }
+
+    static py::object wrap_preview(const std::shared_ptr<const EncodedFrame>& frame) {
+        if (!frame) {
+            return py::none();
+        }
+        py::bytes data(reinterpret_cast<const char*>(frame->data.data()), frame->data.size());
+        return py::make_tuple(data, frame->seq, frame->timestamp);
+    }
+
+    // Capture thread: buf has been filled, prepare()d and timestamped
+    void publish(std::shared_ptr<FrameBuffer> buf) {
+        _stats.interarrival.mark(buf->timestamp);
+        std::shared_ptr<FrameRecorder> rec;
+        std::shared_ptr<FrameEncoder> enc;
+        std::shared_ptr<FrameAnalyzer> analyzer;
+        std::shared_ptr<FlightFrameRecorder> flight;
+        bool shm;
+        {
+            std::lock_guard<std::mutex> g(_sink_mtx);
+            rec = _recorder;
+            enc = _encoder;
+            analyzer = _analyzer;
+            shm = _shm != nullptr;
+            if (buf->format == PixelFormat::MJPG) flight = _flight;
+        }
+        // Hand over after publish so the frame carries its seq
+        auto frame = buf;
+        _pool.publish(std::move(buf));
+        _frame_index.push(frame->seq, frame->timestamp);
+        if (!rec && !enc && !analyzer && !shm && !flight) return;
+        if (shm) publish_shm(*frame);
+        if (flight) {
+            flight->push(frame->pixels(), frame->bytes, static_cast<uint32_t>(PixelFormat::MJPG), frame->width,
+                         frame->height, frame->timestamp, frame->seq);
+        }
+        if (rec) rec->push(frame);
+        if (analyzer) analyzer->push(frame);
+        if (enc) enc->push(std::move(frame));
+    }
+
+    // Copied on the capture thread; readers see the frame as soon as this returns
+    void publish_shm(const FrameBuffer& f) {
+        std::lock_guard<std::mutex> g(_sink_mtx);
+        if (!_shm) return;
+        _shm->push(f.pixels(), f.bytes, pixel_format_name(f.format),
+                   pixel_format_shape(f.format, f.width, f.height, f.bytes), f.timestamp, f.seq);
+    }
+
+    int _device_id;
     std::atomic<bool> _running;
-    std::atomic<bool> _connected;
-    bool _use_real_hardware;
     std::thread _thread;
-    SpscRing _queue;
-    uint32_t _rng{0x12345678};
-    
-#ifdef USE_SHIMMER_CAPI
-    void* _shimmer_handle; // Shimmer C-API handle
-#endif
+    std::mutex _lifecycle_mtx;  // start/stop may be called without the GIL
+    WebcamConfig _config;       // guarded by _lifecycle_mtx; the capture thread works on a copy
+    std::optional<ReplayConfig> _replay_config;  // likewise
+    ReplayCounters _replay_counters;
+    std::atomic<const char*> _backend{""};
+    DeadlineTimer _pace;        // frame pacing of the synthetic source; cancelled by stop_capture
+    FramePool _pool;
+    // Raised by the sinks as they finish each frame; paces unthrottled replay
+    std::shared_ptr<FrameReleaseSignal> _released{std::make_shared<FrameReleaseSignal>()};
+    FrameIndexRing _frame_index{1024};
+    WebcamStreamStats _stats;
+    std::mutex _sink_mtx;  // guards _recorder, _encoder, _analyzer, _shm and _flight
+    std::shared_ptr<FrameRecorder> _recorder;
+    std::shared_ptr<FrameEncoder> _encoder;
+    std::shared_ptr<FrameAnalyzer> _analyzer;
+    std::unique_ptr<ShmFrameWriter> _shm;
+    std::shared_ptr<FlightFrameRecorder> _flight;  // shared with the encoder thread
+    EncodedPreview _preview;
 };
 
-class NativeWebcam {
+// Read-only NumPy view of shared memory, kept mapped by owner
+inline py::array shm_view(const py::dtype& dtype, const std::vector<py::ssize_t>& shape, const void* ptr,
+                          py::handle owner) {
+    py::array arr(dtype, shape, ptr, owner);
+    arr.attr("flags").attr("writeable") = false;
+    return arr;
+}
+
+inline py::object flight_stats_object(const std::optional<FlightRecorderStats>& s) {
+    if (!s) return py::none();
+    return flight_stats_dict(*s);
+}
+
+inline py::dict replay_stats_dict(const ReplayStats& s) {
+    py::dict out;
+    out["path"] = s.config.path;
+    out["speed"] = s.config.speed;
+    out["loop"] = s.config.loop;
+    out["rows"] = s.rows;
+    out["replayed"] = s.replayed;
+    out["passes"] = s.passes;
+    out["skipped"] = s.skipped;
+    out["finished"] = s.finished;
+    return out;
+}
+
+inline py::object replay_stats_object(const std::optional<ReplayStats>& s) {
+    if (!s) return py::none();
+    return replay_stats_dict(*s);
+}
+
+inline py::object shm_stats_object(const std::optional<ShmWriterStats>& s) {
+    if (!s) return py::none();
+    return shm_stats_dict(*s);
+}
+
+// Joins the GSR of several Shimmers onto the frames of several webcams on
+// a native "sync" thread (see stream_sync.h). The thread follows each
+// device's ring and each webcam's frame index with its own readers, so it
+// never holds frames and never competes with other consumers.
+class NativeSynchronizer {
 public:
-    explicit NativeWebcam(int device_id = 0)
-        : _device_id(device_id), _running(false) {
-        _width = 640; _height = 480;
-        _buffer.resize(static_cast<size_t>(_width * _height * 3));
+    static constexpr auto kPollInterval = std::chrono::milliseconds(10);
+
+    // owners keeps the Python objects behind the pointers alive as long as the synchronizer
+    NativeSynchronizer(std::vector<NativeShimmer*> shimmers, std::vector<NativeWebcam*> webcams,
+                       const SyncConfig& cfg, std::vector<py::object> owners = {})
+        : _owners(std::move(owners)), _shimmers(std::move(shimmers)), _webcams(std::move(webcams)),
+          _joiner(_shimmers.size(), _webcams.size(), cfg, SAMPLE_AFTER_GAP) {
+        if (_shimmers.empty() || _webcams.empty()) {
+            throw std::invalid_argument("a synchronizer needs at least one Shimmer and one webcam");
+        }
     }
 
-    void start_capture() {
+    ~NativeSynchronizer() {
+        stop();
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        _recorder.reset();
+    }
+
+    size_t devices() const { return _shimmers.size(); }
+    size_t cameras() const { return _webcams.size(); }
+
+    // Follow the streams from now on; samples and frames published while
+    // stopped are not joined
+    void start() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
         if (_running.load()) return;
+        _sample_readers.clear();
+        _frame_readers.clear();
+        for (NativeShimmer* s : _shimmers) _sample_readers.push_back(s->ring().make_reader());
+        for (NativeWebcam* w : _webcams) _frame_readers.push_back(w->frame_index().make_reader());
+        _readers_dropped = 0;
+        _timer.rearm();
         _running.store(true);
-        _thread = std::thread([this]() { this->run_loop(); });
+        _thread = spawn_thread("sync", "sync", [this] { run_loop(); });
     }
 
-    void stop_capture() {
+    // Join what has arrived, then flush frames still waiting for a device
+    void stop() {
+        std::lock_guard<std::mutex> lifecycle(_lifecycle_mtx);
+        if (!_running.load()) return;
         _running.store(false);
+        _timer.cancel();
         if (_thread.joinable()) _thread.join();
+        poll(true);
     }
 
-    py::array get_latest_frame() {
-        std::lock_guard<std::mutex> g(_mtx);
-        // Expose zero-copy numpy array referencing internal buffer
-        auto shape = std::vector<ssize_t>{_height, _width, 3};
-        auto strides = std::vector<ssize_t>{static_cast<ssize_t>(_width * 3), 3, 1};
-        return py::array(py::buffer_info(
-            _buffer.data(),                       // ptr
-            sizeof(uint8_t),                      // itemsize
-            py::format_descriptor<uint8_t>::format(),
-            3, shape, strides
-        ));
+    bool running() const { return _running.load(); }
+
+    JoinedColumns pop(size_t camera) {
+        if (camera >= _webcams.size()) {
+            throw std::out_of_range("camera index out of range");
+        }
+        std::lock_guard<std::mutex> g(_join_mtx);
+        return _joiner.pop(camera);
+    }
+
+    SyncStats stats() const {
+        std::lock_guard<std::mutex> g(_join_mtx);
+        SyncStats s = _joiner.stats();
+        s.dropped = _dropped.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // Record every frame joined from now on (without its sample window)
+    void start_recording(const std::string& path, const std::string& sync) {
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        if (_recorder) {
+            throw std::runtime_error("Synchronizer recording already in progress");
+        }
+        _recorder = std::make_shared<JoinRecorder>(path, _shimmers.size(), parse_recorder_sync(sync));
+    }
+
+    RecorderStats stop_recording() {
+        std::shared_ptr<JoinRecorder> rec;
+        {
+            std::lock_guard<std::mutex> g(_recorder_mtx);
+            rec = std::move(_recorder);
+        }
+        if (!rec) return {};
+        rec->stop();
+        return rec->stats();
+    }
+
+    bool is_recording() const {
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        return _recorder != nullptr;
+    }
+
+    RecorderStats recording_stats() const {
+        std::lock_guard<std::mutex> g(_recorder_mtx);
+        return _recorder ? _recorder->stats() : RecorderStats{};
     }
 
 private:
     void run_loop() {
-#ifdef USE_OPENCV
-        // Optional OpenCV path
-        cv::VideoCapture cap(_device_id);
-        if (cap.isOpened()) {
-            cap.set(cv::CAP_PROP_FRAME_WIDTH, _width);
-            cap.set(cv::CAP_PROP_FRAME_HEIGHT, _height);
-            cv::Mat frame;
-            while (_running.load()) {
-                if (cap.read(frame)) {
-                    if (frame.empty()) continue;
-                    if (frame.cols != _width || frame.rows != _height) {
-                        cv::resize(frame, frame, cv::Size(_width, _height));
-                    }
-                    std::lock_guard<std::mutex> g(_mtx);
-                    if (frame.channels() == 3) {
-                        std::memcpy(_buffer.data(), frame.data, _buffer.size());
-                    } else {
-                        // convert to BGR
-                        cv::Mat bgr;
-                        cv::cvtColor(frame, bgr, cv::COLOR_GRAY2BGR);
-                        std::memcpy(_buffer.data(), bgr.data, _buffer.size());
-                    }
-                } else {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
-                }
-            }
-            cap.release();
-            return;
-        }
-#endif
-        // Synthetic moving gradient if OpenCV not available or camera failed
-        auto t0 = Clock::now();
+        auto deadline = DeadlineTimer::Clock::now();
         while (_running.load()) {
-            auto dt = std::chrono::duration<double>(Clock::now() - t0).count();
-            int shift = static_cast<int>(std::fmod(dt * 60.0, static_cast<double>(_width)));
-            std::lock_guard<std::mutex> g(_mtx);
-            for (int y = 0; y < _height; ++y) {
-                for (int x = 0; x < _width; ++x) {
-                    int xx = (x + shift) % _width;
-                    uint8_t v = static_cast<uint8_t>((xx * 255) / _width);
-                    size_t idx = static_cast<size_t>((y * _width + x) * 3);
-                    _buffer[idx + 0] = v;
-                    _buffer[idx + 1] = static_cast<uint8_t>(255 - v);
-                    _buffer[idx + 2] = v;
+            poll(false);
+            deadline += kPollInterval;
+            if (!_timer.sleep_until(deadline)) break;
+        }
+    }
+
+    // Sync thread, or stop() once the thread has been joined
+    void poll(bool flush) {
+        std::shared_ptr<JoinRecorder> rec;
+        {
+            std::lock_guard<std::mutex> g(_recorder_mtx);
+            rec = _recorder;
+        }
+        {
+            std::lock_guard<std::mutex> g(_join_mtx);
+            for (size_t d = 0; d < _shimmers.size(); ++d) read_samples(d);
+            for (size_t c = 0; c < _webcams.size(); ++c) read_frames(c);
+            _fresh = JoinedColumns(_shimmers.size());
+            _joiner.join(flush, rec ? &_fresh : nullptr);
+        }
+        if (rec && _fresh.size()) {
+            rec->push(_fresh);
+            if (flush) rec->kick();
+        }
+        uint64_t dropped = 0;
+        for (size_t d = 0; d < _sample_readers.size(); ++d) dropped += _sample_readers[d]->dropped();
+        for (size_t c = 0; c < _frame_readers.size(); ++c) dropped += _frame_readers[c]->dropped();
+        _dropped.fetch_add(dropped - _readers_dropped, std::memory_order_relaxed);
+        _readers_dropped = dropped;
+    }
+
+    // Requires _join_mtx. Rows without GSR are skipped; a gap they follow
+    // is carried onto the next GSR row.
+    void read_samples(size_t d) {
+        ShimmerRing& ring = _shimmers[d]->ring();
+        auto& reader = *_sample_readers[d];
+        _ts.resize(ring.capacity());
+        _gsr.resize(ring.capacity());
+        _flags.resize(ring.capacity());
+        while (true) {
+            const size_t n = ring.read(reader, _ts.size(), nullptr, nullptr, _ts.data(), _gsr.data(), nullptr,
+                                       nullptr, _flags.data());
+            if (n == 0) break;
+            size_t kept = 0;
+            uint32_t carried = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (!(_flags[i] & SAMPLE_HAS_GSR)) {
+                    carried |= _flags[i] & SAMPLE_AFTER_GAP;
+                    continue;
                 }
+                _ts[kept] = _ts[i];
+                _gsr[kept] = _gsr[i];
+                _flags[kept] = _flags[i] | carried;
+                carried = 0;
+                ++kept;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            _joiner.add_samples(d, _ts.data(), _gsr.data(), _flags.data(), kept);
+            if (n < _ts.size()) break;
         }
     }
 
-    int _device_id;
-    std::atomic<bool> _running;
+    // Requires _join_mtx
+    void read_frames(size_t c) {
+        FrameIndexRing& ring = _webcams[c]->frame_index();
+        auto& reader = *_frame_readers[c];
+        _seq.resize(ring.capacity());
+        _frame_ts.resize(ring.capacity());
+        while (true) {
+            const size_t n = ring.read(reader, _seq.size(), _seq.data(), _frame_ts.data());
+            for (size_t i = 0; i < n; ++i) _joiner.add_frame(c, _seq[i], _frame_ts[i]);
+            if (n < _seq.size()) break;
+        }
+    }
+
+    std::vector<py::object> _owners;  // released last, with the GIL held by the deallocating binding
+    const std::vector<NativeShimmer*> _shimmers;
+    const std::vector<NativeWebcam*> _webcams;
+    std::mutex _lifecycle_mtx;
+    std::atomic<bool> _running{false};
     std::thread _thread;
-    std::mutex _mtx;
-    int _width{640};
-    int _height{480};
-    std::vector<uint8_t> _buffer;
+    DeadlineTimer _timer;  // paces run_loop; cancelled by stop()
+    mutable std::mutex _join_mtx;  // guards _joiner and the scratch buffers below
+    StreamJoiner _joiner;
+    std::vector<std::unique_ptr<ShimmerRing::Reader>> _sample_readers;  // replaced by start() only
+    std::vector<std::unique_ptr<FrameIndexRing::Reader>> _frame_readers;
+    uint64_t _readers_dropped{0};  // losses of the current readers already added to _dropped
+    std::atomic<uint64_t> _dropped{0};
+    std::vector<double> _ts, _gsr, _frame_ts;
+    std::vector<uint32_t> _flags;
+    std::vector<uint64_t> _seq;
+    JoinedColumns _fresh;
+    mutable std::mutex _recorder_mtx;
+    std::shared_ptr<JoinRecorder> _recorder;
 };
 
+inline SyncConfig make_sync_config(double max_delay, double buffer_seconds, size_t capacity) {
+    SyncConfig cfg;
+    cfg.max_delay = max_delay;
+    cfg.buffer_seconds = buffer_seconds;
+    cfg.capacity = capacity;
+    validate_sync_config(cfg);
+    return cfg;
+}
+
+inline py::dict sync_stats_dict(const SyncStats& s) {
+    py::dict out;
+    out["frames"] = s.frames;
+    out["forced"] = s.forced;
+    out["samples"] = s.samples;
+    out["trimmed"] = s.trimmed;
+    out["out_of_order"] = s.out_of_order;
+    out["overwritten"] = s.overwritten;
+    out["pending"] = s.pending;
+    out["dropped"] = s.dropped;
+    return out;
+}
+
+// Per-device columns become (frames, devices) arrays; windows one array per device
+inline py::dict joined_columns_dict(const JoinedColumns& j) {
+    const std::vector<py::ssize_t> shape{static_cast<py::ssize_t>(j.size()), static_cast<py::ssize_t>(j.devices)};
+    py::list window_ts, window_gsr;
+    for (size_t d = 0; d < j.devices; ++d) {
+        window_ts.append(ShimmerColumns::to_numpy(j.window_ts[d]));
+        window_gsr.append(ShimmerColumns::to_numpy(j.window_gsr[d]));
+    }
+    py::dict out;
+    out["seq"] = ShimmerColumns::to_numpy(j.seq);
+    out["timestamp"] = ShimmerColumns::to_numpy(j.timestamp);
+    out["gsr_us"] = py::array_t<double>(shape, j.gsr_us.data());
+    out["window_count"] = py::array_t<uint32_t>(shape, j.window_count.data());
+    out["window_mean"] = py::array_t<double>(shape, j.window_mean.data());
+    out["window_start"] = py::array_t<uint64_t>(shape, j.window_start.data());
+    out["window_ts"] = window_ts;
+    out["window_gsr"] = window_gsr;
+    return out;
+}
+
 PYBIND11_MODULE(native_backend, m) {
     m.doc() = "Native backend for PC Controller: Shimmer C-API integration and Webcam with production features";
 
     py::class_<NativeShimmer>(m, "NativeShimmer")
-        .def(py::init<>())
-        .def("connect", &NativeShimmer::connect, py::arg("port"),
+        .def(py::init<size_t>(), py::arg("ring_capacity") = 4096,
+             "Create a Shimmer device; ring_capacity (rounded up to a power of two) bounds undrained samples")
+        .def("connect", &NativeShimmer::connect, py::arg("port"), py::call_guard<py::gil_scoped_release>(),
              "Connect to Shimmer device at specified port (e.g., COM3, /dev/ttyUSB0, or Bluetooth MAC)")
-        .def("start_streaming", &NativeShimmer::start_streaming,
+        .def("start_streaming", &NativeShimmer::start_streaming, py::call_guard<py::gil_scoped_release>(),
              "Start GSR data streaming at 128 Hz using Shimmer C-API")
-        .def("stop_streaming", &NativeShimmer::stop_streaming,
+        .def("stop_streaming", &NativeShimmer::stop_streaming, py::call_guard<py::gil_scoped_release>(),
              "Stop GSR data streaming")
-        .def("get_latest_samples", &NativeShimmer::get_latest_samples,
+        .def("get_latest_samples", &NativeShimmer::get_latest_samples, py::call_guard<py::gil_scoped_release>(),
              "Pop latest (timestamp_seconds, gsr_microsiemens) samples from hardware")
-        .def("is_connected", &NativeShimmer::is_connected,
+        .def("get_latest_samples_array", &NativeShimmer::get_latest_samples_array,
+             "Pop latest samples as a (timestamps, gsr_microsiemens) tuple of float64 NumPy arrays")
+        .def("drain_into", &NativeShimmer::drain_into, py::arg("ts_out"), py::arg("vals_out"),
+             "Pop latest samples into preallocated contiguous float64 arrays; returns the number written")
+        .def("get_latest_channels", &NativeShimmer::get_latest_channels,
+             "Pop latest samples as a dict of column arrays: device_ts, host_ts, aligned_ts, gsr_us, gsr_raw, "
+             "ppg_raw, flags")
+        .def("is_connected", &NativeShimmer::is_connected, py::call_guard<py::gil_scoped_release>(),
              "Check if device is connected")
-        .def("get_device_info", &NativeShimmer::get_device_info,
-             "Get device information string from Shimmer hardware");
+        .def("wait_for_samples", &NativeShimmer::wait_for_samples, py::arg("min_count") = 1, py::arg("timeout_ms") = 100,
+             py::call_guard<py::gil_scoped_release>(),
+             "Block without the GIL until min_count samples are buffered or timeout; returns samples available")
+        .def("dropped_samples", &NativeShimmer::dropped_samples, py::call_guard<py::gil_scoped_release>(),
+             "Number of samples overwritten in the ring before they were drained")
+        .def("subscribe",
+             [](NativeShimmer& self, py::function callback, size_t batch_size, double max_latency_ms) {
+                 auto sub = make_subscription(std::move(callback), batch_size, max_latency_ms, self.ring().capacity());
+                 py::gil_scoped_release nogil;
+                 return self.subscribe(std::move(sub));
+             },
+             py::arg("callback"), py::arg("batch_size") = 32, py::arg("max_latency_ms") = 50.0,
+             "Call callback(channels) from a native thread with every new sample, batch_size at a time or after "
+             "max_latency_ms; channels has the keys of get_latest_channels(). Returns a subscription id")
+        .def("unsubscribe", &NativeShimmer::unsubscribe, py::arg("id"), py::call_guard<py::gil_scoped_release>(),
+             "Stop a subscription; returns False if the id is unknown")
+        .def("get_subscriptions",
+             [](const NativeShimmer& self) {
+                 py::list out;
+                 for (const SubscriptionSnapshot& s : self.subscriptions()) out.append(subscription_dict(s));
+                 return out;
+             },
+             "Per subscription: id, batch_size, max_latency_ms, batches, samples, dropped, errors and the "
+             "receive-to-callback latency histogram")
+        .def("ring_capacity", &NativeShimmer::ring_capacity, py::call_guard<py::gil_scoped_release>(),
+             "Ring buffer capacity in samples")
+        .def("get_device_info", &NativeShimmer::get_device_info, py::call_guard<py::gil_scoped_release>(),
+             "Get device information string from Shimmer hardware")
+        .def("set_gsr_calibration",
+             [](NativeShimmer& self, const std::vector<double>& rf_kohm, double vref, double v_bias) {
+                 self.set_gsr_calibration(make_gsr_calibration(rf_kohm, vref, v_bias));
+             },
+             py::arg("rf_kohm") = std::vector<double>{}, py::arg("vref") = 3.0, py::arg("v_bias") = 0.5,
+             "Set the feedback resistors (kOhm, ranges 0-3), ADC reference and bias voltage used for new samples")
+        .def("get_gsr_calibration", &NativeShimmer::get_gsr_calibration,
+             "Return the active GSR calibration as a dict")
+        .def("start_recording", &NativeShimmer::start_recording, py::arg("path"), py::arg("sync") = "close",
+             py::call_guard<py::gil_scoped_release>(),
+             "Record every channel to a chunked columnar file on a native I/O thread; sync is none, close or chunk")
+        .def("stop_recording",
+             [](NativeShimmer& self) {
+                 RecorderStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.stop_recording();
+                 }
+                 return recorder_stats_dict(stats);
+             },
+             "Flush and close the recording; returns a dict of rows, chunks, bytes and dropped")
+        .def("is_recording", &NativeShimmer::is_recording, py::call_guard<py::gil_scoped_release>(),
+             "True while a native recording is active")
+        .def("recording_stats", [](const NativeShimmer& self) { return recorder_stats_dict(self.recording_stats()); },
+             "Progress of the active recording as a dict of rows, chunks, bytes and dropped")
+        .def("enable_lsl",
+             [](NativeShimmer& self, const std::string& stream_name, size_t chunk_size, double max_latency_ms,
+                const std::string& source_id, const std::string& device_id) {
+                 self.enable_lsl({stream_name, source_id, 0.0, chunk_size, max_latency_ms, device_id});
+             },
+             py::arg("stream_name"), py::arg("chunk_size") = 1, py::arg("max_latency_ms") = 10.0,
+             py::arg("source_id") = "", py::arg("device_id") = "", py::call_guard<py::gil_scoped_release>(),
+             "Publish GSR and PPG as an LSL stream from a native thread, stamped with the aligned device clock; "
+             "chunks of chunk_size samples, or fewer once the oldest has waited max_latency_ms. A non-empty "
+             "device_id is added to the stream description")
+        .def("disable_lsl",
+             [](NativeShimmer& self) {
+                 LslOutletStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.disable_lsl();
+                 }
+                 return lsl_outlet_stats_dict(stats);
+             },
+             "Push pending samples and close the LSL stream; returns its final statistics")
+        .def("get_lsl_stats",
+             [](const NativeShimmer& self) -> py::object {
+                 auto stats = self.lsl_stats();
+                 if (!stats) return py::none();
+                 return lsl_outlet_stats_dict(*stats);
+             },
+             "LSL outlet samples, chunks, dropped, has_consumers and push latency histogram, or None if disabled")
+        .def("enable_eda",
+             [](NativeShimmer& self, double lowpass_hz, double tonic_hz, double onset_threshold_us,
+                double min_amplitude_us, double max_rise_s) {
+                 self.enable_eda({0.0, lowpass_hz, tonic_hz, onset_threshold_us, min_amplitude_us, max_rise_s});
+             },
+             py::arg("lowpass_hz") = 1.0, py::arg("tonic_hz") = 0.05, py::arg("onset_threshold_us") = 0.01,
+             py::arg("min_amplitude_us") = 0.05, py::arg("max_rise_s") = 5.0, py::call_guard<py::gil_scoped_release>(),
+             "Split every new GSR sample into tonic and phasic levels and detect skin conductance responses "
+             "natively, O(1) per sample; drain with get_eda_features() and get_scr_events()")
+        .def("disable_eda", [](NativeShimmer& self) { return eda_state_dict(self.disable_eda()); },
+             "Stop the EDA stage, discarding undrained output; returns its final state")
+        .def("get_eda_state", [](const NativeShimmer& self) { return eda_state_dict(self.eda_state()); },
+             "EDA stage config, samples, responses, drop counts and the latest tonic and phasic levels")
+        .def("get_eda_features",
+             [](NativeShimmer& self) {
+                 EdaFeatureColumns cols;
+                 {
+                     py::gil_scoped_release release;
+                     cols = self.pop_eda_features();
+                 }
+                 return cols.to_dict();
+             },
+             "Pop EDA features as a dict of arrays: aligned_ts, cleaned, tonic, phasic (uS)")
+        .def("get_scr_events",
+             [](NativeShimmer& self) {
+                 ScrEventColumns cols;
+                 {
+                     py::gil_scoped_release release;
+                     cols = self.pop_scr_events();
+                 }
+                 return cols.to_dict();
+             },
+             "Pop detected SCRs as a dict of arrays: onset_ts, peak_ts (aligned s), amplitude (uS), rise_time (s), "
+             "tonic (uS at the peak)")
+        .def("enable_shm", &NativeShimmer::enable_shm, py::arg("name"), py::arg("capacity") = 0,
+             py::call_guard<py::gil_scoped_release>(),
+             "Publish every new sample into the named shared-memory segment for other processes "
+             "(ShmStreamReader); capacity 0 uses the ring capacity")
+        .def("disable_shm", [](NativeShimmer& self) { return shm_stats_dict(self.disable_shm()); },
+             "Close the shared segment and remove its name; returns its final statistics")
+        .def("get_shm_stats", [](const NativeShimmer& self) { return shm_stats_object(self.shm_stats()); },
+             "Shared segment name, capacity, segment_bytes, published rows and per-reader pid, cursor and lag, "
+             "or None if disabled")
+        .def("enable_flight_recorder", &NativeShimmer::enable_flight_recorder, py::arg("path"),
+             py::arg("minutes") = 5.0, py::call_guard<py::gil_scoped_release>(),
+             "Journal the last `minutes` of samples in a memory-mapped file that survives a crash; "
+             "recover it with pc_controller.src.data.flight_recorder")
+        .def("disable_flight_recorder",
+             [](NativeShimmer& self) {
+                 FlightRecorderStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.disable_flight_recorder();
+                 }
+                 return flight_stats_dict(stats);
+             },
+             "Flush and close the journal, marking it clean; returns its final statistics")
+        .def("get_flight_recorder_stats",
+             [](const NativeShimmer& self) { return flight_stats_object(self.flight_recorder_stats()); },
+             "Journal path, file_bytes, capacity (rows kept) and written rows, or None if disabled")
+        .def("enable_plot_cache", &NativeShimmer::enable_plot_cache, py::arg("fanout") = 8,
+             py::call_guard<py::gil_scoped_release>(),
+             "Keep every new (aligned_ts, gsr_us) sample in a min/max decimation pyramid for plotting")
+        .def("disable_plot_cache", [](NativeShimmer& self) { return plot_cache_state_dict(self.disable_plot_cache()); },
+             "Free the plot cache; returns its final state")
+        .def("get_plot_cache_state",
+             [](const NativeShimmer& self) { return plot_cache_state_dict(self.plot_cache_state()); },
+             "Plot cache enabled, fanout, samples, levels, skipped, memory_bytes, first_ts and last_ts")
+        .def("query_plot_cache",
+             [](const NativeShimmer& self, double t0, double t1, size_t max_points, const std::string& method) {
+                 DecimationMethod m = parse_decimation_method(method);
+                 std::vector<double> ts, vals;
+                 {
+                     py::gil_scoped_release release;
+                     self.query_plot_cache(t0, t1, max_points, m, ts, vals);
+                 }
+                 return decimated_tuple(ts, vals);
+             },
+             py::arg("t0") = -std::numeric_limits<double>::infinity(),
+             py::arg("t1") = std::numeric_limits<double>::infinity(), py::arg("max_points") = 2000,
+             py::arg("method") = "minmax",
+             "At most max_points (aligned_ts, gsr_us) points of [t0, t1] as float64 arrays, min/max or LTTB "
+             "decimated, in O(log n + max_points)")
+        .def("configure_simulation",
+             [](NativeShimmer& self, double rate_hz, uint64_t seed, double dropout_rate, double timeout_rate,
+                double timeout_ms, double drift_ppm, bool unpaced, double disconnect_rate, double disconnect_ms) {
+                 SimulatorConfig cfg = make_simulator_config(rate_hz, seed, dropout_rate, timeout_rate, timeout_ms,
+                                                             drift_ppm, unpaced, disconnect_rate, disconnect_ms);
+                 py::gil_scoped_release release;
+                 self.configure_simulation(cfg);
+             },
+             py::arg("rate_hz") = 128.0, py::arg("seed") = uint64_t{0x12345678}, py::arg("dropout_rate") = 0.0,
+             py::arg("timeout_rate") = 0.0, py::arg("timeout_ms") = 100.0, py::arg("drift_ppm") = 30.0,
+             py::arg("unpaced") = false, py::arg("disconnect_rate") = 0.0, py::arg("disconnect_ms") = 1000.0,
+             "Configure the simulated device (stopped only): rate, seed, dropout probability, link stalls per "
+             "second and their length, clock drift, unpaced (as fast as possible, no wall-clock pacing), and "
+             "link losses per second and their length")
+        .def("get_simulation", &NativeShimmer::get_simulation,
+             "Simulator config plus this session's samples, dropouts, timeouts, disconnects and lost counters")
+        .def("configure_replay",
+             [](NativeShimmer& self, const std::string& path, double speed, bool loop) {
+                 self.configure_replay({path, speed, loop});
+             },
+             py::arg("path"), py::arg("speed") = 1.0, py::arg("loop") = false,
+             py::call_guard<py::gil_scoped_release>(),
+             "Stream a start_recording() file instead of the device or simulator from the next start (stopped "
+             "only): speed is a multiple of real time, 0 for as fast as the pipeline runs")
+        .def("clear_replay", &NativeShimmer::clear_replay, py::call_guard<py::gil_scoped_release>(),
+             "Go back to the device or simulator from the next start")
+        .def("get_replay", [](const NativeShimmer& self) { return replay_stats_object(self.replay_stats()); },
+             "Replay path, speed, loop, rows, replayed, passes and finished; None without a replay")
+        .def("link_state", &NativeShimmer::link_state, py::call_guard<py::gil_scoped_release>(),
+             "Connection state: idle, streaming, reconnecting or failed")
+        .def("wait_for_link_events",
+             [](NativeShimmer& self, uint64_t last_seq, int timeout_ms) {
+                 std::vector<LinkEvent> events;
+                 {
+                     py::gil_scoped_release release;
+                     events = self.wait_for_link_events(last_seq, timeout_ms);
+                 }
+                 py::list out;
+                 for (const LinkEvent& e : events) out.append(link_event_dict(e));
+                 return out;
+             },
+             py::arg("last_seq") = 0, py::arg("timeout_ms") = 100,
+             "Block (without the GIL) until link state changes newer than last_seq; returns a list of dicts with "
+             "seq, state, timestamp, attempt and message (empty on timeout)")
+        .def("set_reconnect_policy",
+             [](NativeShimmer& self, bool enabled, double initial_backoff_ms, double max_backoff_ms,
+                uint32_t max_attempts) {
+                 self.set_reconnect_policy({enabled, initial_backoff_ms, max_backoff_ms, max_attempts});
+             },
+             py::arg("enabled") = true, py::arg("initial_backoff_ms") = 100.0, py::arg("max_backoff_ms") = 5000.0,
+             py::arg("max_attempts") = 0,
+             "Reconnect a lost link with exponential backoff; max_attempts 0 keeps trying, enabled=False fails at once")
+        .def("get_reconnect_policy",
+             [](const NativeShimmer& self) { return reconnect_policy_dict(self.reconnect_policy()); },
+             "Reconnect policy as a dict")
+        .def("get_clock_model", [](const NativeShimmer& self) { return clock_model_dict(self.clock_model()); },
+             "Device-to-host clock fit behind aligned_ts: offset (s), drift_ppm, jitter (s), samples, resets, bins")
+        .def("get_stats", [](const NativeShimmer& self) { return shimmer_stats_dict(self.stats()); },
+             "Session counters (packets, timeouts, errors, reconnects, ring_dropped) and interarrival/drain_latency "
+             "histograms (count, min, mean, p50, p90, p99, p999, max in seconds)")
+        .def("reset_stats", &NativeShimmer::reset_stats, py::call_guard<py::gil_scoped_release>(),
+             "Restart the counters and histograms reported by get_stats()");
+
+    py::class_<NativeShimmerHub>(m, "NativeShimmerHub")
+        .def(py::init<size_t, size_t>(), py::arg("workers") = 2, py::arg("ring_capacity") = 4096,
+             "Create a hub that polls all its Shimmer devices on a fixed pool of worker threads")
+        .def("add_device", &NativeShimmerHub::add_device, py::arg("port"), py::call_guard<py::gil_scoped_release>(),
+             "Connect a device at the given port and return its index")
+        .def("discover_and_connect",
+             [](NativeShimmerHub& self, std::vector<std::string> ports, bool scan_serial, bool scan_bluetooth,
+                double timeout_s, double scan_timeout_s, size_t max_parallel) {
+                 DiscoveryConfig cfg{std::move(ports), scan_serial, scan_bluetooth, timeout_s, scan_timeout_s,
+                                     max_parallel};
+                 py::gil_scoped_release release;
+                 return std::make_unique<ShimmerConnectJob>(self, std::move(cfg));
+             },
+             py::arg("ports") = std::vector<std::string>{}, py::arg("scan_serial") = true,
+             py::arg("scan_bluetooth") = true, py::arg("timeout_s") = 20.0, py::arg("scan_timeout_s") = 15.0,
+             py::arg("max_parallel") = 8, py::keep_alive<0, 1>(),
+             "Connect ports and every scanned device concurrently in the background; returns a ShimmerConnectJob "
+             "to follow progress and collect the new device indices")
+        .def("device_count", &NativeShimmerHub::device_count, py::call_guard<py::gil_scoped_release>(),
+             "Number of devices owned by the hub")
+        .def("add_simulated_devices",
+             [](NativeShimmerHub& self, size_t count, double rate_hz, uint64_t seed, double dropout_rate,
+                double timeout_rate, double timeout_ms, double drift_ppm, bool unpaced, double disconnect_rate,
+                double disconnect_ms) {
+                 SimulatorConfig cfg = make_simulator_config(rate_hz, seed, dropout_rate, timeout_rate, timeout_ms,
+                                                             drift_ppm, unpaced, disconnect_rate, disconnect_ms);
+                 py::gil_scoped_release release;
+                 return self.add_simulated_devices(count, cfg);
+             },
+             py::arg("count"), py::arg("rate_hz") = 128.0, py::arg("seed") = uint64_t{0x12345678},
+             py::arg("dropout_rate") = 0.0, py::arg("timeout_rate") = 0.0, py::arg("timeout_ms") = 100.0,
+             py::arg("drift_ppm") = 30.0, py::arg("unpaced") = false, py::arg("disconnect_rate") = 0.0,
+             py::arg("disconnect_ms") = 1000.0,
+             "Add count simulated devices with the same settings and seeds seed, seed+1, ...; returns their indices")
+        .def("get_simulation",
+             [](const NativeShimmerHub& self, size_t index) { return self.shimmer(index).get_simulation(); },
+             py::arg("index"), "Simulator config and counters of one device")
+        .def("add_replay_devices", &NativeShimmerHub::add_replay_devices, py::arg("paths"), py::arg("speed") = 1.0,
+             py::arg("loop") = false, py::call_guard<py::gil_scoped_release>(),
+             "Add one device per Shimmer recording, each replaying it as NativeShimmer.configure_replay(); "
+             "returns their indices")
+        .def("configure_replay",
+             [](NativeShimmerHub& self, size_t index, const std::string& path, double speed, bool loop) {
+                 self.shimmer(index).configure_replay({path, speed, loop});
+             },
+             py::arg("index"), py::arg("path"), py::arg("speed") = 1.0, py::arg("loop") = false,
+             py::call_guard<py::gil_scoped_release>(), "Replay a recording on one device, as NativeShimmer")
+        .def("clear_replay", [](NativeShimmerHub& self, size_t index) { self.shimmer(index).clear_replay(); },
+             py::arg("index"), py::call_guard<py::gil_scoped_release>(), "Stop replaying on one device")
+        .def("get_replay",
+             [](const NativeShimmerHub& self, size_t index) {
+                 return replay_stats_object(self.shimmer(index).replay_stats());
+             },
+             py::arg("index"), "Replay config and progress of one device; None without a replay")
+        .def("start", &NativeShimmerHub::start, py::call_guard<py::gil_scoped_release>(),
+             "Start streaming on every device and launch the worker pool")
+        .def("stop", &NativeShimmerHub::stop, py::call_guard<py::gil_scoped_release>(),
+             "Stop the worker pool and streaming on every device")
+        .def("drain", &NativeShimmerHub::drain,
+             "Pop buffered samples as a list of per-device column dicts")
+        .def("drain_merged", &NativeShimmerHub::drain_merged, py::arg("max_lag_ms") = 250.0,
+             "Pop buffered samples of all devices as one host_ts-ordered dict of columns plus a 'device' column")
+        .def("get_device_info", &NativeShimmerHub::get_device_info, py::arg("index"),
+             py::call_guard<py::gil_scoped_release>(), "Device information string for one device")
+        .def("dropped_samples", &NativeShimmerHub::dropped_samples, py::arg("index"),
+             py::call_guard<py::gil_scoped_release>(), "Samples of one device lost before the hub drained them")
+        .def("device_failed", &NativeShimmerHub::device_failed, py::arg("index"),
+             py::call_guard<py::gil_scoped_release>(),
+             "True if the device's link failed beyond its reconnect policy and it is no longer polled")
+        .def("link_state", &NativeShimmerHub::link_state, py::arg("index"), py::call_guard<py::gil_scoped_release>(),
+             "Connection state of one device: idle, streaming, reconnecting or failed")
+        .def("subscribe",
+             [](NativeShimmerHub& self, size_t index, py::function callback, size_t batch_size,
+                double max_latency_ms) {
+                 auto sub = make_subscription(std::move(callback), batch_size, max_latency_ms, self.ring_capacity());
+                 py::gil_scoped_release nogil;
+                 return self.subscribe(index, std::move(sub));
+             },
+             py::arg("index"), py::arg("callback"), py::arg("batch_size") = 32, py::arg("max_latency_ms") = 50.0,
+             "Subscribe to one device as with NativeShimmer.subscribe(); independent of the hub drains")
+        .def("unsubscribe", &NativeShimmerHub::unsubscribe, py::arg("index"), py::arg("id"),
+             py::call_guard<py::gil_scoped_release>(), "Stop a subscription of one device")
+        .def("get_subscriptions",
+             [](const NativeShimmerHub& self, size_t index) {
+                 py::list out;
+                 for (const SubscriptionSnapshot& s : self.subscriptions(index)) out.append(subscription_dict(s));
+                 return out;
+             },
+             py::arg("index"), "Subscription counters of one device")
+        .def("enable_lsl",
+             [](NativeShimmerHub& self, size_t index, const std::string& stream_name, size_t chunk_size,
+                double max_latency_ms, const std::string& source_id, const std::string& device_id) {
+                 self.enable_lsl(index, {stream_name, source_id, 0.0, chunk_size, max_latency_ms, device_id});
+             },
+             py::arg("index"), py::arg("stream_name"), py::arg("chunk_size") = 1, py::arg("max_latency_ms") = 10.0,
+             py::arg("source_id") = "", py::arg("device_id") = "", py::call_guard<py::gil_scoped_release>(),
+             "Publish one device as an LSL stream, as NativeShimmer.enable_lsl()")
+        .def("disable_lsl",
+             [](NativeShimmerHub& self, size_t index) {
+                 LslOutletStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.disable_lsl(index);
+                 }
+                 return lsl_outlet_stats_dict(stats);
+             },
+             py::arg("index"), "Close the LSL stream of one device; returns its final statistics")
+        .def("get_lsl_stats",
+             [](const NativeShimmerHub& self, size_t index) -> py::object {
+                 auto stats = self.lsl_stats(index);
+                 if (!stats) return py::none();
+                 return lsl_outlet_stats_dict(*stats);
+             },
+             py::arg("index"), "LSL outlet statistics of one device, or None if disabled")
+        .def("enable_eda",
+             [](NativeShimmerHub& self, size_t index, double lowpass_hz, double tonic_hz, double onset_threshold_us,
+                double min_amplitude_us, double max_rise_s) {
+                 self.enable_eda(index, {0.0, lowpass_hz, tonic_hz, onset_threshold_us, min_amplitude_us, max_rise_s});
+             },
+             py::arg("index"), py::arg("lowpass_hz") = 1.0, py::arg("tonic_hz") = 0.05,
+             py::arg("onset_threshold_us") = 0.01, py::arg("min_amplitude_us") = 0.05, py::arg("max_rise_s") = 5.0,
+             py::call_guard<py::gil_scoped_release>(), "Run the EDA stage on one device, as NativeShimmer.enable_eda()")
+        .def("disable_eda",
+             [](NativeShimmerHub& self, size_t index) { return eda_state_dict(self.disable_eda(index)); },
+             py::arg("index"), "Stop the EDA stage of one device; returns its final state")
+        .def("get_eda_state",
+             [](const NativeShimmerHub& self, size_t index) { return eda_state_dict(self.eda_state(index)); },
+             py::arg("index"), "EDA stage state of one device")
+        .def("get_eda_features",
+             [](NativeShimmerHub& self, size_t index) {
+                 EdaFeatureColumns cols;
+                 {
+                     py::gil_scoped_release release;
+                     cols = self.pop_eda_features(index);
+                 }
+                 return cols.to_dict();
+             },
+             py::arg("index"), "Pop EDA features of one device, as NativeShimmer.get_eda_features()")
+        .def("get_scr_events",
+             [](NativeShimmerHub& self, size_t index) {
+                 ScrEventColumns cols;
+                 {
+                     py::gil_scoped_release release;
+                     cols = self.pop_scr_events(index);
+                 }
+                 return cols.to_dict();
+             },
+             py::arg("index"), "Pop detected SCRs of one device, as NativeShimmer.get_scr_events()")
+        .def("enable_shm", &NativeShimmerHub::enable_shm, py::arg("index"), py::arg("name"), py::arg("capacity") = 0,
+             py::call_guard<py::gil_scoped_release>(), "Publish one device into a shared segment, as NativeShimmer")
+        .def("disable_shm",
+             [](NativeShimmerHub& self, size_t index) { return shm_stats_dict(self.disable_shm(index)); },
+             py::arg("index"), "Close the shared segment of one device; returns its final statistics")
+        .def("get_shm_stats",
+             [](const NativeShimmerHub& self, size_t index) { return shm_stats_object(self.shm_stats(index)); },
+             py::arg("index"), "Shared segment statistics of one device, or None if disabled")
+        .def("enable_flight_recorder", &NativeShimmerHub::enable_flight_recorder, py::arg("index"),
+             py::arg("path"), py::arg("minutes") = 5.0, py::call_guard<py::gil_scoped_release>(),
+             "Journal the last minutes of one device's samples, as NativeShimmer")
+        .def("disable_flight_recorder",
+             [](NativeShimmerHub& self, size_t index) {
+                 FlightRecorderStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.disable_flight_recorder(index);
+                 }
+                 return flight_stats_dict(stats);
+             },
+             py::arg("index"), "Flush and close one device's journal; returns its final statistics")
+        .def("get_flight_recorder_stats",
+             [](const NativeShimmerHub& self, size_t index) {
+                 return flight_stats_object(self.flight_recorder_stats(index));
+             },
+             py::arg("index"), "Journal statistics of one device, or None if disabled")
+        .def("enable_plot_cache", &NativeShimmerHub::enable_plot_cache, py::arg("index"), py::arg("fanout") = 8,
+             py::call_guard<py::gil_scoped_release>(), "Keep a plot cache of one device, as NativeShimmer")
+        .def("disable_plot_cache",
+             [](NativeShimmerHub& self, size_t index) { return plot_cache_state_dict(self.disable_plot_cache(index)); },
+             py::arg("index"), "Free the plot cache of one device; returns its final state")
+        .def("get_plot_cache_state",
+             [](const NativeShimmerHub& self, size_t index) {
+                 return plot_cache_state_dict(self.plot_cache_state(index));
+             },
+             py::arg("index"), "Plot cache state of one device")
+        .def("query_plot_cache",
+             [](const NativeShimmerHub& self, size_t index, double t0, double t1, size_t max_points,
+                const std::string& method) {
+                 DecimationMethod m = parse_decimation_method(method);
+                 std::vector<double> ts, vals;
+                 {
+                     py::gil_scoped_release release;
+                     self.query_plot_cache(index, t0, t1, max_points, m, ts, vals);
+                 }
+                 return decimated_tuple(ts, vals);
+             },
+             py::arg("index"), py::arg("t0") = -std::numeric_limits<double>::infinity(),
+             py::arg("t1") = std::numeric_limits<double>::infinity(), py::arg("max_points") = 2000,
+             py::arg("method") = "minmax", "Decimated points of one device, as NativeShimmer.query_plot_cache()")
+        .def("get_clock_model",
+             [](const NativeShimmerHub& self, size_t index) { return clock_model_dict(self.clock_model(index)); },
+             py::arg("index"), "Device-to-host clock fit of one device as a dict")
+        .def("get_stats",
+             [](const NativeShimmerHub& self, size_t index) { return shimmer_stats_dict(self.stats(index)); },
+             py::arg("index"), "Counters and latency histograms of one device; ring_dropped counts hub drains");
+
+    py::class_<ShimmerConnectJob>(m, "ShimmerConnectJob")
+        .def("progress",
+             [](const ShimmerConnectJob& self) {
+                 py::list out;
+                 for (const ConnectProgress& p : self.progress()) out.append(connect_progress_dict(p));
+                 return out;
+             },
+             "One dict per device: port, source (port, serial or bluetooth), state (pending, connecting, connected, "
+             "failed, timeout or cancelled), error, elapsed (s), index in the hub once added, and seq")
+        .def("wait", &ShimmerConnectJob::wait, py::arg("timeout_ms") = -1, py::call_guard<py::gil_scoped_release>(),
+             "Block without the GIL until every device has been added or given up (forever if timeout_ms < 0); "
+             "returns done")
+        .def("wait_for_update", &ShimmerConnectJob::wait_for_update, py::arg("last_seq") = 0,
+             py::arg("timeout_ms") = 100, py::call_guard<py::gil_scoped_release>(),
+             "Block without the GIL until progress changes after last_seq or the job ends; returns the latest seq")
+        .def("result", &ShimmerConnectJob::result,
+             "Hub indices of the connected devices, in port order; raises RuntimeError while still running")
+        .def("cancel", &ShimmerConnectJob::cancel, py::call_guard<py::gil_scoped_release>(),
+             "Give up on pending and in-flight connects; devices already connected are still added")
+        .def_property_readonly("done", &ShimmerConnectJob::done)
+        .def_property_readonly("scanning", &ShimmerConnectJob::scanning, "True while a port scan is running");
 
     py::class_<NativeWebcam>(m, "NativeWebcam")
-        .def(py::init<int>(), py::arg("device_id") = 0,
-             "Initialize webcam with device ID (0 for default)")
-        .def("start_capture", &NativeWebcam::start_capture,
+        .def(py::init([](int device_id, int width, int height, double fps, const std::string& pixel_format) {
+                 return std::make_unique<NativeWebcam>(device_id, make_webcam_config(width, height, fps, pixel_format));
+             }),
+             py::arg("device_id") = 0, py::arg("width") = 640, py::arg("height") = 480, py::arg("fps") = 30.0,
+             py::arg("pixel_format") = "BGR",
+             "Initialize webcam with device ID (0 for default), requested frame size, rate and pixel format "
+             "(BGR, GRAY, YUYV, NV12 or MJPG)")
+        .def("configure",
+             [](NativeWebcam& self, int width, int height, double fps, const std::string& pixel_format) {
+                 self.configure(make_webcam_config(width, height, fps, pixel_format));
+             },
+             py::arg("width") = 640, py::arg("height") = 480, py::arg("fps") = 30.0, py::arg("pixel_format") = "BGR",
+             py::call_guard<py::gil_scoped_release>(), "Change the capture mode while capture is stopped")
+        .def("get_config",
+             [](NativeWebcam& self) {
+                 WebcamConfig cfg;
+                 {
+                     py::gil_scoped_release release;
+                     cfg = self.config();
+                 }
+                 py::dict d;
+                 d["width"] = cfg.width;
+                 d["height"] = cfg.height;
+                 d["fps"] = cfg.fps;
+                 d["pixel_format"] = pixel_format_name(cfg.format);
+                 return d;
+             },
+             "Requested capture mode as a dict of width, height, fps and pixel_format")
+        .def("delivered_pixel_format", &NativeWebcam::delivered_pixel_format,
+             "Pixel format of the latest frame (BGR if the camera could not provide the requested one), or None")
+        .def("start_capture", &NativeWebcam::start_capture, py::call_guard<py::gil_scoped_release>(),
              "Start video capture")
-        .def("stop_capture", &NativeWebcam::stop_capture,
+        .def("stop_capture", &NativeWebcam::stop_capture, py::call_guard<py::gil_scoped_release>(),
              "Stop video capture")
-        .def("get_latest_frame", &NativeWebcam::get_latest_frame,
-             "Return last BGR frame as a NumPy array (zero-copy)");
-    
+        .def("get_latest_frame", &NativeWebcam::get_latest_frame, py::arg("native") = false,
+             "Return last frame as a read-only NumPy array (zero-copy), or None before the first frame; BGR unless "
+             "native=True, which returns the capture format's own layout")
+        .def("get_latest_frame_with_info", &NativeWebcam::get_latest_frame_with_info, py::arg("native") = false,
+             "Return (frame, seq, timestamp) for the last frame, or None before the first frame")
+        .def("wait_for_frame", &NativeWebcam::wait_for_frame, py::arg("last_seq"), py::arg("timeout_ms") = 100,
+             py::arg("native") = false,
+             "Block without the GIL until a frame newer than last_seq arrives; returns (frame, seq, timestamp) or None")
+        .def("enable_shm", &NativeWebcam::enable_shm, py::arg("name"), py::arg("slots") = 4,
+             py::call_guard<py::gil_scoped_release>(),
+             "Copy every new frame into `slots` slots of the named shared-memory segment for other processes "
+             "(ShmFrameReader)")
+        .def("disable_shm", [](NativeWebcam& self) { return shm_stats_dict(self.disable_shm()); },
+             "Close the shared segment and remove its name; returns its final statistics")
+        .def("get_shm_stats", [](NativeWebcam& self) { return shm_stats_object(self.shm_stats()); },
+             "Shared segment statistics (oversized counts frames too large for a slot), or None if disabled")
+        .def("enable_flight_recorder", &NativeWebcam::enable_flight_recorder, py::arg("path"),
+             py::arg("frames") = 150, py::arg("max_frame_bytes") = 0, py::call_guard<py::gil_scoped_release>(),
+             "Journal the last `frames` encoded frames in a memory-mapped file that survives a crash: MJPG "
+             "frames as captured, other formats as the encode stage's JPEG while it runs; max_frame_bytes 0 "
+             "allows half a byte per pixel")
+        .def("disable_flight_recorder",
+             [](NativeWebcam& self) {
+                 FlightRecorderStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.disable_flight_recorder();
+                 }
+                 return flight_stats_dict(stats);
+             },
+             "Flush and close the journal, marking it clean; returns its final statistics")
+        .def("get_flight_recorder_stats",
+             [](NativeWebcam& self) { return flight_stats_object(self.flight_recorder_stats()); },
+             "Journal statistics (oversized counts frames larger than a record), or None if disabled")
+        .def("latest_frame_seq", &NativeWebcam::latest_frame_seq, py::call_guard<py::gil_scoped_release>(),
+             "Sequence number of the last published frame (0 before the first frame)")
+        .def("capture_backend", &NativeWebcam::capture_backend, py::call_guard<py::gil_scoped_release>(),
+             "Capture path in use: v4l2, mediafoundation, opencv, synthetic or replay (empty before start_capture)")
+        .def("configure_replay",
+             [](NativeWebcam& self, const std::string& path, double speed, bool loop) {
+                 self.configure_replay({path, speed, loop});
+             },
+             py::arg("path"), py::arg("speed") = 1.0, py::arg("loop") = false,
+             py::call_guard<py::gil_scoped_release>(),
+             "Publish the frames of a start_recording() file instead of capturing from the next start (stopped "
+             "only): speed is a multiple of real time, 0 for as fast as the pipeline runs")
+        .def("clear_replay", &NativeWebcam::clear_replay, py::call_guard<py::gil_scoped_release>(),
+             "Go back to the camera from the next start")
+        .def("get_replay", [](NativeWebcam& self) { return replay_stats_object(self.replay_stats()); },
+             "Replay path, speed, loop, rows (frames), replayed, passes, skipped and finished; None without one")
+        .def("frames_captured", &NativeWebcam::frames_captured, py::call_guard<py::gil_scoped_release>(),
+             "Number of frames published by the capture thread")
+        .def("frames_delivered", &NativeWebcam::frames_delivered, py::call_guard<py::gil_scoped_release>(),
+             "Number of distinct frames handed to get_latest_frame callers")
+        .def("frames_dropped", &NativeWebcam::frames_dropped, py::call_guard<py::gil_scoped_release>(),
+             "Frames replaced before delivery or skipped because every buffer was in use")
+        .def("get_stats", [](const NativeWebcam& self) { return webcam_stats_dict(self.stats()); },
+             "Frame counters, timeouts, errors, and interarrival/delivery_latency histograms (seconds)")
+        .def("reset_stats", &NativeWebcam::reset_stats, py::call_guard<py::gil_scoped_release>(),
+             "Restart the timeout/error counters and histograms reported by get_stats()")
+        .def("start_recording", &NativeWebcam::start_recording, py::arg("path"), py::arg("sync") = "close",
+             py::call_guard<py::gil_scoped_release>(),
+             "Record every published frame to a chunked columnar file on a native I/O thread")
+        .def("stop_recording",
+             [](NativeWebcam& self) {
+                 RecorderStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.stop_recording();
+                 }
+                 return recorder_stats_dict(stats);
+             },
+             "Flush and close the recording; returns a dict of rows, chunks, bytes and dropped")
+        .def("is_recording", &NativeWebcam::is_recording, py::call_guard<py::gil_scoped_release>(),
+             "True while a native recording is active")
+        .def("recording_stats", [](NativeWebcam& self) { return recorder_stats_dict(self.recording_stats()); },
+             "Progress of the active recording as a dict of rows, chunks, bytes and dropped")
+        .def("start_encoding",
+             [](NativeWebcam& self, const std::string& path, const std::string& codec, int quality,
+                int bitrate_kbps, double fps, int preview_interval) {
+                 EncoderOptions opts;
+                 opts.path = path;
+                 opts.codec = codec;
+                 opts.quality = quality;
+                 opts.bitrate_kbps = bitrate_kbps;
+                 opts.fps = fps;
+                 opts.preview_interval = std::max(0, preview_interval);
+                 self.start_encoding(opts);
+             },
+             py::arg("path") = "", py::arg("codec") = "mjpeg", py::arg("quality") = 85, py::arg("bitrate_kbps") = 4000,
+             py::arg("fps") = 30.0, py::arg("preview_interval") = 1, py::call_guard<py::gil_scoped_release>(),
+             "Encode frames on a dedicated thread (codec mjpeg or h264) to path; an empty path only feeds the preview")
+        .def("stop_encoding",
+             [](NativeWebcam& self) {
+                 EncoderStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.stop_encoding();
+                 }
+                 return encoder_stats_dict(stats);
+             },
+             "Flush the encoder and close its file; returns a dict of frames, bytes, dropped, errors and encode_seconds")
+        .def("is_encoding", &NativeWebcam::is_encoding, py::call_guard<py::gil_scoped_release>(),
+             "True while the encode stage is running")
+        .def("encoding_stats", [](NativeWebcam& self) { return encoder_stats_dict(self.encoding_stats()); },
+             "Progress of the encode stage as a dict of frames, bytes, dropped, errors and encode_seconds")
+        .def("get_encoded_preview", &NativeWebcam::get_encoded_preview,
+             "Return (jpeg_bytes, seq, timestamp) for the latest encoded preview, or None")
+        .def("wait_for_encoded_preview", &NativeWebcam::wait_for_encoded_preview, py::arg("last_seq"),
+             py::arg("timeout_ms") = 100,
+             "Block without the GIL until a preview newer than last_seq; returns (jpeg_bytes, seq, timestamp) or None")
+        .def("enable_frame_analysis",
+             [](NativeWebcam& self, const std::vector<std::tuple<int, int, int, int>>& rois, int thumbnail_levels,
+                size_t capacity) {
+                 self.enable_frame_analysis(make_frame_analysis_config(rois, thumbnail_levels, capacity));
+             },
+             py::arg("rois") = std::vector<std::tuple<int, int, int, int>>{}, py::arg("thumbnail_levels") = 0,
+             py::arg("capacity") = 1024, py::call_guard<py::gil_scoped_release>(),
+             "Take the mean and variance of B, G and R over each (x, y, width, height) ROI of every frame, and "
+             "thumbnails of the latest at 1/2 ... 1/2**thumbnail_levels size, on a native thread; drain with "
+             "get_roi_stats()")
+        .def("disable_frame_analysis",
+             [](NativeWebcam& self) {
+                 FrameAnalysisState state;
+                 {
+                     py::gil_scoped_release release;
+                     state = self.disable_frame_analysis();
+                 }
+                 return frame_analysis_state_dict(state);
+             },
+             "Stop the analysis stage, discarding undrained statistics; returns its final state")
+        .def("get_frame_analysis_state",
+             [](NativeWebcam& self) { return frame_analysis_state_dict(self.frame_analysis_state()); },
+             "Analysis config, frames, dropped (analyzer behind), overwritten (not drained in time), errors, "
+             "analysis_seconds and kernel")
+        .def("get_roi_stats",
+             [](NativeWebcam& self) {
+                 RoiStatsColumns cols;
+                 {
+                     py::gil_scoped_release release;
+                     cols = self.pop_roi_stats();
+                 }
+                 return cols.to_dict();
+             },
+             "Pop ROI statistics as a dict of arrays: seq, timestamp (steady_clock s, as Shimmer host_ts), and "
+             "mean and var of shape (frames, rois, 3) in B, G, R order")
+        .def("get_thumbnail",
+             [](NativeWebcam& self, int level) -> py::object {
+                 if (level < 1) {
+                     throw std::invalid_argument("level must be at least 1");
+                 }
+                 auto pyramid = self.thumbnails();
+                 if (!pyramid || static_cast<size_t>(level) > pyramid->levels.size()) {
+                     return py::none();
+                 }
+                 const Thumbnail& t = pyramid->levels[static_cast<size_t>(level) - 1];
+                 // The capsule keeps the pyramid from being reused while the array is alive
+                 auto* holder = new std::shared_ptr<const ThumbnailPyramid>(pyramid);
+                 py::capsule owner(holder, [](void* p) {
+                     delete static_cast<std::shared_ptr<const ThumbnailPyramid>*>(p);
+                 });
+                 py::array arr(py::dtype::of<uint8_t>(), std::vector<py::ssize_t>{t.height, t.width, 3}, t.bgr.data(),
+                               owner);
+                 arr.attr("flags").attr("writeable") = false;
+                 return py::make_tuple(arr, pyramid->seq, pyramid->timestamp);
+             },
+             py::arg("level") = 1,
+             "Latest BGR thumbnail at 1/2**level size as (frame, seq, timestamp), or None before the first "
+             "analyzed frame or if the frame is too small for that level");
+
+    py::class_<NativeSynchronizer>(m, "NativeSynchronizer")
+        .def(py::init([](const std::vector<py::object>& shimmer_objs, const std::vector<py::object>& webcam_objs,
+                         py::object hub_obj, double max_delay, double buffer_seconds, size_t capacity) {
+                 SyncConfig cfg = make_sync_config(max_delay, buffer_seconds, capacity);
+                 // Hold every device object itself, not the sequences that were passed in
+                 std::vector<py::object> owners;
+                 std::vector<NativeShimmer*> shimmers;
+                 std::vector<NativeWebcam*> webcams;
+                 for (const py::object& o : shimmer_objs) {
+                     shimmers.push_back(&o.cast<NativeShimmer&>());
+                     owners.push_back(o);
+                 }
+                 for (const py::object& o : webcam_objs) {
+                     webcams.push_back(&o.cast<NativeWebcam&>());
+                     owners.push_back(o);
+                 }
+                 if (!hub_obj.is_none()) {
+                     auto& hub = hub_obj.cast<NativeShimmerHub&>();
+                     for (size_t i = 0; i < hub.device_count(); ++i) shimmers.push_back(&hub.shimmer(i));
+                     owners.push_back(hub_obj);
+                 }
+                 return std::make_unique<NativeSynchronizer>(std::move(shimmers), std::move(webcams), cfg,
+                                                             std::move(owners));
+             }),
+             py::arg("shimmers") = py::list(), py::arg("webcams") = py::list(), py::arg("hub") = py::none(),
+             py::arg("max_delay") = 0.5, py::arg("buffer_seconds") = 10.0, py::arg("capacity") = 4096,
+             "Join the GSR of the given Shimmers (then every device the hub has now) onto the frames of each "
+             "webcam; a frame waits up to max_delay stream seconds for devices that are behind. capacity bounds "
+             "the joined frames kept per camera until get_joined()")
+        .def("start", &NativeSynchronizer::start, py::call_guard<py::gil_scoped_release>(),
+             "Follow samples and frames published from now on on a native sync thread")
+        .def("stop", &NativeSynchronizer::stop, py::call_guard<py::gil_scoped_release>(),
+             "Stop the sync thread and join every frame still waiting, with whatever samples have arrived")
+        .def("is_running", &NativeSynchronizer::running, "True while the sync thread is following the streams")
+        .def("get_joined",
+             [](NativeSynchronizer& self, size_t camera) {
+                 JoinedColumns j;
+                 {
+                     py::gil_scoped_release release;
+                     j = self.pop(camera);
+                 }
+                 return joined_columns_dict(j);
+             },
+             py::arg("camera") = 0,
+             "Pop the joined frames of one webcam: seq and timestamp, then (frames, devices) arrays of gsr_us "
+             "(interpolated at the frame time; NaN across a gap), window_count and window_mean (samples since the "
+             "previous frame) and window_start, which indexes the per-device window_ts and window_gsr arrays")
+        .def("get_stats",
+             [](const NativeSynchronizer& self) {
+                 SyncStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.stats();
+                 }
+                 py::dict out = sync_stats_dict(stats);
+                 out["devices"] = self.devices();
+                 out["cameras"] = self.cameras();
+                 return out;
+             },
+             "Dict of frames joined, forced (before every device caught up), samples, trimmed, out_of_order, "
+             "overwritten, pending, dropped (lost in the stream rings), devices and cameras")
+        .def("start_recording", &NativeSynchronizer::start_recording, py::arg("path"), py::arg("sync") = "close",
+             py::call_guard<py::gil_scoped_release>(),
+             "Record every frame joined from now on (camera, seq, timestamp and per device gsr_us_<d>, "
+             "window_count_<d>, window_mean_<d>) to a chunked columnar file on a native I/O thread")
+        .def("stop_recording",
+             [](NativeSynchronizer& self) {
+                 RecorderStats stats;
+                 {
+                     py::gil_scoped_release release;
+                     stats = self.stop_recording();
+                 }
+                 return recorder_stats_dict(stats);
+             },
+             "Flush and close the recording; returns a dict of rows, chunks, bytes and dropped")
+        .def("is_recording", &NativeSynchronizer::is_recording, py::call_guard<py::gil_scoped_release>(),
+             "True while a native recording is active")
+        .def("recording_stats",
+             [](const NativeSynchronizer& self) { return recorder_stats_dict(self.recording_stats()); },
+             "Progress of the active recording as a dict of rows, chunks, bytes and dropped");
+
+    py::class_<ClockModel>(m, "ClockModel")
+        .def(py::init<double, size_t, double>(), py::arg("bin_seconds") = 0.5, py::arg("window_bins") = 64,
+             py::arg("reset_threshold") = 1.0,
+             "Online drift/offset fit of a device clock against host receive times (lower-envelope regression)")
+        .def("observe",
+             [](ClockModel& self, py::array_t<double, py::array::c_style | py::array::forcecast> device_ts,
+                py::array_t<double, py::array::c_style | py::array::forcecast> host_ts) {
+                 if (device_ts.size() != host_ts.size()) {
+                     throw std::invalid_argument("device_ts and host_ts must have the same length");
+                 }
+                 py::array_t<double> out(device_ts.size());
+                 const double* d = device_ts.data();
+                 const double* h = host_ts.data();
+                 double* dst = out.mutable_data();
+                 auto n = static_cast<size_t>(device_ts.size());
+                 {
+                     py::gil_scoped_release release;
+                     for (size_t i = 0; i < n; ++i) dst[i] = self.observe(d[i], h[i]);
+                 }
+                 return out;
+             },
+             py::arg("device_ts"), py::arg("host_ts"),
+             "Feed (device, host receive) timestamp pairs in order; returns their host-aligned timestamps")
+        .def("align",
+             [](const ClockModel& self, py::array_t<double, py::array::c_style | py::array::forcecast> device_ts) {
+                 py::array_t<double> out(device_ts.size());
+                 const double* d = device_ts.data();
+                 double* dst = out.mutable_data();
+                 for (py::ssize_t i = 0; i < device_ts.size(); ++i) dst[i] = self.align(d[i]);
+                 return out;
+             },
+             py::arg("device_ts"), "Map device timestamps onto the host clock with the current fit")
+        .def("get_state", [](const ClockModel& self) { return clock_model_dict(self.state()); },
+             "Current fit as a dict of offset (s), drift_ppm, jitter (s), samples, resets and bins")
+        .def("reset", &ClockModel::reset, "Forget every observation");
+
+    py::class_<EdaProcessor>(m, "EdaProcessor")
+        .def(py::init([](double sample_rate, double lowpass_hz, double tonic_hz, double onset_threshold_us,
+                         double min_amplitude_us, double max_rise_s) {
+                 return EdaProcessor(make_eda_config(sample_rate, lowpass_hz, tonic_hz, onset_threshold_us,
+                                                     min_amplitude_us, max_rise_s));
+             }),
+             py::arg("sample_rate") = 128.0, py::arg("lowpass_hz") = 1.0, py::arg("tonic_hz") = 0.05,
+             py::arg("onset_threshold_us") = 0.01, py::arg("min_amplitude_us") = 0.05, py::arg("max_rise_s") = 5.0,
+             "Incremental tonic/phasic split and SCR detection, the stage behind NativeShimmer.enable_eda()")
+        .def("process",
+             [](EdaProcessor& self, py::array_t<double, py::array::c_style | py::array::forcecast> ts,
+                py::array_t<double, py::array::c_style | py::array::forcecast> gsr_us) {
+                 if (ts.size() != gsr_us.size()) {
+                     throw std::invalid_argument("ts and gsr_us must have the same length");
+                 }
+                 const double* t = ts.data();
+                 const double* g = gsr_us.data();
+                 auto n = static_cast<size_t>(ts.size());
+                 EdaFeatureColumns features;
+                 ScrEventColumns events;
+                 {
+                     py::gil_scoped_release release;
+                     EdaSample s;
+                     ScrEvent e;
+                     for (size_t i = 0; i < n; ++i) {
+                         if (!std::isfinite(g[i])) continue;
+                         if (self.process(t[i], g[i], s, e)) events.push_row(e);
+                         features.push_row(t[i], s);
+                     }
+                 }
+                 return py::make_tuple(features.to_dict(), events.to_dict());
+             },
+             py::arg("ts"), py::arg("gsr_us"),
+             "Feed samples in order, continuing from earlier calls; returns (features, scr_events) dicts with the "
+             "keys of NativeShimmer.get_eda_features() and get_scr_events()")
+        .def("restart", &EdaProcessor::restart, "Forget the signal history, e.g. after a gap")
+        .def_property_readonly("samples", &EdaProcessor::samples)
+        .def_property_readonly("responses", &EdaProcessor::responses);
+
+    py::class_<ShmStreamReader>(m, "ShmStreamReader")
+        .def(py::init<const std::string&>(), py::arg("name"),
+             "Attach to a sample stream published with enable_shm() in another process; reading starts at the "
+             "live edge")
+        .def("read",
+             [](ShmStreamReader& self, size_t max_rows) {
+                 const std::vector<ShmColumn> cols = self.columns();
+                 const auto pending = static_cast<size_t>(std::min<uint64_t>(self.head() - self.cursor(), self.capacity()));
+                 const size_t n = std::min(max_rows, pending);
+                 std::vector<py::array> arrays;
+                 std::vector<uint8_t*> out;
+                 for (const ShmColumn& c : cols) {
+                     arrays.emplace_back(py::dtype(std::string(c.dtype)), std::vector<py::ssize_t>{static_cast<py::ssize_t>(n)});
+                     out.push_back(static_cast<uint8_t*>(arrays.back().mutable_data()));
+                 }
+                 size_t got;
+                 {
+                     py::gil_scoped_release release;
+                     got = self.read_rows(n, out);
+                 }
+                 py::dict result;
+                 for (size_t i = 0; i < cols.size(); ++i) {
+                     arrays[i].resize({static_cast<py::ssize_t>(got)});
+                     result[py::str(cols[i].name)] = arrays[i];
+                 }
+                 return result;
+             },
+             py::arg("max_rows") = 65536,
+             "Copy the rows published since the last read as a dict of column arrays; rows overwritten before "
+             "they could be read are counted in dropped")
+        .def("wait",
+             [](const ShmStreamReader& self, size_t min_rows, int timeout_ms) {
+                 self.wait_for(self.cursor() + min_rows, std::chrono::milliseconds(std::max(0, timeout_ms)));
+                 return self.head() - self.cursor();
+             },
+             py::arg("min_rows") = 1, py::arg("timeout_ms") = 100, py::call_guard<py::gil_scoped_release>(),
+             "Poll without the GIL until min_rows are pending, the writer closes, or timeout; returns rows pending")
+        .def("columns",
+             [](py::object self_obj) {
+                 auto& self = self_obj.cast<ShmStreamReader&>();
+                 py::dict out;
+                 for (const ShmColumn& c : self.columns()) {
+                     out[py::str(c.name)] = shm_view(py::dtype(std::string(c.dtype)),
+                                                     {static_cast<py::ssize_t>(self.capacity())},
+                                                     self.data() + c.offset, self_obj);
+                 }
+                 return out;
+             },
+             "Read-only zero-copy views of the whole ring: row r sits at r % capacity and is valid while intact(r)")
+        .def("intact", &ShmStreamReader::intact, py::arg("index"),
+             "True while row `index` has not been overwritten by the writer")
+        .def_property_readonly("name", &ShmStreamReader::name)
+        .def_property_readonly("capacity", &ShmStreamReader::capacity)
+        .def_property_readonly("head", &ShmStreamReader::head, "Rows published so far")
+        .def_property_readonly("cursor", &ShmStreamReader::cursor, "Rows consumed by read(), skipped ones included")
+        .def_property_readonly("dropped", &ShmStreamReader::dropped)
+        .def_property_readonly("closed", &ShmStreamReader::closed, "True once the writer has stopped")
+        .def_property_readonly("writer_pid", &ShmStreamReader::writer_pid);
+
+    py::class_<ShmFrameReader>(m, "ShmFrameReader")
+        .def(py::init<const std::string&>(), py::arg("name"),
+             "Attach to frames published with NativeWebcam.enable_shm() in another process")
+        .def("latest",
+             [](py::object self_obj, bool copy) -> py::object {
+                 auto& self = self_obj.cast<ShmFrameReader&>();
+                 // A copy races at most the writer lapping the slot ring; retry then
+                 for (int attempt = 0; attempt < 3; ++attempt) {
+                     ShmFrameSlot slot;
+                     const uint8_t* px;
+                     if (!self.latest_frame(slot, px)) {
+                         if (self.head() == 0) return py::none();
+                         continue;
+                     }
+                     // latest_frame() checked that shape covers exactly slot.bytes within the slot
+                     std::vector<py::ssize_t> shape(slot.shape, slot.shape + slot.ndim);
+                     py::array frame;
+                     if (copy) {
+                         frame = py::array(py::dtype::of<uint8_t>(), shape);
+                         std::memcpy(frame.mutable_data(), px,
+                                     std::min<size_t>(slot.bytes, static_cast<size_t>(frame.nbytes())));
+                     } else {
+                         frame = shm_view(py::dtype::of<uint8_t>(), shape, px, self_obj);
+                     }
+                     if (!self.frame_intact(slot)) continue;
+                     self.consumed(slot.index);
+                     return py::make_tuple(frame, slot.index, slot.timestamp, py::str(slot.format));
+                 }
+                 return py::none();
+             },
+             py::arg("copy") = true,
+             "Newest frame as (frame, index, timestamp, pixel_format), or None before the first one; copy=False "
+             "returns a read-only view into the segment that stays valid while intact(index)")
+        .def("wait_for_frame",
+             [](const ShmFrameReader& self, int64_t last_index, int timeout_ms) {
+                 return self.wait_for(static_cast<uint64_t>(last_index + 2),
+                                      std::chrono::milliseconds(std::max(0, timeout_ms)));
+             },
+             py::arg("last_index") = -1, py::arg("timeout_ms") = 100, py::call_guard<py::gil_scoped_release>(),
+             "Poll without the GIL until a frame newer than last_index is published; False on timeout or close")
+        .def("intact", &ShmFrameReader::intact, py::arg("index"),
+             "True while frame `index` has not been overwritten by the writer")
+        .def_property_readonly("name", &ShmFrameReader::name)
+        .def_property_readonly("slots", &ShmFrameReader::capacity)
+        .def_property_readonly("head", &ShmFrameReader::head, "Frames published so far")
+        .def_property_readonly("closed", &ShmFrameReader::closed, "True once the writer has stopped")
+        .def_property_readonly("writer_pid", &ShmFrameReader::writer_pid);
+
+    py::class_<DecimationPyramid>(m, "DecimationPyramid")
+        .def(py::init<size_t>(), py::arg("fanout") = 8,
+             "Incremental min/max pyramid over a (timestamp, value) series, the store behind "
+             "NativeShimmer.query_plot_cache()")
+        .def("append",
+             [](DecimationPyramid& self, py::array_t<double, py::array::c_style | py::array::forcecast> ts,
+                py::array_t<double, py::array::c_style | py::array::forcecast> values) {
+                 if (ts.size() != values.size()) {
+                     throw std::invalid_argument("ts and values must have the same length");
+                 }
+                 const double* t = ts.data();
+                 const double* v = values.data();
+                 auto n = static_cast<size_t>(ts.size());
+                 py::gil_scoped_release release;
+                 for (size_t i = 0; i < n; ++i) self.append(t[i], v[i]);
+             },
+             py::arg("ts"), py::arg("values"),
+             "Append samples with non-decreasing timestamps; NaN and out-of-order samples are skipped")
+        .def("query",
+             [](const DecimationPyramid& self, double t0, double t1, size_t max_points, const std::string& method) {
+                 std::vector<double> ts, vals;
+                 self.query(t0, t1, max_points, parse_decimation_method(method), ts, vals);
+                 return decimated_tuple(ts, vals);
+             },
+             py::arg("t0"), py::arg("t1"), py::arg("max_points"), py::arg("method") = "minmax",
+             "At most max_points (ts, values) points of [t0, t1]: per-bucket min and max, or LTTB")
+        .def("get_state", [](const DecimationPyramid& self) { return plot_cache_state_dict(pyramid_state(self)); },
+             "fanout, samples, levels, skipped, memory_bytes, first_ts and last_ts")
+        .def("clear", &DecimationPyramid::clear, "Drop every sample")
+        .def("__len__", &DecimationPyramid::size);
+
+    m.def("gsr_raw_to_microsiemens",
+          [](py::array_t<uint16_t, py::array::c_style | py::array::forcecast> raw,
+             const std::vector<double>& rf_kohm, double vref, double v_bias) {
+              GsrCalibration cal = make_gsr_calibration(rf_kohm, vref, v_bias);
+              py::array_t<double> out(raw.size());
+              const uint16_t* src = raw.data();
+              double* dst = out.mutable_data();
+              auto n = static_cast<size_t>(raw.size());
+              {
+                  py::gil_scoped_release release;
+                  gsr_raw_to_microsiemens(src, dst, n, cal);
+              }
+              return out;
+          },
+          py::arg("raw"), py::arg("rf_kohm") = std::vector<double>{}, py::arg("vref") = 3.0, py::arg("v_bias") = 0.5,
+          "Convert raw Shimmer3 GSR words (ADC bits 0-11, range bits 14-15) to microsiemens as a float64 array");
+    m.def("set_thread_policy",
+          [](const std::string& role, int priority, const std::vector<int>& cpus) {
+              ThreadRegistry::instance().set_policy(role, ThreadPolicy{priority, cpus});
+          },
+          py::arg("role"), py::arg("priority") = 0, py::arg("cpus") = std::vector<int>{},
+          py::call_guard<py::gil_scoped_release>(),
+          "Set the scheduling policy of a thread role (shimmer, webcam, encoder, recorder, dispatch, lsl, "
+          "analysis, sync): priority 0 is normal, 1-99 real-time (SCHED_FIFO / TIME_CRITICAL); cpus restricts "
+          "affinity. Applies to running threads too");
+    m.def("get_thread_policies",
+          []() {
+              py::dict out;
+              for (const auto& kv : ThreadRegistry::instance().policies()) {
+                  out[py::str(kv.first)] = thread_policy_dict(kv.second);
+              }
+              return out;
+          },
+          "Configured policies as a dict of role -> {priority, cpus}");
+    m.def("get_threads",
+          []() {
+              py::list out;
+              for (const ThreadInfo& t : ThreadRegistry::instance().threads()) out.append(thread_info_dict(t));
+              return out;
+          },
+          "Running native threads as dicts of name, role, tid, priority and cpus in effect, and error "
+          "(why a policy was refused)");
+    m.def("pixel_kernel", &pixel_kernel_name, "Name of the SIMD kernel used for YUV/GRAY to BGR conversion (ssse3 or scalar)");
+    m.def("analysis_kernel", &analysis_kernel_name,
+          "Name of the SIMD kernel used for webcam ROI statistics (sse2, neon or scalar)");
+    m.def("frame_roi_stats",
+          [](py::array_t<uint8_t, py::array::c_style | py::array::forcecast> frame,
+             const std::vector<std::tuple<int, int, int, int>>& rois) {
+              if (frame.ndim() != 3 || frame.shape(2) != 3) {
+                  throw std::invalid_argument("frame must be an (height, width, 3) BGR array");
+              }
+              FrameAnalysisConfig cfg = make_frame_analysis_config(rois, 0, 1);
+              const int height = static_cast<int>(frame.shape(0)), width = static_cast<int>(frame.shape(1));
+              const uint8_t* px = frame.data();
+              std::vector<RoiStats> stats(cfg.rois.size());
+              {
+                  py::gil_scoped_release release;
+                  std::vector<uint8_t> row;
+                  frame_roi_stats(PixelFormat::BGR, px, width, height, cfg.rois, row, stats.data());
+              }
+              const std::vector<py::ssize_t> shape{static_cast<py::ssize_t>(stats.size()), 3};
+              py::array_t<double> mean(shape), var(shape);
+              double* m_out = mean.mutable_data();
+              double* v_out = var.mutable_data();
+              for (size_t i = 0; i < stats.size(); ++i) {
+                  for (size_t c = 0; c < 3; ++c) {
+                      m_out[i * 3 + c] = stats[i].mean[c];
+                      v_out[i * 3 + c] = stats[i].var[c];
+                  }
+              }
+              return py::make_tuple(mean, var);
+          },
+          py::arg("frame"), py::arg("rois"),
+          "Mean and variance of B, G and R over each (x, y, width, height) ROI of a BGR frame, as two (rois, 3) "
+          "arrays; the kernel of NativeWebcam.enable_frame_analysis()");
+    m.def("gsr_kernel", &gsr_kernel_name, "Name of the SIMD kernel used for GSR conversion (avx2 or scalar)");
+
+    m.attr("native_camera_backend") = native_camera_backend();
+    m.attr("jpeg_enabled") = jpeg_encoder_available();
+    m.attr("h264_enabled") = h264_encoder_available();
+    m.attr("lsl_enabled") = lsl_outlet_available();
+
+    m.attr("SAMPLE_HAS_GSR") = static_cast<uint32_t>(SAMPLE_HAS_GSR);
+    m.attr("SAMPLE_HAS_PPG") = static_cast<uint32_t>(SAMPLE_HAS_PPG);
+    m.attr("SAMPLE_SIMULATED") = static_cast<uint32_t>(SAMPLE_SIMULATED);
+    m.attr("SAMPLE_AFTER_GAP") = static_cast<uint32_t>(SAMPLE_AFTER_GAP);
+    m.attr("SAMPLE_REPLAYED") = static_cast<uint32_t>(SAMPLE_REPLAYED);
+
 #ifdef USE_SHIMMER_CAPI
     m.attr("__version__") = "2.1.0-shimmer-capi";
     m.attr("shimmer_capi_enabled") = true;
@@ -0,0 +1,87 @@
+#pragma once
+
+// Deadline-based pacing for simulated and polled sources.
+//
+// Producers compute absolute steady_clock deadlines (start + k * period) and
+// sleep until the next one, so the rate never drifts with loop overhead and
+// an idle producer wakes once per sample or frame instead of spinning.
+// A DeadlineTimer can be shared by several threads (e.g. all workers of a
+// hub); cancel() wakes every sleeper at once for a prompt shutdown.
+//
+// The condition-variable wait uses CLOCK_MONOTONIC absolute timeouts on
+// Linux (pthread_cond_clockwait). On Windows it is bound by the system timer
+// resolution (typically 1-15.6 ms), which is below one 128 Hz sample period
+// only once the process has raised it with timeBeginPeriod().
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+class DeadlineTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Sleep until `deadline`; false if the timer was cancelled before or during the sleep
+    bool sleep_until(Clock::time_point deadline) {
+        std::unique_lock<std::mutex> lk(_mtx);
+        _cv.wait_until(lk, deadline, [this] { return _cancelled; });
+        return !_cancelled;
+    }
+
+    // Wake every sleeper; later sleeps return false immediately until rearm()
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            _cancelled = true;
+        }
+        _cv.notify_all();
+    }
+
+    void rearm() {
+        std::lock_guard<std::mutex> g(_mtx);
+        _cancelled = false;
+    }
+
+private:
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    bool _cancelled{false};
+};
+
+// Fixed-rate deadlines start + k * period, computed from k rather than
+// accumulated so rounding never builds up into drift
+class RateSchedule {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RateSchedule(double hz, Clock::time_point start = Clock::now())
+        : _period(1.0 / hz), _start(start) {}
+
+    Clock::time_point next() const { return deadline(_tick + 1); }
+
+    // Step to the latest deadline at or before `now` (at least one tick).
+    // Deadlines that passed while the producer was busy are skipped, not
+    // burst through, and counted; returns how many were skipped.
+    uint64_t advance(Clock::time_point now) {
+        const double elapsed = std::chrono::duration<double>(now - _start).count();
+        const auto due = elapsed > 0.0 ? static_cast<uint64_t>(elapsed / _period.count()) : uint64_t{0};
+        const uint64_t skipped = due > _tick + 1 ? due - _tick - 1 : 0;
+        _tick = std::max(_tick + 1, due);
+        _missed += skipped;
+        return skipped;
+    }
+
+    uint64_t missed() const { return _missed; }
+
+private:
+    Clock::time_point deadline(uint64_t k) const {
+        return _start + std::chrono::duration_cast<Clock::duration>(_period * static_cast<double>(k));
+    }
+
+    std::chrono::duration<double> _period;
+    Clock::time_point _start;
+    uint64_t _tick{0};
+    uint64_t _missed{0};
+};
@@ -0,0 +1,385 @@
+#pragma once
+
+// Camera pixel formats and their conversion to BGR.
+//
+// Frames are captured and handed out in the camera's native layout; BGR is
+// only produced when a consumer asks for it (FrameBuffer::bgr()). The YUV
+// kernels use BT.601 limited-range coefficients in 6-bit fixed point:
+//
+//     R = (75 (Y-16)            + 102 (V-128) + 32) >> 6
+//     G = (75 (Y-16) - 25 (U-128) - 52 (V-128) + 32) >> 6
+//     B = (75 (Y-16) + 129 (U-128)             + 32) >> 6
+//
+// The SSSE3 path (x86-64, selected at runtime) converts 16 pixels per step
+// and matches the scalar fallback bit for bit. MJPG frames are decoded with
+// libjpeg when the module is built with USE_LIBJPEG.
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#ifdef USE_LIBJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+enum class PixelFormat : uint32_t {
+    BGR = 0,   // packed 8-bit B, G, R
+    GRAY = 1,  // 8-bit luma
+    YUYV = 2,  // packed 4:2:2, Y0 U Y1 V
+    NV12 = 3,  // Y plane followed by an interleaved UV plane at half resolution
+    MJPG = 4,  // one JPEG image per frame
+};
+
+inline const char* pixel_format_name(PixelFormat f) {
+    switch (f) {
+        case PixelFormat::BGR: return "BGR";
+        case PixelFormat::GRAY: return "GRAY";
+        case PixelFormat::YUYV: return "YUYV";
+        case PixelFormat::NV12: return "NV12";
+        case PixelFormat::MJPG: return "MJPG";
+    }
+    return "BGR";
+}
+
+inline PixelFormat parse_pixel_format(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (name == "BGR") return PixelFormat::BGR;
+    if (name == "GRAY") return PixelFormat::GRAY;
+    if (name == "YUYV" || name == "YUY2") return PixelFormat::YUYV;
+    if (name == "NV12") return PixelFormat::NV12;
+    if (name == "MJPG" || name == "MJPEG") return PixelFormat::MJPG;
+    throw std::invalid_argument("pixel_format must be one of BGR, GRAY, YUYV, NV12, MJPG");
+}
+
+// Buffer size for one frame; an upper bound for MJPG
+inline size_t pixel_format_frame_bytes(PixelFormat f, int width, int height) {
+    const size_t px = static_cast<size_t>(width) * static_cast<size_t>(height);
+    switch (f) {
+        case PixelFormat::BGR: return px * 3;
+        case PixelFormat::GRAY: return px;
+        case PixelFormat::YUYV: return px * 2;
+        case PixelFormat::NV12: return px * 3 / 2;
+        case PixelFormat::MJPG: return px * 3;
+    }
+    return px * 3;
+}
+
+// Interleaved channels of the native layout (NV12 and MJPG are single-plane byte arrays)
+inline int pixel_format_channels(PixelFormat f) {
+    switch (f) {
+        case PixelFormat::BGR: return 3;
+        case PixelFormat::YUYV: return 2;
+        default: return 1;
+    }
+}
+
+// NumPy shape of a frame in its native layout
+inline std::vector<size_t> pixel_format_shape(PixelFormat f, int width, int height, size_t bytes) {
+    const auto w = static_cast<size_t>(width), h = static_cast<size_t>(height);
+    switch (f) {
+        case PixelFormat::BGR: return {h, w, 3};
+        case PixelFormat::GRAY: return {h, w};
+        case PixelFormat::YUYV: return {h, w, 2};
+        case PixelFormat::NV12: return {h * 3 / 2, w};
+        case PixelFormat::MJPG: return {bytes};
+    }
+    return {bytes};
+}
+
+namespace pixel_detail {
+
+inline uint8_t clamp_u8(int v) { return static_cast<uint8_t>(std::min(255, std::max(0, v))); }
+
+inline void yuv_to_bgr_px(int y, int u, int v, uint8_t* out) {
+    const int c = 75 * (y - 16), d = u - 128, e = v - 128;
+    out[0] = clamp_u8((c + 129 * d + 32) >> 6);
+    out[1] = clamp_u8((c - 25 * d - 52 * e + 32) >> 6);
+    out[2] = clamp_u8((c + 102 * e + 32) >> 6);
+}
+
+inline void yuyv_row_scalar(const uint8_t* src, uint8_t* dst, int from, int width) {
+    for (int x = from & ~1; x < width; x += 2) {
+        const uint8_t* p = src + x * 2;
+        yuv_to_bgr_px(p[0], p[1], p[3], dst + x * 3);
+        yuv_to_bgr_px(p[2], p[1], p[3], dst + x * 3 + 3);
+    }
+}
+
+inline void nv12_row_scalar(const uint8_t* y_row, const uint8_t* uv_row, uint8_t* dst, int from, int width) {
+    for (int x = from & ~1; x < width; x += 2) {
+        const int u = uv_row[x], v = uv_row[x + 1];
+        yuv_to_bgr_px(y_row[x], u, v, dst + x * 3);
+        yuv_to_bgr_px(y_row[x + 1], u, v, dst + x * 3 + 3);
+    }
+}
+
+inline void gray_row_scalar(const uint8_t* src, uint8_t* dst, int from, int width) {
+    for (int x = from; x < width; ++x) {
+        dst[x * 3 + 0] = dst[x * 3 + 1] = dst[x * 3 + 2] = src[x];
+    }
+}
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define PIXEL_HAVE_SSSE3_KERNEL 1
+
+// pshufb masks that scatter 16 B, G and R bytes into three 16-byte BGR blocks
+struct InterleaveMasks {
+    alignas(16) uint8_t m[3][3][16];  // [output block][channel][byte]
+    InterleaveMasks() {
+        for (int blk = 0; blk < 3; ++blk)
+            for (int ch = 0; ch < 3; ++ch)
+                for (int i = 0; i < 16; ++i) {
+                    int k = blk * 16 + i;
+                    m[blk][ch][i] = (k % 3 == ch) ? static_cast<uint8_t>(k / 3) : 0x80;
+                }
+    }
+};
+
+inline const InterleaveMasks& interleave_masks() {
+    static const InterleaveMasks masks;
+    return masks;
+}
+
+__attribute__((target("ssse3")))
+inline void store_bgr16(uint8_t* dst, __m128i b, __m128i g, __m128i r) {
+    const auto& m = interleave_masks().m;
+    for (int blk = 0; blk < 3; ++blk) {
+        __m128i out = _mm_or_si128(
+            _mm_or_si128(_mm_shuffle_epi8(b, _mm_load_si128(reinterpret_cast<const __m128i*>(m[blk][0]))),
+                         _mm_shuffle_epi8(g, _mm_load_si128(reinterpret_cast<const __m128i*>(m[blk][1])))),
+            _mm_shuffle_epi8(r, _mm_load_si128(reinterpret_cast<const __m128i*>(m[blk][2]))));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + blk * 16), out);
+    }
+}
+
+// 8 pixels in 16-bit lanes -> B, G, R in 16-bit lanes
+__attribute__((target("ssse3")))
+inline void yuv8_to_bgr16(__m128i y, __m128i u, __m128i v, __m128i& b, __m128i& g, __m128i& r) {
+    const __m128i c = _mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), _mm_set1_epi16(75));
+    const __m128i d = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    const __m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    const __m128i round = _mm_set1_epi16(32);
+    // Saturation only occurs where the result clamps to 0 or 255 anyway
+    b = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(129))), round), 6);
+    g = _mm_srai_epi16(_mm_adds_epi16(_mm_subs_epi16(_mm_subs_epi16(c, _mm_mullo_epi16(d, _mm_set1_epi16(25))),
+                                                     _mm_mullo_epi16(e, _mm_set1_epi16(52))), round), 6);
+    r = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(e, _mm_set1_epi16(102))), round), 6);
+}
+
+__attribute__((target("ssse3")))
+inline void store_yuv16(uint8_t* dst, __m128i y_lo, __m128i y_hi, __m128i u_lo, __m128i u_hi,
+                        __m128i v_lo, __m128i v_hi) {
+    __m128i b0, g0, r0, b1, g1, r1;
+    yuv8_to_bgr16(y_lo, u_lo, v_lo, b0, g0, r0);
+    yuv8_to_bgr16(y_hi, u_hi, v_hi, b1, g1, r1);
+    store_bgr16(dst, _mm_packus_epi16(b0, b1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(r0, r1));
+}
+
+__attribute__((target("ssse3")))
+inline int yuyv_row_ssse3(const uint8_t* src, uint8_t* dst, int width) {
+    const __m128i lo_bytes = _mm_set1_epi16(0x00FF);
+    const __m128i dup_u = _mm_setr_epi8(0, 1, 0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12, 13, 12, 13);
+    const __m128i dup_v = _mm_setr_epi8(2, 3, 2, 3, 6, 7, 6, 7, 10, 11, 10, 11, 14, 15, 14, 15);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2 + 16));
+        __m128i ca = _mm_srli_epi16(a, 8), cb = _mm_srli_epi16(b, 8);  // U0 V0 U1 V1 ...
+        store_yuv16(dst + x * 3, _mm_and_si128(a, lo_bytes), _mm_and_si128(b, lo_bytes),
+                    _mm_shuffle_epi8(ca, dup_u), _mm_shuffle_epi8(cb, dup_u),
+                    _mm_shuffle_epi8(ca, dup_v), _mm_shuffle_epi8(cb, dup_v));
+    }
+    return x;
+}
+
+__attribute__((target("ssse3")))
+inline int nv12_row_ssse3(const uint8_t* y_row, const uint8_t* uv_row, uint8_t* dst, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo_bytes = _mm_set1_epi16(0x00FF);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_row + x));
+        __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv_row + x));
+        __m128i u = _mm_and_si128(uv, lo_bytes), v = _mm_srli_epi16(uv, 8);
+        store_yuv16(dst + x * 3, _mm_unpacklo_epi8(y, zero), _mm_unpackhi_epi8(y, zero),
+                    _mm_unpacklo_epi16(u, u), _mm_unpackhi_epi16(u, u),
+                    _mm_unpacklo_epi16(v, v), _mm_unpackhi_epi16(v, v));
+    }
+    return x;
+}
+
+__attribute__((target("ssse3")))
+inline int gray_row_ssse3(const uint8_t* src, uint8_t* dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        store_bgr16(dst + x * 3, y, y, y);
+    }
+    return x;
+}
+
+inline bool cpu_has_ssse3() {
+    static const bool has = __builtin_cpu_supports("ssse3");
+    return has;
+}
+#endif
+
+#ifdef USE_LIBJPEG
+// MJPG -> BGR; one instance per thread
+class JpegDecoder {
+public:
+    JpegDecoder() {
+        _dinfo.err = jpeg_std_error(&_err.pub);
+        _err.pub.error_exit = &JpegDecoder::on_error;
+        jpeg_create_decompress(&_dinfo);
+    }
+    ~JpegDecoder() { jpeg_destroy_decompress(&_dinfo); }
+    JpegDecoder(const JpegDecoder&) = delete;
+    JpegDecoder& operator=(const JpegDecoder&) = delete;
+
+    // Decode into a width x height BGR buffer; returns false on a decode error or size mismatch
+    bool decode(const uint8_t* src, size_t bytes, int width, int height, uint8_t* bgr) {
+        if (setjmp(_err.jump)) {
+            jpeg_abort_decompress(&_dinfo);
+            return false;
+        }
+        jpeg_mem_src(&_dinfo, const_cast<unsigned char*>(src), static_cast<unsigned long>(bytes));
+        jpeg_read_header(&_dinfo, TRUE);
+#ifdef JCS_EXTENSIONS
+        _dinfo.out_color_space = JCS_EXT_BGR;
+#else
+        _dinfo.out_color_space = JCS_RGB;
+#endif
+        _dinfo.dct_method = JDCT_IFAST;
+        jpeg_start_decompress(&_dinfo);
+        if (static_cast<int>(_dinfo.output_width) != width || static_cast<int>(_dinfo.output_height) != height ||
+            _dinfo.output_components != 3) {
+            jpeg_abort_decompress(&_dinfo);
+            return false;
+        }
+        const size_t stride = static_cast<size_t>(width) * 3;
+        while (_dinfo.output_scanline < _dinfo.output_height) {
+            JSAMPROW row = bgr + stride * _dinfo.output_scanline;
+            jpeg_read_scanlines(&_dinfo, &row, 1);
+#ifndef JCS_EXTENSIONS
+            // Plain libjpeg decodes to RGB; swap to BGR in place
+            for (size_t x = 0; x < stride; x += 3) std::swap(row[x], row[x + 2]);
+#endif
+        }
+        jpeg_finish_decompress(&_dinfo);
+        return true;
+    }
+
+private:
+    struct ErrorMgr {
+        jpeg_error_mgr pub;
+        jmp_buf jump;
+    };
+
+    static void on_error(j_common_ptr cinfo) {
+        longjmp(reinterpret_cast<ErrorMgr*>(cinfo->err)->jump, 1);
+    }
+
+    jpeg_decompress_struct _dinfo{};
+    ErrorMgr _err{};
+};
+#endif
+
+}  // namespace pixel_detail
+
+// Convert pixels [x0, x1) of row y of a non-MJPG frame to BGR at dst[x * 3],
+// dst being a whole BGR row. YUV spans widen to even bounds (x0 & ~1 up to
+// the end of the chroma pair holding x1 - 1).
+inline void convert_row_to_bgr(PixelFormat f, const uint8_t* src, int width, int height, int y, int x0, int x1,
+                               uint8_t* dst) {
+    const size_t w = static_cast<size_t>(width);
+#if defined(PIXEL_HAVE_SSSE3_KERNEL)
+    const bool simd = pixel_detail::cpu_has_ssse3();
+#endif
+    switch (f) {
+        case PixelFormat::BGR:
+            std::memcpy(dst + static_cast<size_t>(x0) * 3, src + (static_cast<size_t>(y) * w + x0) * 3,
+                        static_cast<size_t>(x1 - x0) * 3);
+            return;
+        case PixelFormat::GRAY: {
+            const uint8_t* s = src + static_cast<size_t>(y) * w;
+            int x = x0;
+#if defined(PIXEL_HAVE_SSSE3_KERNEL)
+            if (simd) x += pixel_detail::gray_row_ssse3(s + x0, dst + static_cast<size_t>(x0) * 3, x1 - x0);
+#endif
+            pixel_detail::gray_row_scalar(s, dst, x, x1);
+            return;
+        }
+        case PixelFormat::YUYV: {
+            const uint8_t* s = src + static_cast<size_t>(y) * w * 2;
+            int x = x0 & ~1;
+#if defined(PIXEL_HAVE_SSSE3_KERNEL)
+            if (simd) {
+                x += pixel_detail::yuyv_row_ssse3(s + static_cast<size_t>(x) * 2, dst + static_cast<size_t>(x) * 3,
+                                                  x1 - x);
+            }
+#endif
+            pixel_detail::yuyv_row_scalar(s, dst, x, x1);
+            return;
+        }
+        case PixelFormat::NV12: {
+            const uint8_t* ys = src + static_cast<size_t>(y) * w;
+            const uint8_t* uvs = src + w * static_cast<size_t>(height) + static_cast<size_t>(y / 2) * w;
+            int x = x0 & ~1;
+#if defined(PIXEL_HAVE_SSSE3_KERNEL)
+            if (simd) x += pixel_detail::nv12_row_ssse3(ys + x, uvs + x, dst + static_cast<size_t>(x) * 3, x1 - x);
+#endif
+            pixel_detail::nv12_row_scalar(ys, uvs, dst, x, x1);
+            return;
+        }
+        case PixelFormat::MJPG:
+            throw std::invalid_argument("MJPG frames cannot be converted row by row");
+    }
+}
+
+// Convert one frame in its native layout to packed BGR (width * height * 3 bytes)
+inline void convert_to_bgr(PixelFormat f, const uint8_t* src, size_t bytes, int width, int height, uint8_t* dst) {
+    const size_t dst_stride = static_cast<size_t>(width) * 3;
+    switch (f) {
+        case PixelFormat::BGR:
+            std::memcpy(dst, src, std::min(bytes, dst_stride * static_cast<size_t>(height)));
+            return;
+        case PixelFormat::GRAY:
+        case PixelFormat::YUYV:
+        case PixelFormat::NV12:
+            for (int y = 0; y < height; ++y) {
+                convert_row_to_bgr(f, src, width, height, y, 0, width, dst + static_cast<size_t>(y) * dst_stride);
+            }
+            return;
+        case PixelFormat::MJPG: {
+#ifdef USE_LIBJPEG
+            thread_local pixel_detail::JpegDecoder decoder;
+            if (decoder.decode(src, bytes, width, height, dst)) return;
+            throw std::runtime_error("Corrupt MJPG frame");
+#else
+            throw std::runtime_error("MJPG to BGR conversion needs a build with USE_LIBJPEG");
+#endif
+        }
+    }
+}
+
+// Name of the conversion kernel used on this machine
+inline const char* pixel_kernel_name() {
+#if defined(PIXEL_HAVE_SSSE3_KERNEL)
+    return pixel_detail::cpu_has_ssse3() ? "ssse3" : "scalar";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,538 @@
+#pragma once
+
+// Replay of recordings written by stream_recorder.h, for offline
+// reprocessing through the live pipeline. The file is memory-mapped
+// read-only and its chunks located through the index footer (or by scanning,
+// for a file that was never closed); rows are then copied straight from the
+// mapping into the caller's batch, with no parsing per sample.
+//
+// Rows are paced by a recorded timestamp column: row t is due at
+// start + (t - t0) / speed, so speed 1 is real time, 10 is ten times faster
+// and 0 is unthrottled. A looping replay shifts the timestamps of every pass
+// by the recording's span, so consumers see one continuous stream.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "pixel_format.h"
+#include "stream_recorder.h"  // RecorderColumn, RecorderTypeStr
+
+struct ReplayConfig {
+    std::string path;
+    double speed{1.0};  // multiple of real time; 0 replays as fast as the pipeline runs
+    bool loop{false};   // start over at the end instead of finishing
+};
+
+inline void validate_replay_config(const ReplayConfig& cfg) {
+    if (cfg.path.empty()) {
+        throw std::invalid_argument("replay path must not be empty");
+    }
+    if (!std::isfinite(cfg.speed) || cfg.speed < 0.0) {
+        throw std::invalid_argument("speed must be a non-negative multiple of real time");
+    }
+}
+
+// A native recording mapped read-only; immutable once opened
+class RecordingFile {
+public:
+    explicit RecordingFile(const std::string& path) : _path(path) {
+        map();
+        try {
+            parse_header();
+            if (!read_index()) scan_chunks();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+        for (const Chunk& c : _chunks) _rows += c.rows;
+    }
+
+    RecordingFile(const RecordingFile&) = delete;
+    RecordingFile& operator=(const RecordingFile&) = delete;
+
+    ~RecordingFile() { unmap(); }
+
+    const std::string& path() const { return _path; }
+    const std::vector<RecorderColumn>& columns() const { return _columns; }
+    size_t chunk_count() const { return _chunks.size(); }
+    uint32_t chunk_rows(size_t chunk) const { return _chunks[chunk].rows; }
+    uint64_t rows() const { return _rows; }
+
+    // Index of a column that must exist with type T (or typestr, for blobs)
+    size_t require(const std::string& name, const char* typestr) const {
+        for (size_t i = 0; i < _columns.size(); ++i) {
+            if (_columns[i].name != name) continue;
+            if (_columns[i].typestr != typestr) {
+                throw std::runtime_error("Recording column " + name + " is " + _columns[i].typestr + ", expected " +
+                                         typestr);
+            }
+            return i;
+        }
+        throw std::runtime_error("Recording " + _path + " has no " + name + " column");
+    }
+
+    // Bytes of one column in one chunk
+    const uint8_t* column_data(size_t chunk, size_t column, uint64_t* bytes) const {
+        const uint8_t* header = _data + _chunks[chunk].offset;
+        uint64_t pos = kChunkHeader + 8 * _columns.size();
+        for (size_t c = 0; c < column; ++c) pos += load<uint64_t>(header + 16 + 8 * c);
+        *bytes = load<uint64_t>(header + 16 + 8 * column);
+        return header + pos;
+    }
+
+    // Copy rows [first, first + n) of a fixed-width column of one chunk
+    template <typename T>
+    void copy_rows(size_t chunk, size_t column, size_t first, size_t n, T* out) const {
+        uint64_t bytes;
+        const uint8_t* src = column_data(chunk, column, &bytes);
+        std::memcpy(out, src + first * sizeof(T), n * sizeof(T));
+    }
+
+    template <typename T>
+    T value(size_t chunk, size_t column, size_t row) const {
+        T v;
+        copy_rows(chunk, column, row, 1, &v);
+        return v;
+    }
+
+private:
+    struct Chunk {
+        uint64_t offset;
+        uint32_t rows;
+    };
+
+    static constexpr uint64_t kChunkHeader = 16;  // magic, rows, first_row
+    static constexpr uint32_t kChunkMagic = 0x4B4E4843u;  // "CHNK"
+    static constexpr uint64_t kTrailer = 32;
+
+    template <typename T>
+    static T load(const uint8_t* p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+
+    void map() {
+#ifdef _WIN32
+        _file = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (_file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open recording " + _path);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size)) {
+            CloseHandle(_file);
+            throw std::runtime_error("Cannot open recording " + _path);
+        }
+        _size = static_cast<size_t>(size.QuadPart);
+        _mapping = _size ? CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        _data = _mapping ? static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (!_data) {
+            if (_mapping) CloseHandle(_mapping);
+            CloseHandle(_file);
+            throw std::runtime_error("Cannot map recording " + _path);
+        }
+#else
+        const int fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("Cannot open recording " + _path + ": " + std::strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot open recording " + _path + ": empty or unreadable");
+        }
+        _size = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("Cannot map recording " + _path + ": " + std::strerror(errno));
+        // Replays read front to back; let the kernel read ahead
+        madvise(p, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const uint8_t*>(p);
+#endif
+    }
+
+    void unmap() {
+        if (!_data) return;
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+#else
+        munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+        _data = nullptr;
+    }
+
+    void parse_header() {
+        if (_size < 12 || std::memcmp(_data, "NBREC01\0", 8) != 0) {
+            throw std::runtime_error(_path + " is not a native backend recording");
+        }
+        const uint32_t n = load<uint32_t>(_data + 8);
+        uint64_t pos = 12;
+        for (uint32_t i = 0; i < n; ++i) {
+            RecorderColumn col;
+            for (std::string* field : {&col.name, &col.typestr}) {
+                if (pos + 2 > _size) throw std::runtime_error("Truncated recording header in " + _path);
+                const uint16_t len = load<uint16_t>(_data + pos);
+                if (pos + 2 + len > _size) throw std::runtime_error("Truncated recording header in " + _path);
+                field->assign(reinterpret_cast<const char*>(_data + pos + 2), len);
+                pos += 2 + len;
+            }
+            _columns.push_back(std::move(col));
+        }
+        _first_chunk = pos;
+    }
+
+    // Size of the chunk at offset if it lies wholly inside the file, else 0
+    uint64_t chunk_size(uint64_t offset) const {
+        const uint64_t header = kChunkHeader + 8 * _columns.size();
+        // Written as differences: offset comes from the file and offset + n may wrap
+        if (offset < _first_chunk || offset > _size || header > _size - offset) return 0;
+        if (load<uint32_t>(_data + offset) != kChunkMagic) return 0;
+        const uint64_t room = _size - offset;
+        uint64_t total = header;
+        for (size_t c = 0; c < _columns.size(); ++c) {
+            const uint64_t bytes = load<uint64_t>(_data + offset + 16 + 8 * c);
+            if (bytes > room - total) return 0;
+            total += bytes;
+        }
+        // Fixed-width columns must hold a whole number of rows, or copy_rows would overrun them
+        const uint32_t rows = load<uint32_t>(_data + offset + 4);
+        for (size_t c = 0; c < _columns.size(); ++c) {
+            const size_t item = typestr_bytes(_columns[c].typestr);
+            if (item > 1 && load<uint64_t>(_data + offset + 16 + 8 * c) < uint64_t{rows} * item) return 0;
+        }
+        return total;
+    }
+
+    static size_t typestr_bytes(const std::string& typestr) {
+        return typestr.size() >= 3 ? static_cast<size_t>(std::atoi(typestr.c_str() + 2)) : 1;
+    }
+
+    bool read_index() {
+        if (_size < _first_chunk + kTrailer || std::memcmp(_data + _size - 8, "NBRIDX1\0", 8) != 0) return false;
+        const uint64_t index = load<uint64_t>(_data + _size - kTrailer);
+        const uint64_t n = load<uint64_t>(_data + _size - kTrailer + 8);
+        if (index > _size - kTrailer || n > (_size - kTrailer - index) / 24) return false;
+        std::vector<Chunk> chunks;
+        chunks.reserve(static_cast<size_t>(n));
+        for (uint64_t i = 0; i < n; ++i) {
+            const uint64_t offset = load<uint64_t>(_data + index + 24 * i);
+            if (chunk_size(offset) == 0) return false;  // a damaged index; scan instead
+            chunks.push_back({offset, load<uint32_t>(_data + offset + 4)});
+        }
+        _chunks = std::move(chunks);
+        return true;
+    }
+
+    // No footer: walk the chunks and stop at the first incomplete one
+    void scan_chunks() {
+        uint64_t pos = _first_chunk;
+        while (uint64_t size = chunk_size(pos)) {
+            _chunks.push_back({pos, load<uint32_t>(_data + pos + 4)});
+            pos += size;
+        }
+    }
+
+    std::string _path;
+    const uint8_t* _data{nullptr};
+    size_t _size{0};
+#ifdef _WIN32
+    HANDLE _file{INVALID_HANDLE_VALUE};
+    HANDLE _mapping{nullptr};
+#endif
+    std::vector<RecorderColumn> _columns;
+    uint64_t _first_chunk{0};
+    std::vector<Chunk> _chunks;
+    uint64_t _rows{0};
+};
+
+// Position of a replay in a recording, with its pacing and loop bookkeeping
+class ReplayCursor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ReplayCursor(const RecordingFile& file, size_t ts_column, const ReplayConfig& cfg)
+        : _file(file), _ts_column(ts_column), _speed(cfg.speed), _loop(cfg.loop) {
+        skip_empty();
+        if (finished()) return;
+        _t0 = file.value<double>(_chunk, _ts_column, _row);
+        size_t last = file.chunk_count();
+        while (last > 0 && file.chunk_rows(last - 1) == 0) --last;
+        const double t1 = file.value<double>(last - 1, _ts_column, file.chunk_rows(last - 1) - 1);
+        // One pass plus one mean row interval, so the next pass starts where a next row would have been
+        const double span = std::max(0.0, t1 - _t0);
+        if (file.rows() > 1 && span > 0.0) _rate = static_cast<double>(file.rows() - 1) / span;
+        _loop_step = _rate > 0.0 ? span + 1.0 / _rate : 1.0;
+    }
+
+    // Mean rows per second of recorded time; 0 if unknown
+    double rate() const { return _rate; }
+
+    void start(Clock::time_point now) { _origin = now; }
+
+    bool finished() const { return _chunk >= _file.chunk_count(); }
+    size_t chunk() const { return _chunk; }
+    size_t row() const { return _row; }
+    uint64_t passes() const { return _passes; }
+    uint64_t replayed() const { return _replayed; }
+
+    // Added to the recorded timestamps of the current pass
+    double offset() const { return static_cast<double>(_passes) * _loop_step; }
+
+    bool unthrottled() const { return _speed == 0.0; }
+
+    // When a row stamped ts (recorded time, without the pass offset) is due
+    Clock::time_point due(double ts) const {
+        if (unthrottled()) return _origin;
+        const double wall = (ts + offset() - _t0) / _speed;
+        return _origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(0.0, wall)));
+    }
+
+    // Deadline of the next row; max() once finished
+    Clock::time_point next_due() const {
+        if (finished()) return Clock::time_point::max();
+        return due(_file.value<double>(_chunk, _ts_column, _row));
+    }
+
+    // Rows left in the current chunk
+    size_t run() const { return finished() ? 0 : _file.chunk_rows(_chunk) - _row; }
+
+    void advance(size_t n) {
+        _row += n;
+        _replayed += n;
+        if (_row >= _file.chunk_rows(_chunk)) {
+            ++_chunk;
+            _row = 0;
+            skip_empty();
+        }
+    }
+
+private:
+    void skip_empty() {
+        while (true) {
+            while (_chunk < _file.chunk_count() && _file.chunk_rows(_chunk) == 0) ++_chunk;
+            if (!finished() || !_loop || _file.rows() == 0) return;
+            _chunk = 0;
+            ++_passes;
+        }
+    }
+
+    const RecordingFile& _file;
+    const size_t _ts_column;
+    const double _speed;
+    const bool _loop;
+    size_t _chunk{0};
+    size_t _row{0};
+    uint64_t _passes{0};
+    uint64_t _replayed{0};
+    double _t0{0.0};
+    double _rate{0.0};
+    double _loop_step{1.0};
+    Clock::time_point _origin{};
+};
+
+// Samples of a NativeShimmer recording, paced by device_ts. The GSR values
+// are not replayed: the caller converts gsr_raw again with its own calibration
+// and re-fits the clock model from device_ts and host_ts.
+class ShimmerReplaySource {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ShimmerReplaySource(const ReplayConfig& cfg)
+        : _file(cfg.path),
+          _device_ts(_file.require("device_ts", RecorderTypeStr<double>::value)),
+          _host_ts(_file.require("host_ts", RecorderTypeStr<double>::value)),
+          _gsr_raw(_file.require("gsr_raw", RecorderTypeStr<uint16_t>::value)),
+          _ppg_raw(_file.require("ppg_raw", RecorderTypeStr<uint16_t>::value)),
+          _flags(_file.require("flags", RecorderTypeStr<uint32_t>::value)),
+          _cursor(_file, _device_ts, cfg) {}
+
+    void start(Clock::time_point now) { _cursor.start(now); }
+
+    // Copy up to max rows due by `now` into the output columns; returns the
+    // number copied. Timestamps carry the offset of the current loop pass.
+    size_t read_due(Clock::time_point now, size_t max, double* device_ts, double* host_ts, uint16_t* gsr_raw,
+                    uint16_t* ppg_raw, uint32_t* flags) {
+        size_t n = 0;
+        while (n < max && !_cursor.finished()) {
+            const size_t chunk = _cursor.chunk(), row = _cursor.row();
+            size_t take = std::min(_cursor.run(), max - n);
+            _file.copy_rows(chunk, _device_ts, row, take, device_ts + n);
+            if (!_cursor.unthrottled()) {
+                // Rows are due in order; stop at the first one still in the future
+                size_t due = 0;
+                while (due < take && _cursor.due(device_ts[n + due]) <= now) ++due;
+                take = due;
+            }
+            if (take == 0) break;
+            _file.copy_rows(chunk, _host_ts, row, take, host_ts + n);
+            _file.copy_rows(chunk, _gsr_raw, row, take, gsr_raw + n);
+            _file.copy_rows(chunk, _ppg_raw, row, take, ppg_raw + n);
+            _file.copy_rows(chunk, _flags, row, take, flags + n);
+            const double offset = _cursor.offset();
+            if (offset != 0.0) {
+                for (size_t i = n; i < n + take; ++i) {
+                    device_ts[i] += offset;
+                    host_ts[i] += offset;
+                }
+            }
+            _cursor.advance(take);
+            n += take;
+        }
+        return n;
+    }
+
+    // Recorded sample rate, for stages that are configured by rate
+    double sample_rate() const { return _cursor.rate(); }
+
+    Clock::time_point next_due() const { return _cursor.next_due(); }
+    bool unthrottled() const { return _cursor.unthrottled(); }
+    bool finished() const { return _cursor.finished(); }
+    uint64_t rows() const { return _file.rows(); }
+    uint64_t replayed() const { return _cursor.replayed(); }
+    uint64_t passes() const { return _cursor.passes(); }
+    uint64_t skipped() const { return 0; }
+
+private:
+    RecordingFile _file;
+    const size_t _device_ts, _host_ts, _gsr_raw, _ppg_raw, _flags;
+    ReplayCursor _cursor;
+};
+
+// One frame of a NativeWebcam recording; pixels point into the mapping
+struct ReplayFrame {
+    const uint8_t* pixels{nullptr};
+    size_t bytes{0};
+    PixelFormat format{PixelFormat::BGR};
+    int width{0};
+    int height{0};
+    double timestamp{0.0};
+};
+
+// Frames of a NativeWebcam recording, paced by their capture timestamps
+class FrameReplaySource {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameReplaySource(const ReplayConfig& cfg)
+        : _file(cfg.path),
+          _timestamp(_file.require("timestamp", RecorderTypeStr<double>::value)),
+          _width(_file.require("width", RecorderTypeStr<uint32_t>::value)),
+          _height(_file.require("height", RecorderTypeStr<uint32_t>::value)),
+          _format(_file.require("format", RecorderTypeStr<uint32_t>::value)),
+          _pixels(_file.require("pixels", RecorderTypeStr<uint8_t>::value)),
+          _cursor(_file, _timestamp, cfg) {}
+
+    void start(Clock::time_point now) { _cursor.start(now); }
+
+    // The next frame if it is due by `now`. Frames whose size does not match
+    // their pixel format are skipped and counted.
+    bool read_due(Clock::time_point now, ReplayFrame& out) {
+        while (!_cursor.finished() && _cursor.next_due() <= now) {
+            const size_t chunk = _cursor.chunk(), row = _cursor.row();
+            const uint32_t width = _file.value<uint32_t>(chunk, _width, row);
+            const uint32_t height = _file.value<uint32_t>(chunk, _height, row);
+            const uint32_t format = _file.value<uint32_t>(chunk, _format, row);
+            out.timestamp = _file.value<double>(chunk, _timestamp, row) + _cursor.offset();
+            uint64_t bytes;
+            out.pixels = _file.column_data(chunk, _pixels, &bytes);
+            _cursor.advance(1);  // the recorder writes one frame per chunk
+            const auto fmt = static_cast<PixelFormat>(format);
+            const bool fits = format <= static_cast<uint32_t>(PixelFormat::MJPG) && width > 0 && height > 0 &&
+                              width <= 16384 && height <= 16384 &&
+                              (fmt == PixelFormat::MJPG ? bytes > 0
+                                                        : bytes == pixel_format_frame_bytes(fmt, static_cast<int>(width),
+                                                                                            static_cast<int>(height)));
+            if (!fits) {
+                ++_skipped;
+                continue;
+            }
+            out.bytes = static_cast<size_t>(bytes);
+            out.format = fmt;
+            out.width = static_cast<int>(width);
+            out.height = static_cast<int>(height);
+            return true;
+        }
+        return false;
+    }
+
+    Clock::time_point next_due() const { return _cursor.next_due(); }
+    bool unthrottled() const { return _cursor.unthrottled(); }
+    bool finished() const { return _cursor.finished(); }
+    uint64_t rows() const { return _file.rows(); }
+    uint64_t replayed() const { return _cursor.replayed() - _skipped; }
+    uint64_t passes() const { return _cursor.passes(); }
+    uint64_t skipped() const { return _skipped; }
+
+private:
+    RecordingFile _file;
+    const size_t _timestamp, _width, _height, _format, _pixels;
+    ReplayCursor _cursor;
+    uint64_t _skipped{0};
+};
+
+struct ReplayStats {
+    ReplayConfig config;
+    uint64_t rows{0};      // rows or frames in the recording
+    uint64_t replayed{0};  // published this session, over all passes
+    uint64_t passes{0};    // completed loops
+    uint64_t skipped{0};   // frames that did not match their pixel format
+    bool finished{false};  // the end was reached without loop
+};
+
+// Progress of the current replay, published by the acquisition thread
+class ReplayCounters {
+public:
+    template <typename Source>
+    void update(const Source& src) {
+        _rows.store(src.rows(), std::memory_order_relaxed);
+        _replayed.store(src.replayed(), std::memory_order_relaxed);
+        _passes.store(src.passes(), std::memory_order_relaxed);
+        _skipped.store(src.skipped(), std::memory_order_relaxed);
+        _finished.store(src.finished(), std::memory_order_relaxed);
+    }
+
+    void reset() {
+        _rows.store(0);
+        _replayed.store(0);
+        _passes.store(0);
+        _skipped.store(0);
+        _finished.store(false);
+    }
+
+    ReplayStats snapshot(const ReplayConfig& cfg) const {
+        ReplayStats s;
+        s.config = cfg;
+        s.rows = _rows.load(std::memory_order_relaxed);
+        s.replayed = _replayed.load(std::memory_order_relaxed);
+        s.passes = _passes.load(std::memory_order_relaxed);
+        s.skipped = _skipped.load(std::memory_order_relaxed);
+        s.finished = _finished.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    std::atomic<uint64_t> _rows{0};
+    std::atomic<uint64_t> _replayed{0};
+    std::atomic<uint64_t> _passes{0};
+    std::atomic<uint64_t> _skipped{0};
+    std::atomic<bool> _finished{false};
+};
@@ -23,12 +23,15 @@ extern "C" {
 // GSR range settings
 #define SHIMMER_GSR_RANGE_AUTO 0
 
+// Buffer size for one port name or MAC address returned by a scan
+#define SHIMMER_ADDRESS_MAX 64
+
 // Data packet structure
 typedef struct {
     uint64_t timestamp_ms;
     bool has_gsr;
     bool has_ppg;
-    uint16_t gsr_raw;      // 12-bit ADC value (0-4095)
+    uint16_t gsr_raw;      // bits 0-11: 12-bit ADC value, bits 14-15: GSR range
     uint16_t ppg_raw;      // PPG raw value
 } ShimmerDataPacket;
 
@@ -49,6 +52,10 @@ int Shimmer_setGSRRange(void* handle, int range);
 int Shimmer_startStreaming(void* handle);
 int Shimmer_stopStreaming(void* handle);
 int Shimmer_getNextDataPacket(void* handle, ShimmerDataPacket* packet, int timeout_ms);
+// Decode every packet already buffered by the serial/Bluetooth link, up to
+// max, waiting at most timeout_ms for the first one. Returns the number of
+// packets written to out, 0 on timeout, or SHIMMER_ERROR.
+int Shimmer_readPackets(void* handle, ShimmerDataPacket* out, int max, int timeout_ms);
 
 // Device information functions
 int Shimmer_getDeviceName(void* handle, char* name_buffer, int buffer_size);
@@ -11,6 +11,9 @@ extern "C" {
 
 // Bluetooth-specific connection functions
 void* ShimmerBluetooth_connect(const char* mac_address);
+// Inquiry for paired Shimmer units: writes up to max_devices MAC addresses,
+// NUL-terminated, into caller buffers of SHIMMER_ADDRESS_MAX bytes each.
+// Blocks for the inquiry; returns the number found or SHIMMER_ERROR.
 int ShimmerBluetooth_scan(char** device_list, int max_devices);
 int ShimmerBluetooth_disconnect(void* handle);
 
@@ -11,6 +11,9 @@ extern "C" {
 
 // Serial-specific connection functions
 void* ShimmerSerial_connect(const char* port);
+// Serial ports with a Shimmer dock attached: writes up to max_ports names,
+// NUL-terminated, into caller buffers of SHIMMER_ADDRESS_MAX bytes each.
+// Returns the number found or SHIMMER_ERROR.
 int ShimmerSerial_scan(char** port_list, int max_ports);
 int ShimmerSerial_disconnect(void* handle);
 
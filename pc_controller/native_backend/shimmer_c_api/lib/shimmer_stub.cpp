@@ -9,25 +9,112 @@
 #include <cstring>
 #include <cstdlib>
 #include <chrono>
+#include <cmath>
 #include <thread>
 
 // Simple stub implementation for development/testing
 // This will be replaced by the actual Shimmer C-API library
 
+namespace {
+
+// Per-connection state, so several stub devices can stream from different
+// threads. Each device's noise is seeded from its port name and reproducible.
+struct StubDevice {
+    explicit StubDevice(const char* port) {
+        for (const char* p = port; p && *p; ++p) rng = (rng ^ static_cast<uint8_t>(*p)) * 0x100000001B3ull;
+    }
+
+    uint32_t next_random() {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        return static_cast<uint32_t>(rng >> 32);
+    }
+
+    uint64_t rng{0xCBF29CE484222325ull};  // FNV-1a offset basis, then xorshift64
+    uint64_t calls{0};
+    std::chrono::nanoseconds period{7812500};  // 128 Hz
+    std::chrono::steady_clock::time_point next_due{std::chrono::steady_clock::now()};
+};
+
+StubDevice* stub(void* handle) {
+    return static_cast<StubDevice*>(handle);
+}
+
+// The packet due at next_due; advances to the following sample
+void next_packet(StubDevice* dev, ShimmerDataPacket* packet) {
+    auto timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        dev->next_due.time_since_epoch()).count();
+    dev->next_due += dev->period;
+
+    packet->timestamp_ms = static_cast<uint64_t>(timestamp_ms);
+    packet->has_gsr = true;
+    packet->has_ppg = true;
+
+    // 12-bit ADC value in bits 0-11, GSR range 1 (287 kOhm) in bits 14-15:
+    // ADC 2000-2500 corresponds to roughly 6.7-9.3 uS
+    packet->gsr_raw = static_cast<uint16_t>((1 << 14) | (2000 + dev->next_random() % 500));
+
+    packet->ppg_raw = static_cast<uint16_t>(1500 + dev->next_random() % 1000);
+}
+
+// Wait for the next packet to fall due; false after timeout_ms without one
+bool wait_next_due(StubDevice* dev, int timeout_ms) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - dev->next_due > std::chrono::seconds(1)) {
+        dev->next_due = now;  // resync after a long gap instead of bursting the backlog
+    }
+    if (dev->next_due > now) {
+        if (dev->next_due - now > std::chrono::milliseconds(timeout_ms)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return false;
+        }
+        std::this_thread::sleep_until(dev->next_due);
+    }
+    return true;
+}
+
+// Comma-separated port list from an environment variable, so discovery can be
+// exercised without hardware; returns the number written
+int stub_scan(const char* env, char** list, int max) {
+    const char* ports = std::getenv(env);
+    int n = 0;
+    for (const char* p = ports; p && *p && n < max;) {
+        const char* end = std::strchr(p, ',');
+        size_t len = end ? static_cast<size_t>(end - p) : std::strlen(p);
+        if (len > 0) {
+            size_t keep = len < SHIMMER_ADDRESS_MAX - 1 ? len : SHIMMER_ADDRESS_MAX - 1;
+            std::memcpy(list[n], p, keep);
+            list[n++][keep] = '\0';
+        }
+        p = end ? end + 1 : p + len;
+    }
+    return n;
+}
+
+// SHIMMER_STUB_CONNECT_MS simulates a slow Bluetooth pairing
+void* stub_connect(const char* port) {
+    if (const char* ms = std::getenv("SHIMMER_STUB_CONNECT_MS")) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::atoi(ms)));
+    }
+    return new StubDevice(port);
+}
+
+}  // namespace
+
 extern "C" {
 
 // Connection functions
 void* ShimmerSerial_connect(const char* port) {
-    // Return a dummy handle for stub implementation
-    return reinterpret_cast<void*>(0x12345678);
+    return stub_connect(port);
 }
 
 void* ShimmerBluetooth_connect(const char* mac_address) {
-    // Return a dummy handle for stub implementation  
-    return reinterpret_cast<void*>(0x87654321);
+    return stub_connect(mac_address);
 }
 
 int Shimmer_disconnect(void* handle) {
+    delete stub(handle);
     return SHIMMER_OK;
 }
 
@@ -37,6 +124,8 @@ int Shimmer_enableSensor(void* handle, int sensor_type) {
 }
 
 int Shimmer_setSamplingRate(void* handle, double rate_hz) {
+    if (!handle || !(rate_hz > 0.0)) return SHIMMER_ERROR;
+    stub(handle)->period = std::chrono::nanoseconds(static_cast<int64_t>(std::llround(1e9 / rate_hz)));
     return SHIMMER_OK;
 }
 
@@ -54,35 +143,41 @@ int Shimmer_stopStreaming(void* handle) {
 }
 
 int Shimmer_getNextDataPacket(void* handle, ShimmerDataPacket* packet, int timeout_ms) {
+    StubDevice* dev = stub(handle);
+    if (!dev) return SHIMMER_ERROR;
     // Simulate timeout occasionally
-    static int call_count = 0;
-    call_count++;
-    
-    if (call_count % 10 == 0) {
+    if (++dev->calls % 10 == 0) {
         return SHIMMER_TIMEOUT;
     }
     
-    // Simulate realistic packet data
-    auto now = std::chrono::steady_clock::now();
-    auto timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()).count();
-    
-    packet->timestamp_ms = static_cast<uint64_t>(timestamp_ms);
-    packet->has_gsr = true;
-    packet->has_ppg = true;
-    
-    // Simulate 12-bit ADC GSR value (0-4095)
-    // Simulate a GSR value corresponding to ~10 µS
-    packet->gsr_raw = 2000 + (rand() % 500); // Some variation around midpoint
-    
-    packet->ppg_raw = 1500 + (rand() % 1000);
-    
-    // Simulate realistic sampling timing
-    std::this_thread::sleep_for(std::chrono::milliseconds(8)); // ~128Hz
+    // Packets become ready once per sample period; wait at most timeout_ms for the next one
+    if (!wait_next_due(dev, timeout_ms)) {
+        return SHIMMER_TIMEOUT;
+    }
+    next_packet(dev, packet);
     
     return SHIMMER_OK;
 }
 
+int Shimmer_readPackets(void* handle, ShimmerDataPacket* out, int max, int timeout_ms) {
+    StubDevice* dev = stub(handle);
+    if (!dev || !out || max <= 0) return SHIMMER_ERROR;
+    // Simulate timeout occasionally
+    if (++dev->calls % 10 == 0) {
+        return 0;
+    }
+    if (!wait_next_due(dev, timeout_ms)) {
+        return 0;
+    }
+    // Everything that has fallen due is in the receive buffer
+    const auto now = std::chrono::steady_clock::now();
+    int count = 0;
+    while (count < max && dev->next_due <= now) {
+        next_packet(dev, &out[count++]);
+    }
+    return count;
+}
+
 // Device information functions
 int Shimmer_getDeviceName(void* handle, char* name_buffer, int buffer_size) {
     const char* name = "Shimmer3 GSR+ Stub";
@@ -100,7 +195,7 @@ int Shimmer_getFirmwareVersion(void* handle, char* version_buffer, int buffer_si
 
 // Bluetooth-specific functions
 int ShimmerBluetooth_scan(char** device_list, int max_devices) {
-    return 0; // No devices found in stub mode
+    return stub_scan("SHIMMER_STUB_BLUETOOTH", device_list, max_devices);
 }
 
 int ShimmerBluetooth_disconnect(void* handle) {
@@ -109,7 +204,7 @@ int ShimmerBluetooth_disconnect(void* handle) {
 
 // Serial-specific functions  
 int ShimmerSerial_scan(char** port_list, int max_ports) {
-    return 0; // No ports found in stub mode
+    return stub_scan("SHIMMER_STUB_SERIAL", port_list, max_ports);
 }
 
 int ShimmerSerial_disconnect(void* handle) {
@@ -0,0 +1,122 @@
+#pragma once
+
+// Deterministic Shimmer3 GSR+ simulator for load tests.
+//
+// Sample k of a stream is a pure function of the seed and k: the device
+// timestamp is k / rate_hz on a crystal running drift_ppm slow, the signal is
+// a slow baseline drift plus breathing and cardiac components with uniform
+// noise from a per-device SplitMix64 generator, and link faults are drawn from
+// the same generator. Two simulators with the same config produce identical
+// streams regardless of host timing, so load tests are reproducible.
+//
+// Faults:
+//   dropout_rate  probability that a sample is lost on the link
+//   timeout_rate  link stalls per second; during a stall of timeout_ms the
+//                 device delivers nothing (poll() times out) and the queued
+//                 samples arrive in one burst afterwards
+//   disconnect_rate  link losses per second; the device is unreachable for
+//                 disconnect_ms, reconnect attempts fail meanwhile, and the
+//                 samples due during the outage are lost
+//
+// Pacing (wall-clock deadlines or as fast as possible) is left to the caller.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+struct SimulatorConfig {
+    double rate_hz{128.0};
+    uint64_t seed{0x12345678};
+    double dropout_rate{0.0};
+    double timeout_rate{0.0};   // stalls per second of device time
+    double timeout_ms{100.0};   // length of each stall
+    double drift_ppm{30.0};     // device clock runs this much slow against the host
+    bool unpaced{false};        // emit as fast as the consumer takes samples, no wall-clock pacing
+    double disconnect_rate{0.0};  // link losses per second of device time (paced only)
+    double disconnect_ms{1000.0}; // how long the device stays unreachable
+};
+
+struct SimulatedSample {
+    double device_ts;
+    double gsr_us;
+    uint16_t ppg_raw;
+    bool dropped;       // lost on the link; not to be published
+    double stall_s;     // > 0 if a link stall starts after this sample
+    double outage_s;    // > 0 if the link is lost after this sample
+};
+
+// Throws std::invalid_argument for values the simulator cannot honour
+inline void validate_simulator_config(const SimulatorConfig& cfg) {
+    if (!(cfg.rate_hz > 0.0 && cfg.rate_hz <= 1e6)) {
+        throw std::invalid_argument("simulation rate_hz must be in (0, 1e6]");
+    }
+    if (!(cfg.dropout_rate >= 0.0 && cfg.dropout_rate < 1.0)) {
+        throw std::invalid_argument("dropout_rate must be in [0, 1)");
+    }
+    if (!(cfg.timeout_rate >= 0.0 && cfg.timeout_ms >= 0.0)) {
+        throw std::invalid_argument("timeout_rate and timeout_ms must not be negative");
+    }
+    if (!(cfg.disconnect_rate >= 0.0 && cfg.disconnect_ms >= 0.0)) {
+        throw std::invalid_argument("disconnect_rate and disconnect_ms must not be negative");
+    }
+    if (!(std::abs(cfg.drift_ppm) < 1e4)) {
+        throw std::invalid_argument("drift_ppm must be within +-10000");
+    }
+}
+
+class ShimmerSimulator {
+public:
+    explicit ShimmerSimulator(const SimulatorConfig& cfg = {}) { reset(cfg); }
+
+    // Restart the stream at sample 0
+    void reset(const SimulatorConfig& cfg) {
+        _cfg = cfg;
+        _index = 0;
+        _state = cfg.seed;
+        _stall_p = cfg.timeout_rate / cfg.rate_hz;
+        _outage_p = cfg.disconnect_rate / cfg.rate_hz;
+    }
+
+    const SimulatorConfig& config() const { return _cfg; }
+    uint64_t index() const { return _index; }
+
+    SimulatedSample next() {
+        constexpr double two_pi = 6.283185307179586;
+        const double t = static_cast<double>(_index) / _cfg.rate_hz;
+        ++_index;
+
+        SimulatedSample s;
+        s.device_ts = t * (1.0 - _cfg.drift_ppm * 1e-6);
+        double baseline = 8.0 + 2.0 * std::sin(two_pi * 0.016 * t);  // slow tonic drift
+        double respiratory = 1.5 * std::sin(two_pi * 0.25 * t);       // breathing
+        double cardiac = 0.5 * std::sin(two_pi * 1.2 * t);            // heart rate
+        double noise = (uniform() * 2.0 - 1.0) * 0.2;
+        s.gsr_us = std::max(0.1, baseline + respiratory + cardiac + noise);
+        // Synthetic PPG pulse around mid-scale of the 12-bit ADC
+        s.ppg_raw = static_cast<uint16_t>(2048.0 + 600.0 * std::sin(two_pi * 1.2 * t));
+        // Draw every fault every sample so the signal does not depend on the fault rates
+        s.dropped = uniform() < _cfg.dropout_rate;
+        s.stall_s = uniform() < _stall_p ? _cfg.timeout_ms / 1000.0 : 0.0;
+        s.outage_s = uniform() < _outage_p ? _cfg.disconnect_ms / 1000.0 : 0.0;
+        return s;
+    }
+
+private:
+    // SplitMix64: tiny state, full 64-bit period, good enough for test signals
+    uint64_t next_u64() {
+        uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double uniform() { return static_cast<double>(next_u64() >> 11) * 0x1.0p-53; }
+
+    SimulatorConfig _cfg;
+    uint64_t _index{0};
+    uint64_t _state{0};
+    double _stall_p{0.0};
+    double _outage_p{0.0};
+};
@@ -0,0 +1,653 @@
+#pragma once
+
+// Shared-memory transport: a writer process publishes sample rows or frames
+// into a named segment (POSIX shm_open / Windows file mapping) and any
+// number of reader processes attach to it and read without copies through
+// the owning process.
+//
+// Segment layout (little-endian, offsets in bytes):
+//
+//   0     u64  magic "HBSHMv01"
+//   8     u32  version (1)
+//   12    u32  kind: 1 = sample ring, 2 = frame ring
+//   16    u64  capacity: rows (power of two) or frame slots
+//   24    u64  slot_bytes: frame slot stride incl. its 64-byte header; 0 for rings
+//   32    u64  data_offset: start of the column arrays / frame slots
+//   40    u32  column_count
+//   44    u32  writer_pid
+//   48    u32  closed: set once the writer has stopped
+//   64    u64  claimed: rows/frames whose write has started
+//   128   u64  head: rows/frames published
+//   192   16 x {char name[24], char dtype[8], u64 offset, u64 itemsize} columns
+//   1024  16 x {u64 cursor, u32 pid, u32 reserved, 48 bytes padding} reader slots
+//
+// Ring column c holds capacity items of itemsize at data_offset + offset;
+// row r lives at index r % capacity. Frame slot s starts at
+// data_offset + s * slot_bytes with {u64 index, f64 timestamp, u64 bytes,
+// char format[8], u32 ndim, u32 shape[3], u64 frame_seq} and the pixels
+// follow at +64. Frame r lives in slot r % capacity.
+//
+// The writer never waits for readers. For each row or frame r it stores
+// claimed = r + 1, issues a release fence, writes the data and then stores
+// head = r + 1 with release. A reader loads head (acquire), copies or views
+// rows older than head, issues an acquire fence and loads claimed: rows
+// r < claimed - capacity may have been overwritten while it read them and
+// must be discarded (a seqlock over the whole ring). Readers keep their
+// cursor and pid in a reader slot, so the writer can report their lag; a
+// slot whose process has died is reused.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "stream_recorder.h"  // RecorderTypeStr
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory counters must be lock-free to work across processes");
+
+constexpr uint64_t kShmMagic = 0x3130764D48534248ull;  // the bytes "HBSHMv01"
+constexpr uint32_t kShmVersion = 1;
+constexpr uint32_t kShmKindRing = 1;
+constexpr uint32_t kShmKindFrames = 2;
+constexpr size_t kShmMaxColumns = 16;
+constexpr size_t kShmMaxReaders = 16;
+
+struct ShmColumn {
+    char name[24];
+    char dtype[8];  // NumPy array-protocol type string, e.g. "<f8"
+    uint64_t offset;
+    uint64_t itemsize;
+};
+
+struct alignas(64) ShmReaderSlot {
+    std::atomic<uint64_t> cursor;
+    std::atomic<uint32_t> pid;  // 0 = free
+    uint32_t reserved;
+};
+
+struct ShmHeader {
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t kind;
+    uint64_t capacity;
+    uint64_t slot_bytes;
+    uint64_t data_offset;
+    uint32_t column_count;
+    uint32_t writer_pid;
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> claimed;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) ShmColumn columns[kShmMaxColumns];
+    uint8_t reserved[64];
+    ShmReaderSlot readers[kShmMaxReaders];
+};
+
+static_assert(offsetof(ShmHeader, claimed) == 64 && offsetof(ShmHeader, head) == 128 &&
+                  offsetof(ShmHeader, columns) == 192 && offsetof(ShmHeader, readers) == 1024,
+              "ShmHeader must match the documented layout");
+
+struct ShmFrameSlot {
+    uint64_t index;
+    double timestamp;
+    uint64_t bytes;
+    char format[8];
+    uint32_t ndim;
+    uint32_t shape[3];
+    uint64_t frame_seq;
+};
+
+constexpr size_t kShmFrameHeaderBytes = 64;
+static_assert(sizeof(ShmFrameSlot) <= kShmFrameHeaderBytes, "frame slot header must fit its 64 bytes");
+
+inline uint32_t shm_current_pid() {
+#ifdef _WIN32
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+inline bool shm_process_alive(uint32_t pid) {
+#ifdef _WIN32
+    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!h) return GetLastError() == ERROR_ACCESS_DENIED;
+    DWORD code = 0;
+    const bool alive = GetExitCodeProcess(h, &code) && code == STILL_ACTIVE;
+    CloseHandle(h);
+    return alive;
+#else
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif
+}
+
+// One mapping of a named segment; the creator removes the name on destruction
+class SharedSegment {
+public:
+    static std::unique_ptr<SharedSegment> create(const std::string& name, size_t bytes) {
+        const std::string os_name = os_name_of(name);
+#ifdef _WIN32
+        HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                      static_cast<DWORD>(bytes & 0xFFFFFFFFu), os_name.c_str());
+        if (!h) throw std::runtime_error("Failed to create shared segment '" + name + "'");
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            CloseHandle(h);
+            throw std::runtime_error("Shared segment '" + name + "' is in use");
+        }
+        return map(h, bytes, name, true);
+#else
+        int fd = shm_open(os_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 && errno == EEXIST && stale(name)) {
+            shm_unlink(os_name.c_str());
+            fd = shm_open(os_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        }
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create shared segment '" + name + "': " +
+                                     (errno == EEXIST ? "in use by a running writer" : std::strerror(errno)));
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            shm_unlink(os_name.c_str());
+            throw std::runtime_error("Failed to size shared segment '" + name + "'");
+        }
+        return map(fd, bytes, name, true);
+#endif
+    }
+
+    static std::unique_ptr<SharedSegment> attach(const std::string& name) {
+        const std::string os_name = os_name_of(name);
+#ifdef _WIN32
+        HANDLE h = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, os_name.c_str());
+        if (!h) throw std::runtime_error("No shared segment named '" + name + "'");
+        return map(h, 0, name, false);
+#else
+        int fd = shm_open(os_name.c_str(), O_RDWR, 0);
+        if (fd < 0) throw std::runtime_error("No shared segment named '" + name + "'");
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmHeader)) {
+            close(fd);
+            throw std::runtime_error("Shared segment '" + name + "' is not initialised");
+        }
+        return map(fd, static_cast<size_t>(st.st_size), name, false);
+#endif
+    }
+
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    ~SharedSegment() {
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_handle);
+#else
+        munmap(_data, _size);
+        if (_owner) shm_unlink(os_name_of(_name).c_str());
+#endif
+    }
+
+    uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+    const std::string& name() const { return _name; }
+
+private:
+    SharedSegment() = default;
+
+    static std::string os_name_of(const std::string& name) {
+        if (name.empty() || name.size() > 200 || name.find_first_of("/\\") != std::string::npos) {
+            throw std::invalid_argument("shared segment names must be 1-200 characters without slashes");
+        }
+#ifdef _WIN32
+        return "Local\\" + name;
+#else
+        return "/" + name;
+#endif
+    }
+
+#ifdef _WIN32
+    static std::unique_ptr<SharedSegment> map(HANDLE h, size_t bytes, const std::string& name, bool owner) {
+        void* p = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+        if (!p) {
+            CloseHandle(h);
+            throw std::runtime_error("Failed to map shared segment '" + name + "'");
+        }
+        MEMORY_BASIC_INFORMATION info{};
+        VirtualQuery(p, &info, sizeof(info));
+        std::unique_ptr<SharedSegment> s(new SharedSegment());
+        s->_handle = h;
+        s->_data = static_cast<uint8_t*>(p);
+        s->_size = bytes ? bytes : static_cast<size_t>(info.RegionSize);
+        s->_name = name;
+        s->_owner = owner;
+        return s;
+    }
+#else
+    static std::unique_ptr<SharedSegment> map(int fd, size_t bytes, const std::string& name, bool owner) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            if (owner) shm_unlink(os_name_of(name).c_str());
+            throw std::runtime_error("Failed to map shared segment '" + name + "'");
+        }
+        std::unique_ptr<SharedSegment> s(new SharedSegment());
+        s->_data = static_cast<uint8_t*>(p);
+        s->_size = bytes;
+        s->_name = name;
+        s->_owner = owner;
+        return s;
+    }
+
+    // A segment left behind by a writer that crashed or has already stopped
+    static bool stale(const std::string& name) {
+        try {
+            auto seg = attach(name);
+            const auto* h = reinterpret_cast<const ShmHeader*>(seg->data());
+            return h->magic.load(std::memory_order_acquire) != kShmMagic || h->closed.load() ||
+                   !shm_process_alive(h->writer_pid);
+        } catch (const std::exception&) {
+            return true;
+        }
+    }
+#endif
+
+#ifdef _WIN32
+    HANDLE _handle{nullptr};
+#endif
+    uint8_t* _data{nullptr};
+    size_t _size{0};
+    std::string _name;
+    bool _owner{false};
+};
+
+struct ShmReaderInfo {
+    uint32_t pid;
+    uint64_t cursor;
+    uint64_t lag;  // published rows/frames the reader has not consumed
+};
+
+// Writer side shared by rings and frame rings
+class ShmWriterBase {
+public:
+    ShmWriterBase(const ShmWriterBase&) = delete;
+    ShmWriterBase& operator=(const ShmWriterBase&) = delete;
+
+    ~ShmWriterBase() {
+        if (_seg) header()->closed.store(1, std::memory_order_release);
+    }
+
+    const std::string& name() const { return _seg->name(); }
+    size_t capacity() const { return static_cast<size_t>(header()->capacity); }
+    uint64_t published() const { return header()->head.load(std::memory_order_relaxed); }
+    size_t segment_bytes() const { return _seg->size(); }
+
+    std::vector<ShmReaderInfo> readers() const {
+        std::vector<ShmReaderInfo> out;
+        const uint64_t head = published();
+        for (const ShmReaderSlot& r : header()->readers) {
+            const uint32_t pid = r.pid.load(std::memory_order_relaxed);
+            if (!pid || !shm_process_alive(pid)) continue;
+            const uint64_t cursor = r.cursor.load(std::memory_order_relaxed);
+            out.push_back({pid, cursor, head > cursor ? head - cursor : 0});
+        }
+        return out;
+    }
+
+protected:
+    ShmWriterBase(const std::string& name, uint32_t kind, uint64_t capacity, uint64_t slot_bytes, size_t data_bytes,
+                  const std::vector<ShmColumn>& columns) {
+        const size_t data_offset = (sizeof(ShmHeader) + 4095) & ~size_t{4095};
+        _seg = SharedSegment::create(name, data_offset + data_bytes);
+        auto* h = new (_seg->data()) ShmHeader();
+        h->version = kShmVersion;
+        h->kind = kind;
+        h->capacity = capacity;
+        h->slot_bytes = slot_bytes;
+        h->data_offset = data_offset;
+        h->column_count = static_cast<uint32_t>(columns.size());
+        h->writer_pid = shm_current_pid();
+        std::copy(columns.begin(), columns.end(), h->columns);
+        _data = _seg->data() + data_offset;
+        // Readers check the magic last
+        h->magic.store(kShmMagic, std::memory_order_release);
+    }
+
+    ShmHeader* header() const { return reinterpret_cast<ShmHeader*>(_seg->data()); }
+
+    // Bracket the write of row/frame `index`
+    void begin_write(uint64_t index) {
+        header()->claimed.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void end_write(uint64_t index) { header()->head.store(index + 1, std::memory_order_release); }
+
+    std::unique_ptr<SharedSegment> _seg;
+    uint8_t* _data{nullptr};
+};
+
+// Sample rows with the column types of a SoaRing
+template <typename... Columns>
+class ShmRingWriter : public ShmWriterBase {
+public:
+    ShmRingWriter(const std::string& name, size_t capacity, const std::vector<std::string>& names)
+        : ShmWriterBase(name, kShmKindRing, round_capacity(capacity), 0, data_bytes(round_capacity(capacity)),
+                        make_columns(names, round_capacity(capacity))),
+          _mask(round_capacity(capacity) - 1) {
+        for (size_t i = 0; i < sizeof...(Columns); ++i) _cols[i] = _data + header()->columns[i].offset;
+    }
+
+    // Writer thread only
+    void push(const Columns&... values) {
+        const uint64_t r = _next;
+        const size_t slot = static_cast<size_t>(r & _mask);
+        begin_write(r);
+        size_t i = 0;
+        ((std::memcpy(_cols[i] + slot * sizeof(Columns), &values, sizeof(Columns)), ++i), ...);
+        end_write(r);
+        _next = r + 1;
+    }
+
+private:
+    static size_t round_capacity(size_t n) {
+        size_t c = 1;
+        while (c < std::max<size_t>(n, 2)) c <<= 1;
+        return c;
+    }
+
+    static uint64_t column_bytes(size_t itemsize, size_t capacity) {
+        return (itemsize * capacity + 63) & ~uint64_t{63};
+    }
+
+    static size_t data_bytes(size_t capacity) {
+        return static_cast<size_t>((column_bytes(sizeof(Columns), capacity) + ...));
+    }
+
+    static std::vector<ShmColumn> make_columns(const std::vector<std::string>& names, size_t capacity) {
+        if (names.size() != sizeof...(Columns) || names.size() > kShmMaxColumns) {
+            throw std::invalid_argument("one column name is required per ring column");
+        }
+        const char* types[] = {RecorderTypeStr<Columns>::value...};
+        const size_t sizes[] = {sizeof(Columns)...};
+        std::vector<ShmColumn> cols(names.size());
+        uint64_t offset = 0;
+        for (size_t i = 0; i < names.size(); ++i) {
+            std::strncpy(cols[i].name, names[i].c_str(), sizeof(cols[i].name) - 1);
+            std::strncpy(cols[i].dtype, types[i], sizeof(cols[i].dtype) - 1);
+            cols[i].offset = offset;
+            cols[i].itemsize = sizes[i];
+            offset += column_bytes(sizes[i], capacity);
+        }
+        return cols;
+    }
+
+    size_t _mask;
+    uint64_t _next{0};
+    uint8_t* _cols[sizeof...(Columns)]{};
+};
+
+// Frames of up to max_frame_bytes; larger frames are skipped and counted
+class ShmFrameWriter : public ShmWriterBase {
+public:
+    ShmFrameWriter(const std::string& name, size_t slots, size_t max_frame_bytes)
+        : ShmWriterBase(name, kShmKindFrames, check_slots(slots), stride_of(max_frame_bytes),
+                        slots * stride_of(max_frame_bytes), {}),
+          _slots(slots), _max_bytes(max_frame_bytes) {}
+
+    size_t max_frame_bytes() const { return _max_bytes; }
+    uint64_t oversized() const { return _oversized.load(std::memory_order_relaxed); }
+
+    // Writer thread only
+    void push(const uint8_t* pixels, size_t bytes, const char* format, const std::vector<size_t>& shape,
+              double timestamp, uint64_t frame_seq) {
+        // Drivers may report padding past the pixels; readers expect exactly the shape
+        size_t elements = 1;
+        for (size_t d : shape) elements *= d;
+        bytes = std::min(bytes, elements);
+        if (bytes > _max_bytes || shape.empty() || shape.size() > 3) {
+            _oversized.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const uint64_t r = _next;
+        uint8_t* base = _data + static_cast<size_t>(r % _slots) * header()->slot_bytes;
+        begin_write(r);
+        ShmFrameSlot slot{};
+        slot.index = r;
+        slot.timestamp = timestamp;
+        slot.bytes = bytes;
+        std::strncpy(slot.format, format, sizeof(slot.format) - 1);
+        slot.ndim = static_cast<uint32_t>(shape.size());
+        for (size_t i = 0; i < shape.size(); ++i) slot.shape[i] = static_cast<uint32_t>(shape[i]);
+        slot.frame_seq = frame_seq;
+        std::memcpy(base, &slot, sizeof(slot));
+        std::memcpy(base + kShmFrameHeaderBytes, pixels, bytes);
+        end_write(r);
+        _next = r + 1;
+    }
+
+private:
+    static size_t check_slots(size_t slots) {
+        if (slots < 2 || slots > 1024) throw std::invalid_argument("shared frame slots must be in [2, 1024]");
+        return slots;
+    }
+
+    static uint64_t stride_of(size_t max_frame_bytes) {
+        return (kShmFrameHeaderBytes + max_frame_bytes + 63) & ~uint64_t{63};
+    }
+
+    size_t _slots;
+    size_t _max_bytes;
+    uint64_t _next{0};
+    std::atomic<uint64_t> _oversized{0};
+};
+
+// Reader side, attached by name from any process
+class ShmReader {
+public:
+    explicit ShmReader(const std::string& name) : _seg(SharedSegment::attach(name)) {
+        const ShmHeader* h = header();
+        if (h->magic.load(std::memory_order_acquire) != kShmMagic || h->version != kShmVersion ||
+            h->data_offset > _seg->size()) {
+            throw std::runtime_error("'" + name + "' is not a stream segment of this version");
+        }
+        if (!layout_fits(*h, _seg->size() - h->data_offset)) {
+            throw std::runtime_error("'" + name + "' has a header that does not fit its segment");
+        }
+        _capacity = static_cast<size_t>(h->capacity);
+        _data = _seg->data() + h->data_offset;
+        claim_slot();
+        _cursor = h->head.load(std::memory_order_acquire);  // new readers start at the live edge
+        if (_slot) _slot->cursor.store(_cursor, std::memory_order_relaxed);
+    }
+
+    ShmReader(const ShmReader&) = delete;
+    ShmReader& operator=(const ShmReader&) = delete;
+
+    ~ShmReader() {
+        if (_slot) _slot->pid.store(0, std::memory_order_release);
+    }
+
+    const std::string& name() const { return _seg->name(); }
+    uint32_t kind() const { return header()->kind; }
+    size_t capacity() const { return _capacity; }
+    bool closed() const { return header()->closed.load(std::memory_order_acquire) != 0; }
+    uint32_t writer_pid() const { return header()->writer_pid; }
+    uint64_t head() const { return header()->head.load(std::memory_order_acquire); }
+    uint64_t cursor() const { return _cursor; }
+    uint64_t dropped() const { return _dropped; }
+    uint8_t* data() const { return _data; }
+
+    std::vector<ShmColumn> columns() const {
+        const ShmHeader* h = header();
+        return std::vector<ShmColumn>(h->columns, h->columns + std::min<size_t>(h->column_count, kShmMaxColumns));
+    }
+
+    // True when row/frame `index` has not been (partly) overwritten yet
+    bool intact(uint64_t index) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header()->claimed.load(std::memory_order_relaxed) <= index + _capacity;
+    }
+
+    // Copy up to max rows newer than the cursor into one buffer per column;
+    // rows overwritten before or during the copy are skipped and counted
+    size_t read_rows(size_t max, const std::vector<uint8_t*>& out) {
+        const std::vector<ShmColumn> cols = columns();
+        const uint64_t head = this->head();
+        uint64_t start = std::max(_cursor, head > _capacity ? head - _capacity : 0);
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(head - start, max));
+        for (size_t c = 0; c < cols.size() && c < out.size(); ++c) {
+            const uint8_t* col = _data + cols[c].offset;
+            const size_t item = static_cast<size_t>(cols[c].itemsize);
+            for (size_t done = 0; done < n;) {
+                const size_t slot = static_cast<size_t>((start + done) % _capacity);
+                const size_t run = std::min(n - done, _capacity - slot);
+                std::memcpy(out[c] + done * item, col + slot * item, run * item);
+                done += run;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claimed = header()->claimed.load(std::memory_order_relaxed);
+        const uint64_t valid = claimed > _capacity ? claimed - _capacity : 0;
+        size_t skip = 0;
+        if (valid > start) {
+            skip = static_cast<size_t>(std::min<uint64_t>(valid - start, n));
+            for (size_t c = 0; c < cols.size() && c < out.size(); ++c) {
+                const size_t item = static_cast<size_t>(cols[c].itemsize);
+                std::memmove(out[c], out[c] + skip * item, (n - skip) * item);
+            }
+        }
+        _dropped += (start - _cursor) + skip;
+        _cursor = start + n;
+        if (_slot) _slot->cursor.store(_cursor, std::memory_order_relaxed);
+        return n - skip;
+    }
+
+    // Header and pixel pointer of the newest frame, or false if none has been
+    // published or its header is torn or inconsistent. On success bytes fits
+    // the slot and equals the product of the 1-3 dimensions of shape.
+    bool latest_frame(ShmFrameSlot& slot, const uint8_t*& pixels) const {
+        const uint64_t head = this->head();
+        if (head == 0) return false;
+        const uint64_t index = head - 1;
+        const uint8_t* base = frame_base(index);
+        std::memcpy(&slot, base, sizeof(slot));
+        pixels = base + kShmFrameHeaderBytes;
+        if (slot.index != index || slot.bytes > header()->slot_bytes - kShmFrameHeaderBytes) return false;
+        if (slot.ndim < 1 || slot.ndim > 3) return false;
+        uint64_t elements = 1;
+        for (uint32_t i = 0; i < slot.ndim; ++i) {
+            elements *= slot.shape[i];
+            if (elements > slot.bytes) return false;
+        }
+        return elements == slot.bytes;
+    }
+
+    // True when a frame returned by latest_frame() was neither overwritten
+    // nor rewritten while the caller used it; check after copying
+    bool frame_intact(const ShmFrameSlot& slot) const {
+        if (!intact(slot.index)) return false;
+        ShmFrameSlot now;
+        std::memcpy(&now, frame_base(slot.index), sizeof(now));
+        return std::memcmp(&now, &slot, sizeof(slot)) == 0;
+    }
+
+    // Mark frames up to index as consumed, for the writer's lag report
+    void consumed(uint64_t index) {
+        _cursor = std::max(_cursor, index + 1);
+        if (_slot) _slot->cursor.store(_cursor, std::memory_order_relaxed);
+    }
+
+    // Poll until head passes target or timeout; cross-process wake-ups would need an OS primitive per platform
+    bool wait_for(uint64_t target, std::chrono::milliseconds timeout) const {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (head() < target) {
+            if (closed() || std::chrono::steady_clock::now() >= deadline) return head() >= target;
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+        return true;
+    }
+
+private:
+    ShmHeader* header() const { return reinterpret_cast<ShmHeader*>(_seg->data()); }
+
+    const uint8_t* frame_base(uint64_t index) const {
+        return _data + static_cast<size_t>(index % _capacity) * header()->slot_bytes;
+    }
+
+    void claim_slot() {
+        const uint32_t me = shm_current_pid();
+        for (int pass = 0; pass < 2 && !_slot; ++pass) {
+            for (ShmReaderSlot& r : header()->readers) {
+                uint32_t pid = r.pid.load(std::memory_order_relaxed);
+                // First pass takes free slots, the second reclaims those of dead readers
+                if ((pass == 0 && pid != 0) || (pass == 1 && (pid == 0 || shm_process_alive(pid)))) continue;
+                if (r.pid.compare_exchange_strong(pid, me)) {
+                    _slot = &r;
+                    break;
+                }
+            }
+        }
+        // Without a free slot the reader still works; the writer just cannot see its lag
+    }
+
+    std::unique_ptr<SharedSegment> _seg;
+    uint8_t* _data{nullptr};
+    size_t _capacity{0};
+    ShmReaderSlot* _slot{nullptr};
+    uint64_t _cursor{0};
+    uint64_t _dropped{0};
+
+    // The header comes from another process: every column and frame slot must lie within
+    // the `room` bytes after data_offset. Written as divisions so capacity * n cannot wrap.
+    static bool layout_fits(const ShmHeader& h, uint64_t room) {
+        if (h.capacity == 0 || h.column_count > kShmMaxColumns) return false;
+        if (h.kind == kShmKindFrames &&
+            (h.slot_bytes < kShmFrameHeaderBytes || h.capacity > room / h.slot_bytes)) {
+            return false;
+        }
+        for (uint32_t c = 0; c < h.column_count; ++c) {
+            const ShmColumn& col = h.columns[c];
+            if (col.itemsize != 0 && h.capacity > room / col.itemsize) return false;
+            if (col.offset > room - h.capacity * col.itemsize) return false;
+        }
+        return true;
+    }
+};
+
+// Readers of one segment kind, for the Python bindings
+class ShmStreamReader : public ShmReader {
+public:
+    explicit ShmStreamReader(const std::string& name) : ShmReader(name) {
+        if (kind() != kShmKindRing) throw std::invalid_argument("'" + name + "' is not a sample stream segment");
+    }
+};
+
+class ShmFrameReader : public ShmReader {
+public:
+    explicit ShmFrameReader(const std::string& name) : ShmReader(name) {
+        if (kind() != kShmKindFrames) throw std::invalid_argument("'" + name + "' is not a frame segment");
+    }
+};
@@ -0,0 +1,290 @@
+#pragma once
+
+// Structure-of-arrays ring buffers used by the native capture paths.
+//
+// SoaRing<Columns...> stores one cache-line aligned array per column, so a
+// consumer that only needs some channels (e.g. timestamp + GSR) touches only
+// those arrays, and every drain is at most two memcpy calls per column.
+// Column count and element types are fixed at compile time; the capacity is
+// chosen at construction and rounded up to a power of two.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+constexpr size_t kCacheLineSize = 64;
+
+// Fixed-size heap array aligned to a cache line
+template <typename T>
+class AlignedColumn {
+    static_assert(std::is_trivially_copyable<T>::value, "ring columns must be trivially copyable");
+
+public:
+    explicit AlignedColumn(size_t n)
+        : _data(static_cast<T*>(::operator new[](n * sizeof(T), std::align_val_t(kCacheLineSize)))) {
+        std::memset(_data.get(), 0, n * sizeof(T));
+    }
+
+    T* data() { return _data.get(); }
+    const T* data() const { return _data.get(); }
+    T& operator[](size_t i) { return _data[i]; }
+    const T& operator[](size_t i) const { return _data[i]; }
+
+private:
+    struct Deleter {
+        void operator()(T* p) const { ::operator delete[](p, std::align_val_t(kCacheLineSize)); }
+    };
+    std::unique_ptr<T[], Deleter> _data;
+};
+
+// Single-producer drop-oldest ring with one array per column.
+//
+// The producer is wait-free and never reads consumer state: it only writes
+// the slots, `_claim` and `_head`. Each consumer owns a Reader cursor and
+// validates what it copied seqlock-style: before touching slot i the producer
+// publishes `_claim = i + 1`, so after copying a consumer re-reads `_claim`
+// and discards any rows the producer may have been overwriting meanwhile.
+// Lost rows (overrun or torn) are counted in Reader::dropped. Any number of
+// readers may follow the same ring, each from its own thread.
+template <typename... Columns>
+class SoaRing {
+public:
+    static constexpr size_t kColumns = sizeof...(Columns);
+    template <size_t I>
+    using column_type = std::tuple_element_t<I, std::tuple<Columns...>>;
+
+    // Consumer cursor; must only be used by one thread at a time
+    class Reader {
+    public:
+        explicit Reader(uint64_t start = 0) : _cursor(start), _dropped(0) {}
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        uint64_t cursor() const { return _cursor.load(std::memory_order_relaxed); }
+        uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    private:
+        friend class SoaRing;
+        std::atomic<uint64_t> _cursor;  // written by the owning thread only
+        std::atomic<uint64_t> _dropped;
+    };
+
+    explicit SoaRing(size_t capacity)
+        : _cap(next_pow2(capacity)), _mask(_cap - 1), _cols(AlignedColumn<Columns>(_cap)...),
+          _head(0), _claim(0), _default_reader(0) {}
+
+    size_t capacity() const { return _cap; }
+
+    // Total rows ever pushed
+    uint64_t total_pushed() const { return _head.load(std::memory_order_acquire); }
+
+    // Producer push of one row; overwrites the oldest row when full
+    void push(Columns... values) {
+        auto h = _head.load(std::memory_order_relaxed);
+        // Announce the slot before writing it so readers can detect the overlap
+        _claim.store(h + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        write_row(static_cast<size_t>(h & _mask), std::index_sequence_for<Columns...>{}, values...);
+        _head.store(h + 1, std::memory_order_release);
+    }
+
+    // Producer push of n rows from column arrays, published with one head
+    // update; only the newest `capacity` rows are written when n exceeds it
+    void push_n(size_t n, const Columns*... in) {
+        if (n == 0) return;
+        const size_t skip = n > _cap ? n - _cap : 0;
+        auto h = _head.load(std::memory_order_relaxed);
+        _claim.store(h + n, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        write_rows(static_cast<size_t>((h + skip) & _mask), skip, n - skip, std::index_sequence_for<Columns...>{},
+                   in...);
+        _head.store(h + n, std::memory_order_release);
+    }
+
+    // Reader that only sees rows pushed from now on
+    std::unique_ptr<Reader> make_reader() const {
+        return std::make_unique<Reader>(_head.load(std::memory_order_acquire));
+    }
+
+    // Rows currently available to a reader (capped at capacity). Pairs with
+    // the release in read(), so a producer that waits for a reader's backlog
+    // to shrink only reuses slots that reader has finished copying.
+    size_t available(const Reader& r) const {
+        auto h = _head.load(std::memory_order_acquire);
+        const uint64_t cursor = r._cursor.load(std::memory_order_acquire);
+        return static_cast<size_t>(std::min<uint64_t>(h - std::min(h, cursor), _cap));
+    }
+
+    // Copy up to max rows for a reader into caller-owned column buffers.
+    // Pass nullptr for columns that are not needed; they are skipped, not
+    // copied. Returns the number of valid rows written to the front of out.
+    size_t read(Reader& r, size_t max, Columns*... out) {
+        auto h = _head.load(std::memory_order_acquire);
+        const uint64_t cursor = r.cursor();
+        uint64_t start = cursor;
+        if (h > _cap && start < h - _cap) {
+            start = h - _cap;  // already overwritten before we got here
+        }
+        auto count = static_cast<size_t>(std::min<uint64_t>(h - start, max));
+        copy_rows(static_cast<size_t>(start & _mask), count, std::index_sequence_for<Columns...>{}, out...);
+
+        // Rows below claim - cap may have been rewritten while we copied
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto claim = _claim.load(std::memory_order_relaxed);
+        size_t torn = 0;
+        if (claim > _cap && start < claim - _cap) {
+            torn = static_cast<size_t>(std::min<uint64_t>(claim - _cap - start, count));
+            shift_rows(torn, count - torn, std::index_sequence_for<Columns...>{}, out...);
+        }
+
+        uint64_t lost = (start - cursor) + torn;
+        if (lost) {
+            r._dropped.fetch_add(lost, std::memory_order_relaxed);
+        }
+        r._cursor.store(start + count, std::memory_order_release);
+        return count - torn;
+    }
+
+    // Default reader used by the single-consumer convenience API below
+    Reader& default_reader() { return _default_reader; }
+    const Reader& default_reader() const { return _default_reader; }
+
+    size_t size() const { return available(_default_reader); }
+    uint64_t dropped() const { return _default_reader.dropped(); }
+    size_t pop_into(size_t max, Columns*... out) { return read(_default_reader, max, out...); }
+
+private:
+    static size_t next_pow2(size_t v) {
+        size_t p = 1;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    template <size_t... I>
+    void write_row(size_t slot, std::index_sequence<I...>, Columns... values) {
+        ((std::get<I>(_cols)[slot] = values), ...);
+    }
+
+    template <size_t I>
+    void write_column(size_t first, size_t count, const column_type<I>* in) {
+        auto* dst = std::get<I>(_cols).data();
+        size_t seg1 = std::min(count, _cap - first);
+        std::memcpy(dst + first, in, seg1 * sizeof(column_type<I>));
+        if (count > seg1) {
+            std::memcpy(dst, in + seg1, (count - seg1) * sizeof(column_type<I>));
+        }
+    }
+
+    template <size_t... I>
+    void write_rows(size_t first, size_t skip, size_t count, std::index_sequence<I...>, const Columns*... in) {
+        (write_column<I>(first, count, in + skip), ...);
+    }
+
+    template <size_t I>
+    void copy_column(size_t first, size_t count, column_type<I>* out) const {
+        if (out == nullptr || count == 0) return;
+        const auto* src = std::get<I>(_cols).data();
+        size_t seg1 = std::min(count, _cap - first);
+        std::memcpy(out, src + first, seg1 * sizeof(column_type<I>));
+        if (count > seg1) {
+            std::memcpy(out + seg1, src, (count - seg1) * sizeof(column_type<I>));
+        }
+    }
+
+    template <size_t... I>
+    void copy_rows(size_t first, size_t count, std::index_sequence<I...>, Columns*... out) const {
+        (copy_column<I>(first, count, out), ...);
+    }
+
+    // Drop the first `skip` rows of each output column (rare torn-read path)
+    template <size_t... I>
+    static void shift_rows(size_t skip, size_t keep, std::index_sequence<I...>, Columns*... out) {
+        ((out != nullptr && keep ? (void)std::memmove(out, out + skip, keep * sizeof(column_type<I>)) : (void)0), ...);
+    }
+
+    const size_t _cap;
+    const size_t _mask;
+    std::tuple<AlignedColumn<Columns>...> _cols;
+    alignas(kCacheLineSize) std::atomic<uint64_t> _head;   // rows published
+    std::atomic<uint64_t> _claim;                           // rows being written (head or head + 1)
+    alignas(kCacheLineSize) Reader _default_reader;
+};
+
+// Two-column (timestamp, value) ring
+using SpscRing = SoaRing<double, double>;
+
+// Lets consumers sleep until a ring's producer has published a target row
+// count. The producer pays one fence and one atomic load per notify() unless
+// a consumer is waiting for the row just published.
+class RingSignal {
+public:
+    // Producer: call after publishing rows up to `head`
+    void notify(uint64_t head) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (head >= _wake_at.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> g(_mtx);
+            _wake_at.store(kNobody, std::memory_order_relaxed);
+            _cv.notify_all();
+        }
+    }
+
+    // Wake every waiter regardless of target (used on shutdown)
+    void wake_all() {
+        std::lock_guard<std::mutex> g(_mtx);
+        ++_generation;
+        _cv.notify_all();
+    }
+
+    // Consumer: block until head() >= target, timeout or wake_all().
+    // Returns true if the target was reached.
+    template <typename HeadFn>
+    bool wait(uint64_t target, HeadFn head, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lk(_mtx);
+        const uint64_t generation = _generation;
+        WaiterScope scope(*this);
+        while (true) {
+            if (target < _wake_at.load(std::memory_order_relaxed)) {
+                _wake_at.store(target, std::memory_order_relaxed);
+            }
+            // Pairs with the fence in notify(): either we see the new head or it sees _wake_at
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (head() >= target) return true;
+            if (generation != _generation ||
+                _cv.wait_until(lk, deadline) == std::cv_status::timeout) {
+                return head() >= target;
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t kNobody = std::numeric_limits<uint64_t>::max();
+
+    // Counts a waiter while it holds _mtx. The last one to leave clears
+    // _wake_at, so a target abandoned on timeout or wake_all() does not keep
+    // notify() taking the mutex.
+    struct WaiterScope {
+        explicit WaiterScope(RingSignal& s) : signal(s) { ++signal._waiters; }
+        ~WaiterScope() {
+            if (--signal._waiters == 0) signal._wake_at.store(kNobody, std::memory_order_relaxed);
+        }
+        RingSignal& signal;
+    };
+
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::atomic<uint64_t> _wake_at{kNobody};
+    uint64_t _generation{0};  // guarded by _mtx
+    size_t _waiters{0};       // guarded by _mtx
+};
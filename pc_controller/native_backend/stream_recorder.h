@@ -0,0 +1,512 @@
+#pragma once
+
+// Native recorders that write capture streams to disk on their own I/O
+// thread, so a stalled GUI or Python consumer never costs samples on disk.
+//
+// File layout (little-endian, append-only):
+//
+//   header   "NBREC01\0", u32 n_columns,
+//            per column: u16 name_len, name, u16 type_len, NumPy typestr
+//   chunk*   u32 "CHNK", u32 rows, u64 first_row, u64 bytes[n_columns],
+//            then each column's bytes back to back
+//   index    per chunk: u64 offset, u64 first_row, u64 rows
+//   trailer  u64 index_offset, u64 n_chunks, u64 total_rows, "NBRIDX1\0"
+//
+// Fixed-width columns hold rows * itemsize bytes per chunk. Blob columns
+// (typestr "|u1", e.g. frame pixels or JPEG data) carry one variable-size
+// payload per row and are written one row per chunk. A file without
+// a trailer (crash, power loss) can still be read by scanning the chunks
+// from the end of the header.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "frame_pool.h"
+#include "soa_ring.h"
+#include "thread_registry.h"
+
+// When the recorder forces data to stable storage
+enum class RecorderSync {
+    None,      // leave it to the OS page cache
+    OnClose,   // fsync once when the recording is stopped
+    EveryChunk // fsync after every chunk (bounded loss on power failure, slower)
+};
+
+inline RecorderSync parse_recorder_sync(const std::string& name) {
+    if (name == "none") return RecorderSync::None;
+    if (name == "close") return RecorderSync::OnClose;
+    if (name == "chunk") return RecorderSync::EveryChunk;
+    throw std::invalid_argument("sync must be 'none', 'close' or 'chunk'");
+}
+
+template <typename T> struct RecorderTypeStr;
+template <> struct RecorderTypeStr<double>   { static constexpr const char* value = "<f8"; };
+template <> struct RecorderTypeStr<uint8_t>  { static constexpr const char* value = "|u1"; };
+template <> struct RecorderTypeStr<uint16_t> { static constexpr const char* value = "<u2"; };
+template <> struct RecorderTypeStr<uint32_t> { static constexpr const char* value = "<u4"; };
+template <> struct RecorderTypeStr<uint64_t> { static constexpr const char* value = "<u8"; };
+
+struct RecorderColumn {
+    std::string name;
+    std::string typestr;  // NumPy array-interface type string
+};
+
+struct RecorderStats {
+    uint64_t rows{0};
+    uint64_t chunks{0};
+    uint64_t bytes{0};
+    uint64_t dropped{0};  // rows/frames lost before reaching the I/O thread
+};
+
+// Chunked columnar file; used from one thread only
+class ColumnarFileWriter {
+public:
+    ColumnarFileWriter(const std::string& path, std::vector<RecorderColumn> columns, RecorderSync sync)
+        : _columns(std::move(columns)), _sync(sync) {
+#ifdef _WIN32
+        _fd = ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        if (_fd < 0) {
+            throw std::runtime_error("Cannot open recording file: " + path);
+        }
+        std::vector<uint8_t> header;
+        append(header, "NBREC01\0", 8);
+        append_u32(header, static_cast<uint32_t>(_columns.size()));
+        for (const auto& col : _columns) {
+            append_u16(header, static_cast<uint16_t>(col.name.size()));
+            append(header, col.name.data(), col.name.size());
+            append_u16(header, static_cast<uint16_t>(col.typestr.size()));
+            append(header, col.typestr.data(), col.typestr.size());
+        }
+        Part part{header.data(), header.size()};
+        try {
+            write_parts(&part, 1);
+        } catch (...) {
+            close_fd(_fd);
+            throw;
+        }
+    }
+
+    ColumnarFileWriter(const ColumnarFileWriter&) = delete;
+    ColumnarFileWriter& operator=(const ColumnarFileWriter&) = delete;
+
+    ~ColumnarFileWriter() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    struct Part {
+        const void* data;
+        size_t bytes;
+    };
+
+    // Append one chunk; column_parts holds one (pointer, bytes) per column
+    void write_chunk(uint32_t rows, const std::vector<Part>& column_parts) {
+        if (column_parts.size() != _columns.size()) {
+            throw std::logic_error("chunk column count does not match the schema");
+        }
+        _chunk_header.clear();
+        append_u32(_chunk_header, 0x4B4E4843u);  // "CHNK"
+        append_u32(_chunk_header, rows);
+        append_u64(_chunk_header, _total_rows);
+        for (const auto& part : column_parts) {
+            append_u64(_chunk_header, part.bytes);
+        }
+        _parts.clear();
+        _parts.push_back({_chunk_header.data(), _chunk_header.size()});
+        _parts.insert(_parts.end(), column_parts.begin(), column_parts.end());
+
+        _index.push_back({_offset, _total_rows, rows});
+        write_parts(_parts.data(), _parts.size());
+        _total_rows += rows;
+        if (_sync == RecorderSync::EveryChunk) {
+            sync_fd();
+        }
+    }
+
+    // Write the index footer and close; safe to call more than once
+    void close() {
+        if (_fd < 0) return;
+        std::vector<uint8_t> footer;
+        footer.reserve(_index.size() * 24 + 32);
+        for (const auto& e : _index) {
+            append_u64(footer, e.offset);
+            append_u64(footer, e.first_row);
+            append_u64(footer, e.rows);
+        }
+        append_u64(footer, _offset);
+        append_u64(footer, _index.size());
+        append_u64(footer, _total_rows);
+        append(footer, "NBRIDX1\0", 8);
+        Part part{footer.data(), footer.size()};
+        int fd = _fd;
+        try {
+            write_parts(&part, 1);
+            if (_sync != RecorderSync::None) sync_fd();
+        } catch (...) {
+            close_fd(fd);
+            _fd = -1;
+            throw;
+        }
+        close_fd(fd);
+        _fd = -1;
+    }
+
+    uint64_t bytes_written() const { return _offset; }
+    uint64_t chunks_written() const { return _index.size(); }
+    uint64_t rows_written() const { return _total_rows; }
+
+private:
+    struct IndexEntry {
+        uint64_t offset;
+        uint64_t first_row;
+        uint64_t rows;
+    };
+
+    static void append(std::vector<uint8_t>& out, const void* p, size_t n) {
+        auto* b = static_cast<const uint8_t*>(p);
+        out.insert(out.end(), b, b + n);
+    }
+    static void append_u16(std::vector<uint8_t>& out, uint16_t v) { append(out, &v, sizeof(v)); }
+    static void append_u32(std::vector<uint8_t>& out, uint32_t v) { append(out, &v, sizeof(v)); }
+    static void append_u64(std::vector<uint8_t>& out, uint64_t v) { append(out, &v, sizeof(v)); }
+
+    // One gathered write per chunk on POSIX; retried until every byte is written
+    void write_parts(Part* parts, size_t count) {
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) total += parts[i].bytes;
+#ifdef _WIN32
+        for (size_t i = 0; i < count; ++i) {
+            auto* p = static_cast<const char*>(parts[i].data);
+            size_t left = parts[i].bytes;
+            while (left > 0) {
+                int n = ::_write(_fd, p, static_cast<unsigned>(std::min<size_t>(left, 1u << 30)));
+                if (n <= 0) throw std::runtime_error("Recording write failed");
+                p += n;
+                left -= static_cast<size_t>(n);
+            }
+        }
+#else
+        std::vector<iovec> iov;
+        iov.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (parts[i].bytes) iov.push_back({const_cast<void*>(parts[i].data), parts[i].bytes});
+        }
+        size_t first = 0;
+        while (first < iov.size()) {
+            int n_iov = static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+            ssize_t n = ::writev(_fd, iov.data() + first, n_iov);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("Recording write failed: ") + std::strerror(errno));
+            }
+            auto done = static_cast<size_t>(n);
+            while (first < iov.size() && done >= iov[first].iov_len) {
+                done -= iov[first].iov_len;
+                ++first;
+            }
+            if (done > 0) {
+                iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + done;
+                iov[first].iov_len -= done;
+            }
+        }
+#endif
+        _offset += total;
+    }
+
+    void sync_fd() {
+#ifdef _WIN32
+        ::_commit(_fd);
+#elif defined(__APPLE__)
+        ::fsync(_fd);
+#else
+        ::fdatasync(_fd);
+#endif
+    }
+
+    static void close_fd(int fd) {
+#ifdef _WIN32
+        ::_close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    std::vector<RecorderColumn> _columns;
+    RecorderSync _sync;
+    int _fd{-1};
+    uint64_t _offset{0};
+    uint64_t _total_rows{0};
+    std::vector<IndexEntry> _index;
+    std::vector<uint8_t> _chunk_header;  // reused per chunk
+    std::vector<Part> _parts;
+};
+
+// Background thread lifecycle shared by the recorders below. Subclasses
+// implement drain(), which runs on the I/O thread every flush interval and
+// once more on stop.
+class RecorderThread {
+public:
+    virtual ~RecorderThread() = default;
+
+    // Stops the I/O thread, flushes and closes the file. Rethrows the first
+    // I/O error hit by the thread.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            _stop = true;
+        }
+        _cv.notify_all();
+        if (_thread.joinable()) _thread.join();
+        if (!_error.empty()) {
+            throw std::runtime_error("Recording failed: " + _error);
+        }
+    }
+
+    RecorderStats stats() const {
+        RecorderStats s;
+        s.rows = _rows.load(std::memory_order_relaxed);
+        s.chunks = _chunks.load(std::memory_order_relaxed);
+        s.bytes = _bytes.load(std::memory_order_relaxed);
+        s.dropped = dropped();
+        return s;
+    }
+
+    // Rows or frames handed over but not yet written; a producer that runs
+    // faster than real time (a replay) waits on this instead of dropping
+    virtual size_t backlog() const = 0;
+
+    // Wake the I/O thread before the flush interval expires
+    void kick() { _cv.notify_one(); }
+
+protected:
+    RecorderThread(const std::string& path, std::vector<RecorderColumn> columns, RecorderSync sync,
+                   std::chrono::milliseconds flush_interval)
+        : _writer(path, std::move(columns), sync), _flush_interval(flush_interval) {}
+
+    void start() {
+        _thread = spawn_thread("recorder", "recorder", [this] { run(); });
+    }
+
+    // Join before members of derived classes go away
+    void join_in_destructor() {
+        try {
+            stop();
+        } catch (...) {
+        }
+    }
+
+    virtual void drain() = 0;
+    virtual uint64_t dropped() const = 0;
+
+    void write_chunk(uint32_t rows, const std::vector<ColumnarFileWriter::Part>& parts) {
+        _writer.write_chunk(rows, parts);
+        _rows.store(_writer.rows_written(), std::memory_order_relaxed);
+        _chunks.store(_writer.chunks_written(), std::memory_order_relaxed);
+        _bytes.store(_writer.bytes_written(), std::memory_order_relaxed);
+    }
+
+    mutable std::mutex _mtx;  // guards _stop; derived classes may reuse it for their queues
+    std::condition_variable _cv;
+    bool _stop{false};
+
+private:
+    void run() {
+        try {
+            std::unique_lock<std::mutex> lk(_mtx);
+            while (!_stop) {
+                _cv.wait_for(lk, _flush_interval);
+                lk.unlock();
+                drain();
+                lk.lock();
+            }
+            lk.unlock();
+            drain();
+            _writer.close();
+            _bytes.store(_writer.bytes_written(), std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            _error = e.what();
+        }
+    }
+
+    ColumnarFileWriter _writer;
+    std::chrono::milliseconds _flush_interval;
+    std::thread _thread;
+    std::string _error;  // written by the I/O thread, read after join
+    std::atomic<uint64_t> _rows{0};
+    std::atomic<uint64_t> _chunks{0};
+    std::atomic<uint64_t> _bytes{0};
+};
+
+// Records every row pushed to a SoaRing from now on, through its own Reader.
+// The producer is untouched; if the disk falls more than a ring's worth
+// behind, the lost rows show up in stats().dropped.
+template <typename... Columns>
+class RingRecorder : public RecorderThread {
+public:
+    using Ring = SoaRing<Columns...>;
+
+    RingRecorder(const std::string& path, Ring& ring, const std::vector<std::string>& names, RecorderSync sync,
+                 size_t chunk_rows = 1024, std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100))
+        : RecorderThread(path, make_columns(names), sync, flush_interval),
+          _ring(ring), _reader(ring.make_reader()), _chunk_rows(std::max<size_t>(1, chunk_rows)) {
+        resize_staging(std::index_sequence_for<Columns...>{});
+        start();
+    }
+
+    ~RingRecorder() override { join_in_destructor(); }
+
+    size_t backlog() const override { return _ring.available(*_reader); }
+
+private:
+    static std::vector<RecorderColumn> make_columns(const std::vector<std::string>& names) {
+        if (names.size() != sizeof...(Columns)) {
+            throw std::invalid_argument("one column name is required per ring column");
+        }
+        std::vector<RecorderColumn> cols;
+        const char* types[] = {RecorderTypeStr<Columns>::value...};
+        for (size_t i = 0; i < names.size(); ++i) {
+            cols.push_back({names[i], types[i]});
+        }
+        return cols;
+    }
+
+    template <size_t... I>
+    void resize_staging(std::index_sequence<I...>) {
+        (std::get<I>(_staging).resize(_chunk_rows), ...);
+    }
+
+    template <size_t... I>
+    size_t read_chunk(std::index_sequence<I...>) {
+        return _ring.read(*_reader, _chunk_rows, std::get<I>(_staging).data()...);
+    }
+
+    template <size_t... I>
+    void write_staged(size_t rows, std::index_sequence<I...>) {
+        _parts.clear();
+        ((_parts.push_back({std::get<I>(_staging).data(), rows * sizeof(Columns)})), ...);
+        write_chunk(static_cast<uint32_t>(rows), _parts);
+    }
+
+    void drain() override {
+        while (true) {
+            size_t rows = read_chunk(std::index_sequence_for<Columns...>{});
+            if (rows == 0) break;
+            write_staged(rows, std::index_sequence_for<Columns...>{});
+            if (rows < _chunk_rows && _ring.available(*_reader) == 0) break;
+        }
+    }
+
+    uint64_t dropped() const override { return _reader->dropped(); }
+
+    Ring& _ring;
+    std::unique_ptr<typename Ring::Reader> _reader;
+    const size_t _chunk_rows;
+    std::tuple<std::vector<Columns>...> _staging;
+    std::vector<ColumnarFileWriter::Part> _parts;
+};
+
+// Records published frames, one chunk per frame. The capture thread hands
+// over a shared reference; the buffer returns to the pool once written.
+class FrameRecorder : public RecorderThread {
+public:
+    FrameRecorder(const std::string& path, RecorderSync sync, size_t max_queue = 4,
+                  std::chrono::milliseconds flush_interval = std::chrono::milliseconds(50))
+        : RecorderThread(path,
+                         {{"seq", "<u8"}, {"timestamp", "<f8"}, {"width", "<u4"}, {"height", "<u4"},
+                          {"channels", "<u4"}, {"format", "<u4"}, {"pixels", "|u1"}},
+                         sync, flush_interval),
+          _max_queue(std::max<size_t>(1, max_queue)) {
+        start();
+    }
+
+    ~FrameRecorder() override { join_in_destructor(); }
+
+    size_t backlog() const override {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _queue.size();
+    }
+
+    size_t max_queue() const { return _max_queue; }
+
+    // Notified after every frame written (nullptr stops)
+    void set_release_signal(std::shared_ptr<FrameReleaseSignal> signal) {
+        std::lock_guard<std::mutex> g(_mtx);
+        _released = std::move(signal);
+    }
+
+    // Capture thread: queue a published frame; dropped if the disk is behind
+    void push(std::shared_ptr<FrameBuffer> frame) {
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            if (_queue.size() >= _max_queue) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            _queue.push_back(std::move(frame));
+        }
+        kick();
+    }
+
+private:
+    void drain() override {
+        while (true) {
+            std::shared_ptr<FrameBuffer> frame;
+            std::shared_ptr<FrameReleaseSignal> released;
+            {
+                std::lock_guard<std::mutex> g(_mtx);
+                if (_queue.empty()) return;
+                frame = std::move(_queue.front());
+                _queue.pop_front();
+                released = _released;
+            }
+            // Frames are stored in their native pixel format (see PixelFormat)
+            uint32_t dims[4] = {static_cast<uint32_t>(frame->width), static_cast<uint32_t>(frame->height),
+                                static_cast<uint32_t>(frame->channels), static_cast<uint32_t>(frame->format)};
+            size_t pixel_bytes = std::min(frame->capacity(), frame->bytes);
+            write_chunk(1, {{&frame->seq, sizeof(uint64_t)},
+                            {&frame->timestamp, sizeof(double)},
+                            {&dims[0], sizeof(uint32_t)},
+                            {&dims[1], sizeof(uint32_t)},
+                            {&dims[2], sizeof(uint32_t)},
+                            {&dims[3], sizeof(uint32_t)},
+                            {frame->pixels(), pixel_bytes}});
+            frame.reset();
+            if (released) released->notify();
+        }
+    }
+
+    uint64_t dropped() const override { return _dropped.load(std::memory_order_relaxed); }
+
+    const size_t _max_queue;
+    std::deque<std::shared_ptr<FrameBuffer>> _queue;  // guarded by _mtx
+    std::shared_ptr<FrameReleaseSignal> _released;    // likewise
+    std::atomic<uint64_t> _dropped{0};
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+// Lock-free per-stream instrumentation: event counters and latency histograms.
+//
+// Writers are the acquisition, capture and drain threads; they only do
+// relaxed atomic increments, so recording costs a few nanoseconds and never
+// blocks. Readers take a snapshot at any time. A snapshot taken while
+// writers are active is not a single instant (a count may be one sample
+// ahead of a bucket), which is fine for diagnostics.
+//
+// LatencyHistogram is log-linear in the HDR histogram style: values are
+// kept in microseconds, exact below 32 us and in 32 linear sub-buckets per
+// power of two above, i.e. within ~3% of the recorded value. The range is
+// 0 to 2^32 us (71 minutes); larger values land in the top bucket.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+class StatCounter {
+public:
+    void add(uint64_t n = 1) { _v.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return _v.load(std::memory_order_relaxed); }
+    void reset() { _v.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> _v{0};
+};
+
+struct HistogramSnapshot {
+    uint64_t count{0};
+    // Seconds; all 0 while count is 0
+    double min{0.0};
+    double mean{0.0};
+    double p50{0.0};
+    double p90{0.0};
+    double p99{0.0};
+    double p999{0.0};
+    double max{0.0};
+};
+
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr uint64_t kSub = uint64_t{1} << kSubBits;
+    static constexpr int kMaxExponent = 31;
+    static constexpr size_t kBuckets = static_cast<size_t>(kSub * (kMaxExponent - kSubBits + 2));
+
+    // Record one value in seconds; negative values count as 0
+    void record(double seconds) {
+        const uint64_t us = to_us(seconds);
+        _buckets[index_of(us)].fetch_add(1, std::memory_order_relaxed);
+        _sum_us.fetch_add(us, std::memory_order_relaxed);
+        uint64_t seen = _max_us.load(std::memory_order_relaxed);
+        while (us > seen && !_max_us.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+        }
+        seen = _min_us.load(std::memory_order_relaxed);
+        while (us < seen && !_min_us.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSnapshot snapshot() const {
+        std::array<uint64_t, kBuckets> counts;
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts[i] = _buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        HistogramSnapshot s;
+        s.count = total;
+        if (total == 0) return s;
+        s.min = static_cast<double>(_min_us.load(std::memory_order_relaxed)) * 1e-6;
+        s.max = static_cast<double>(_max_us.load(std::memory_order_relaxed)) * 1e-6;
+        s.mean = static_cast<double>(_sum_us.load(std::memory_order_relaxed)) * 1e-6 / static_cast<double>(total);
+        s.p50 = percentile(counts, total, 0.50, s);
+        s.p90 = percentile(counts, total, 0.90, s);
+        s.p99 = percentile(counts, total, 0.99, s);
+        s.p999 = percentile(counts, total, 0.999, s);
+        return s;
+    }
+
+    void reset() {
+        for (auto& b : _buckets) b.store(0, std::memory_order_relaxed);
+        _sum_us.store(0, std::memory_order_relaxed);
+        _max_us.store(0, std::memory_order_relaxed);
+        _min_us.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    }
+
+    static size_t index_of(uint64_t us) {
+        if (us < kSub) return static_cast<size_t>(us);
+        const int e = highest_bit(us);
+        if (e > kMaxExponent) return kBuckets - 1;
+        // The top kSubBits + 1 bits select the bucket; the leading one is implied by e
+        const uint64_t sub = (us >> (e - kSubBits)) - kSub;
+        return static_cast<size_t>(kSub * static_cast<uint64_t>(e - kSubBits + 1) + sub);
+    }
+
+    // Smallest and one past the largest microsecond value of a bucket
+    static uint64_t lower_bound(size_t index) {
+        if (index < kSub) return index;
+        const uint64_t e = index / kSub + kSubBits - 1;
+        return (kSub + index % kSub) << (e - kSubBits);
+    }
+
+    static uint64_t upper_bound(size_t index) {
+        if (index < kSub) return index + 1;
+        const uint64_t e = index / kSub + kSubBits - 1;
+        return lower_bound(index) + (uint64_t{1} << (e - kSubBits));
+    }
+
+private:
+    // Index of the most significant set bit; us must be non-zero
+    static int highest_bit(uint64_t us) {
+#ifdef _MSC_VER
+        unsigned long bit;
+        _BitScanReverse64(&bit, us);
+        return static_cast<int>(bit);
+#else
+        return 63 - __builtin_clzll(us);
+#endif
+    }
+
+    static uint64_t to_us(double seconds) {
+        if (!(seconds > 0.0)) return 0;
+        const double us = seconds * 1e6;
+        return us >= 1.8e19 ? std::numeric_limits<uint64_t>::max() : static_cast<uint64_t>(us + 0.5);
+    }
+
+    // Midpoint of the bucket holding the q-quantile, kept within the observed range
+    static double percentile(const std::array<uint64_t, kBuckets>& counts, uint64_t total, double q,
+                             const HistogramSnapshot& s) {
+        const auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank && counts[i] > 0) {
+                const double mid = 0.5 * static_cast<double>(lower_bound(i) + upper_bound(i) - 1) * 1e-6;
+                return std::clamp(mid, s.min, s.max);
+            }
+        }
+        return s.max;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> _buckets{};
+    std::atomic<uint64_t> _sum_us{0};
+    std::atomic<uint64_t> _max_us{0};
+    std::atomic<uint64_t> _min_us{std::numeric_limits<uint64_t>::max()};
+};
+
+// Interval between successive events of one producer thread
+class IntervalHistogram {
+public:
+    // Record the time since the previous mark(); the first mark only starts the clock
+    void mark(double now_s) {
+        const double last = _last.exchange(now_s, std::memory_order_relaxed);
+        if (last > 0.0) _hist.record(now_s - last);
+    }
+
+    // Forget the previous event, e.g. when a stream restarts
+    void restart() { _last.store(0.0, std::memory_order_relaxed); }
+
+    HistogramSnapshot snapshot() const { return _hist.snapshot(); }
+    void reset() { _hist.reset(); }
+
+private:
+    std::atomic<double> _last{0.0};
+    LatencyHistogram _hist;
+};
@@ -0,0 +1,389 @@
+#pragma once
+
+// Incremental timestamp join of GSR streams onto video frames.
+//
+// StreamJoiner keeps a bounded, time-ordered history per GSR device and the
+// frames of each camera that are still waiting. A frame is joined once every
+// device has a sample at or after its timestamp, or once the newest input
+// (any stream) is max_delay past it. For each device it then gets two things:
+// the GSR value linearly interpolated at the frame time, and the window of
+// samples since the camera's previous frame. Inputs arrive in time order, so
+// each camera keeps one cursor per device and visits every sample once. There
+// is no searching. All timestamps share one clock (steady_clock seconds: the
+// Shimmer aligned_ts and the webcam frame timestamp).
+//
+// JoinRecorder writes joined frames (without their windows) to the columnar
+// format of stream_recorder.h on its own I/O thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stream_recorder.h"
+
+struct SyncConfig {
+    double max_delay{0.5};        // stream seconds a frame waits for devices that are behind
+    double buffer_seconds{10.0};  // GSR history kept per device
+    size_t capacity{4096};        // joined frames kept per camera until drained
+};
+
+inline void validate_sync_config(const SyncConfig& cfg) {
+    if (!(cfg.max_delay >= 0.0) || !std::isfinite(cfg.max_delay)) {
+        throw std::invalid_argument("max_delay must be a non-negative number of seconds");
+    }
+    if (!(cfg.buffer_seconds > cfg.max_delay) || !std::isfinite(cfg.buffer_seconds)) {
+        throw std::invalid_argument("buffer_seconds must be finite and longer than max_delay");
+    }
+    if (cfg.capacity == 0) {
+        throw std::invalid_argument("capacity must be positive");
+    }
+}
+
+struct SyncStats {
+    uint64_t frames{0};        // frames joined
+    uint64_t forced{0};        // of those, joined before every device caught up
+    uint64_t samples{0};       // GSR samples taken in
+    uint64_t trimmed{0};       // samples that aged out of the history before a camera windowed them
+    uint64_t out_of_order{0};  // samples or frames ignored because their time ran backwards
+    uint64_t overwritten{0};   // joined frames discarded before they were drained
+    uint64_t pending{0};       // frames waiting for their devices
+    uint64_t dropped{0};       // samples or frames lost before reaching the joiner (set by the owner)
+};
+
+// Joined frames, column by column. Per-device columns are frame-major
+// ([frame * devices + device]); window_start indexes the device's
+// window_ts / window_gsr, which hold the windows back to back.
+struct JoinedColumns {
+    size_t devices{0};
+    std::vector<uint32_t> camera;
+    std::vector<uint64_t> seq;
+    std::vector<double> timestamp;
+    std::vector<double> gsr_us;          // interpolated at timestamp; NaN without a bracketing pair
+    std::vector<uint32_t> window_count;  // samples in (previous frame, frame]
+    std::vector<double> window_mean;     // their mean GSR; NaN for an empty window
+    std::vector<uint64_t> window_start;
+    std::vector<std::vector<double>> window_ts, window_gsr;
+
+    explicit JoinedColumns(size_t n_devices = 0)
+        : devices(n_devices), window_ts(n_devices), window_gsr(n_devices) {}
+
+    size_t size() const { return seq.size(); }
+
+    // Drop the oldest n frames and their windows
+    void erase_front(size_t n) {
+        n = std::min(n, size());
+        if (n == 0) return;
+        const auto frames = static_cast<std::ptrdiff_t>(n);
+        const auto cells = static_cast<std::ptrdiff_t>(n * devices);
+        for (size_t d = 0; d < devices; ++d) {
+            const uint64_t cut = n < size() ? window_start[n * devices + d] : window_ts[d].size();
+            window_ts[d].erase(window_ts[d].begin(), window_ts[d].begin() + static_cast<std::ptrdiff_t>(cut));
+            window_gsr[d].erase(window_gsr[d].begin(), window_gsr[d].begin() + static_cast<std::ptrdiff_t>(cut));
+            for (size_t i = n * devices + d; i < window_start.size(); i += devices) window_start[i] -= cut;
+        }
+        camera.erase(camera.begin(), camera.begin() + frames);
+        seq.erase(seq.begin(), seq.begin() + frames);
+        timestamp.erase(timestamp.begin(), timestamp.begin() + frames);
+        gsr_us.erase(gsr_us.begin(), gsr_us.begin() + cells);
+        window_count.erase(window_count.begin(), window_count.begin() + cells);
+        window_mean.erase(window_mean.begin(), window_mean.begin() + cells);
+        window_start.erase(window_start.begin(), window_start.begin() + cells);
+    }
+};
+
+// Single-threaded merge engine; the caller serialises access
+class StreamJoiner {
+public:
+    // Samples carrying any of gap_flags follow lost data; interpolation does not bridge them
+    StreamJoiner(size_t devices, size_t cameras, const SyncConfig& cfg, uint32_t gap_flags)
+        : _cfg(cfg), _gap_flags(gap_flags), _devices(devices), _cameras(cameras) {
+        validate_sync_config(cfg);
+        for (auto& cam : _cameras) {
+            cam.cursor.assign(devices, 0);
+            cam.out = JoinedColumns(devices);
+        }
+    }
+
+    size_t devices() const { return _devices.size(); }
+    size_t cameras() const { return _cameras.size(); }
+
+    void add_samples(size_t device, const double* ts, const double* gsr_us, const uint32_t* flags, size_t n) {
+        Device& dev = _devices.at(device);
+        for (size_t i = 0; i < n; ++i) {
+            if (ts[i] < dev.newest) {
+                ++_stats.out_of_order;
+                continue;
+            }
+            dev.history.push_back({ts[i], gsr_us[i], flags[i]});
+            dev.newest = ts[i];
+        }
+        _stats.samples += n;
+        if (n) _now = std::max(_now, dev.newest);
+    }
+
+    void add_frame(size_t camera, uint64_t seq, double ts) {
+        Camera& cam = _cameras.at(camera);
+        if (ts < cam.newest) {
+            ++_stats.out_of_order;
+            return;
+        }
+        cam.newest = ts;
+        cam.pending.push_back({seq, ts});
+        _now = std::max(_now, ts);
+    }
+
+    // Join every frame that is ready, or every pending frame when flushing.
+    // Newly joined frames are also appended to `fresh` if given. Returns
+    // the number joined.
+    size_t join(bool flush, JoinedColumns* fresh = nullptr) {
+        size_t joined = 0;
+        for (size_t c = 0; c < _cameras.size(); ++c) {
+            Camera& cam = _cameras[c];
+            while (!cam.pending.empty()) {
+                const auto [seq, t] = cam.pending.front();
+                const bool caught_up = std::all_of(_devices.begin(), _devices.end(),
+                                                   [t = t](const Device& d) { return d.newest >= t; });
+                if (!caught_up && !flush && _now - t <= _cfg.max_delay) break;
+                cam.pending.pop_front();
+                if (!caught_up) ++_stats.forced;
+                emit(static_cast<uint32_t>(c), cam, seq, t, fresh);
+                ++joined;
+            }
+        }
+        _stats.frames += joined;
+        trim();
+        return joined;
+    }
+
+    // Joined frames of one camera, oldest first
+    JoinedColumns pop(size_t camera) {
+        Camera& cam = _cameras.at(camera);
+        JoinedColumns out(_devices.size());
+        std::swap(out, cam.out);
+        return out;
+    }
+
+    SyncStats stats() const {
+        SyncStats s = _stats;
+        for (const auto& cam : _cameras) s.pending += cam.pending.size();
+        return s;
+    }
+
+private:
+    struct Sample {
+        double ts;
+        double gsr_us;
+        uint32_t flags;
+    };
+
+    struct Device {
+        std::deque<Sample> history;  // time-ordered; history[0] is sample number `base`
+        uint64_t base{0};
+        double newest{-std::numeric_limits<double>::infinity()};
+
+        uint64_t end() const { return base + history.size(); }
+        const Sample& at(uint64_t i) const { return history[static_cast<size_t>(i - base)]; }
+    };
+
+    struct Camera {
+        std::deque<std::pair<uint64_t, double>> pending;  // (seq, timestamp)
+        std::vector<uint64_t> cursor;  // per device: first sample after the previous frame
+        bool started{false};
+        double newest{-std::numeric_limits<double>::infinity()};
+        JoinedColumns out;
+    };
+
+    void emit(uint32_t camera, Camera& cam, uint64_t seq, double t, JoinedColumns* fresh) {
+        JoinedColumns& out = cam.out;
+        out.camera.push_back(camera);
+        out.seq.push_back(seq);
+        out.timestamp.push_back(t);
+        for (size_t d = 0; d < _devices.size(); ++d) {
+            const Device& dev = _devices[d];
+            uint64_t cur = std::max(cam.cursor[d], dev.base);
+            const uint64_t first = cur;
+            while (cur < dev.end() && dev.at(cur).ts <= t) ++cur;
+            cam.cursor[d] = cur;
+            // The first frame of a camera has no previous frame, so its window is empty
+            const uint64_t from = cam.started ? first : cur;
+
+            double value = std::numeric_limits<double>::quiet_NaN();
+            if (cur > dev.base) {
+                const Sample& l = dev.at(cur - 1);
+                if (l.ts == t) {
+                    value = l.gsr_us;
+                } else if (cur < dev.end() && !(dev.at(cur).flags & _gap_flags)) {
+                    const Sample& r = dev.at(cur);
+                    value = l.gsr_us + (r.gsr_us - l.gsr_us) * (t - l.ts) / (r.ts - l.ts);
+                }
+            }
+            double sum = 0.0;
+            out.window_start.push_back(out.window_ts[d].size());
+            for (uint64_t i = from; i < cur; ++i) {
+                out.window_ts[d].push_back(dev.at(i).ts);
+                out.window_gsr[d].push_back(dev.at(i).gsr_us);
+                sum += dev.at(i).gsr_us;
+            }
+            const uint64_t count = cur - from;
+            out.gsr_us.push_back(value);
+            out.window_count.push_back(static_cast<uint32_t>(count));
+            out.window_mean.push_back(count ? sum / static_cast<double>(count)
+                                            : std::numeric_limits<double>::quiet_NaN());
+        }
+        cam.started = true;
+        if (fresh) append_last(out, *fresh);
+        if (out.size() > _cfg.capacity) {
+            // Discard in batches so a consumer that stopped draining costs amortised O(1) per frame
+            const size_t n = std::max<size_t>(1, _cfg.capacity / 4);
+            out.erase_front(n);
+            _stats.overwritten += n;
+        }
+    }
+
+    // Copy the newest frame of src, without its window, to dst
+    static void append_last(const JoinedColumns& src, JoinedColumns& dst) {
+        const size_t i = src.size() - 1, n = src.devices;
+        dst.camera.push_back(src.camera[i]);
+        dst.seq.push_back(src.seq[i]);
+        dst.timestamp.push_back(src.timestamp[i]);
+        for (size_t d = 0; d < n; ++d) {
+            dst.gsr_us.push_back(src.gsr_us[i * n + d]);
+            dst.window_count.push_back(src.window_count[i * n + d]);
+            dst.window_mean.push_back(src.window_mean[i * n + d]);
+            dst.window_start.push_back(0);
+        }
+    }
+
+    // Drop history no camera needs: everything before the left neighbour of
+    // each started camera's cursor that is also older than a frame arriving
+    // max_delay late could ask for. Past buffer_seconds it goes regardless.
+    void trim() {
+        const double late_horizon = _now - _cfg.max_delay;
+        for (size_t d = 0; d < _devices.size(); ++d) {
+            Device& dev = _devices[d];
+            uint64_t needed = dev.end();
+            uint64_t windowed = dev.end();  // below this every started camera has windowed the sample
+            for (const auto& cam : _cameras) {
+                if (!cam.started) continue;
+                const uint64_t cur = cam.cursor[d];
+                needed = std::min(needed, cur > 0 ? cur - 1 : 0);
+                windowed = std::min(windowed, cur);
+            }
+            const double hard_horizon = dev.newest - _cfg.buffer_seconds;
+            while (!dev.history.empty()) {
+                const Sample& s = dev.history.front();
+                // Keep the newest sample before the horizon: it brackets a frame right after it
+                const bool unneeded = dev.base < needed && dev.history.size() > 1 && dev.history[1].ts < late_horizon;
+                if (!unneeded && !(s.ts < hard_horizon)) break;
+                if (dev.base >= windowed) ++_stats.trimmed;
+                dev.history.pop_front();
+                ++dev.base;
+            }
+        }
+    }
+
+    SyncConfig _cfg;
+    uint32_t _gap_flags;
+    std::vector<Device> _devices;
+    std::vector<Camera> _cameras;
+    double _now{-std::numeric_limits<double>::infinity()};  // newest timestamp of any input
+    SyncStats _stats;
+};
+
+// Writes joined frames from now on on a native I/O thread: camera, seq and
+// timestamp, then gsr_us_<d>, window_count_<d> and window_mean_<d> for each
+// device d
+class JoinRecorder : public RecorderThread {
+public:
+    static constexpr size_t kMaxStaged = 1 << 16;
+
+    JoinRecorder(const std::string& path, size_t devices, RecorderSync sync)
+        : RecorderThread(path, make_columns(devices), sync, std::chrono::milliseconds(200)), _devices(devices),
+          _staged(devices) {
+        start();
+    }
+
+    ~JoinRecorder() override { join_in_destructor(); }
+
+    // Queue joined frames (their windows are ignored); dropped if the disk is far behind
+    void push(const JoinedColumns& rows) {
+        std::lock_guard<std::mutex> g(_mtx);
+        if (_staged.size() + rows.size() > kMaxStaged) {
+            _dropped += rows.size();
+            return;
+        }
+        auto append = [](auto& dst, const auto& src) { dst.insert(dst.end(), src.begin(), src.end()); };
+        append(_staged.camera, rows.camera);
+        append(_staged.seq, rows.seq);
+        append(_staged.timestamp, rows.timestamp);
+        append(_staged.gsr_us, rows.gsr_us);
+        append(_staged.window_count, rows.window_count);
+        append(_staged.window_mean, rows.window_mean);
+    }
+
+    size_t backlog() const override {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _staged.size();
+    }
+
+private:
+    static std::vector<RecorderColumn> make_columns(size_t devices) {
+        std::vector<RecorderColumn> cols{{"camera", "<u4"}, {"seq", "<u8"}, {"timestamp", "<f8"}};
+        for (size_t d = 0; d < devices; ++d) {
+            const std::string n = std::to_string(d);
+            cols.push_back({"gsr_us_" + n, "<f8"});
+            cols.push_back({"window_count_" + n, "<u4"});
+            cols.push_back({"window_mean_" + n, "<f8"});
+        }
+        return cols;
+    }
+
+    void drain() override {
+        JoinedColumns rows(_devices);
+        {
+            std::lock_guard<std::mutex> g(_mtx);
+            std::swap(rows, _staged);
+        }
+        const size_t n = rows.size();
+        if (n == 0) return;
+        // Per-device columns are frame-major in memory; gather each into its own run
+        _gsr.resize(n * _devices);
+        _count.resize(n * _devices);
+        _mean.resize(n * _devices);
+        for (size_t d = 0; d < _devices; ++d) {
+            for (size_t i = 0; i < n; ++i) {
+                _gsr[d * n + i] = rows.gsr_us[i * _devices + d];
+                _count[d * n + i] = rows.window_count[i * _devices + d];
+                _mean[d * n + i] = rows.window_mean[i * _devices + d];
+            }
+        }
+        std::vector<ColumnarFileWriter::Part> parts{{rows.camera.data(), n * sizeof(uint32_t)},
+                                                    {rows.seq.data(), n * sizeof(uint64_t)},
+                                                    {rows.timestamp.data(), n * sizeof(double)}};
+        for (size_t d = 0; d < _devices; ++d) {
+            parts.push_back({_gsr.data() + d * n, n * sizeof(double)});
+            parts.push_back({_count.data() + d * n, n * sizeof(uint32_t)});
+            parts.push_back({_mean.data() + d * n, n * sizeof(double)});
+        }
+        write_chunk(static_cast<uint32_t>(n), parts);
+    }
+
+    uint64_t dropped() const override {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _dropped;
+    }
+
+    const size_t _devices;
+    JoinedColumns _staged;  // guarded by _mtx
+    uint64_t _dropped{0};   // likewise
+    std::vector<double> _gsr, _mean;  // I/O thread only
+    std::vector<uint32_t> _count;
+};
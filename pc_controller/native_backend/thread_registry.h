@@ -0,0 +1,281 @@
+#pragma once
+
+// Registry of the native backend's threads.
+//
+// Every acquisition, encode and recording thread is started with
+// spawn_thread(role, name, fn). The thread names itself, applies the policy
+// configured for its role and is listed by the registry until it exits.
+//
+// A policy is a priority and a CPU set. Priority 0 is the normal scheduler;
+// 1-99 requests SCHED_FIFO at that priority on POSIX systems, and
+// THREAD_PRIORITY_TIME_CRITICAL on Windows. Real-time scheduling usually
+// needs privileges (CAP_SYS_NICE or an rtprio limit on Linux); when the OS
+// refuses, the thread keeps the normal scheduler and the reason is
+// reported with the thread instead of failing the capture. Changing a
+// role's policy also re-applies it to that role's running threads.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct ThreadPolicy {
+    int priority{0};        // 0 = normal scheduler, 1-99 = real-time priority
+    std::vector<int> cpus;  // allowed CPUs; empty = any
+};
+
+struct ThreadInfo {
+    std::string name;
+    std::string role;
+    uint64_t tid{0};           // OS thread id (0 where the platform has none to show)
+    int priority{0};           // priority in effect
+    std::vector<int> cpus;     // affinity in effect; empty = any
+    std::string error;         // why the policy was not (fully) applied, if it was not
+};
+
+class ThreadRegistry {
+public:
+    // Highest priority accepted for SCHED_FIFO
+    static constexpr int kMaxPriority = 99;
+    static constexpr int kMaxCpus = 1024;
+
+    static ThreadRegistry& instance() {
+        static ThreadRegistry registry;
+        return registry;
+    }
+
+    // Start fn on a new registered thread
+    std::thread spawn(std::string role, std::string name, std::function<void()> fn) {
+        return std::thread([this, role = std::move(role), name = std::move(name), fn = std::move(fn)]() {
+            Registration reg(*this, role, name);
+            fn();
+        });
+    }
+
+    // Set the policy of a role; threads already running in it are updated
+    void set_policy(const std::string& role, ThreadPolicy policy) {
+        if (policy.priority < 0 || policy.priority > kMaxPriority) {
+            throw std::invalid_argument("thread priority must be between 0 and 99");
+        }
+        for (int cpu : policy.cpus) {
+            if (cpu < 0 || cpu >= kMaxCpus) {
+                throw std::invalid_argument("CPU index out of range: " + std::to_string(cpu));
+            }
+        }
+        std::lock_guard<std::mutex> g(_mtx);
+        _policies[role] = policy;
+        for (Entry& e : _threads) {
+            if (e.info.role == role) apply(e, policy);
+        }
+    }
+
+    ThreadPolicy policy(const std::string& role) const {
+        std::lock_guard<std::mutex> g(_mtx);
+        auto it = _policies.find(role);
+        return it == _policies.end() ? ThreadPolicy{} : it->second;
+    }
+
+    std::map<std::string, ThreadPolicy> policies() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        return _policies;
+    }
+
+    std::vector<ThreadInfo> threads() const {
+        std::lock_guard<std::mutex> g(_mtx);
+        std::vector<ThreadInfo> out;
+        out.reserve(_threads.size());
+        for (const Entry& e : _threads) out.push_back(e.info);
+        return out;
+    }
+
+private:
+#ifdef _WIN32
+    using Handle = HANDLE;
+#else
+    using Handle = pthread_t;
+#endif
+
+    struct Entry {
+        uint64_t id;
+        Handle handle;
+        ThreadInfo info;
+    };
+
+    // Lists the calling thread for as long as it lives
+    class Registration {
+    public:
+        Registration(ThreadRegistry& reg, const std::string& role, const std::string& name)
+            : _reg(reg), _id(reg.add(role, name)) {}
+        ~Registration() { _reg.remove(_id); }
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+    private:
+        ThreadRegistry& _reg;
+        uint64_t _id;
+    };
+
+    uint64_t add(const std::string& role, const std::string& name) {
+        set_current_name(name);
+        Entry e;
+        e.info.name = name;
+        e.info.role = role;
+#ifdef _WIN32
+        e.info.tid = GetCurrentThreadId();
+        // GetCurrentThread() is a pseudo handle; other threads need a real one to re-apply policies
+        DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &e.handle,
+                        THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION, FALSE, 0);
+#else
+        e.handle = pthread_self();
+#ifdef __linux__
+        e.info.tid = static_cast<uint64_t>(syscall(SYS_gettid));
+#endif
+#endif
+        std::lock_guard<std::mutex> g(_mtx);
+        e.id = ++_next_id;
+        // Threads of roles without a policy keep whatever they inherited
+        auto it = _policies.find(role);
+        if (it != _policies.end()) apply(e, it->second);
+        _threads.push_back(std::move(e));
+        return _next_id;
+    }
+
+    void remove(uint64_t id) {
+        std::lock_guard<std::mutex> g(_mtx);
+        for (auto it = _threads.begin(); it != _threads.end(); ++it) {
+            if (it->id == id) {
+#ifdef _WIN32
+                CloseHandle(it->handle);
+#endif
+                _threads.erase(it);
+                return;
+            }
+        }
+    }
+
+    static void set_current_name(const std::string& name) {
+#if defined(_WIN32)
+        std::wstring wide(name.begin(), name.end());
+        SetThreadDescription(GetCurrentThread(), wide.c_str());
+#elif defined(__APPLE__)
+        pthread_setname_np(name.c_str());
+#elif defined(__linux__)
+        // The kernel keeps 15 characters plus the terminator
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    // Requires _mtx. Records what actually took effect in e.info.
+    static void apply(Entry& e, const ThreadPolicy& policy) {
+        std::string error;
+        e.info.priority = apply_priority(e.handle, policy.priority, error);
+        e.info.cpus = apply_affinity(e.handle, policy.cpus, error) ? policy.cpus : std::vector<int>{};
+        e.info.error = error;
+    }
+
+    static void append(std::string& error, const std::string& msg) {
+        error += error.empty() ? msg : "; " + msg;
+    }
+
+    static int apply_priority(Handle h, int priority, std::string& error) {
+#ifdef _WIN32
+        int level = priority > 0 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_NORMAL;
+        if (!SetThreadPriority(h, level)) {
+            append(error, "SetThreadPriority failed (error " + std::to_string(GetLastError()) + ")");
+            return 0;
+        }
+        return priority;
+#else
+        sched_param param{};
+        param.sched_priority = priority;
+        int rc = pthread_setschedparam(h, priority > 0 ? SCHED_FIFO : SCHED_OTHER, &param);
+        if (rc != 0) {
+            append(error, std::string(priority > 0 ? "SCHED_FIFO" : "SCHED_OTHER") + " refused: " +
+                              std::strerror(rc));
+            if (priority > 0) {
+                // Stay on (or fall back to) the normal scheduler
+                param.sched_priority = 0;
+                pthread_setschedparam(h, SCHED_OTHER, &param);
+            }
+            return 0;
+        }
+        return priority;
+#endif
+    }
+
+    static bool apply_affinity(Handle h, const std::vector<int>& cpus, std::string& error) {
+#if defined(_WIN32)
+        DWORD_PTR mask = 0;
+        for (int cpu : cpus) {
+            if (cpu >= static_cast<int>(8 * sizeof(DWORD_PTR))) {
+                append(error, "CPU " + std::to_string(cpu) + " is outside this process group");
+                return false;
+            }
+            mask |= DWORD_PTR{1} << cpu;
+        }
+        if (mask == 0) {
+            DWORD_PTR system_mask = 0;
+            GetProcessAffinityMask(GetCurrentProcess(), &mask, &system_mask);
+        }
+        if (!SetThreadAffinityMask(h, mask)) {
+            append(error, "SetThreadAffinityMask failed (error " + std::to_string(GetLastError()) + ")");
+            return false;
+        }
+        return true;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (cpus.empty()) {
+            // Back to the CPUs of the main thread (the process's launch affinity)
+            if (sched_getaffinity(getpid(), sizeof(set), &set) != 0) return true;
+        }
+        for (int cpu : cpus) CPU_SET(cpu, &set);
+        int rc = pthread_setaffinity_np(h, sizeof(set), &set);
+        if (rc != 0) {
+            append(error, std::string("CPU affinity refused: ") + std::strerror(rc));
+            return false;
+        }
+        return true;
+#else
+        (void)h;
+        if (!cpus.empty()) {
+            append(error, "CPU affinity is not supported on this platform");
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    mutable std::mutex _mtx;  // guards everything below
+    std::map<std::string, ThreadPolicy> _policies;
+    std::vector<Entry> _threads;
+    uint64_t _next_id{0};
+};
+
+// Start fn on a named thread that follows the policy of `role`
+inline std::thread spawn_thread(std::string role, std::string name, std::function<void()> fn) {
+    return ThreadRegistry::instance().spawn(std::move(role), std::move(name), std::move(fn));
+}
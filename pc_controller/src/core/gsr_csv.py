@@ -8,6 +8,10 @@ Usage:
 
 This module keeps dependencies minimal and is suitable for tests and simple
 recording pipelines (e.g., SimulatedShimmer callbacks).
+
+raw_to_microsiemens() recomputes conductance from raw Shimmer3 GSR words
+offline, using the native SIMD kernel when the extension is built and an
+equivalent NumPy implementation otherwise.
 """
 
 from __future__ import annotations
@@ -17,6 +21,37 @@ import threading
 from pathlib import Path
 from typing import Any, TextIO
 
+# Shimmer3 GSR+ feedback resistors for ranges 0-3 (kOhm)
+SHIMMER3_GSR_RF_KOHM: tuple[float, float, float, float] = (40.2, 287.0, 1000.0, 3300.0)
+
+
+def raw_to_microsiemens(
+    raw: Any,
+    rf_kohm: tuple[float, float, float, float] | None = None,
+    vref: float = 3.0,
+    v_bias: float = 0.5,
+) -> Any:
+    """Convert raw GSR words (ADC bits 0-11, range bits 14-15) to microsiemens.
+
+    Returns a float64 NumPy array. Values are clamped at 0.1 uS, matching the
+    conversion applied by NativeShimmer while streaming.
+    """
+    import numpy as np
+
+    raw_u16 = np.ascontiguousarray(raw, dtype=np.uint16)
+    try:
+        from pc_controller.native_backend.native_backend import gsr_raw_to_microsiemens
+    except Exception:
+        gsr_raw_to_microsiemens = None
+    if gsr_raw_to_microsiemens is not None:
+        return gsr_raw_to_microsiemens(raw_u16, list(rf_kohm or ()), vref, v_bias)
+
+    rf = np.asarray(rf_kohm or SHIMMER3_GSR_RF_KOHM, dtype=np.float64)
+    adc = (raw_u16 & 0x0FFF).astype(np.float64)
+    volts = adc * (vref / 4095.0)
+    us = (volts / v_bias - 1.0) * (1000.0 / rf[(raw_u16 >> 14) & 0x3])
+    return np.maximum(us, 0.1)
+
 
 class GsrCsvWriter:
     def __init__(self, file_path: str | Path, newline: str = "") -> None:
@@ -23,11 +23,21 @@ import importlib
 import threading
 import time
 from collections import deque
+from collections.abc import Callable
 
 import numpy as np
 
+try:
+    from ..config import get as cfg_get
+except Exception:  # pragma: no cover
+
+    def cfg_get(key: str, default=None):
+        return default
+
+
 _ns_cls = None
 _nw_cls = None
+nb_mod = None
 try:
     nb_mod = importlib.import_module("pc_controller.native_backend.native_backend")
     _ns_cls = getattr(nb_mod, "NativeShimmer", None)
@@ -42,6 +52,28 @@ except Exception:
         _nw_cls = None
 
 
+def apply_native_thread_policy(policy: dict | None = None) -> None:
+    """Apply per-role scheduling of native capture threads.
+
+    `policy` maps a role (shimmer, webcam, encoder, recorder, dispatch,
+    lsl, analysis, sync) to {"priority": 0-99, "cpus": [...]}; it
+    defaults to the "native_thread_policy" entry of config.json. Roles
+    that the OS refuses real-time scheduling for keep running normally;
+    see native_backend.get_threads() for what took effect. The
+    interfaces apply it when they start a native device.
+    """
+    setter = getattr(nb_mod, "set_thread_policy", None)
+    if setter is None:
+        return
+    if policy is None:
+        policy = cfg_get("native_thread_policy", {}) or {}
+    for role, spec in policy.items():
+        try:
+            setter(role, int(spec.get("priority", 0)), list(spec.get("cpus", [])))
+        except Exception as e:
+            print(f"native thread policy for {role!r} ignored: {e}")
+
+
 class ShimmerInterface:
     """Local Shimmer GSR access via native backend or simulated fallback.
 
@@ -49,15 +81,23 @@ class ShimmerInterface:
     Shimmer dock. Otherwise, a simulated 128 Hz signal is generated.
     """
 
+    _BUFFER_SAMPLES = 4096
+
     def __init__(self, port: str | None = None) -> None:
         self._port = port or "COM3"
         self._use_native = _ns_cls is not None
         self._lock = threading.Lock()
         self._running = False
-        self._buf_ts: deque[float] = deque(maxlen=4096)
-        self._buf_vals: deque[float] = deque(maxlen=4096)
+        self._buf_ts: deque[float] = deque(maxlen=self._BUFFER_SAMPLES)
+        self._buf_vals: deque[float] = deque(maxlen=self._BUFFER_SAMPLES)
+        # Native path keeps drained (ts, vals) array chunks to avoid per-sample objects
+        self._chunks: deque[tuple[np.ndarray, np.ndarray]] = deque()
+        self._chunk_samples = 0
         self._thread: threading.Thread | None = None
         self._native: object | None = None
+        # Link state listeners, called from _link_thread with native event dicts
+        self._link_listeners: list[Callable[[dict], None]] = []
+        self._link_thread: threading.Thread | None = None
         
         # Performance tracking for native backend demonstration
         self._samples_processed = 0
@@ -69,12 +109,20 @@ class ShimmerInterface:
         self._running = True
         if self._use_native:
             try:
+                apply_native_thread_policy()
                 self._native = _ns_cls()  # type: ignore[operator]
+                policy = cfg_get("shimmer_reconnect", {}) or {}
+                if policy:
+                    self._native.set_reconnect_policy(**policy)
                 self._native.connect(self._port)
                 self._native.start_streaming()
                 self._native_backend_active = True
                 self._thread = threading.Thread(target=self._native_loop, daemon=True)
                 self._thread.start()
+                self._link_thread = threading.Thread(
+                    target=self._link_loop, args=(self._native,), daemon=True
+                )
+                self._link_thread.start()
                 print(f"ShimmerInterface: Started with native C++ backend for high-performance GSR capture")
                 return
             except Exception as e:
@@ -94,9 +142,188 @@ class ShimmerInterface:
             self._thread.join(timeout=0.5)
         self._thread = None
         if self._native is not None:
+            with contextlib.suppress(Exception):
+                self._native.stop_recording()
+            with contextlib.suppress(Exception):
+                self._native.disable_lsl()
             with contextlib.suppress(Exception):
                 self._native.stop_streaming()
+            # Callbacks usually reference their owner; drop them so the device can be freed
+            with contextlib.suppress(Exception):
+                for sub in self._native.get_subscriptions():
+                    self._native.unsubscribe(sub["id"])
             self._native = None
+        if self._link_thread and self._link_thread.is_alive():
+            self._link_thread.join(timeout=1.0)
+        self._link_thread = None
+
+    def add_link_listener(self, callback: Callable[[dict], None]) -> None:
+        """Call ``callback(event)`` on every native link state change.
+
+        Events are the dicts of NativeShimmer.wait_for_link_events (seq,
+        state, timestamp, attempt, message); state is one of "streaming",
+        "reconnecting", "failed" or "idle". Callbacks run on a background
+        thread and must not block.
+        """
+        self._link_listeners.append(callback)
+
+    def subscribe(
+        self,
+        callback: Callable[[dict], None],
+        batch_size: int = 32,
+        max_latency_ms: float = 50.0,
+    ) -> int | None:
+        """Deliver new native samples to ``callback(channels)`` in batches.
+
+        A native dispatcher thread calls back with the column arrays of
+        NativeShimmer.get_latest_channels() once batch_size samples are
+        pending or the oldest has waited max_latency_ms. Every subscriber
+        sees every sample, independently of get_latest_samples(). Returns a
+        subscription id, or None when the native backend is not active.
+        """
+        native = self._native
+        if native is None:
+            return None
+        return native.subscribe(callback, batch_size, max_latency_ms)  # type: ignore[attr-defined]
+
+    def unsubscribe(self, subscription_id: int) -> bool:
+        """Stop a subscription made with subscribe()."""
+        native = self._native
+        if native is None:
+            return False
+        return native.unsubscribe(subscription_id)  # type: ignore[attr-defined]
+
+    def link_state(self) -> str:
+        """Native link state, or "simulated" on the Python fallback."""
+        native = self._native
+        if native is None:
+            return "simulated"
+        return native.link_state()  # type: ignore[attr-defined]
+
+    def start_recording(self, path: str, sync: str = "close") -> bool:
+        """Record straight to disk on the native I/O thread.
+
+        Returns False when the native backend is not active; callers then keep
+        recording through the Python path.
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.start_recording(str(path), sync)  # type: ignore[attr-defined]
+        return True
+
+    def stop_recording(self) -> dict[str, int] | None:
+        """Stop a native recording; returns its rows/chunks/bytes/dropped counts."""
+        native = self._native
+        if native is None:
+            return None
+        return native.stop_recording()  # type: ignore[attr-defined]
+
+    def enable_lsl(
+        self,
+        stream_name: str,
+        chunk_size: int = 1,
+        max_latency_ms: float = 10.0,
+        source_id: str = "",
+        device_id: str = "",
+    ) -> bool:
+        """Publish GSR/PPG to LSL from the native acquisition side.
+
+        Returns False when the native backend is not active; raises if it was
+        built without LSL support (native_backend.lsl_enabled).
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.enable_lsl(  # type: ignore[attr-defined]
+            stream_name, chunk_size, max_latency_ms, source_id, device_id
+        )
+        return True
+
+    def disable_lsl(self) -> dict[str, object] | None:
+        """Close the native LSL stream; returns its samples/chunks/dropped counts."""
+        native = self._native
+        if native is None:
+            return None
+        return native.disable_lsl()  # type: ignore[attr-defined]
+
+    def enable_eda(self, **options: float) -> bool:
+        """Start native tonic/phasic and SCR extraction on the live stream.
+
+        Options are those of NativeShimmer.enable_eda(). Returns False when the
+        native backend is not active.
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.enable_eda(**options)  # type: ignore[attr-defined]
+        return True
+
+    def get_eda_features(self) -> dict[str, np.ndarray] | None:
+        """Pop aligned_ts/cleaned/tonic/phasic columns; None without the native backend."""
+        native = self._native
+        if native is None:
+            return None
+        return native.get_eda_features()  # type: ignore[attr-defined]
+
+    def get_scr_events(self) -> dict[str, np.ndarray] | None:
+        """Pop SCRs detected since the last call; None without the native backend."""
+        native = self._native
+        if native is None:
+            return None
+        return native.get_scr_events()  # type: ignore[attr-defined]
+
+    def enable_plot_cache(self, fanout: int = 8) -> bool:
+        """Keep the whole session natively in a min/max pyramid for query_plot().
+
+        Returns False when the native backend is not active.
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.enable_plot_cache(fanout)  # type: ignore[attr-defined]
+        return True
+
+    def query_plot(
+        self,
+        t0: float = float("-inf"),
+        t1: float = float("inf"),
+        max_points: int = 2000,
+        method: str = "minmax",
+    ) -> tuple[np.ndarray, np.ndarray] | None:
+        """Return at most max_points (ts, gsr) points of [t0, t1] for drawing.
+
+        Cost depends on max_points, not on the session length. None without
+        the native backend.
+        """
+        native = self._native
+        if native is None:
+            return None
+        return native.query_plot_cache(t0, t1, max_points, method)  # type: ignore[attr-defined]
+
+    def enable_flight_recorder(self, path: str, minutes: float = 5.0) -> bool:
+        """Journal the last minutes of samples natively in a crash-safe file.
+
+        Recover it with data.flight_recorder.read_flight_recorder(). Returns
+        False when the native backend is not active.
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.enable_flight_recorder(path, minutes)  # type: ignore[attr-defined]
+        return True
+
+    def enable_shm(self, name: str, capacity: int = 0) -> bool:
+        """Publish samples into a named shared segment for other processes.
+
+        Readers attach with native_backend.ShmStreamReader(name). Returns False
+        when the native backend is not active.
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.enable_shm(name, capacity)  # type: ignore[attr-defined]
+        return True
 
     def get_latest_samples(self) -> tuple[np.ndarray, np.ndarray]:
         """Return all currently buffered samples and clear internal buffers.
@@ -105,14 +332,23 @@ class ShimmerInterface:
         order for plotting and tests.
         """
         with self._lock:
-            if not self._buf_ts:
+            if not self._buf_ts and not self._chunks:
                 return np.array([], dtype=np.float64), np.array([], dtype=np.float64)
-            ts = np.fromiter(self._buf_ts, dtype=np.float64, count=len(self._buf_ts))
-            vals = np.fromiter(
-                self._buf_vals, dtype=np.float64, count=len(self._buf_vals)
-            )
+            ts_parts = [c[0] for c in self._chunks]
+            val_parts = [c[1] for c in self._chunks]
+            if self._buf_ts:
+                ts_parts.append(
+                    np.fromiter(self._buf_ts, dtype=np.float64, count=len(self._buf_ts))
+                )
+                val_parts.append(
+                    np.fromiter(self._buf_vals, dtype=np.float64, count=len(self._buf_vals))
+                )
+            ts = np.concatenate(ts_parts)
+            vals = np.concatenate(val_parts)
             self._buf_ts.clear()
             self._buf_vals.clear()
+            self._chunks.clear()
+            self._chunk_samples = 0
         if ts.size > 1:
             order = np.argsort(ts)
             ts = ts[order]
@@ -120,25 +356,31 @@ class ShimmerInterface:
         return ts, vals
 
     def get_performance_stats(self) -> dict[str, any]:
-        """Get performance statistics for native backend demonstration."""
+        """Get performance statistics for native backend demonstration.
+
+        "native_stats" holds the native layer's counters and latency
+        histograms (see NativeShimmer.get_stats) while the native backend is
+        active, otherwise None.
+        """
+        native = self._native
         return {
             "native_backend_active": self._native_backend_active,
             "samples_processed": self._samples_processed,
-            "buffer_size": len(self._buf_ts),
-            "backend_type": "C++ Native" if self._native_backend_active else "Python Simulation"
+            "buffer_size": len(self._buf_ts) + self._chunk_samples,
+            "backend_type": "C++ Native" if self._native_backend_active else "Python Simulation",
+            "native_stats": native.get_stats() if native is not None else None,  # type: ignore[attr-defined]
         }
 
     def _native_loop(self) -> None:
-        poll_dt = 0.005
+        # Block in native code until 8 samples are buffered or 50 ms pass, instead of polling
+        batch, timeout_ms = 8, 50
         while self._running:
             try:
-                samples = self._native.get_latest_samples()  # type: ignore[attr-defined]
-                if samples:
+                self._native.wait_for_samples(batch, timeout_ms)  # type: ignore[attr-defined]
+                ts, vals = self._native.get_latest_samples_array()  # type: ignore[attr-defined]
+                if ts.size:
                     with self._lock:
-                        for t, v in samples:
-                            self._buf_ts.append(float(t))
-                            self._buf_vals.append(float(v))
-                            self._samples_processed += 1
+                        self._append_chunk(ts, vals)
             except Exception as e:
                 print(f"ShimmerInterface: Native loop failed ({e}), falling back to simulation")
                 self._use_native = False
@@ -146,7 +388,43 @@ class ShimmerInterface:
                 self._native = None
                 self._sim_loop()
                 return
-            time.sleep(poll_dt)
+
+    def _link_loop(self, native: object) -> None:
+        # Block in native code for the next transition; the native stream
+        # thread keeps running (and reconnecting) independently of this loop
+        last_seq = 0
+        while self._running:
+            try:
+                events = native.wait_for_link_events(last_seq, 500)  # type: ignore[attr-defined]
+            except Exception:
+                return
+            for event in events:
+                last_seq = event["seq"]
+                if event["state"] == "failed":
+                    print(f"ShimmerInterface: Shimmer link failed ({event['message']})")
+                for callback in list(self._link_listeners):
+                    try:
+                        callback(event)
+                    except Exception as e:
+                        print(f"ShimmerInterface: link listener failed ({e})")
+
+    def _append_chunk(self, ts: np.ndarray, vals: np.ndarray) -> None:
+        """Buffer a drained native chunk, keeping at most _BUFFER_SAMPLES samples.
+
+        Must be called with self._lock held.
+        """
+        self._chunks.append((ts, vals))
+        self._chunk_samples += ts.size
+        self._samples_processed += ts.size
+        while self._chunk_samples > self._BUFFER_SAMPLES:
+            old_ts, old_vals = self._chunks[0]
+            excess = self._chunk_samples - self._BUFFER_SAMPLES
+            if old_ts.size <= excess:
+                self._chunks.popleft()
+                self._chunk_samples -= old_ts.size
+            else:
+                self._chunks[0] = (old_ts[excess:], old_vals[excess:])
+                self._chunk_samples -= excess
 
     def _sim_loop(self) -> None:
         rate = 128.0
@@ -171,10 +449,21 @@ class ShimmerInterface:
 class WebcamInterface:
     """Local webcam access via native backend, OpenCV, or synthetic frames."""
 
-    def __init__(self, device_id: int = 0, width: int = 640, height: int = 480) -> None:
+    def __init__(
+        self,
+        device_id: int = 0,
+        width: int = 640,
+        height: int = 480,
+        fps: float = 30.0,
+        pixel_format: str = "BGR",
+    ) -> None:
         self._device_id = device_id
         self._width = width
         self._height = height
+        self._fps = fps
+        # Capture format of the native backend (BGR, GRAY, YUYV, NV12 or MJPG);
+        # get_latest_frame() always returns BGR
+        self._pixel_format = pixel_format
         self._use_native = _nw_cls is not None
         self._lock = threading.Lock()
         self._running = False
@@ -189,7 +478,14 @@ class WebcamInterface:
         self._running = True
         if self._use_native:
             try:
-                self._native = _nw_cls(self._device_id)  # type: ignore[operator]
+                apply_native_thread_policy()
+                self._native = _nw_cls(  # type: ignore[operator]
+                    self._device_id,
+                    width=self._width,
+                    height=self._height,
+                    fps=self._fps,
+                    pixel_format=self._pixel_format,
+                )
                 self._native.start_capture()
                 self._thread = threading.Thread(target=self._native_loop, daemon=True)
                 self._thread.start()
@@ -209,6 +505,7 @@ class WebcamInterface:
                 try:
                     self._cap.set(cv2.CAP_PROP_FRAME_WIDTH, float(self._width))
                     self._cap.set(cv2.CAP_PROP_FRAME_HEIGHT, float(self._height))
+                    self._cap.set(cv2.CAP_PROP_FPS, float(self._fps))
                 except Exception:
                     pass
                 self._thread = threading.Thread(target=self._cv_loop, daemon=True)
@@ -233,6 +530,10 @@ class WebcamInterface:
             self._thread.join(timeout=0.5)
         self._thread = None
         if self._native is not None:
+            with contextlib.suppress(Exception):
+                self._native.stop_encoding()
+            with contextlib.suppress(Exception):
+                self._native.stop_recording()
             with contextlib.suppress(Exception):
                 self._native.stop_capture()
             self._native = None
@@ -241,23 +542,87 @@ class WebcamInterface:
                 self._cap.release()
             self._cap = None
 
+    def start_recording(self, path: str, sync: str = "close") -> bool:
+        """Record straight to disk on the native I/O thread.
+
+        Returns False when the native backend is not active; callers then keep
+        recording through the Python path.
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.start_recording(str(path), sync)  # type: ignore[attr-defined]
+        return True
+
+    def stop_recording(self) -> dict[str, int] | None:
+        """Stop a native recording; returns its rows/chunks/bytes/dropped counts."""
+        native = self._native
+        if native is None:
+            return None
+        return native.stop_recording()  # type: ignore[attr-defined]
+
+    def start_encoding(self, path: str = "", codec: str = "mjpeg", **options: object) -> bool:
+        """Start the native encode stage (MJPEG or H.264) and its JPEG preview.
+
+        An empty path only feeds get_encoded_preview(). Returns False when the
+        native backend is not active.
+        """
+        native = self._native
+        if native is None:
+            return False
+        native.start_encoding(str(path), codec, **options)  # type: ignore[attr-defined]
+        return True
+
+    def stop_encoding(self) -> dict[str, float] | None:
+        native = self._native
+        if native is None:
+            return None
+        return native.stop_encoding()  # type: ignore[attr-defined]
+
+    def get_encoded_preview(self) -> tuple[bytes, float] | None:
+        """Latest JPEG preview and its capture timestamp, ready for network transport."""
+        native = self._native
+        if native is None:
+            return None
+        got = native.get_encoded_preview()  # type: ignore[attr-defined]
+        return None if got is None else (got[0], got[2])
+
+    def get_performance_stats(self) -> dict[str, object] | None:
+        """Frame counters and latency histograms of the native capture, or None."""
+        native = self._native
+        if native is None:
+            return None
+        return native.get_stats()  # type: ignore[attr-defined]
+
     def get_latest_frame(self) -> np.ndarray | None:
         with self._lock:
             return None if self._frame is None else self._frame.copy()
 
+    def get_native_frame(self) -> np.ndarray | None:
+        """Latest frame in the capture pixel format, without BGR conversion.
+
+        Shapes: GRAY (H, W), YUYV (H, W, 2), NV12 (H * 3 // 2, W), MJPG 1-D
+        JPEG bytes, BGR (H, W, 3). Returns None when the native backend is not
+        active.
+        """
+        native = self._native
+        if native is None:
+            return None
+        return native.get_latest_frame(native=True)  # type: ignore[attr-defined]
+
     def _native_loop(self) -> None:
-        poll_dt = 0.01
+        last_seq = 0
         while self._running:
             try:
-                frame = self._native.get_latest_frame()  # type: ignore[attr-defined]
-                if frame is not None:
+                got = self._native.wait_for_frame(last_seq, 100)  # type: ignore[attr-defined]
+                if got is not None:
+                    frame, last_seq, _ts = got
                     with self._lock:
                         self._frame = frame
             except Exception:
                 self._use_native = False
                 self._synthetic_loop()
                 return
-            time.sleep(poll_dt)
 
     def _cv_loop(self) -> None:
 
@@ -0,0 +1,173 @@
+"""Salvage tool for native flight-recorder journals.
+
+NativeShimmer.enable_flight_recorder() and NativeWebcam.enable_flight_recorder()
+keep the last minutes of samples, or the last encoded frames, in a circular
+memory-mapped journal (see native_backend/flight_recorder.h for the layout).
+read_flight_recorder() recovers every intact record of one, whether the writer
+closed it or the process died; records whose checksum does not match (a page
+torn by a power loss) are skipped. A restart keeps a journal that was never
+closed as "<path>.crash". Run the module to convert a journal to .npz:
+
+    python -m pc_controller.src.data.flight_recorder shimmer.nbfr shimmer.npz
+"""
+
+from __future__ import annotations
+
+import argparse
+import struct
+import zlib
+from pathlib import Path
+from typing import Any
+
+import numpy as np
+
+_MAGIC = b"NBFLT01\0"
+_RECORD_MAGIC = 0x43455246  # "FREC"
+_KIND_ROWS = 1
+_KIND_FRAMES = 2
+_RECORD_HEADER = 64
+
+
+def flight_recorder_info(path: str | Path) -> dict[str, Any]:
+    """Return the journal header and how many of its records are intact.
+
+    Keys: kind ("rows" or "frames"), clean (False if the writer never closed
+    it), writer_pid, records (slots), columns, valid and corrupt.
+    """
+    buf = Path(path).read_bytes()
+    header = _parse_header(buf)
+    valid, corrupt = _records(buf, header)
+    return {
+        "kind": "rows" if header["kind"] == _KIND_ROWS else "frames",
+        "clean": header["clean"],
+        "writer_pid": header["writer_pid"],
+        "records": header["records"],
+        "columns": [name for name, _ in header["columns"]],
+        "valid": len(valid),
+        "corrupt": corrupt,
+    }
+
+
+def read_flight_recorder(path: str | Path) -> dict[str, np.ndarray]:
+    """Return the intact contents of a journal as NumPy arrays, oldest first.
+
+    Sample journals give one array per column (device_ts, ..., flags) plus
+    "row", the index of each sample since the journal was enabled. Frame
+    journals give seq, timestamp, width, height and format per frame and
+    "jpeg", an object array of the encoded bytes.
+    """
+    buf = Path(path).read_bytes()
+    header = _parse_header(buf)
+    valid, _corrupt = _records(buf, header)
+    if header["kind"] == _KIND_ROWS:
+        return _rows(buf, header, valid)
+    return _frames(buf, valid)
+
+
+def _parse_header(buf: bytes) -> dict[str, Any]:
+    if buf[:8] != _MAGIC:
+        raise ValueError("not a native flight recorder journal")
+    version, kind, page_bytes, record_pages, records = struct.unpack_from("<IIIIQ", buf, 8)
+    row_bytes, n_columns, writer_pid, clean = struct.unpack_from("<IIII", buf, 32)
+    if version != 1 or kind not in (_KIND_ROWS, _KIND_FRAMES):
+        raise ValueError(f"unsupported flight recorder journal (version {version}, kind {kind})")
+    columns = []
+    for i in range(n_columns):
+        name, dtype = struct.unpack_from("<24s8s", buf, 64 + 32 * i)
+        columns.append((name.rstrip(b"\0").decode("utf-8"), dtype.rstrip(b"\0").decode("ascii")))
+    return {
+        "kind": kind,
+        "page_bytes": page_bytes,
+        "record_bytes": record_pages * page_bytes,
+        "records": records,
+        "row_bytes": row_bytes,
+        "columns": columns,
+        "writer_pid": writer_pid,
+        "clean": bool(clean),
+    }
+
+
+# (seq, offset, count, first) of one record
+_Record = tuple[int, int, int, int]
+
+
+def _records(buf: bytes, header: dict[str, Any]) -> tuple[list[_Record], int]:
+    # Every record whose checksum matches, by seq, and the number that do not
+    valid: list[_Record] = []
+    corrupt = 0
+    unit = header["row_bytes"] if header["kind"] == _KIND_ROWS else 1
+    for slot in range(header["records"]):
+        offset = header["page_bytes"] + slot * header["record_bytes"]
+        if offset + _RECORD_HEADER > len(buf):
+            break
+        magic, _, seq, first = struct.unpack_from("<IIQQ", buf, offset)
+        (commit,) = struct.unpack_from("<Q", buf, offset + 48)
+        if magic != _RECORD_MAGIC or seq == 0:
+            continue  # never written, or being reused
+        count, crc = commit >> 32, commit & 0xFFFFFFFF
+        start = offset + _RECORD_HEADER
+        end = start + count * unit
+        if end > offset + header["record_bytes"] or zlib.crc32(buf[start:end]) != crc:
+            corrupt += 1
+            continue
+        valid.append((seq, offset, count, first))
+    valid.sort()
+    return valid, corrupt
+
+
+def _rows(buf: bytes, header: dict[str, Any], valid: list[_Record]) -> dict[str, np.ndarray]:
+    dtype = np.dtype([(name, typestr) for name, typestr in header["columns"]])
+    if dtype.itemsize != header["row_bytes"]:
+        raise ValueError("flight recorder columns do not match the row size")
+    parts = [
+        np.frombuffer(buf, dtype=dtype, count=count, offset=off + _RECORD_HEADER)
+        for _, off, count, _ in valid
+    ]
+    rows = np.concatenate(parts) if parts else np.empty(0, dtype=dtype)
+    firsts = [np.arange(first, first + count, dtype=np.uint64) for _, _, count, first in valid]
+    out = {name: np.ascontiguousarray(rows[name]) for name in dtype.names or ()}
+    out["row"] = np.concatenate(firsts) if firsts else np.empty(0, dtype=np.uint64)
+    return out
+
+
+def _frames(buf: bytes, valid: list[_Record]) -> dict[str, np.ndarray]:
+    n = len(valid)
+    out = {
+        "seq": np.empty(n, dtype=np.uint64),
+        "timestamp": np.empty(n, dtype=np.float64),
+        "width": np.empty(n, dtype=np.uint32),
+        "height": np.empty(n, dtype=np.uint32),
+        "format": np.empty(n, dtype=np.uint32),
+        "jpeg": np.empty(n, dtype=object),
+    }
+    for i, (_, offset, count, first) in enumerate(valid):
+        timestamp, width, height, fmt = struct.unpack_from("<dIII", buf, offset + 24)
+        out["seq"][i] = first
+        out["timestamp"][i] = timestamp
+        out["width"][i] = width
+        out["height"][i] = height
+        out["format"][i] = fmt
+        out["jpeg"][i] = buf[offset + _RECORD_HEADER : offset + _RECORD_HEADER + count]
+    return out
+
+
+def main(argv: list[str] | None = None) -> int:
+    parser = argparse.ArgumentParser(description="Salvage a flight-recorder journal to .npz")
+    parser.add_argument("journal", type=Path)
+    parser.add_argument("output", type=Path, nargs="?", help="default: the journal path with .npz")
+    args = parser.parse_args(argv)
+    info = flight_recorder_info(args.journal)
+    data = read_flight_recorder(args.journal)
+    output = args.output or args.journal.with_suffix(".npz")
+    np.savez(output, **data)
+    n = len(data["row"] if info["kind"] == "rows" else data["seq"])
+    state = "closed cleanly" if info["clean"] else f"not closed (writer pid {info['writer_pid']})"
+    print(
+        f"{args.journal}: {state}; {n} {info['kind']} from {info['valid']} records, "
+        f"{info['corrupt']} corrupt -> {output}"
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
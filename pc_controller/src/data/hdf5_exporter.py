@@ -15,6 +15,11 @@ import h5py
 import numpy as np
 import pandas as pd
 
+try:
+    from ..core.gsr_csv import raw_to_microsiemens
+except ImportError:  # imported as a top-level "data" package (GUI)
+    from core.gsr_csv import raw_to_microsiemens
+
 
 def export_session_to_hdf5(
     session_dir: str,
@@ -118,6 +123,21 @@ def export_session_to_hdf5(
                         ds.attrs["sample_rate_hz"] = float(sample_rate_hz)
                 except Exception:
                     pass
+            if "gsr_raw" in data_cols and "gsr_microsiemens" not in data_cols:
+                # Raw-only GSR logs: recompute conductance with the shared kernel
+                with contextlib.suppress(Exception):
+                    raw = pd.to_numeric(df["gsr_raw"], errors="coerce")
+                    # Missing or garbled words have no reading; keep them NaN
+                    invalid = (raw.isna() | ~raw.between(0, 0xFFFF)).to_numpy()
+                    us = raw_to_microsiemens(raw.where(~invalid, 0).astype("uint16").to_numpy())
+                    us[invalid] = np.nan
+                    ds = group.create_dataset(
+                        "gsr_microsiemens", data=us, compression="gzip", compression_opts=4
+                    )
+                    ds.attrs["units"] = "microsiemens"
+                    ds.attrs["derived_from"] = "gsr_raw"
+                    if sample_rate_hz is not None:
+                        ds.attrs["sample_rate_hz"] = float(sample_rate_hz)
         try:
             meta_src = metadata if isinstance(metadata, dict) else None
             if meta_src is None:
@@ -0,0 +1,159 @@
+"""Reader for recordings written by the native backend recorder.
+
+NativeShimmer.start_recording() and NativeWebcam.start_recording() write a
+chunked columnar file (see native_backend/stream_recorder.h for the layout).
+read_native_recording() loads one into NumPy arrays. Files that were never
+closed (the application crashed mid-session) have no index footer; their
+chunks are recovered by scanning from the header.
+"""
+
+from __future__ import annotations
+
+import struct
+from pathlib import Path
+
+import numpy as np
+
+_MAGIC = b"NBREC01\0"
+_TRAILER_MAGIC = b"NBRIDX1\0"
+_CHUNK_MAGIC = 0x4B4E4843
+_TRAILER_SIZE = 32
+_BLOB_TYPE = "|u1"
+
+# PixelFormat codes of the webcam "format" column (native_backend/pixel_format.h)
+PIXEL_FORMATS = {0: "BGR", 1: "GRAY", 2: "YUYV", 3: "NV12", 4: "MJPG"}
+
+
+def read_native_recording(path: str | Path) -> dict[str, np.ndarray]:
+    """Return every column of a native recording as a NumPy array.
+
+    Fixed-width columns are concatenated across chunks. Blob columns hold one
+    payload per row: webcam "pixels" are reshaped to the frame's native pixel
+    format (BGR (H, W, 3), GRAY (H, W), YUYV (H, W, 2), NV12 (H * 3 // 2, W),
+    MJPG 1-D) and stacked into one uint8 array when all frames share a shape
+    (otherwise a 1-D object array of frames). Other blobs such as MJPEG
+    "jpeg" come back as an object array of bytes.
+    """
+    buf = Path(path).read_bytes()
+    columns, pos = _parse_header(buf)
+    chunk_offsets = _index_offsets(buf) or _scan_offsets(buf, pos, len(columns))
+
+    blobs = {name for name, typestr in columns if typestr == _BLOB_TYPE}
+    parts: dict[str, list[np.ndarray]] = {name: [] for name, _ in columns}
+    for offset in chunk_offsets:
+        rows, sizes, data_pos = _parse_chunk_header(buf, offset, len(columns))
+        for (name, typestr), size in zip(columns, sizes, strict=True):
+            dtype = np.dtype(typestr)
+            arr = np.frombuffer(buf, dtype=dtype, count=size // dtype.itemsize, offset=data_pos)
+            if name in blobs:
+                # One payload per row (the recorders write blob chunks one row at a time)
+                parts[name].extend(np.array_split(arr, rows) if rows else [])
+            else:
+                parts[name].append(arr)
+            data_pos += size
+
+    out: dict[str, np.ndarray] = {}
+    for name, typestr in columns:
+        if name in blobs:
+            continue
+        chunks = parts[name]
+        out[name] = np.concatenate(chunks) if chunks else np.empty(0, dtype=np.dtype(typestr))
+    for name in blobs:
+        if name == "pixels":
+            out[name] = _frames(parts[name], out)
+        else:
+            payloads = np.empty(len(parts[name]), dtype=object)
+            for i, payload in enumerate(parts[name]):
+                payloads[i] = payload.tobytes()
+            out[name] = payloads
+    return out
+
+
+def _parse_header(buf: bytes) -> tuple[list[tuple[str, str]], int]:
+    if buf[:8] != _MAGIC:
+        raise ValueError("not a native backend recording")
+    (n_columns,) = struct.unpack_from("<I", buf, 8)
+    pos = 12
+    columns: list[tuple[str, str]] = []
+    for _ in range(n_columns):
+        (name_len,) = struct.unpack_from("<H", buf, pos)
+        name = buf[pos + 2 : pos + 2 + name_len].decode("utf-8")
+        pos += 2 + name_len
+        (type_len,) = struct.unpack_from("<H", buf, pos)
+        typestr = buf[pos + 2 : pos + 2 + type_len].decode("ascii")
+        pos += 2 + type_len
+        columns.append((name, typestr))
+    return columns, pos
+
+
+def _parse_chunk_header(buf: bytes, offset: int, n_columns: int) -> tuple[int, list[int], int]:
+    magic, rows, _first_row = struct.unpack_from("<IIQ", buf, offset)
+    if magic != _CHUNK_MAGIC:
+        raise ValueError(f"corrupt chunk at offset {offset}")
+    sizes = list(struct.unpack_from(f"<{n_columns}Q", buf, offset + 16))
+    return rows, sizes, offset + 16 + 8 * n_columns
+
+
+def _index_offsets(buf: bytes) -> list[int] | None:
+    if len(buf) < _TRAILER_SIZE or buf[-8:] != _TRAILER_MAGIC:
+        return None
+    index_offset, n_chunks, _total_rows = struct.unpack_from("<QQQ", buf, len(buf) - _TRAILER_SIZE)
+    return [struct.unpack_from("<Q", buf, index_offset + 24 * i)[0] for i in range(n_chunks)]
+
+
+def _scan_offsets(buf: bytes, pos: int, n_columns: int) -> list[int]:
+    # No footer: walk the chunks and stop at the first incomplete one
+    offsets: list[int] = []
+    header_size = 16 + 8 * n_columns
+    while pos + header_size <= len(buf):
+        try:
+            _rows, sizes, data_pos = _parse_chunk_header(buf, pos, n_columns)
+        except ValueError:
+            break
+        end = data_pos + sum(sizes)
+        if end > len(buf):
+            break
+        offsets.append(pos)
+        pos = end
+    return offsets
+
+
+def _frame_shape(fmt: int, h: int, w: int, c: int, size: int) -> tuple[int, ...]:
+    name = PIXEL_FORMATS.get(fmt, "BGR")
+    if name == "GRAY":
+        return (h, w)
+    if name == "NV12":
+        return (h * 3 // 2, w)
+    if name == "MJPG":
+        return (size,)
+    return (h, w, c)
+
+
+def _frames(frames: list[np.ndarray], cols: dict[str, np.ndarray]) -> np.ndarray:
+    n = len(frames)
+    # Recordings from before the format column hold BGR frames
+    formats = cols.get("format", np.zeros(n, dtype=np.uint32))
+    dims = list(
+        zip(
+            cols.get("height", []),
+            cols.get("width", []),
+            cols.get("channels", []),
+            formats,
+            strict=False,
+        )
+    )
+    if len(dims) != n:
+        out = np.empty(n, dtype=object)
+        for i, frame in enumerate(frames):
+            out[i] = frame
+        return out
+    shapes = [
+        _frame_shape(int(fmt), int(h), int(w), int(c), frame.size)
+        for (h, w, c, fmt), frame in zip(dims, frames, strict=True)
+    ]
+    if frames and len(set(shapes)) == 1:
+        return np.stack(frames).reshape(n, *shapes[0])
+    out = np.empty(n, dtype=object)
+    for i, (frame, shape) in enumerate(zip(frames, shapes, strict=True)):
+        out[i] = frame.reshape(shape)
+    return out
@@ -60,6 +60,8 @@ class LSLOutletManager:
 
     def __init__(self):
         """Initialize LSL outlet manager."""
+        # Native outlets need liblsl in the native backend, not pylsl
+        self._native_outlets: dict[str, object] = {}
         if not LSL_AVAILABLE:
             logger.warning("pylsl not available - LSL streaming disabled")
             return
@@ -138,6 +140,53 @@ class LSLOutletManager:
             logger.error(f"Failed to create GSR outlet for {device_id}: {e}")
             return False
 
+    def create_native_gsr_outlet(
+        self,
+        device_id: str,
+        source: object,
+        chunk_size: int = 1,
+        max_latency_ms: float = 10.0,
+    ) -> bool:
+        """Publish a native Shimmer's GSR/PPG to LSL without a Python hop.
+
+        The native backend pushes from the acquisition side with device-clock
+        timestamps, which keeps end-to-end latency to other LSL consumers in
+        the low milliseconds. The stream has the name, source id, channel
+        labels and units, and device_id entry of create_gsr_outlet(); its PPG
+        channel is typed "PPG" rather than "GSR".
+
+        Args:
+            device_id: Unique identifier for the device
+            source: NativeShimmer or ShimmerInterface to publish from
+            chunk_size: Samples per LSL push
+            max_latency_ms: Push a partial chunk once its oldest sample is this old
+
+        Returns:
+            True if the native outlet is running, False if LSL is disabled,
+            the source is not native or the backend was built without LSL
+        """
+        if cfg_get("lsl_enabled", "false").lower() != "true":
+            return False
+
+        outlet_name = f"GSR_{device_id}"
+        try:
+            enabled = source.enable_lsl(  # type: ignore[attr-defined]
+                f"GSR Sensor - {device_id}",
+                chunk_size,
+                max_latency_ms,
+                f"gsr_{device_id}",
+                device_id,
+            )
+        except Exception as e:
+            logger.warning(f"Native LSL outlet unavailable for {device_id}: {e}")
+            return False
+        if enabled is False:
+            return False
+
+        self._native_outlets[outlet_name] = source
+        logger.info(f"Created native LSL GSR outlet for device {device_id}")
+        return True
+
     def create_thermal_outlet(
         self,
         device_id: str,
@@ -288,6 +337,16 @@ class LSLOutletManager:
         """
         outlet_name = f"{sensor_type}_{device_id}"
 
+        native = self._native_outlets.pop(outlet_name, None)
+        if native is not None:
+            try:
+                native.disable_lsl()  # type: ignore[attr-defined]
+                logger.info(f"Removed native LSL {sensor_type} outlet for device {device_id}")
+                return True
+            except Exception as e:
+                logger.error(f"Error removing native {sensor_type} outlet for {device_id}: {e}")
+                return False
+
         if outlet_name in self._outlets:
             try:
                 del self._outlets[outlet_name]
@@ -304,10 +363,13 @@ class LSLOutletManager:
 
     def get_active_outlets(self) -> list[str]:
         """Get list of active outlet names."""
-        return list(self._outlets.keys())
+        return list(getattr(self, "_outlets", {}).keys()) + list(self._native_outlets)
 
     def shutdown(self):
         """Shutdown all outlets and clean up resources."""
+        for outlet_name in list(self._native_outlets):
+            sensor_type, device_id = outlet_name.split("_", 1)
+            self.remove_outlet(device_id=device_id, sensor_type=sensor_type)
         if not self.available:
             return
 
@@ -12,6 +12,7 @@ import pytest
 
 pd = pytest.importorskip("pandas")
 h5py = pytest.importorskip("h5py")
+np = pytest.importorskip("numpy")
 
 from pc_controller.src.data.hdf5_exporter import export_session_to_hdf5
 
@@ -101,3 +102,38 @@ def test_export_session_to_hdf5_structure_and_attrs() -> None:
                 assert "stats_json" in sync
                 s = sync["stats_json"][()]
                 assert isinstance(s, bytes | str)
+
+
+def test_export_recomputes_microsiemens_from_raw_gsr() -> None:
+    with tempfile.TemporaryDirectory() as td:
+        root = Path(td)
+        session = root / "20250101_030303"
+        # Range 1 (287 kOhm): ADC 2048 -> ((2048 * 3 / 4095) / 0.5 - 1) * 1000 / 287
+        _write_csv(session / "Shimmer" / "gsr.csv", "timestamp_ns,gsr_raw", [
+            f"1000000000,{(1 << 14) | 2048}",
+            f"2000000000,{(1 << 14) | 2048}",
+        ])
+        written = export_session_to_hdf5(str(session), str(root / "export.h5"))
+        with h5py.File(written, "r") as hf:
+            grp = hf["/Shimmer/gsr"]
+            assert "gsr_raw" in grp and "gsr_microsiemens" in grp
+            us = grp["gsr_microsiemens"][()]
+            expected = ((2048 * 3.0 / 4095.0) / 0.5 - 1.0) * 1000.0 / 287.0
+            assert abs(float(us[0]) - expected) < 1e-9
+            assert grp["gsr_microsiemens"].attrs.get("units") == "microsiemens"
+
+
+def test_export_keeps_missing_raw_gsr_as_nan() -> None:
+    with tempfile.TemporaryDirectory() as td:
+        root = Path(td)
+        session = root / "20250101_040404"
+        _write_csv(session / "Shimmer" / "gsr.csv", "timestamp_ns,gsr_raw", [
+            f"1000000000,{(1 << 14) | 2048}",
+            "2000000000,",
+            "3000000000,garbled",
+        ])
+        written = export_session_to_hdf5(str(session), str(root / "export.h5"))
+        with h5py.File(written, "r") as hf:
+            us = hf["/Shimmer/gsr/gsr_microsiemens"][()]
+            assert np.isfinite(us[0])
+            assert np.isnan(us[1]) and np.isnan(us[2])
@@ -229,6 +229,29 @@ class TestLSLOutletManager:
             assert "GSR_device_001" in active
             assert "Thermal_device_002" in active
 
+    def test_native_gsr_outlet_forwards_to_source(self):
+        """Test that native outlets are enabled on and removed from their source."""
+        with patch('pc_controller.src.network.lsl_integration.cfg_get') as mock_cfg:
+            mock_cfg.return_value = "true"
+
+            manager = LSLOutletManager()
+            source = MagicMock()
+            source.enable_lsl.return_value = None
+
+            assert manager.create_native_gsr_outlet("device_001", source, chunk_size=4) is True
+            source.enable_lsl.assert_called_once_with(
+                "GSR Sensor - device_001", 4, 10.0, "gsr_device_001", "device_001"
+            )
+            assert "GSR_device_001" in manager.get_active_outlets()
+
+            assert manager.remove_outlet("device_001", "GSR") is True
+            source.disable_lsl.assert_called_once()
+
+            unsupported = MagicMock()
+            unsupported.enable_lsl.side_effect = RuntimeError("LSL output needs a build with USE_LSL")
+            assert manager.create_native_gsr_outlet("device_002", unsupported) is False
+            assert "GSR_device_002" not in manager.get_active_outlets()
+
     def test_unavailable_operations(self):
         """Test that operations return False when LSL is unavailable."""
         manager = LSLOutletManager()
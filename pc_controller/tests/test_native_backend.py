@@ -0,0 +1,791 @@
+"""Unit tests for the compiled native backend (NativeShimmer / NativeWebcam).
+
+These tests are skipped unless the PyBind11 extension has been built and
+placed next to pc_controller/native_backend/__init__.py. They run against the
+simulation paths so no hardware is required.
+"""
+from __future__ import annotations
+
+import gc
+import os
+import struct
+import time
+
+import pytest
+
+np = pytest.importorskip("numpy")
+nb = pytest.importorskip("pc_controller.native_backend.native_backend")
+
+
+@pytest.fixture
+def shimmer():
+    dev = nb.NativeShimmer()
+    dev.connect("SIM")
+    dev.start_streaming()
+    try:
+        yield dev
+    finally:
+        dev.stop_streaming()
+
+
+def test_get_latest_samples_array_returns_float64_columns(shimmer) -> None:
+    time.sleep(0.1)
+    ts, vals = shimmer.get_latest_samples_array()
+    assert ts.dtype == np.float64 and vals.dtype == np.float64
+    assert ts.flags["C_CONTIGUOUS"] and vals.flags["C_CONTIGUOUS"]
+    assert ts.size == vals.size > 0
+    assert np.all(np.diff(ts) >= 0)
+
+
+def test_drain_into_fills_preallocated_buffers(shimmer) -> None:
+    time.sleep(0.1)
+    ts = np.zeros(4096, dtype=np.float64)
+    vals = np.zeros(4096, dtype=np.float64)
+    n = shimmer.drain_into(ts, vals)
+    assert n > 0
+    assert np.all(vals[:n] > 0.0)
+
+
+def test_drain_into_rejects_non_float64_buffers(shimmer) -> None:
+    with pytest.raises(ValueError):
+        shimmer.drain_into(np.zeros(16, dtype=np.float32), np.zeros(16, dtype=np.float64))
+
+
+def test_get_latest_channels_carries_ppg_and_flags(shimmer) -> None:
+    time.sleep(0.1)
+    cols = shimmer.get_latest_channels()
+    assert set(cols) == {"device_ts", "host_ts", "aligned_ts", "gsr_us", "gsr_raw", "ppg_raw", "flags"}
+    n = cols["device_ts"].size
+    assert n > 0 and all(c.size == n for c in cols.values())
+    assert cols["ppg_raw"].dtype == np.uint16
+    assert np.all(cols["flags"] & nb.SAMPLE_HAS_PPG)
+
+
+def test_aligned_ts_maps_device_time_onto_host_clock(shimmer) -> None:
+    time.sleep(0.3)
+    cols = shimmer.get_latest_channels()
+    assert cols["aligned_ts"].size > 0
+    # Aligned times sit behind receive times by at most the transport latency
+    lag = cols["host_ts"] - cols["aligned_ts"]
+    assert np.all(lag > -1e-3) and np.all(lag < 0.05)
+    assert np.all(np.diff(cols["aligned_ts"]) >= 0)
+    assert shimmer.get_clock_model()["samples"] > 0
+
+
+def test_clock_model_recovers_drift_and_offset() -> None:
+    rng = np.random.default_rng(0)
+    send = np.arange(0.0, 60.0, 1 / 128)
+    device = 5.0 + send * (1 - 40e-6)
+    host = 1000.0 + send + 0.004 + rng.exponential(0.008, send.size)
+    model = nb.ClockModel()
+    # Before any observation timestamps pass through unchanged
+    np.testing.assert_array_equal(model.align(device[:3]), device[:3])
+    aligned = model.observe(device, host)
+    state = model.get_state()
+    assert abs(state["drift_ppm"] - 40.0) < 5.0
+    late = send > 20.0
+    np.testing.assert_allclose(aligned[late] - (1000.0 + send[late]), 0.004, atol=1e-3)
+    # A device counter restart resets the fit
+    model.observe(np.array([0.0]), np.array([2000.0]))
+    assert model.get_state()["resets"] == 1
+
+
+def test_synchronizer_joins_gsr_onto_frames(shimmer) -> None:
+    cam = nb.NativeWebcam(0)
+    cam.start_capture()
+    sync = nb.NativeSynchronizer(shimmers=[shimmer], webcams=[cam])
+    sync.start()
+    try:
+        time.sleep(0.5)
+    finally:
+        sync.stop()
+        cam.stop_capture()
+    joined = sync.get_joined(0)
+    stats = sync.get_stats()
+    n = joined["seq"].size
+    assert n > 5 and stats["frames"] == n and stats["pending"] == 0
+    assert joined["gsr_us"].shape == joined["window_count"].shape == (n, 1)
+    assert np.all(np.diff(joined["timestamp"]) > 0)
+    # Frames away from the ends are bracketed by samples on both sides
+    assert np.all(np.isfinite(joined["gsr_us"][1:-1, 0]))
+    counts = joined["window_count"][:, 0]
+    assert counts[0] == 0 and joined["window_ts"][0].size == counts.sum()
+    start = int(joined["window_start"][1, 0])
+    window = joined["window_ts"][0][start:start + counts[1]]
+    assert np.all((window > joined["timestamp"][0]) & (window <= joined["timestamp"][1]))
+    with pytest.raises(ValueError):
+        nb.NativeSynchronizer(shimmers=[shimmer], webcams=[])
+
+
+def test_synchronizer_keeps_its_devices_alive(shimmer) -> None:
+    cams = [nb.NativeWebcam(0)]
+    cams[0].start_capture()
+    sync = nb.NativeSynchronizer(shimmers=[shimmer], webcams=cams)
+    # Only the synchronizer refers to the webcam from here on
+    cams.clear()
+    gc.collect()
+    sync.start()
+    time.sleep(0.3)
+    sync.stop()
+    assert sync.get_stats()["frames"] > 0
+
+
+def test_eda_processor_finds_synthetic_responses() -> None:
+    t = np.arange(0.0, 60.0, 1 / 128)
+    gsr = 5.0 + 0.01 * t
+    for onset, amp in ((10.0, 0.5), (25.0, 1.0), (40.0, 0.3)):
+        after = t > onset
+        gsr[after] += amp * (np.exp(-(t[after] - onset) / 4.0) - np.exp(-(t[after] - onset) / 0.75))
+    features, scrs = nb.EdaProcessor(sample_rate=128.0).process(t, gsr)
+    assert features["tonic"].size == t.size
+    np.testing.assert_allclose(features["cleaned"], features["tonic"] + features["phasic"])
+    # The tonic level follows the drift, not the responses
+    assert abs(features["tonic"][-1] - (5.0 + 0.01 * t[-1])) < 0.1
+    np.testing.assert_allclose(scrs["onset_ts"], [10.0, 25.0, 40.0], atol=0.5)
+    assert np.all(scrs["rise_time"] > 1.0) and np.all(scrs["rise_time"] < 2.5)
+    assert scrs["amplitude"][1] > scrs["amplitude"][0] > scrs["amplitude"][2] > 0.1
+    with pytest.raises(ValueError):
+        nb.EdaProcessor(sample_rate=128.0, tonic_hz=2.0, lowpass_hz=1.0)
+    # A response whose onset sample is already its peak still reports the SCL there
+    t = np.arange(0.0, 100.0, 0.25)
+    gsr = np.full(t.size, 5.0)
+    gsr[200] += 1.0
+    _, scrs = nb.EdaProcessor(sample_rate=4.0, lowpass_hz=1.9).process(t, gsr)
+    assert scrs["tonic"].size > 0
+    np.testing.assert_allclose(scrs["tonic"], 5.0, atol=0.1)
+
+
+def test_eda_stage_streams_features_alongside_samples() -> None:
+    dev = nb.NativeShimmer()
+    dev.connect("SIM")
+    dev.enable_eda()
+    with pytest.raises(RuntimeError):
+        dev.enable_eda()
+    dev.start_streaming()
+    time.sleep(0.5)
+    dev.stop_streaming()
+    channels = dev.get_latest_channels()
+    features = dev.get_eda_features()
+    np.testing.assert_array_equal(features["aligned_ts"], channels["aligned_ts"])
+    assert set(dev.get_scr_events()) == {"onset_ts", "peak_ts", "amplitude", "rise_time", "tonic"}
+    state = dev.disable_eda()
+    assert state["samples"] == channels["gsr_us"].size > 0
+    assert state["features_dropped"] == 0
+    assert not dev.get_eda_state()["enabled"]
+    assert dev.get_eda_features()["tonic"].size == 0
+
+
+def test_decimation_pyramid_keeps_peaks_within_point_budget() -> None:
+    ts = np.arange(0.0, 3600.0, 1 / 128)
+    vals = np.sin(ts * 0.1)
+    vals[200_000] = 50.0
+    pyramid = nb.DecimationPyramid(fanout=8)
+    pyramid.append(ts, vals)
+    assert len(pyramid) == ts.size and pyramid.get_state()["levels"] > 5
+    for method in ("minmax", "lttb"):
+        x, y = pyramid.query(0.0, ts[-1], 1000, method)
+        assert 500 <= x.size <= 1000
+        assert np.all(np.diff(x) >= 0)
+        assert y.max() == 50.0
+    # A range that fits comes back raw
+    x, y = pyramid.query(10.0, 12.0, 1000)
+    np.testing.assert_array_equal(x, ts[(ts >= 10.0) & (ts <= 12.0)])
+    pyramid.append(np.array([0.0]), np.array([1.0]))
+    assert pyramid.get_state()["skipped"] == 1
+    with pytest.raises(ValueError):
+        pyramid.query(0.0, 1.0, 10, "mean")
+
+
+def test_plot_cache_follows_the_stream(shimmer) -> None:
+    shimmer.enable_plot_cache()
+    time.sleep(0.5)
+    state = shimmer.get_plot_cache_state()
+    assert state["enabled"] and state["samples"] > 0
+    x, y = shimmer.query_plot_cache(max_points=16)
+    assert 0 < x.size <= 16 and x[0] >= state["first_ts"]
+    assert shimmer.disable_plot_cache()["samples"] >= state["samples"]
+    assert shimmer.query_plot_cache()[0].size == 0
+
+
+def test_shm_reader_sees_published_samples(shimmer) -> None:
+    name = f"hb_test_{os.getpid()}"
+    shimmer.enable_shm(name, capacity=1024)
+    reader = nb.ShmStreamReader(name)
+    assert reader.wait(min_rows=32, timeout_ms=2000) >= 32
+    rows = reader.read()
+    assert rows["device_ts"].dtype == np.float64 and rows["flags"].dtype == np.uint32
+    assert rows["device_ts"].size >= 32 and np.all(np.diff(rows["device_ts"]) > 0)
+    assert not reader.columns()["gsr_us"].flags.writeable
+    stats = shimmer.get_shm_stats()
+    assert stats["published"] >= reader.cursor and stats["readers"][0]["pid"] == os.getpid()
+    with pytest.raises(RuntimeError):
+        shimmer.enable_shm(name)
+    shimmer.disable_shm()
+    assert reader.closed and shimmer.get_shm_stats() is None
+
+
+def test_capture_threads_are_registered_and_configurable(shimmer) -> None:
+    threads = [t for t in nb.get_threads() if t["role"] == "shimmer"]
+    assert any(t["name"] == "shimmer:SIM" for t in threads)
+    try:
+        nb.set_thread_policy("shimmer", priority=0, cpus=[0])
+        assert nb.get_thread_policies()["shimmer"] == {"priority": 0, "cpus": [0]}
+        mine = next(t for t in nb.get_threads() if t["name"] == "shimmer:SIM")
+        assert mine["cpus"] == [0] or mine["error"]
+    finally:
+        nb.set_thread_policy("shimmer")
+    with pytest.raises(ValueError):
+        nb.set_thread_policy("shimmer", priority=100)
+
+
+def test_small_ring_counts_dropped_samples() -> None:
+    dev = nb.NativeShimmer(ring_capacity=8)
+    assert dev.ring_capacity() == 8
+    dev.connect("SIM")
+    dev.start_streaming()
+    try:
+        time.sleep(0.2)
+        ts, _ = dev.get_latest_samples_array()
+    finally:
+        dev.stop_streaming()
+    assert ts.size <= 8
+    assert dev.dropped_samples() > 0
+
+
+def test_webcam_frame_is_tear_free_snapshot() -> None:
+    cam = nb.NativeWebcam(0)
+    cam.start_capture()
+    try:
+        frame = None
+        for _ in range(50):
+            frame = cam.get_latest_frame()
+            if frame is not None:
+                break
+            time.sleep(0.01)
+        assert frame is not None
+        assert frame.shape == (480, 640, 3) and frame.dtype == np.uint8
+        assert not frame.flags["WRITEABLE"]
+        snapshot = frame.copy()
+        time.sleep(0.1)
+        # The capture thread must not rewrite a buffer we still hold
+        assert np.array_equal(frame, snapshot)
+        assert cam.frames_delivered() >= 1
+        assert cam.frames_captured() >= cam.frames_delivered()
+    finally:
+        cam.stop_capture()
+
+
+def test_wait_for_frame_returns_newer_sequence() -> None:
+    cam = nb.NativeWebcam(0)
+    cam.start_capture()
+    try:
+        got = cam.wait_for_frame(0, 1000)
+        assert got is not None
+        frame, seq, ts = got
+        assert seq >= 1 and ts > 0.0 and frame.ndim == 3
+        newer = cam.wait_for_frame(seq, 1000)
+        assert newer is not None and newer[1] > seq and newer[2] >= ts
+    finally:
+        cam.stop_capture()
+    assert cam.wait_for_frame(cam.latest_frame_seq(), 20) is None
+
+
+def test_wait_for_samples_blocks_until_batch(shimmer) -> None:
+    shimmer.get_latest_samples_array()
+    available = shimmer.wait_for_samples(16, 1000)
+    assert available >= 16
+
+
+def test_blocking_calls_release_the_gil() -> None:
+    import threading
+
+    dev = nb.NativeShimmer()
+    dev.connect("SIM")
+    waiter = threading.Thread(target=dev.wait_for_samples, args=(1_000_000, 300))
+    deadline = time.monotonic() + 0.2
+    waiter.start()
+    ticks = 0
+    # Only ticks taken while the wait is still blocked show the GIL was released
+    while time.monotonic() < deadline:
+        ticks += 1
+    still_waiting = waiter.is_alive()
+    waiter.join()
+    assert still_waiting
+    assert ticks > 1000
+
+
+def test_lifecycle_calls_work_from_asyncio() -> None:
+    import asyncio
+
+    async def run() -> int:
+        dev = nb.NativeShimmer()
+        await asyncio.to_thread(dev.connect, "SIM")
+        await asyncio.to_thread(dev.start_streaming)
+        await asyncio.sleep(0.05)
+        await asyncio.to_thread(dev.stop_streaming)
+        return dev.get_latest_samples_array()[0].size
+
+    assert asyncio.run(run()) > 0
+
+
+def test_hub_merges_devices_in_host_time_order() -> None:
+    hub = nb.NativeShimmerHub(workers=2)
+    for i in range(4):
+        assert hub.add_device(f"SIM{i}") == i
+    hub.start()
+    try:
+        time.sleep(0.2)
+        merged = hub.drain_merged(max_lag_ms=50.0)
+        time.sleep(0.05)
+        per_device = hub.drain()
+    finally:
+        hub.stop()
+    assert hub.device_count() == 4
+    assert merged["device"].size == merged["host_ts"].size > 0
+    assert set(np.unique(merged["device"])) == {0, 1, 2, 3}
+    assert np.all(np.diff(merged["host_ts"]) >= 0)
+    assert len(per_device) == 4 and all(d["gsr_us"].size > 0 for d in per_device)
+
+
+def test_hub_discovery_connects_ports_concurrently() -> None:
+    hub = nb.NativeShimmerHub(workers=2)
+    job = hub.discover_and_connect(
+        ports=["SIM0", "SIM1", "SIM2", "SIM0"], scan_serial=False, scan_bluetooth=False
+    )
+    assert job.wait(timeout_ms=5000)
+    progress = {d["port"]: d for d in job.progress()}
+    assert list(progress) == ["SIM0", "SIM1", "SIM2"]
+    assert all(d["state"] == "connected" and d["source"] == "port" for d in progress.values())
+    assert job.result() == [0, 1, 2] and hub.device_count() == 3
+    hub.start()
+    try:
+        late = hub.discover_and_connect(ports=["SIM3"], scan_serial=False, scan_bluetooth=False)
+        assert late.wait(timeout_ms=5000)
+        assert late.progress()[0]["state"] == "failed" and late.result() == []
+    finally:
+        hub.stop()
+    with pytest.raises(ValueError):
+        hub.discover_and_connect(ports=["SIM4"], max_parallel=0)
+
+
+def test_gsr_kernel_applies_range_dependent_resistors() -> None:
+    rf = (40.2, 287.0, 1000.0, 3300.0)
+    adc = np.arange(0, 4096, 7, dtype=np.uint16)
+    for rng in range(4):
+        raw = adc | np.uint16(rng << 14)
+        us = nb.gsr_raw_to_microsiemens(raw)
+        expected = np.maximum(((adc * 3.0 / 4095.0) / 0.5 - 1.0) * 1000.0 / rf[rng], 0.1)
+        np.testing.assert_allclose(us, expected, rtol=1e-12)
+    # Mixed ranges within one SIMD vector
+    ranges = np.arange(adc.size, dtype=np.uint16) % 4
+    mixed = nb.gsr_raw_to_microsiemens(adc | (ranges << 14).astype(np.uint16))
+    expected = np.maximum(((adc * 3.0 / 4095.0) / 0.5 - 1.0) * 1000.0 / np.take(rf, ranges), 0.1)
+    np.testing.assert_allclose(mixed, expected, rtol=1e-12)
+    assert nb.gsr_kernel() in {"avx2", "scalar"}
+    with pytest.raises(ValueError):
+        nb.gsr_raw_to_microsiemens(adc, rf_kohm=[1.0, 2.0])
+
+
+def test_simulated_raw_gsr_round_trips_through_kernel(shimmer) -> None:
+    time.sleep(0.1)
+    cols = shimmer.get_latest_channels()
+    assert cols["gsr_raw"].size > 0
+    recomputed = nb.gsr_raw_to_microsiemens(cols["gsr_raw"])
+    np.testing.assert_allclose(recomputed, cols["gsr_us"], rtol=0.02)
+
+
+def test_native_recording_round_trips_every_sample(shimmer, tmp_path) -> None:
+    from pc_controller.src.data.native_recording import read_native_recording
+
+    path = tmp_path / "gsr.nbrec"
+    shimmer.start_recording(str(path), sync="chunk")
+    assert shimmer.is_recording()
+    time.sleep(0.3)
+    stats = shimmer.stop_recording()
+    assert not shimmer.is_recording()
+    cols = read_native_recording(path)
+    assert stats["rows"] == cols["device_ts"].size > 0 and stats["dropped"] == 0
+    assert cols["gsr_raw"].dtype == np.uint16
+    assert np.all(np.diff(cols["device_ts"]) > 0)
+
+
+def test_flight_recorder_survives_without_close(shimmer, tmp_path) -> None:
+    from pc_controller.src.data.flight_recorder import flight_recorder_info, read_flight_recorder
+
+    path = tmp_path / "gsr.nbfr"
+    shimmer.enable_flight_recorder(str(path), minutes=0.05)
+    time.sleep(0.3)
+    # Read while the journal is still open, as after a crash
+    assert not flight_recorder_info(path)["clean"]
+    cols = read_flight_recorder(path)
+    assert cols["device_ts"].size > 0 and np.all(np.diff(cols["row"]) == 1)
+    assert np.all(np.diff(cols["device_ts"]) > 0)
+    stats = shimmer.disable_flight_recorder()
+    info = flight_recorder_info(path)
+    assert info["clean"] and info["corrupt"] == 0
+    assert read_flight_recorder(path)["row"].size == stats["written"] >= cols["row"].size
+
+
+def test_replay_reprocesses_a_recording(shimmer, tmp_path) -> None:
+    from pc_controller.src.data.native_recording import read_native_recording
+
+    path = tmp_path / "gsr.nbrec"
+    shimmer.start_recording(str(path))
+    time.sleep(0.3)
+    shimmer.stop_recording()
+    original = read_native_recording(path)
+
+    dev = nb.NativeShimmer()
+    dev.connect("REPLAY")
+    dev.configure_replay(str(path), speed=0)
+    dev.start_recording(str(tmp_path / "again.nbrec"))
+    dev.start_streaming()
+    try:
+        deadline = time.monotonic() + 5.0
+        while not dev.get_replay()["finished"] and time.monotonic() < deadline:
+            time.sleep(0.01)
+    finally:
+        dev.stop_streaming()
+    stats = dev.stop_recording()
+    replay = dev.get_replay()
+    assert replay["finished"] and replay["replayed"] == replay["rows"] == original["device_ts"].size
+    again = read_native_recording(tmp_path / "again.nbrec")
+    assert stats["dropped"] == 0
+    np.testing.assert_array_equal(again["device_ts"], original["device_ts"])
+    assert np.all(again["flags"] & nb.SAMPLE_REPLAYED)
+    with pytest.raises(ValueError):
+        dev.configure_replay(str(path), speed=-1.0)
+
+
+def test_webcam_recording_stores_frames(tmp_path) -> None:
+    from pc_controller.src.data.native_recording import read_native_recording
+
+    cam = nb.NativeWebcam(0)
+    cam.start_capture()
+    try:
+        cam.start_recording(str(tmp_path / "cam.nbrec"))
+        time.sleep(0.2)
+        stats = cam.stop_recording()
+    finally:
+        cam.stop_capture()
+    cols = read_native_recording(tmp_path / "cam.nbrec")
+    assert cols["pixels"].shape == (stats["rows"], 480, 640, 3)
+    assert np.all(np.diff(cols["seq"].astype(np.int64)) > 0)
+
+
+def test_frame_analysis_reports_roi_statistics() -> None:
+    rois = [(0, 0, 640, 480), (100, 40, 33, 17), (700, 0, 10, 10)]
+    cam = nb.NativeWebcam(0)
+    cam.enable_frame_analysis(rois, thumbnail_levels=2)
+    cam.start_capture()
+    try:
+        frame, seq, _ts = cam.wait_for_frame(0, 1000)
+        deadline = time.monotonic() + 2.0
+        stats = {"seq": np.empty(0)}
+        while seq not in stats["seq"] and time.monotonic() < deadline:
+            time.sleep(0.05)
+            stats = cam.get_roi_stats()
+        thumb = cam.get_thumbnail(2)
+    finally:
+        cam.stop_capture()
+    state = cam.disable_frame_analysis()
+    assert stats["mean"].shape == stats["var"].shape == (stats["seq"].size, 3, 3)
+    i = int(np.flatnonzero(stats["seq"] == seq)[0])
+    ref = frame.astype(np.float64)
+    np.testing.assert_allclose(stats["mean"][i, 0], ref.mean(axis=(0, 1)))
+    np.testing.assert_allclose(stats["var"][i, 1], ref[40:57, 100:133].var(axis=(0, 1)))
+    assert np.all(np.isnan(stats["mean"][:, 2]))
+    mean, var = nb.frame_roi_stats(frame, rois[:2])
+    np.testing.assert_allclose(mean, stats["mean"][i, :2])
+    np.testing.assert_allclose(var, stats["var"][i, :2])
+    assert thumb is not None and thumb[0].shape == (120, 160, 3)
+    assert state["frames"] >= stats["seq"].size and state["errors"] == 0
+    with pytest.raises(ValueError):
+        cam.enable_frame_analysis([(0, 0, 0, 10)])
+
+
+@pytest.mark.skipif(not getattr(nb, "jpeg_enabled", False), reason="built without libjpeg")
+def test_mjpeg_encoder_writes_file_and_preview(tmp_path) -> None:
+    from pc_controller.src.data.native_recording import read_native_recording
+
+    cam = nb.NativeWebcam(0)
+    cam.start_capture()
+    try:
+        cam.start_encoding(str(tmp_path / "cam_mjpeg.nbrec"), codec="mjpeg", quality=80)
+        preview = cam.wait_for_encoded_preview(0, 1000)
+        time.sleep(0.1)
+        stats = cam.stop_encoding()
+    finally:
+        cam.stop_capture()
+    assert preview is not None
+    jpeg, seq, ts = preview
+    assert jpeg[:2] == b"\xff\xd8" and seq >= 1 and ts > 0.0
+    cols = read_native_recording(tmp_path / "cam_mjpeg.nbrec")
+    assert cols["jpeg"].size == stats["frames"] > 0
+    assert all(j[:2] == b"\xff\xd8" for j in cols["jpeg"])
+
+
+@pytest.mark.skipif(
+    not (getattr(nb, "h264_enabled", False) and getattr(nb, "jpeg_enabled", False)),
+    reason="built without FFmpeg or libjpeg",
+)
+def test_h264_encoder_skips_corrupt_mjpeg_frames(tmp_path) -> None:
+    from pc_controller.src.data.native_recording import read_native_recording
+
+    cam = nb.NativeWebcam(0, width=160, height=120, fps=60.0, pixel_format="MJPG")
+    cam.start_capture()
+    try:
+        cam.start_recording(str(tmp_path / "mjpg.nbrec"))
+        time.sleep(0.2)
+        cam.stop_recording()
+    finally:
+        cam.stop_capture()
+    cols = read_native_recording(tmp_path / "mjpg.nbrec")
+    jpegs = [bytes(p) for p in cols["pixels"]]
+    assert len(jpegs) >= 3
+    jpegs[0] = jpegs[0][:16]  # truncated inside the JPEG header
+
+    # Rewrite the recording with the truncated frame, one chunk per frame
+    columns = ["seq:<u8", "timestamp:<f8", "width:<u4", "height:<u4", "channels:<u4", "format:<u4"]
+    out = bytearray(b"NBREC01\0" + struct.pack("<I", len(columns) + 1))
+    for field in [f for c in columns for f in c.split(":")] + ["pixels", "|u1"]:
+        out += struct.pack("<H", len(field)) + field.encode()
+    for i, (ts, jpeg) in enumerate(zip(cols["timestamp"], jpegs, strict=True)):
+        fields = (i + 1, ts, 160, 120, 3, 4)
+        values = [struct.pack("<" + f, v) for f, v in zip("QdIIII", fields, strict=True)]
+        out += struct.pack("<IIQ", 0x4B4E4843, 1, i)
+        out += struct.pack("<7Q", *(len(v) for v in values), len(jpeg)) + b"".join(values) + jpeg
+    (tmp_path / "corrupt.nbrec").write_bytes(bytes(out))
+
+    replay = nb.NativeWebcam(0, width=160, height=120, pixel_format="MJPG")
+    replay.configure_replay(str(tmp_path / "corrupt.nbrec"), speed=0)
+    replay.start_encoding(str(tmp_path / "cam.mp4"), codec="h264", preview_interval=0)
+    replay.start_capture()
+    try:
+        deadline = time.monotonic() + 5.0
+        while not replay.get_replay()["finished"] and time.monotonic() < deadline:
+            time.sleep(0.01)
+    finally:
+        replay.stop_capture()
+    stats = replay.stop_encoding()
+    assert stats["errors"] == 1
+    assert stats["frames"] + stats["dropped"] == len(jpegs) - 1 and stats["frames"] > 0
+
+
+@pytest.mark.parametrize(
+    ("fmt", "native_shape"),
+    [("GRAY", (120, 160)), ("YUYV", (120, 160, 2)), ("NV12", (180, 160))],
+)
+def test_webcam_delivers_native_format_and_bgr_view(fmt, native_shape) -> None:
+    cam = nb.NativeWebcam(0, width=160, height=120, fps=60.0, pixel_format=fmt)
+    cam.start_capture()
+    try:
+        got = cam.wait_for_frame(0, 1000, native=True)
+        assert got is not None
+        raw, seq, _ts = got
+        bgr = cam.get_latest_frame()
+    finally:
+        cam.stop_capture()
+    assert raw.shape == native_shape and raw.dtype == np.uint8
+    assert bgr.shape == (120, 160, 3)
+    assert cam.delivered_pixel_format() == fmt
+    assert cam.get_config() == {"width": 160, "height": 120, "fps": 60.0, "pixel_format": fmt}
+    if fmt == "GRAY":
+        assert np.array_equal(bgr[..., 0], raw) and np.array_equal(bgr[..., 2], raw)
+
+
+def test_webcam_configure_requires_stopped_capture() -> None:
+    cam = nb.NativeWebcam(0)
+    with pytest.raises(ValueError):
+        cam.configure(width=641, height=480, pixel_format="YUYV")
+    cam.start_capture()
+    try:
+        with pytest.raises(RuntimeError):
+            cam.configure(width=320, height=240)
+    finally:
+        cam.stop_capture()
+    cam.configure(width=320, height=240, pixel_format="GRAY")
+    assert cam.get_config()["pixel_format"] == "GRAY"
+
+
+def test_webcam_without_device_falls_back_to_synthetic() -> None:
+    cam = nb.NativeWebcam(99, width=160, height=120)
+    assert cam.capture_backend() == ""
+    cam.start_capture()
+    try:
+        assert cam.wait_for_frame(0, 1000) is not None
+        assert cam.capture_backend() == "synthetic"
+    finally:
+        cam.stop_capture()
+    assert nb.native_camera_backend in ("v4l2", "mediafoundation", "")
+
+
+def test_synthetic_sources_hold_their_rate() -> None:
+    cam = nb.NativeWebcam(99, width=64, height=48, fps=50.0, pixel_format="GRAY")
+    cam.start_capture()
+    time.sleep(1.0)
+    cam.stop_capture()
+    # Absolute deadlines: no per-frame drift, so one second holds ~50 frames
+    assert 45 <= cam.frames_captured() <= 52
+
+
+def test_simulator_is_deterministic_per_seed_at_high_rate() -> None:
+    def run(seed: int) -> dict:
+        dev = nb.NativeShimmer(ring_capacity=1 << 16)
+        dev.connect("SIM")
+        dev.configure_simulation(rate_hz=10000.0, seed=seed, dropout_rate=0.1)
+        dev.start_streaming()
+        time.sleep(0.2)
+        dev.stop_streaming()
+        return dev.get_latest_channels() | {"sim": dev.get_simulation()}
+
+    a, b, c = run(1), run(1), run(2)
+    n = min(a["gsr_raw"].size, b["gsr_raw"].size)
+    assert n > 1000
+    np.testing.assert_array_equal(a["gsr_raw"][:n], b["gsr_raw"][:n])
+    np.testing.assert_array_equal(a["device_ts"][:n], b["device_ts"][:n])
+    assert not np.array_equal(a["gsr_raw"][:n], c["gsr_raw"][:n])
+    sim = a["sim"]
+    assert sim["samples"] == a["gsr_raw"].size + sim["dropouts"]
+    assert 0.05 < sim["dropouts"] / sim["samples"] < 0.15
+
+
+def test_configure_simulation_validates_and_requires_stopped_stream(shimmer) -> None:
+    with pytest.raises(RuntimeError):
+        shimmer.configure_simulation(rate_hz=1000.0)
+    dev = nb.NativeShimmer()
+    with pytest.raises(ValueError):
+        dev.configure_simulation(rate_hz=0.0)
+    with pytest.raises(ValueError):
+        dev.configure_simulation(dropout_rate=1.5)
+
+
+def test_get_stats_reports_counters_and_latency_histograms() -> None:
+    dev = nb.NativeShimmer()
+    dev.connect("SIM")
+    dev.configure_simulation(rate_hz=1000.0)
+    dev.start_streaming()
+    time.sleep(0.3)
+    ts, _ = dev.get_latest_samples_array()
+    dev.stop_streaming()
+    stats = dev.get_stats()
+    assert stats["packets"] >= ts.size > 100
+    assert stats["errors"] == 0 and stats["ring_dropped"] == 0
+    gaps, drain = stats["interarrival"], stats["drain_latency"]
+    assert gaps["count"] > 100
+    assert 0.0005 < gaps["p50"] < 0.003
+    assert gaps["min"] <= gaps["p50"] <= gaps["p99"] <= gaps["max"]
+    assert drain["count"] == ts.size
+    assert 0.0 <= drain["p50"] <= drain["max"] < 1.0
+    dev.reset_stats()
+    assert dev.get_stats()["interarrival"]["count"] == 0
+
+    cam = nb.NativeWebcam(99, 320, 240, 50.0)
+    cam.start_capture()
+    last = 0
+    for _ in range(10):
+        got = cam.wait_for_frame(last, 500)
+        if got is not None:
+            last = got[1]
+    cam.stop_capture()
+    stats = cam.get_stats()
+    assert stats["frames_captured"] >= 10
+    assert stats["delivery_latency"]["count"] >= 10
+    assert 0.01 < stats["interarrival"]["p50"] < 0.04
+
+
+def test_lost_link_reconnects_and_flags_the_gap() -> None:
+    dev = nb.NativeShimmer(ring_capacity=1 << 14)
+    dev.connect("SIM")
+    dev.configure_simulation(rate_hz=500.0, disconnect_rate=4.0, disconnect_ms=300.0)
+    dev.set_reconnect_policy(initial_backoff_ms=20.0, max_backoff_ms=100.0)
+    dev.start_streaming()
+    states, last = [], 0
+    deadline = time.monotonic() + 3.0
+    while time.monotonic() < deadline and not ("reconnecting" in states and states[-1] == "streaming"):
+        for event in dev.wait_for_link_events(last, 200):
+            last = event["seq"]
+            states.append(event["state"])
+    ch = dev.get_latest_channels()
+    dev.stop_streaming()
+    assert states[0] == "streaming" and "reconnecting" in states and states[-1] == "streaming"
+    gaps = (ch["flags"] & nb.SAMPLE_AFTER_GAP) != 0
+    assert gaps.any()
+    # The first sample after the outage is at least disconnect_ms past the last one before it
+    i = int(np.argmax(gaps))
+    assert i > 0 and ch["device_ts"][i] - ch["device_ts"][i - 1] >= 0.29
+    assert dev.get_stats()["reconnects"] >= 1
+    assert dev.get_simulation()["lost"] > 0
+    assert dev.link_state() == "idle"
+
+
+def test_link_fails_when_reconnect_is_disabled() -> None:
+    dev = nb.NativeShimmer()
+    dev.connect("SIM")
+    dev.configure_simulation(rate_hz=500.0, disconnect_rate=10.0, disconnect_ms=300.0)
+    dev.set_reconnect_policy(enabled=False)
+    assert dev.get_reconnect_policy()["enabled"] is False
+    dev.start_streaming()
+    last, failed = 0, False
+    for _ in range(20):
+        for event in dev.wait_for_link_events(last, 200):
+            last = event["seq"]
+            failed = failed or event["state"] == "failed"
+        if failed:
+            break
+    assert failed and dev.link_state() == "failed"
+    dev.stop_streaming()
+    assert dev.link_state() == "failed"
+    with pytest.raises(ValueError):
+        dev.set_reconnect_policy(initial_backoff_ms=500.0, max_backoff_ms=100.0)
+
+
+def test_subscribers_each_receive_every_sample_in_batches() -> None:
+    dev = nb.NativeShimmer(ring_capacity=1 << 14)
+    dev.connect("SIM")
+    dev.configure_simulation(rate_hz=1000.0)
+    batches: dict[str, list[dict]] = {"count": [], "latency": []}
+    by_count = dev.subscribe(lambda ch: batches["count"].append(ch), batch_size=64, max_latency_ms=1000.0)
+    by_latency = dev.subscribe(lambda ch: batches["latency"].append(ch), batch_size=100000, max_latency_ms=20.0)
+    dev.start_streaming()
+    time.sleep(0.5)
+    drained, _ = dev.get_latest_samples_array()  # does not take samples from subscribers
+    time.sleep(0.2)
+    dev.stop_streaming()
+    time.sleep(0.1)
+    subs = {s["id"]: s for s in dev.get_subscriptions()}
+    assert dev.unsubscribe(by_count) and dev.unsubscribe(by_latency)
+    assert not dev.unsubscribe(by_count)
+
+    count_sizes = [b["gsr_us"].size for b in batches["count"]]
+    assert len(count_sizes) > 5 and all(n == 64 for n in count_sizes[:-1])
+    late = batches["latency"]
+    assert len(late) > 10
+    assert set(late[0]) == {"device_ts", "host_ts", "aligned_ts", "gsr_us", "gsr_raw", "ppg_raw", "flags"}
+    ts = np.concatenate([b["device_ts"] for b in late])
+    assert ts.size == subs[by_latency]["samples"] > drained.size
+    assert np.all(np.diff(ts) > 0)
+    assert subs[by_latency]["latency"]["p50"] < 0.05
+    assert subs[by_count]["dropped"] == subs[by_latency]["dropped"] == 0
+    with pytest.raises(ValueError):
+        dev.subscribe(lambda ch: None, batch_size=0)
+
+
+def test_native_lsl_outlet_pushes_every_sample() -> None:
+    dev = nb.NativeShimmer()
+    dev.connect("SIM")
+    if not nb.lsl_enabled:
+        with pytest.raises(RuntimeError):
+            dev.enable_lsl("GSR Sensor - test")
+        assert dev.get_lsl_stats() is None
+        return
+    dev.enable_lsl("GSR Sensor - test", chunk_size=4, max_latency_ms=10.0, source_id="gsr_test")
+    with pytest.raises(RuntimeError):
+        dev.enable_lsl("GSR Sensor - test")
+    dev.start_streaming()
+    time.sleep(0.3)
+    assert dev.get_lsl_stats()["samples"] > 0
+    dev.stop_streaming()
+    stats = dev.disable_lsl()
+    assert stats["samples"] == dev.get_stats()["packets"] > 0
+    assert stats["dropped"] == 0 and stats["latency"]["p99"] < 0.05